@@ -0,0 +1,79 @@
+#include "activitypanel.h"
+#include <QHeaderView>
+
+namespace {
+
+// Sorts the count columns numerically instead of as text
+class CountItem : public QTreeWidgetItem
+{
+public:
+    using QTreeWidgetItem::QTreeWidgetItem;
+
+    bool operator<(const QTreeWidgetItem &other) const override
+    {
+        int column = treeWidget() ? treeWidget()->sortColumn() : 0;
+        if (column == 0) {
+            return text(0).toLower() < other.text(0).toLower();
+        }
+        return data(column, Qt::UserRole).toDouble() < other.data(column, Qt::UserRole).toDouble();
+    }
+};
+
+} // namespace
+
+ActivityPanel::ActivityPanel(QWidget *parent)
+    : QWidget(parent)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(5, 5, 5, 5);
+    layout->setSpacing(5);
+
+    // Header label
+    m_headerLabel = new QLabel("Most Active", this);
+    m_headerLabel->setStyleSheet("font-weight: bold; color: #9147ff;");
+
+    // Sortable table: user + decayed message counts per horizon
+    m_treeWidget = new QTreeWidget(this);
+    m_treeWidget->setRootIsDecorated(false);
+    m_treeWidget->setHeaderLabels(QStringList() << "User" << "1m" << "5m" << "15m");
+    m_treeWidget->setSortingEnabled(true);
+    m_treeWidget->sortByColumn(1, Qt::DescendingOrder);
+    m_treeWidget->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int column = 1; column <= 3; ++column) {
+        m_treeWidget->header()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+    }
+    m_treeWidget->setToolTip("Approximate messages per user (Count-Min Sketch, time-decayed)");
+
+    layout->addWidget(m_headerLabel);
+    layout->addWidget(m_treeWidget);
+
+    connect(m_treeWidget, &QTreeWidget::itemDoubleClicked, [this](QTreeWidgetItem *item, int) {
+        emit userInfoRequested(item->text(0));
+    });
+}
+
+void ActivityPanel::setEntries(const QList<HeavyHitters::Entry> &entries)
+{
+    // Rebuild with sorting off, then restore the user's sort column
+    m_treeWidget->setUpdatesEnabled(false);
+    m_treeWidget->setSortingEnabled(false);
+    m_treeWidget->clear();
+
+    for (const HeavyHitters::Entry &entry : entries) {
+        CountItem *item = new CountItem(m_treeWidget);
+        item->setText(0, entry.username);
+        for (int h = 0; h < HeavyHitters::HorizonCount; ++h) {
+            item->setText(h + 1, QString::number(qRound(entry.counts[h])));
+            item->setData(h + 1, Qt::UserRole, entry.counts[h]);
+            item->setTextAlignment(h + 1, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+
+    m_treeWidget->setSortingEnabled(true);
+    m_treeWidget->setUpdatesEnabled(true);
+}
+
+void ActivityPanel::clearEntries()
+{
+    m_treeWidget->clear();
+}
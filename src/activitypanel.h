@@ -0,0 +1,30 @@
+#ifndef ACTIVITYPANEL_H
+#define ACTIVITYPANEL_H
+
+#include <QWidget>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+#include <QLabel>
+#include "moderation/heavyhitters.h"
+
+// "Most active" chatters of the current channel over 1/5/15 minutes,
+// fed from the channel's HeavyHitters sketch
+class ActivityPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ActivityPanel(QWidget *parent = nullptr);
+
+    void setEntries(const QList<HeavyHitters::Entry> &entries);
+    void clearEntries();
+
+signals:
+    void userInfoRequested(const QString &username);
+
+private:
+    QLabel *m_headerLabel;
+    QTreeWidget *m_treeWidget;
+};
+
+#endif // ACTIVITYPANEL_H
@@ -0,0 +1,142 @@
+#include "automoddialog.h"
+#include "moderation/automodqueue.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QShortcut>
+#include <QItemSelectionModel>
+#include <algorithm>
+
+AutoModDialog::AutoModDialog(AutoModQueue *queue, QWidget *parent)
+    : QDialog(parent)
+    , m_queue(queue)
+{
+    setWindowTitle("AutoMod Queue");
+    resize(640, 480);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *topLayout = new QHBoxLayout();
+    m_channelCombo = new QComboBox(this);
+    m_countLabel = new QLabel(this);
+    topLayout->addWidget(new QLabel("Channel:", this));
+    topLayout->addWidget(m_channelCombo, 1);
+    topLayout->addWidget(m_countLabel);
+    mainLayout->addLayout(topLayout);
+
+    // Virtualized: fixed row height, only visible rows are laid out
+    m_listView = new QListView(this);
+    m_listView->setModel(m_queue);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setLayoutMode(QListView::Batched);
+    m_listView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_listView->setWordWrap(false);
+    m_listView->setTextElideMode(Qt::ElideRight);
+    mainLayout->addWidget(m_listView);
+
+    QLabel *hint = new QLabel("A approve, D deny, Shift/Ctrl to select several, Ctrl+A all", this);
+    hint->setStyleSheet("color: gray; font-size: 11px;");
+    mainLayout->addWidget(hint);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    m_approveButton = new QPushButton("Approve (A)", this);
+    m_denyButton = new QPushButton("Deny (D)", this);
+    QPushButton *closeButton = new QPushButton("Close", this);
+    buttonLayout->addWidget(m_approveButton);
+    buttonLayout->addWidget(m_denyButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(m_approveButton, &QPushButton::clicked, [this]() { act(true); });
+    connect(m_denyButton, &QPushButton::clicked, [this]() { act(false); });
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+
+    QShortcut *approveShortcut = new QShortcut(QKeySequence(Qt::Key_A), m_listView);
+    connect(approveShortcut, &QShortcut::activated, [this]() { act(true); });
+    QShortcut *denyShortcut = new QShortcut(QKeySequence(Qt::Key_D), m_listView);
+    connect(denyShortcut, &QShortcut::activated, [this]() { act(false); });
+
+    connect(m_channelCombo, &QComboBox::activated, [this](int index) {
+        m_queue->setChannel(m_channelCombo->itemData(index).toString());
+        m_listView->setCurrentIndex(m_queue->index(0));
+        updateButtons();
+    });
+    connect(m_listView->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &AutoModDialog::updateButtons);
+    connect(m_queue, &AutoModQueue::countsChanged, this, &AutoModDialog::refreshChannels);
+    connect(m_queue, &QAbstractItemModel::modelReset, this, [this]() {
+        // The reset replaced the selection model's contents, not the object
+        updateButtons();
+    });
+
+    refreshChannels();
+}
+
+void AutoModDialog::showChannel(const QString &channel)
+{
+    if (!channel.isEmpty()) {
+        m_queue->setChannel(channel);
+    }
+    refreshChannels();
+    if (!m_listView->currentIndex().isValid()) {
+        m_listView->setCurrentIndex(m_queue->index(0));
+    }
+    m_listView->setFocus();
+}
+
+void AutoModDialog::refreshChannels()
+{
+    QStringList channels = m_queue->channels();
+    const QString current = m_queue->channel();
+    if (!current.isEmpty() && !channels.contains(current)) {
+        channels.append(current);
+    }
+
+    m_channelCombo->blockSignals(true);
+    m_channelCombo->clear();
+    for (const QString &channel : channels) {
+        m_channelCombo->addItem(QString("#%1 (%2)").arg(channel).arg(m_queue->pendingCount(channel)), channel);
+    }
+    m_channelCombo->setCurrentIndex(m_channelCombo->findData(current));
+    m_channelCombo->blockSignals(false);
+
+    m_countLabel->setText(QString("%1 held in all channels").arg(m_queue->pendingCount()));
+    updateButtons();
+}
+
+void AutoModDialog::updateButtons()
+{
+    bool any = m_listView->selectionModel()->hasSelection();
+    m_approveButton->setEnabled(any);
+    m_denyButton->setEnabled(any);
+}
+
+void AutoModDialog::act(bool allow)
+{
+    const QModelIndexList selected = m_listView->selectionModel()->selectedIndexes();
+    if (selected.isEmpty()) {
+        return;
+    }
+
+    QList<int> rows;
+    for (const QModelIndex &index : selected) {
+        rows.append(index.row());
+    }
+    std::sort(rows.begin(), rows.end());
+
+    if (allow) {
+        m_queue->approve(rows);
+    } else {
+        m_queue->deny(rows);
+    }
+
+    // Continue with the next message nobody has acted on yet
+    for (int row = rows.last() + 1; row < m_queue->rowCount(); ++row) {
+        QModelIndex next = m_queue->index(row);
+        if (next.data(AutoModQueue::StateRole).toInt() == HeldMessage::Pending) {
+            m_listView->setCurrentIndex(next);
+            return;
+        }
+    }
+    m_listView->clearSelection();
+}
@@ -0,0 +1,41 @@
+#ifndef AUTOMODDIALOG_H
+#define AUTOMODDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QListView>
+#include <QLabel>
+#include <QPushButton>
+
+class AutoModQueue;
+
+// Triage window for AutoMod-held messages.
+//
+// The list is a QListView over AutoModQueue with uniform row heights, so
+// only visible rows are laid out however long the queue grows. Keys:
+// A approves and D denies the selection (Shift/Ctrl extend it, Ctrl+A
+// takes everything), after which the cursor moves to the next row still
+// waiting for review.
+class AutoModDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    AutoModDialog(AutoModQueue *queue, QWidget *parent = nullptr);
+
+    void showChannel(const QString &channel);
+
+private:
+    void act(bool allow);
+    void refreshChannels();
+    void updateButtons();
+
+    AutoModQueue *m_queue;
+    QComboBox *m_channelCombo;
+    QListView *m_listView;
+    QLabel *m_countLabel;
+    QPushButton *m_approveButton;
+    QPushButton *m_denyButton;
+};
+
+#endif // AUTOMODDIALOG_H
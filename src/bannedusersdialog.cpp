@@ -0,0 +1,272 @@
+#include "bannedusersdialog.h"
+#include "moderation/banlist.h"
+#include <QAbstractTableModel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QElapsedTimer>
+
+// Rows of the current search; the view only asks for visible ones
+class BanTableModel : public QAbstractTableModel
+{
+public:
+    using QAbstractTableModel::QAbstractTableModel;
+
+    void setBans(const QList<BannedUser> &bans)
+    {
+        beginResetModel();
+        m_bans = bans;
+        endResetModel();
+    }
+
+    BannedUser ban(int row) const { return m_bans.value(row); }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : int(m_bans.size());
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override
+    {
+        return parent.isValid() ? 0 : 5;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override
+    {
+        if (!index.isValid() || index.row() >= m_bans.size()) {
+            return QVariant();
+        }
+        const BannedUser &ban = m_bans.at(index.row());
+        if (role == Qt::ToolTipRole) {
+            return ban.reason;
+        }
+        if (role != Qt::DisplayRole) {
+            return QVariant();
+        }
+        switch (index.column()) {
+        case 0:
+            return ban.login;
+        case 1:
+            return ban.createdAt.toLocalTime().toString("yyyy-MM-dd HH:mm");
+        case 2:
+            return ban.expiresAt.isValid() ? ban.expiresAt.toLocalTime().toString("yyyy-MM-dd HH:mm")
+                                           : QString("permanent");
+        case 3:
+            return ban.moderatorLogin;
+        case 4:
+            return ban.reason;
+        default:
+            return QVariant();
+        }
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+    {
+        static const char *const titles[] = {"Login", "Banned", "Expires", "Moderator", "Reason"};
+        if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < 5) {
+            return QString(titles[section]);
+        }
+        return QVariant();
+    }
+
+private:
+    QList<BannedUser> m_bans;
+};
+
+BannedUsersDialog::BannedUsersDialog(BanList *banList, QWidget *parent)
+    : QDialog(parent)
+    , m_banList(banList)
+{
+    setWindowTitle("Banned Users");
+    resize(760, 520);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *topLayout = new QHBoxLayout();
+    m_channelCombo = new QComboBox(this);
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText("Login starts with...");
+    m_searchEdit->setClearButtonEnabled(true);
+    m_sortCombo = new QComboBox(this);
+    m_sortCombo->addItem("Newest first", BanList::NewestFirst);
+    m_sortCombo->addItem("Oldest first", BanList::OldestFirst);
+    m_sortCombo->addItem("Login", BanList::ByLogin);
+    topLayout->addWidget(m_channelCombo);
+    topLayout->addWidget(m_searchEdit, 1);
+    topLayout->addWidget(m_sortCombo);
+    mainLayout->addLayout(topLayout);
+
+    m_model = new BanTableModel(this);
+    m_tableView = new QTableView(this);
+    m_tableView->setModel(m_model);
+    m_tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_tableView->verticalHeader()->setVisible(false);
+    // Fixed row height: no per-row measuring, however many bans
+    m_tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_tableView->verticalHeader()->setDefaultSectionSize(m_tableView->fontMetrics().height() + 6);
+    m_tableView->horizontalHeader()->setStretchLastSection(true);
+    m_tableView->setWordWrap(false);
+    mainLayout->addWidget(m_tableView);
+
+    QHBoxLayout *bottomLayout = new QHBoxLayout();
+    m_statusLabel = new QLabel(this);
+    m_refreshButton = new QPushButton("Refresh", this);
+    m_refreshButton->setToolTip("Fetch the full ban list from Twitch again");
+    m_unbanButton = new QPushButton("Unban", this);
+    QPushButton *closeButton = new QPushButton("Close", this);
+    bottomLayout->addWidget(m_statusLabel, 1);
+    bottomLayout->addWidget(m_refreshButton);
+    bottomLayout->addWidget(m_unbanButton);
+    bottomLayout->addWidget(closeButton);
+    mainLayout->addLayout(bottomLayout);
+
+    m_redrawTimer = new QTimer(this);
+    m_redrawTimer->setSingleShot(true);
+    m_redrawTimer->setInterval(REDRAW_MS);
+    connect(m_redrawTimer, &QTimer::timeout, this, &BannedUsersDialog::requery);
+
+    connect(m_channelCombo, &QComboBox::activated, [this]() {
+        showChannel(currentChannel());
+    });
+    connect(m_searchEdit, &QLineEdit::textChanged, this, &BannedUsersDialog::requery);
+    connect(m_sortCombo, &QComboBox::activated, this, &BannedUsersDialog::requery);
+    connect(m_refreshButton, &QPushButton::clicked, this, &BannedUsersDialog::refresh);
+    connect(m_unbanButton, &QPushButton::clicked, this, &BannedUsersDialog::unbanSelected);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+
+    connect(m_banList, &BanList::changed, this, [this](const QString &channel) {
+        if (channel == currentChannel() && isVisible() && !m_redrawTimer->isActive()) {
+            m_redrawTimer->start();
+        }
+    });
+    connect(m_banList, &BanList::syncProgress, this, [this](const QString &channel) {
+        if (channel == currentChannel()) {
+            updateStatus();
+        }
+    });
+    connect(m_banList, &BanList::syncFinished, this, [this](const QString &channel) {
+        if (channel == currentChannel()) {
+            updateStatus();
+        }
+    });
+    connect(m_banList, &BanList::syncFailed, this, [this](const QString &channel, const QString &error) {
+        if (channel == currentChannel()) {
+            m_statusLabel->setText("Sync failed: " + error);
+            m_refreshButton->setEnabled(true);
+        }
+    });
+}
+
+void BannedUsersDialog::setModeratorId(const QString &moderatorId)
+{
+    m_moderatorId = moderatorId;
+}
+
+void BannedUsersDialog::setChannels(const QMap<QString, QString> &channels)
+{
+    const QString current = currentChannel();
+    m_broadcasterIds = channels;
+
+    m_channelCombo->clear();
+    for (auto it = channels.constBegin(); it != channels.constEnd(); ++it) {
+        m_channelCombo->addItem("#" + it.key(), it.key());
+    }
+    int index = m_channelCombo->findData(current);
+    m_channelCombo->setCurrentIndex(index >= 0 ? index : 0);
+}
+
+QString BannedUsersDialog::currentChannel() const
+{
+    return m_channelCombo->currentData().toString();
+}
+
+void BannedUsersDialog::showChannel(const QString &channel)
+{
+    int index = m_channelCombo->findData(channel);
+    if (index < 0) {
+        return;
+    }
+    m_channelCombo->setCurrentIndex(index);
+
+    // Stored list first; walk the channel only the first time
+    m_banList->open(channel);
+    QString broadcasterId = m_broadcasterIds.value(channel);
+    if (broadcasterId.isEmpty()) {
+        broadcasterId = m_banList->broadcasterId(channel);
+    }
+    if (!m_banList->hasSynced(channel) && !m_banList->isSyncing(channel) && !broadcasterId.isEmpty()) {
+        m_banList->sync(channel, broadcasterId);
+    }
+    requery();
+}
+
+void BannedUsersDialog::requery()
+{
+    QElapsedTimer timer;
+    timer.start();
+    const auto order = BanList::SortOrder(m_sortCombo->currentData().toInt());
+    m_model->setBans(m_banList->search(currentChannel(), m_searchEdit->text(), order));
+    // Runs on every keystroke; only a search slower than a frame is worth a line
+    if (timer.elapsed() > 16) {
+        qWarning() << "Ban search took" << timer.elapsed() << "ms for" << m_model->rowCount() << "rows";
+    }
+    updateStatus();
+}
+
+void BannedUsersDialog::refresh()
+{
+    const QString channel = currentChannel();
+    QString broadcasterId = m_broadcasterIds.value(channel);
+    if (broadcasterId.isEmpty()) {
+        broadcasterId = m_banList->broadcasterId(channel);
+    }
+    if (channel.isEmpty() || broadcasterId.isEmpty()) {
+        m_statusLabel->setText("Channel id not known yet, open its chat first");
+        return;
+    }
+    m_banList->sync(channel, broadcasterId);
+    updateStatus();
+}
+
+void BannedUsersDialog::unbanSelected()
+{
+    const QModelIndexList rows = m_tableView->selectionModel()->selectedRows();
+    if (rows.isEmpty() || m_moderatorId.isEmpty()) {
+        return;
+    }
+    if (rows.size() > 1) {
+        auto answer = QMessageBox::question(this, "Unban",
+                                            QString("Unban %1 accounts in #%2?").arg(rows.size())
+                                            .arg(currentChannel()));
+        if (answer != QMessageBox::Yes) {
+            return;
+        }
+    }
+
+    const QString channel = currentChannel();
+    for (const QModelIndex &row : rows) {
+        const BannedUser ban = m_model->ban(row.row());
+        m_banList->unban(channel, m_moderatorId, ban.userId)
+            .then(this, [this, ban](const ApiReply &reply) {
+                if (!reply.ok() && reply.statusCode != 400) {
+                    m_statusLabel->setText(QString("Unbanning %1 failed: %2").arg(ban.login, reply.error));
+                }
+            });
+    }
+}
+
+void BannedUsersDialog::updateStatus()
+{
+    const QString channel = currentChannel();
+    QString text = QString("%1 of %2 shown").arg(m_model->rowCount()).arg(m_banList->count(channel));
+    if (m_banList->isSyncing(channel)) {
+        text += ", syncing...";
+    } else if (m_banList->hasSynced(channel)) {
+        text += ", synced " + m_banList->syncedAt(channel).toLocalTime().toString("yyyy-MM-dd HH:mm");
+    }
+    m_statusLabel->setText(text);
+    m_refreshButton->setEnabled(!m_banList->isSyncing(channel));
+    m_unbanButton->setEnabled(!m_moderatorId.isEmpty());
+}
@@ -0,0 +1,56 @@
+#ifndef BANNEDUSERSDIALOG_H
+#define BANNEDUSERSDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QTableView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QMap>
+
+class BanList;
+class BanTableModel;
+
+// Ban browser over the local BanList: prefix search on login, sorting by
+// ban time or login, unban. Opens from the stored list; a channel is only
+// walked in full on its first visit or on Refresh, later changes come in
+// through the store. Redraws during a sync are coalesced to REDRAW_MS.
+class BannedUsersDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    BannedUsersDialog(BanList *banList, QWidget *parent = nullptr);
+
+    void setModeratorId(const QString &moderatorId);
+    // channel -> broadcaster id (may be empty until known)
+    void setChannels(const QMap<QString, QString> &channels);
+    void showChannel(const QString &channel);
+
+    static constexpr int REDRAW_MS = 250;
+
+private:
+    QString currentChannel() const;
+    void requery();
+    void refresh();
+    void unbanSelected();
+    void updateStatus();
+
+    BanList *m_banList;
+    QString m_moderatorId;
+    QMap<QString, QString> m_broadcasterIds;
+
+    QComboBox *m_channelCombo;
+    QLineEdit *m_searchEdit;
+    QComboBox *m_sortCombo;
+    QTableView *m_tableView;
+    BanTableModel *m_model;
+    QLabel *m_statusLabel;
+    QPushButton *m_refreshButton;
+    QPushButton *m_unbanButton;
+    QTimer *m_redrawTimer;
+};
+
+#endif // BANNEDUSERSDIALOG_H
@@ -1,6 +1,32 @@
 #include "chatwidget.h"
 #include <QDateTime>
 #include <QScrollBar>
+#include <QMenu>
+#include <QCursor>
+#include <QApplication>
+#include <QClipboard>
+#include <QTextCursor>
+#include <QTextCharFormat>
+#include <QTextBlockUserData>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <algorithm>
+
+namespace {
+// Tags of a chat line, owned by its text block so any line still on
+// screen can be moderated, tracked or not
+struct LineData : QTextBlockUserData {
+    QString messageId;
+    QString username;
+    QString userId;
+    bool deleted = false;
+};
+
+LineData *lineData(const QTextBlock &block)
+{
+    return block.isValid() ? static_cast<LineData*>(block.userData()) : nullptr;
+}
+}
 
 ChatWidget::ChatWidget(QWidget *parent)
     : QWidget(parent)
@@ -10,9 +36,14 @@ ChatWidget::ChatWidget(QWidget *parent)
     layout->setContentsMargins(0, 0, 0, 0);
     layout->setSpacing(0);
 
-    // Chat display (read-only text edit with HTML support)
-    m_chatDisplay = new QTextEdit(this);
+    // Chat display (read-only HTML view; links are handled by us, not followed)
+    m_chatDisplay = new QTextBrowser(this);
     m_chatDisplay->setReadOnly(true);
+    m_chatDisplay->setOpenLinks(false);
+    m_chatDisplay->setContextMenuPolicy(Qt::CustomContextMenu);
+    m_chatDisplay->setToolTip("Click a message, then Shift+B: ban, Shift+T: timeout 10 minutes, Del: delete message");
+    m_chatDisplay->installEventFilter(this);
+    m_chatDisplay->viewport()->installEventFilter(this);
     m_chatDisplay->setStyleSheet(
         "QTextEdit {"
         "  background-color: #0e0e10;"
@@ -25,7 +56,8 @@ ChatWidget::ChatWidget(QWidget *parent)
 
     // Message input (mIRC-style)
     m_messageInput = new QLineEdit(this);
-    m_messageInput->setPlaceholderText("Send a message...");
+    m_messageInput->setPlaceholderText("Send a message or /command (Tab completes names)...");
+    m_messageInput->installEventFilter(this);
     m_messageInput->setStyleSheet(
         "QLineEdit {"
         "  background-color: #18181b;"
@@ -44,6 +76,8 @@ ChatWidget::ChatWidget(QWidget *parent)
 
     // Connections
     connect(m_messageInput, &QLineEdit::returnPressed, this, &ChatWidget::onSendMessage);
+    connect(m_chatDisplay, &QTextBrowser::anchorClicked, this, &ChatWidget::onAnchorClicked);
+    connect(m_chatDisplay, &QTextBrowser::customContextMenuRequested, this, &ChatWidget::onContextMenu);
 }
 
 void ChatWidget::addMessage(const QString &username, const QString &message, const QColor &userColor)
@@ -53,20 +87,141 @@ void ChatWidget::addMessage(const QString &username, const QString &message, con
         return;
     }
 
-    QString timestamp = QDateTime::currentDateTime().toString("HH:mm:ss");
+    appendFormattedMessage(formatMessageHtml(username, message, userColor,
+                                             QDateTime::currentMSecsSinceEpoch()));
+    scrollToBottom();
+}
+
+QString ChatWidget::formatMessageHtml(const QString &username, const QString &message,
+                                      const QColor &userColor, qint64 timestamp)
+{
+    // No widget access - called from the pipeline's worker threads
+    QString time = QDateTime::fromMSecsSinceEpoch(timestamp).toString("HH:mm:ss");
 
     QString colorHex = userColor.name();
-    QString html = QString("<span style='color: #999;'>[%1]</span> "
-                          "<span style='color: %2; font-weight: bold;'>%3:</span> "
-                          "<span style='color: #efeff1;'>%4</span>")
-                      .arg(timestamp)
-                      .arg(colorHex)
-                      .arg(username)
-                      .arg(message.toHtmlEscaped());
+    return QString("<span style='color: #999;'>[%1]</span> "
+                   "<span style='color: %2; font-weight: bold;'>%3:</span> "
+                   "<span style='color: #efeff1;'>%4</span>")
+        .arg(time)
+        .arg(colorHex)
+        .arg(username)
+        .arg(message.toHtmlEscaped());
+}
 
+void ChatWidget::appendFormattedMessage(const QString &html, const QString &messageId, const QString &username,
+                                        const QString &userId)
+{
     m_chatDisplay->append(html);
+    if (messageId.isEmpty() || username.isEmpty()) {
+        return;
+    }
 
-    // Auto-scroll to bottom
+    const QString user = username.toLower();
+    m_usernames.addChatter(user);
+    QTextBlock block = m_chatDisplay->document()->lastBlock();
+    LineData *data = new LineData;
+    data->messageId = messageId;
+    data->username = user;
+    data->userId = userId;
+    block.setUserData(data);
+
+    m_lines.insert(messageId, TrackedLine{block, user});
+    m_lineOrder.push_back(messageId);
+    std::deque<QString> &ids = m_userLines[user];
+    ids.push_back(messageId);
+
+    if (int(ids.size()) > MAX_LINES_PER_USER) {
+        m_lines.remove(ids.front());
+        ids.pop_front();
+    }
+    while (int(m_lineOrder.size()) > MAX_TRACKED_LINES) {
+        forgetLine(m_lineOrder.front());
+        m_lineOrder.pop_front();
+    }
+}
+
+void ChatWidget::forgetLine(const QString &messageId)
+{
+    auto it = m_lines.find(messageId);
+    if (it == m_lines.end()) {
+        return;
+    }
+    auto user = m_userLines.find(it->username);
+    if (user != m_userLines.end()) {
+        std::deque<QString> &ids = user.value();
+        ids.erase(std::remove(ids.begin(), ids.end(), messageId), ids.end());
+        if (ids.empty()) {
+            m_userLines.erase(user);
+        }
+    }
+    m_lines.erase(it);
+}
+
+QStringList ChatWidget::recentMessageIds(const QString &username, int limit) const
+{
+    QStringList ids;
+    auto it = m_userLines.constFind(username.toLower());
+    if (it == m_userLines.constEnd()) {
+        return ids;
+    }
+    for (auto id = it->rbegin(); id != it->rend(); ++id) {
+        if (limit >= 0 && ids.size() >= limit) {
+            break;
+        }
+        ids.append(*id);
+    }
+    return ids;
+}
+
+QStringList ChatWidget::recentLines(const QString &username, int limit) const
+{
+    QStringList lines;
+    for (const QString &messageId : recentMessageIds(username, limit)) {
+        const QTextBlock block = m_lines.value(messageId).block;
+        if (block.isValid()) {
+            lines.append(block.text());
+        }
+    }
+    return lines;
+}
+
+void ChatWidget::markMessagePending(const QString &messageId, bool pending)
+{
+    auto it = m_lines.constFind(messageId);
+    if (it == m_lines.constEnd() || !it->block.isValid()) {
+        return;
+    }
+    QTextCursor cursor(it->block);
+    cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+    QTextCharFormat format;
+    format.setFontItalic(pending);
+    cursor.mergeCharFormat(format);
+}
+
+void ChatWidget::markMessageDeleted(const QString &messageId)
+{
+    auto it = m_lines.constFind(messageId);
+    if (it == m_lines.constEnd()) {
+        return;
+    }
+    if (it->block.isValid()) {
+        QTextCursor cursor(it->block);
+        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        QTextCharFormat format;
+        format.setFontItalic(false);
+        format.setFontStrikeOut(true);
+        format.setForeground(QColor("#666"));
+        cursor.mergeCharFormat(format);
+        if (LineData *data = lineData(it->block)) {
+            data->deleted = true;
+        }
+    }
+    // Deleted lines are not offered for deletion again
+    forgetLine(messageId);
+}
+
+void ChatWidget::scrollToBottom()
+{
     QScrollBar *scrollBar = m_chatDisplay->verticalScrollBar();
     scrollBar->setValue(scrollBar->maximum());
 }
@@ -92,9 +247,308 @@ void ChatWidget::addSystemMessage(const QString &message)
     scrollBar->setValue(scrollBar->maximum());
 }
 
+void ChatWidget::addFloodAlert(const FloodCluster &cluster)
+{
+    m_floodClusters.insert(cluster.id, cluster);
+
+    QString timestamp = QDateTime::currentDateTime().toString("HH:mm:ss");
+    QString sample = cluster.sampleText.left(80);
+    if (cluster.sampleText.size() > 80) {
+        sample += "...";
+    }
+
+    QString html = QString("<span style='color: #999;'>[%1]</span> "
+                          "<span style='color: #ff6b6b; font-weight: bold;'>* Flood detected:</span> "
+                          "<span style='color: #efeff1;'>%2 accounts posting \"%3\"</span> "
+                          "<a href='flood:%4' style='color: #9147ff;'>[select group]</a>")
+                      .arg(timestamp)
+                      .arg(cluster.usernames.size())
+                      .arg(sample.toHtmlEscaped())
+                      .arg(cluster.id);
+
+    m_chatDisplay->append(html);
+
+    // Auto-scroll to bottom
+    QScrollBar *scrollBar = m_chatDisplay->verticalScrollBar();
+    scrollBar->setValue(scrollBar->maximum());
+}
+
+void ChatWidget::updateFloodCluster(const FloodCluster &cluster)
+{
+    if (m_floodClusters.contains(cluster.id)) {
+        m_floodClusters[cluster.id] = cluster;
+    }
+}
+
+void ChatWidget::onAnchorClicked(const QUrl &url)
+{
+    if (url.scheme() == "flood") {
+        quint64 clusterId = url.path().toULongLong();
+        auto it = m_floodClusters.constFind(clusterId);
+        if (it != m_floodClusters.constEnd()) {
+            showClusterMenu(it.value());
+        }
+    }
+}
+
+void ChatWidget::showClusterMenu(const FloodCluster &cluster)
+{
+    // The whole cluster is one selection - every action applies to all accounts
+    QMenu menu(this);
+
+    QAction *header = menu.addAction(QString("%1 accounts, %2 messages")
+                                        .arg(cluster.usernames.size())
+                                        .arg(cluster.messageCount));
+    header->setEnabled(false);
+    menu.addSeparator();
+
+    QMenu *timeoutMenu = menu.addMenu("Timeout All");
+    QAction *timeout1m = timeoutMenu->addAction("1 minute");
+    QAction *timeout10m = timeoutMenu->addAction("10 minutes");
+    QAction *timeout1h = timeoutMenu->addAction("1 hour");
+
+    QAction *banAction = menu.addAction("Ban All");
+    menu.addSeparator();
+
+    QAction *copyUsernamesAction = menu.addAction("Copy Usernames");
+
+    QAction *selectedAction = menu.exec(QCursor::pos());
+
+    if (selectedAction == timeout1m) {
+        emit clusterTimeoutRequested(cluster, 60);
+    }
+    else if (selectedAction == timeout10m) {
+        emit clusterTimeoutRequested(cluster, 600);
+    }
+    else if (selectedAction == timeout1h) {
+        emit clusterTimeoutRequested(cluster, 3600);
+    }
+    else if (selectedAction == banAction) {
+        emit clusterBanRequested(cluster);
+    }
+    else if (selectedAction == copyUsernamesAction) {
+        QApplication::clipboard()->setText(cluster.usernames.join("\n"));
+    }
+}
+
 void ChatWidget::clearChat()
 {
+    selectLine(QTextBlock());
     m_chatDisplay->clear();
+    m_lines.clear();
+    m_userLines.clear();
+    m_lineOrder.clear();
+}
+
+void ChatWidget::selectLine(const QTextBlock &block)
+{
+    m_selectedLine = block;
+    QList<QTextEdit::ExtraSelection> selections;
+    if (block.isValid()) {
+        QTextEdit::ExtraSelection selection;
+        selection.cursor = QTextCursor(block);
+        selection.format.setBackground(QColor("#26262c"));
+        selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+        selections.append(selection);
+    }
+    m_chatDisplay->setExtraSelections(selections);
+}
+
+bool ChatWidget::eventFilter(QObject *watched, QEvent *event)
+{
+    // Tab would move the focus; here it completes
+    if (watched == m_messageInput && event->type() == QEvent::KeyPress) {
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        if (keyEvent->key() == Qt::Key_Tab || keyEvent->key() == Qt::Key_Backtab) {
+            completeWord(keyEvent->key() == Qt::Key_Backtab);
+            return true;
+        }
+        return false;
+    }
+
+    if (watched == m_chatDisplay->viewport() && event->type() == QEvent::MouseButtonPress) {
+        QMouseEvent *mouseEvent = static_cast<QMouseEvent*>(event);
+        if (mouseEvent->button() == Qt::LeftButton) {
+            const QTextBlock block = m_chatDisplay->cursorForPosition(mouseEvent->position().toPoint()).block();
+            selectLine(lineData(block) ? block : QTextBlock());
+        }
+        // Text selection and links still get the click
+        return false;
+    }
+
+    if (watched == m_chatDisplay && event->type() == QEvent::KeyPress && lineData(m_selectedLine)) {
+        // Latency is measured from here to the Helix response
+        QElapsedTimer sinceInput;
+        sinceInput.start();
+
+        // Ban and timeout need Shift so a stray letter typed into the chat
+        // view cannot act on someone, and every action drops the selection
+        // so a second press does not hit the same account again
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        const Qt::KeyboardModifiers modifiers = keyEvent->modifiers() & ~Qt::KeypadModifier;
+        const QTextBlock line = m_selectedLine;
+        switch (keyEvent->key()) {
+        case Qt::Key_B:
+            if (modifiers != Qt::ShiftModifier) {
+                break;
+            }
+            selectLine(QTextBlock());
+            requestLineAction(line, ChatLineAction::Ban, 0, sinceInput);
+            return true;
+        case Qt::Key_T:
+            if (modifiers != Qt::ShiftModifier) {
+                break;
+            }
+            selectLine(QTextBlock());
+            requestLineAction(line, ChatLineAction::Timeout, 600, sinceInput);
+            return true;
+        case Qt::Key_Delete:
+            if (modifiers != Qt::NoModifier) {
+                break;
+            }
+            selectLine(QTextBlock());
+            requestLineAction(line, ChatLineAction::DeleteMessage, 0, sinceInput);
+            return true;
+        case Qt::Key_Escape:
+            selectLine(QTextBlock());
+            return true;
+        default:
+            break;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void ChatWidget::completeWord(bool backwards)
+{
+    const QString text = m_messageInput->text();
+    if (m_completions.isEmpty() || text != m_completedText) {
+        // New cycle: complete the word left of the cursor
+        const int cursor = m_messageInput->cursorPosition();
+        m_completionStart = cursor > 0 ? int(text.lastIndexOf(' ', cursor - 1) + 1) : 0;
+        QString prefix = text.mid(m_completionStart, cursor - m_completionStart);
+        const bool mention = prefix.startsWith('@');
+        if (mention) {
+            prefix.remove(0, 1);
+        }
+
+        if (m_completionStart == 0 && prefix.startsWith('/')) {
+            m_completions.clear();
+            for (const QString &name : ChatCommand::names()) {
+                if (name.startsWith(prefix, Qt::CaseInsensitive)) {
+                    m_completions.append(name);
+                }
+            }
+        } else if (!prefix.isEmpty()) {
+            m_completions = m_usernames.complete(prefix);
+            if (mention) {
+                for (QString &completion : m_completions) {
+                    completion.prepend('@');
+                }
+            }
+        } else {
+            m_completions.clear();
+        }
+        if (m_completions.isEmpty()) {
+            return;
+        }
+        m_completionIndex = backwards ? int(m_completions.size()) - 1 : 0;
+    } else {
+        const int count = int(m_completions.size());
+        m_completionIndex = (m_completionIndex + (backwards ? count - 1 : 1)) % count;
+    }
+
+    // Replace up to the end of the current word, then a space
+    int end = int(text.indexOf(' ', m_completionStart));
+    if (end < 0) {
+        end = int(text.size());
+    }
+    QString completed = text;
+    const QString word = m_completions.at(m_completionIndex);
+    completed.replace(m_completionStart, end - m_completionStart, word);
+    if (end >= text.size()) {
+        completed += ' ';
+    }
+    m_messageInput->setText(completed);
+    m_messageInput->setCursorPosition(m_completionStart + int(word.size()) + 1);
+    m_completedText = completed;
+}
+
+void ChatWidget::onContextMenu(const QPoint &pos)
+{
+    const QTextBlock block = m_chatDisplay->cursorForPosition(pos).block();
+    const LineData *data = lineData(block);
+    if (!data) {
+        QMenu *menu = m_chatDisplay->createStandardContextMenu(pos);
+        menu->exec(m_chatDisplay->viewport()->mapToGlobal(pos));
+        delete menu;
+        return;
+    }
+    selectLine(block);
+    // Chat keeps arriving while the menu is open
+    const QString username = data->username;
+
+    QMenu menu(this);
+    QAction *header = menu.addAction(username);
+    header->setEnabled(false);
+    menu.addSeparator();
+
+    QMenu *timeoutMenu = menu.addMenu("Timeout");
+    QAction *timeout1m = timeoutMenu->addAction("1 minute");
+    QAction *timeout10m = timeoutMenu->addAction("10 minutes (Shift+T)");
+    QAction *timeout1h = timeoutMenu->addAction("1 hour");
+
+    QAction *banAction = menu.addAction("Ban (Shift+B)");
+    QAction *deleteAction = menu.addAction("Delete Message (Del)");
+    deleteAction->setEnabled(!data->deleted);
+    menu.addSeparator();
+
+    QAction *copyUsernameAction = menu.addAction("Copy Username");
+    QAction *copyLineAction = menu.addAction("Copy Message");
+
+    QAction *selectedAction = menu.exec(m_chatDisplay->viewport()->mapToGlobal(pos));
+    QElapsedTimer sinceInput;
+    sinceInput.start();
+
+    if (selectedAction == timeout1m) {
+        requestLineAction(block, ChatLineAction::Timeout, 60, sinceInput);
+    }
+    else if (selectedAction == timeout10m) {
+        requestLineAction(block, ChatLineAction::Timeout, 600, sinceInput);
+    }
+    else if (selectedAction == timeout1h) {
+        requestLineAction(block, ChatLineAction::Timeout, 3600, sinceInput);
+    }
+    else if (selectedAction == banAction) {
+        requestLineAction(block, ChatLineAction::Ban, 0, sinceInput);
+    }
+    else if (selectedAction == deleteAction) {
+        requestLineAction(block, ChatLineAction::DeleteMessage, 0, sinceInput);
+    }
+    else if (selectedAction == copyUsernameAction) {
+        QApplication::clipboard()->setText(username);
+    }
+    else if (selectedAction == copyLineAction) {
+        QApplication::clipboard()->setText(block.text());
+    }
+}
+
+void ChatWidget::requestLineAction(const QTextBlock &block, ChatLineAction::Kind kind, int durationSeconds,
+                                   const QElapsedTimer &sinceInput)
+{
+    const LineData *data = lineData(block);
+    if (!data || (kind == ChatLineAction::DeleteMessage && data->deleted)) {
+        return;
+    }
+
+    ChatLineAction action;
+    action.kind = kind;
+    action.username = data->username;
+    action.userId = data->userId;
+    action.messageId = data->messageId;
+    action.durationSeconds = durationSeconds;
+    action.sinceInput = sinceInput;
+    emit lineActionRequested(action);
 }
 
 void ChatWidget::setChannelName(const QString &channelName)
@@ -112,8 +566,16 @@ void ChatWidget::onSendMessage()
 
     // Check if it's a mod command
     if (message.startsWith("/")) {
-        addSystemMessage("Mod command: " + message);
-        // TODO: Handle mod commands (ban, timeout, etc.)
+        const ChatCommand command = ChatCommand::parse(message);
+        if (!command.isValid()) {
+            addSystemMessage(command.error);
+            return;
+        }
+        if (command.kind == ChatCommand::Help) {
+            addSystemMessage(ChatCommand::helpText());
+        } else {
+            emit commandEntered(command);
+        }
     } else {
         // Send as regular message
         emit messageSent(message);
@@ -122,4 +584,5 @@ void ChatWidget::onSendMessage()
     }
 
     m_messageInput->clear();
+    m_completions.clear();
 }
@@ -2,9 +2,34 @@
 #define CHATWIDGET_H
 
 #include <QWidget>
-#include <QTextEdit>
+#include <QTextBrowser>
 #include <QLineEdit>
 #include <QVBoxLayout>
+#include <QHash>
+#include <QUrl>
+#include <QTextBlock>
+#include <QElapsedTimer>
+#include <deque>
+#include "moderation/flooddetector.h"
+#include "moderation/chatcommand.h"
+#include "twitch/usernameindex.h"
+
+// Ban, timeout or deletion picked on a chat line. Ids come from the line's
+// IRC tags, so it goes out without a user lookup.
+struct ChatLineAction {
+    enum Kind {
+        Ban,
+        Timeout,
+        DeleteMessage
+    };
+
+    Kind kind = Ban;
+    QString username;
+    QString userId;
+    QString messageId;
+    int durationSeconds = 0; // Timeout only
+    QElapsedTimer sinceInput; // started on the key press or menu click
+};
 
 class ChatWidget : public QWidget
 {
@@ -15,20 +40,91 @@ public:
 
     void addMessage(const QString &username, const QString &message, const QColor &userColor = QColor(255, 255, 255));
     void addSystemMessage(const QString &message);
+
+    // Pipeline render path: lines are formatted off-thread with
+    // formatMessageHtml(), appended in batches, then scrolled once
+    static QString formatMessageHtml(const QString &username, const QString &message,
+                                     const QColor &userColor, qint64 timestamp);
+    // messageId/username put the line in the per-user index used to find
+    // and mark an account's recent messages; with userId the line can be
+    // moderated directly
+    void appendFormattedMessage(const QString &html, const QString &messageId = QString(),
+                                const QString &username = QString(), const QString &userId = QString());
+    void scrollToBottom();
     void clearChat();
     void setChannelName(const QString &channelName);
 
+    // Ids of the user's messages still on screen, newest first
+    QStringList recentMessageIds(const QString &username, int limit = -1) const;
+    // Their lines as shown ("[time] user: text"), newest first
+    QStringList recentLines(const QString &username, int limit = -1) const;
+    // Pending: italic until the deletion is confirmed or failed (restores it)
+    void markMessagePending(const QString &messageId, bool pending);
+    void markMessageDeleted(const QString &messageId);
+
+    static constexpr int MAX_TRACKED_LINES = 5000;
+    static constexpr int MAX_LINES_PER_USER = 100;
+
+    // Channel members and recent chatters, for Tab completion in the input
+    UsernameIndex &usernames() { return m_usernames; }
+
+    // Flood clusters (copy-pasta / bot raids)
+    void addFloodAlert(const FloodCluster &cluster);
+    void updateFloodCluster(const FloodCluster &cluster);
+
 signals:
     void messageSent(const QString &message);
+    void clusterBanRequested(const FloodCluster &cluster);
+    void clusterTimeoutRequested(const FloodCluster &cluster, int seconds);
+    // Clicked line + Shift+B/Shift+T/Del, or its context menu
+    void lineActionRequested(const ChatLineAction &action);
+    // A parsed slash command; invalid ones and /help are answered here
+    void commandEntered(const ChatCommand &command);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
     void onSendMessage();
+    void onAnchorClicked(const QUrl &url);
+    void onContextMenu(const QPoint &pos);
 
 private:
+    void showClusterMenu(const FloodCluster &cluster);
+    void forgetLine(const QString &messageId);
+    void selectLine(const QTextBlock &block);
+    void completeWord(bool backwards);
+    void requestLineAction(const QTextBlock &block, ChatLineAction::Kind kind, int durationSeconds,
+                           const QElapsedTimer &sinceInput);
+
     QString m_channelName;
 
-    QTextEdit *m_chatDisplay;
+    QTextBrowser *m_chatDisplay;
     QLineEdit *m_messageInput;
+
+    // Flagged clusters by id, kept current so a group action covers
+    // accounts that joined the wave after the alert was shown
+    QHash<quint64, FloodCluster> m_floodClusters;
+
+    // Chat lines by message id. QTextBlock handles stay valid while other
+    // lines are added, so marking a line is a hash lookup, not a search.
+    struct TrackedLine {
+        QTextBlock block;
+        QString username; // lowercase
+    };
+    QHash<QString, TrackedLine> m_lines;
+    QHash<QString, std::deque<QString>> m_userLines; // username -> message ids, oldest first
+    std::deque<QString> m_lineOrder;                  // message ids, oldest first
+
+    QTextBlock m_selectedLine; // target of the line hotkeys
+
+    UsernameIndex m_usernames;
+    // Tab cycling: matches for the word starting at m_completionStart, and
+    // the input text as last completed so an edit starts a new cycle
+    QStringList m_completions;
+    int m_completionIndex = -1;
+    int m_completionStart = 0;
+    QString m_completedText;
 };
 
 #endif // CHATWIDGET_H
@@ -0,0 +1,197 @@
+#include "fanoutdialog.h"
+#include "twitch/liveeventsfanout.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+
+FanOutDialog::FanOutDialog(LiveEventsFanOut *fanOut, quint64 groupId, QWidget *parent)
+    : QDialog(parent)
+    , m_fanOut(fanOut)
+    , m_groupId(groupId)
+{
+    const FanOutGroup group = m_fanOut->group(m_groupId);
+    const bool polls = group.kind == FanOutGroup::Polls;
+
+    setWindowTitle(QString("%1: %2").arg(polls ? "Poll" : "Prediction", group.title));
+    setMinimumSize(560, 480);
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    m_summaryLabel = new QLabel(this);
+    mainLayout->addWidget(m_summaryLabel);
+
+    // Totals across channels
+    m_totalsTree = new QTreeWidget(this);
+    m_totalsTree->setRootIsDecorated(false);
+    m_totalsTree->setHeaderLabels(QStringList() << (polls ? "Choice" : "Outcome")
+                                  << (polls ? "Votes" : "Users") << "Points" << "%");
+    m_totalsTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int i = 0; i < group.choices.size(); ++i) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(m_totalsTree);
+        item->setText(0, group.choices.at(i));
+        for (int column = 1; column <= 3; ++column) {
+            item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+        }
+    }
+    mainLayout->addWidget(m_totalsTree);
+
+    // One row per channel
+    m_channelsTree = new QTreeWidget(this);
+    m_channelsTree->setRootIsDecorated(false);
+    m_channelsTree->setHeaderLabels(QStringList() << "Channel" << "Status"
+                                    << (polls ? "Votes" : "Users") << "Points" << "Leading / error");
+    m_channelsTree->header()->setSectionResizeMode(4, QHeaderView::Stretch);
+    for (const FanOutChannel &channel : group.channels) {
+        QTreeWidgetItem *item = new QTreeWidgetItem(m_channelsTree);
+        item->setText(0, "#" + channel.channel);
+        item->setTextAlignment(2, Qt::AlignRight | Qt::AlignVCenter);
+        item->setTextAlignment(3, Qt::AlignRight | Qt::AlignVCenter);
+    }
+    mainLayout->addWidget(m_channelsTree);
+
+    m_lockButton = new QPushButton("Lock All", this);
+    m_resolveButton = new QPushButton("Resolve All", this);
+    m_resolveButton->setToolTip("Pay out the outcome selected in the totals above in every channel");
+    m_endButton = new QPushButton("End All", this);
+    m_cancelButton = new QPushButton(polls ? "Archive All" : "Cancel All", this);
+    QPushButton *closeButton = new QPushButton("Close", this);
+
+    m_lockButton->setVisible(!polls);
+    m_resolveButton->setVisible(!polls);
+    m_endButton->setVisible(polls);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(m_lockButton);
+    buttonLayout->addWidget(m_resolveButton);
+    buttonLayout->addWidget(m_endButton);
+    buttonLayout->addWidget(m_cancelButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(m_lockButton, &QPushButton::clicked, [this]() {
+        m_fanOut->endPredictions(m_groupId, "LOCKED");
+    });
+    connect(m_resolveButton, &QPushButton::clicked, [this]() {
+        QList<QTreeWidgetItem *> selected = m_totalsTree->selectedItems();
+        if (!selected.isEmpty()) {
+            int winningIndex = m_totalsTree->indexOfTopLevelItem(selected.first());
+            m_fanOut->endPredictions(m_groupId, "RESOLVED", winningIndex);
+        }
+    });
+    connect(m_endButton, &QPushButton::clicked, [this]() {
+        m_fanOut->endPolls(m_groupId, "TERMINATED");
+    });
+    connect(m_cancelButton, &QPushButton::clicked, [this, polls]() {
+        if (polls) {
+            m_fanOut->endPolls(m_groupId, "ARCHIVED");
+        } else {
+            m_fanOut->endPredictions(m_groupId, "CANCELED");
+        }
+    });
+    connect(m_totalsTree, &QTreeWidget::itemSelectionChanged, this, &FanOutDialog::redraw);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+
+    m_redrawTimer = new QTimer(this);
+    m_redrawTimer->setSingleShot(true);
+    m_redrawTimer->setInterval(REDRAW_MS);
+    connect(m_redrawTimer, &QTimer::timeout, this, &FanOutDialog::redraw);
+    connect(m_fanOut, &LiveEventsFanOut::groupChanged, this, [this](quint64 groupId) {
+        if (groupId == m_groupId && !m_redrawTimer->isActive()) {
+            m_redrawTimer->start();
+        }
+    });
+
+    redraw();
+}
+
+void FanOutDialog::redraw()
+{
+    const FanOutGroup group = m_fanOut->group(m_groupId);
+    const bool polls = group.kind == FanOutGroup::Polls;
+
+    // Totals
+    const QList<qint64> counts = group.counts();
+    const QList<qint64> points = group.points();
+    qint64 totalCount = 0;
+    qint64 totalPoints = 0;
+    for (int i = 0; i < counts.size(); ++i) {
+        totalCount += counts.at(i);
+        totalPoints += points.at(i);
+    }
+    for (int i = 0; i < counts.size() && i < m_totalsTree->topLevelItemCount(); ++i) {
+        QTreeWidgetItem *item = m_totalsTree->topLevelItem(i);
+        // Predictions are split by points wagered, polls by votes
+        qint64 share = polls ? counts.at(i) : points.at(i);
+        qint64 total = polls ? totalCount : totalPoints;
+        item->setText(1, QString::number(counts.at(i)));
+        item->setText(2, QString::number(points.at(i)));
+        item->setText(3, QString::number(total > 0 ? 100.0 * share / total : 0.0, 'f', 1));
+    }
+
+    // Channels
+    for (int i = 0; i < group.channels.size() && i < m_channelsTree->topLevelItemCount(); ++i) {
+        const FanOutChannel &channel = group.channels.at(i);
+        QTreeWidgetItem *item = m_channelsTree->topLevelItem(i);
+
+        QString status = channel.status().toLower();
+        if (status.isEmpty()) {
+            status = channel.busy ? "starting" : "not started";
+        } else if (channel.busy) {
+            status += "...";
+        }
+
+        qint64 count = 0;
+        qint64 channelPoints = 0;
+        QString leading;
+        qint64 best = 0;
+        if (polls) {
+            for (const PollChoice &choice : channel.poll.choices) {
+                count += choice.votes;
+                channelPoints += choice.channelPointsVotes;
+                if (choice.votes > best) {
+                    best = choice.votes;
+                    leading = choice.title;
+                }
+            }
+        } else {
+            for (const PredictionOutcome &outcome : channel.prediction.outcomes) {
+                count += outcome.users;
+                channelPoints += outcome.channelPoints;
+                if (outcome.id == channel.prediction.winningOutcomeId) {
+                    leading = "Winner: " + outcome.title;
+                    best = -1;
+                } else if (best >= 0 && outcome.channelPoints > best) {
+                    best = outcome.channelPoints;
+                    leading = outcome.title;
+                }
+            }
+        }
+
+        item->setText(1, status);
+        item->setText(2, QString::number(count));
+        item->setText(3, QString::number(channelPoints));
+        if (!channel.error.isEmpty()) {
+            item->setText(4, QString("%1 (%2)").arg(channel.error).arg(channel.statusCode));
+            item->setForeground(4, QColor("#e91916"));
+        } else {
+            item->setText(4, leading);
+            item->setForeground(4, palette().color(QPalette::Text));
+        }
+    }
+
+    const int open = group.open();
+    m_summaryLabel->setText(QString("<b>%1</b><br>%2 of %3 channels started, %4 open, %5 failed")
+                            .arg(group.title.toHtmlEscaped()).arg(group.created())
+                            .arg(group.channels.size()).arg(open).arg(group.failed()));
+
+    bool anyActive = false;
+    for (const FanOutChannel &channel : group.channels) {
+        anyActive = anyActive || channel.status() == "ACTIVE";
+    }
+    m_lockButton->setEnabled(anyActive);
+    m_resolveButton->setEnabled(open > 0 && !m_totalsTree->selectedItems().isEmpty());
+    m_endButton->setEnabled(anyActive);
+    m_cancelButton->setEnabled(polls ? group.created() > 0 : open > 0);
+}
@@ -0,0 +1,41 @@
+#ifndef FANOUTDIALOG_H
+#define FANOUTDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QPushButton>
+#include <QTimer>
+
+class LiveEventsFanOut;
+
+// Combined results of one poll or prediction fanned out to several
+// channels: totals per choice across all of them, each channel's state,
+// and buttons that end, lock, resolve or cancel every channel at once.
+// Redraws are coalesced to one per REDRAW_MS however many channels report.
+class FanOutDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    FanOutDialog(LiveEventsFanOut *fanOut, quint64 groupId, QWidget *parent = nullptr);
+
+    static constexpr int REDRAW_MS = 250;
+
+private:
+    void redraw();
+
+    LiveEventsFanOut *m_fanOut;
+    quint64 m_groupId;
+
+    QLabel *m_summaryLabel;
+    QTreeWidget *m_totalsTree;
+    QTreeWidget *m_channelsTree;
+    QPushButton *m_lockButton;
+    QPushButton *m_resolveButton;
+    QPushButton *m_endButton;
+    QPushButton *m_cancelButton;
+    QTimer *m_redrawTimer;
+};
+
+#endif // FANOUTDIALOG_H
@@ -0,0 +1,346 @@
+#include "liveeventspanel.h"
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QDateTime>
+#include <QFont>
+
+namespace {
+
+struct Row {
+    QString id;
+    QString title;
+    qint64 count = 0;
+    qint64 points = 0;
+    double percent = 0.0;
+    bool winner = false;
+};
+
+QString formatRemaining(qint64 seconds)
+{
+    seconds = qMax<qint64>(0, seconds);
+    return QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+}
+
+// Updates rows in place while the same ids are listed, so the selection
+// (the outcome to resolve with) survives every redraw
+void fillRows(QTreeWidget *tree, const QList<Row> &rows)
+{
+    bool sameIds = tree->topLevelItemCount() == rows.size();
+    for (int i = 0; sameIds && i < rows.size(); ++i) {
+        sameIds = tree->topLevelItem(i)->data(0, Qt::UserRole).toString() == rows[i].id;
+    }
+    if (!sameIds) {
+        tree->clear();
+        for (const Row &row : rows) {
+            QTreeWidgetItem *item = new QTreeWidgetItem(tree);
+            item->setData(0, Qt::UserRole, row.id);
+            for (int column = 1; column <= 3; ++column) {
+                item->setTextAlignment(column, Qt::AlignRight | Qt::AlignVCenter);
+            }
+        }
+    }
+
+    for (int i = 0; i < rows.size(); ++i) {
+        const Row &row = rows[i];
+        QTreeWidgetItem *item = tree->topLevelItem(i);
+        item->setText(0, row.title);
+        item->setText(1, QString::number(row.count));
+        item->setText(2, QString::number(row.points));
+        item->setText(3, QString::number(row.percent, 'f', 1));
+        QFont font = item->font(0);
+        font.setBold(row.winner);
+        item->setFont(0, font);
+    }
+}
+
+} // namespace
+
+LiveEventsPanel::LiveEventsPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_shownIsPrediction(false)
+    , m_renderedVersion(0)
+    , m_renderedAtMs(0)
+    , m_countdown(false)
+    , m_updates(0)
+    , m_renders(0)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(5, 5, 5, 5);
+    layout->setSpacing(5);
+
+    // Header label
+    m_headerLabel = new QLabel("Poll / Prediction", this);
+    m_headerLabel->setStyleSheet("font-weight: bold; color: #9147ff;");
+
+    m_titleLabel = new QLabel(this);
+    m_titleLabel->setWordWrap(true);
+
+    // Choices or outcomes with their totals
+    m_treeWidget = new QTreeWidget(this);
+    m_treeWidget->setRootIsDecorated(false);
+    m_treeWidget->setHeaderLabels(QStringList() << "Choice" << "Votes" << "Points" << "%");
+    m_treeWidget->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    for (int column = 1; column <= 3; ++column) {
+        m_treeWidget->header()->setSectionResizeMode(column, QHeaderView::ResizeToContents);
+    }
+
+    m_lockButton = new QPushButton("Lock", this);
+    m_lockButton->setToolTip("Stop accepting predictions");
+    m_resolveButton = new QPushButton("Resolve", this);
+    m_resolveButton->setToolTip("Pay out the selected outcome");
+    m_cancelButton = new QPushButton("Cancel", this);
+    m_endPollButton = new QPushButton("End", this);
+    m_endPollButton->setToolTip("End the poll now, results stay visible");
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    buttonLayout->addWidget(m_lockButton);
+    buttonLayout->addWidget(m_resolveButton);
+    buttonLayout->addWidget(m_endPollButton);
+    buttonLayout->addWidget(m_cancelButton);
+
+    layout->addWidget(m_headerLabel);
+    layout->addWidget(m_titleLabel);
+    layout->addWidget(m_treeWidget);
+    layout->addLayout(buttonLayout);
+
+    connect(m_lockButton, &QPushButton::clicked, [this]() {
+        emit endPredictionRequested(m_channel, m_shownId, "LOCKED", QString());
+    });
+    connect(m_resolveButton, &QPushButton::clicked, [this]() {
+        QList<QTreeWidgetItem *> selected = m_treeWidget->selectedItems();
+        if (!selected.isEmpty()) {
+            QTreeWidgetItem *item = selected.first();
+            emit endPredictionRequested(m_channel, m_shownId, "RESOLVED",
+                                        item->data(0, Qt::UserRole).toString());
+        }
+    });
+    connect(m_cancelButton, &QPushButton::clicked, [this]() {
+        if (m_shownIsPrediction) {
+            emit endPredictionRequested(m_channel, m_shownId, "CANCELED", QString());
+        } else {
+            emit endPollRequested(m_channel, m_shownId, "ARCHIVED");
+        }
+    });
+    connect(m_endPollButton, &QPushButton::clicked, [this]() {
+        emit endPollRequested(m_channel, m_shownId, "TERMINATED");
+    });
+    connect(m_treeWidget, &QTreeWidget::itemSelectionChanged, this, &LiveEventsPanel::updateButtons);
+
+    m_displayTimer = new QTimer(this);
+    m_displayTimer->setInterval(DISPLAY_INTERVAL_MS);
+    connect(m_displayTimer, &QTimer::timeout, this, &LiveEventsPanel::onDisplayTick);
+    m_displayTimer->start();
+
+    showNothing();
+}
+
+void LiveEventsPanel::setChannel(const QString &channel)
+{
+    if (channel == m_channel) {
+        return;
+    }
+    m_channel = channel;
+    m_treeWidget->clear();
+    render(); // switching is the user's action, don't wait for the tick
+}
+
+void LiveEventsPanel::removeChannel(const QString &channel)
+{
+    m_channels.remove(channel);
+    if (channel == m_channel) {
+        render();
+    }
+}
+
+void LiveEventsPanel::updatePoll(const QString &channel, const Poll &poll)
+{
+    ChannelState &state = m_channels[channel];
+    state.poll = poll;
+    state.pollUpdatedMs = QDateTime::currentMSecsSinceEpoch();
+    ++state.version;
+    ++m_updates;
+}
+
+void LiveEventsPanel::updatePrediction(const QString &channel, const Prediction &prediction)
+{
+    ChannelState &state = m_channels[channel];
+    state.prediction = prediction;
+    state.predictionUpdatedMs = QDateTime::currentMSecsSinceEpoch();
+    ++state.version;
+    ++m_updates;
+}
+
+void LiveEventsPanel::onDisplayTick()
+{
+    auto it = m_channels.constFind(m_channel);
+    quint64 version = it != m_channels.constEnd() ? it->version : 0;
+
+    if (version != m_renderedVersion) {
+        render();
+    } else if (m_countdown && QDateTime::currentMSecsSinceEpoch() - m_renderedAtMs >= 1000) {
+        render();
+    }
+}
+
+void LiveEventsPanel::render()
+{
+    m_renderedAtMs = QDateTime::currentMSecsSinceEpoch();
+    ++m_renders;
+    m_headerLabel->setToolTip(QString("%1 progress updates, %2 redraws")
+                              .arg(m_updates).arg(m_renders));
+
+    auto it = m_channels.constFind(m_channel);
+    if (it == m_channels.constEnd() || (!it->poll.isValid() && !it->prediction.isValid())) {
+        m_renderedVersion = it != m_channels.constEnd() ? it->version : 0;
+        showNothing();
+        return;
+    }
+
+    m_renderedVersion = it->version;
+    m_treeWidget->setUpdatesEnabled(false);
+    if (showsPrediction(*it)) {
+        renderPrediction(it->prediction);
+    } else {
+        renderPoll(it->poll);
+    }
+    m_treeWidget->setUpdatesEnabled(true);
+    updateButtons();
+}
+
+void LiveEventsPanel::renderPoll(const Poll &poll)
+{
+    if (m_shownId != poll.id) {
+        m_treeWidget->clear();
+    }
+    m_shownId = poll.id;
+    m_shownStatus = poll.status;
+    m_shownIsPrediction = false;
+    m_treeWidget->headerItem()->setText(0, "Choice");
+    m_treeWidget->headerItem()->setText(1, "Votes");
+
+    qint64 totalVotes = 0;
+    int topVotes = 0;
+    for (const PollChoice &choice : poll.choices) {
+        totalVotes += choice.votes;
+        topVotes = qMax(topVotes, choice.votes);
+    }
+
+    bool active = poll.status == "ACTIVE";
+    QList<Row> rows;
+    for (const PollChoice &choice : poll.choices) {
+        Row row;
+        row.id = choice.id;
+        row.title = choice.title;
+        row.count = choice.votes;
+        row.points = choice.channelPointsVotes;
+        row.percent = totalVotes > 0 ? 100.0 * choice.votes / totalVotes : 0.0;
+        row.winner = !active && topVotes > 0 && choice.votes == topVotes;
+        rows.append(row);
+    }
+    fillRows(m_treeWidget, rows);
+
+    QString state;
+    if (active) {
+        qint64 endsAt = poll.startedAt.toSecsSinceEpoch() + poll.durationSeconds;
+        state = QString("%1 votes, %2 left").arg(totalVotes)
+                .arg(formatRemaining(endsAt - QDateTime::currentSecsSinceEpoch()));
+    } else {
+        state = QString("%1, %2 votes").arg(poll.status.toLower()).arg(totalVotes);
+    }
+    m_countdown = active;
+    m_titleLabel->setText(QString("<b>Poll:</b> %1<br>%2").arg(poll.title.toHtmlEscaped(), state));
+}
+
+void LiveEventsPanel::renderPrediction(const Prediction &prediction)
+{
+    if (m_shownId != prediction.id) {
+        m_treeWidget->clear();
+    }
+    m_shownId = prediction.id;
+    m_shownStatus = prediction.status;
+    m_shownIsPrediction = true;
+    m_treeWidget->headerItem()->setText(0, "Outcome");
+    m_treeWidget->headerItem()->setText(1, "Users");
+
+    qint64 totalUsers = 0;
+    qint64 totalPoints = 0;
+    for (const PredictionOutcome &outcome : prediction.outcomes) {
+        totalUsers += outcome.users;
+        totalPoints += outcome.channelPoints;
+    }
+
+    QList<Row> rows;
+    for (const PredictionOutcome &outcome : prediction.outcomes) {
+        Row row;
+        row.id = outcome.id;
+        row.title = outcome.title;
+        row.count = outcome.users;
+        row.points = outcome.channelPoints;
+        row.percent = totalPoints > 0 ? 100.0 * outcome.channelPoints / totalPoints : 0.0;
+        row.winner = outcome.id == prediction.winningOutcomeId;
+        rows.append(row);
+    }
+    fillRows(m_treeWidget, rows);
+
+    QString state;
+    if (prediction.status == "ACTIVE") {
+        qint64 locksAt = prediction.createdAt.toSecsSinceEpoch() + prediction.predictionWindowSeconds;
+        state = QString("%1 users, %2 points, locks in %3").arg(totalUsers).arg(totalPoints)
+                .arg(formatRemaining(locksAt - QDateTime::currentSecsSinceEpoch()));
+    } else if (prediction.status == "LOCKED") {
+        state = QString("locked, %1 points - select the winner and resolve").arg(totalPoints);
+    } else {
+        state = QString("%1, %2 points").arg(prediction.status.toLower()).arg(totalPoints);
+    }
+    m_countdown = prediction.status == "ACTIVE";
+    m_titleLabel->setText(QString("<b>Prediction:</b> %1<br>%2")
+                          .arg(prediction.title.toHtmlEscaped(), state));
+}
+
+void LiveEventsPanel::showNothing()
+{
+    m_shownId.clear();
+    m_shownStatus.clear();
+    m_countdown = false;
+    m_treeWidget->clear();
+    m_titleLabel->setText(m_channel.isEmpty() ? QString()
+                                              : "No poll or prediction in this channel");
+    updateButtons();
+}
+
+bool LiveEventsPanel::showsPrediction(const ChannelState &state) const
+{
+    const QString &predictionStatus = state.prediction.status;
+    if (state.prediction.isValid() && (predictionStatus == "ACTIVE" || predictionStatus == "LOCKED")) {
+        return true;
+    }
+    if (state.poll.isValid() && state.poll.status == "ACTIVE") {
+        return false;
+    }
+    if (!state.poll.isValid() || !state.prediction.isValid()) {
+        return state.prediction.isValid();
+    }
+    return state.predictionUpdatedMs >= state.pollUpdatedMs;
+}
+
+void LiveEventsPanel::updateButtons()
+{
+    bool prediction = !m_shownId.isEmpty() && m_shownIsPrediction;
+    bool poll = !m_shownId.isEmpty() && !m_shownIsPrediction;
+    bool open = m_shownStatus == "ACTIVE" || m_shownStatus == "LOCKED";
+
+    m_lockButton->setVisible(!poll);
+    m_resolveButton->setVisible(!poll);
+    m_endPollButton->setVisible(poll);
+
+    m_lockButton->setEnabled(prediction && m_shownStatus == "ACTIVE");
+    m_resolveButton->setEnabled(prediction && open && !m_treeWidget->selectedItems().isEmpty());
+    m_endPollButton->setEnabled(poll && m_shownStatus == "ACTIVE");
+
+    // A finished poll can still be archived; a finished prediction is final
+    m_cancelButton->setText(poll ? "Archive" : "Cancel");
+    m_cancelButton->setToolTip(poll ? "End the poll and hide it from viewers"
+                                    : "Refund all channel points");
+    m_cancelButton->setEnabled(prediction ? open : poll && m_shownStatus != "ARCHIVED");
+}
@@ -0,0 +1,84 @@
+#ifndef LIVEEVENTSPANEL_H
+#define LIVEEVENTSPANEL_H
+
+#include <QWidget>
+#include <QTreeWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QTimer>
+#include <QHash>
+#include "twitch/helixtypes.h"
+
+// Live view of the current channel's poll or prediction.
+//
+// Progress events for every channel only replace that channel's stored
+// state; nothing is drawn on arrival. A display timer redraws the visible
+// channel at most DISPLAY_INTERVAL_MS apart and only when it changed (or
+// once a second for the countdown), so twenty channels running
+// predictions cost twenty hash updates per event burst and one redraw.
+//
+// An active or locked prediction is shown before an active poll, and
+// either before the last finished one. Lock, resolve (with the selected
+// outcome), cancel and end are one click and reported as signals.
+class LiveEventsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LiveEventsPanel(QWidget *parent = nullptr);
+
+    void setChannel(const QString &channel);
+    void removeChannel(const QString &channel);
+
+    void updatePoll(const QString &channel, const Poll &poll);
+    void updatePrediction(const QString &channel, const Prediction &prediction);
+
+    static constexpr int DISPLAY_INTERVAL_MS = 250;
+
+signals:
+    // status: "TERMINATED" (end, results stay visible) or "ARCHIVED"
+    void endPollRequested(const QString &channel, const QString &pollId, const QString &status);
+    // status: "LOCKED", "RESOLVED" (with the winning outcome) or "CANCELED"
+    void endPredictionRequested(const QString &channel, const QString &predictionId,
+                                const QString &status, const QString &winningOutcomeId);
+
+private:
+    struct ChannelState {
+        Poll poll;
+        Prediction prediction;
+        qint64 pollUpdatedMs = 0;
+        qint64 predictionUpdatedMs = 0;
+        quint64 version = 0;
+    };
+
+    void onDisplayTick();
+    void render();
+    void renderPoll(const Poll &poll);
+    void renderPrediction(const Prediction &prediction);
+    void showNothing();
+    bool showsPrediction(const ChannelState &state) const;
+    void updateButtons();
+
+    QLabel *m_headerLabel;
+    QLabel *m_titleLabel;
+    QTreeWidget *m_treeWidget;
+    QPushButton *m_lockButton;
+    QPushButton *m_resolveButton;
+    QPushButton *m_cancelButton;
+    QPushButton *m_endPollButton;
+    QTimer *m_displayTimer;
+
+    QHash<QString, ChannelState> m_channels;
+    QString m_channel;
+    QString m_shownId;         // poll or prediction on screen
+    QString m_shownStatus;
+    bool m_shownIsPrediction;
+    quint64 m_renderedVersion; // of m_channel, 0 = never drawn
+    qint64 m_renderedAtMs;
+    bool m_countdown;          // something active on screen
+
+    quint64 m_updates;
+    quint64 m_renders;
+};
+
+#endif // LIVEEVENTSPANEL_H
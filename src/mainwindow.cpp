@@ -2,11 +2,32 @@
 #include "channellist.h"
 #include "chatwidget.h"
 #include "userlist.h"
+#include "activitypanel.h"
+#include "liveeventspanel.h"
 #include "predictiondialog.h"
 #include "polldialog.h"
+#include "fanoutdialog.h"
+#include "automoddialog.h"
+#include "bannedusersdialog.h"
+#include "modlogdialog.h"
+#include "usercarddialog.h"
+#include "twitch/networkstack.h"
 #include "twitch/twitchauth.h"
 #include "twitch/twitchapi.h"
 #include "twitch/twitchwebsocket.h"
+#include "pipeline/messagepipeline.h"
+#include "moderation/batchmoderation.h"
+#include "moderation/messagepurge.h"
+#include "moderation/moderationoutbox.h"
+#include "moderation/automodqueue.h"
+#include "moderation/banlist.h"
+#include "moderation/usercardloader.h"
+#include "twitch/userlookupservice.h"
+#include "twitch/profilecache.h"
+#include "twitch/chatterssync.h"
+#include "twitch/eventsubclient.h"
+#include "twitch/liveeventspoller.h"
+#include "twitch/liveeventsfanout.h"
 
 #include <QApplication>
 #include <QMessageBox>
@@ -14,12 +35,70 @@
 #include <QDesktopServices>
 #include <QUrl>
 #include <QInputDialog>
+#include <QPushButton>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QLabel>
+#include <QProgressDialog>
+#include <QStandardPaths>
+
+namespace {
+// "Banned x in #channel"
+QString lineActionDone(ChatLineAction::Kind kind)
+{
+    switch (kind) {
+    case ChatLineAction::Ban:
+        return "Banned";
+    case ChatLineAction::Timeout:
+        return "Timed out";
+    case ChatLineAction::DeleteMessage:
+        return "Deleted message from";
+    }
+    return QString();
+}
+
+// "Ban failed for x"
+QString lineActionName(ChatLineAction::Kind kind)
+{
+    switch (kind) {
+    case ChatLineAction::Ban:
+        return "Ban";
+    case ChatLineAction::Timeout:
+        return "Timeout";
+    case ChatLineAction::DeleteMessage:
+        return "Message deletion";
+    }
+    return QString();
+}
+}
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
-    , m_twitchAuth(new TwitchAuth(this))
-    , m_twitchAPI(new TwitchAPI(this))
+    , m_pipeline(new MessagePipeline(this))
+    , m_network(new NetworkStack(this))
+    , m_twitchAuth(new TwitchAuth(m_network, this))
+    , m_twitchAPI(new TwitchAPI(m_network, this))
     , m_webSocket(new TwitchWebSocket(this))
+    , m_profileCache(new ProfileCache(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                                      + "/profiles.dat", 5000, this))
+    , m_userLookup(new UserLookupService(m_twitchAPI, m_profileCache, this))
+    , m_outbox(new ModerationOutbox(m_twitchAPI, QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                                    + "/outbox.journal", this))
+    , m_batchModeration(new BatchModeration(m_twitchAPI, m_userLookup, m_outbox, this))
+    , m_messagePurge(new MessagePurge(m_twitchAPI, m_outbox, this))
+    , m_chattersSync(new ChattersSync(m_twitchAPI, this))
+    , m_eventSub(new EventSubClient(m_twitchAPI, this))
+    , m_liveEventsPoller(new LiveEventsPoller(m_twitchAPI, m_eventSub, this))
+    , m_fanOut(new LiveEventsFanOut(m_twitchAPI, m_userLookup, this))
+    , m_autoModQueue(new AutoModQueue(m_twitchAPI, this))
+    , m_autoModDialog(nullptr)
+    , m_banList(new BanList(m_twitchAPI, QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                            + "/bans", this))
+    , m_bannedUsersDialog(nullptr)
+    , m_modLog(new ModActionLog(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                                + "/modactions.log", this))
+    , m_modLogDialog(nullptr)
+    , m_userCards(new UserCardLoader(m_twitchAPI, m_userLookup, m_profileCache, m_banList, m_modLog, this))
 {
     setWindowTitle("TwitchMod - Twitch Moderator Client");
     resize(1280, 720);
@@ -77,9 +156,12 @@ void MainWindow::createMenuBar()
 
     // Mods Menu
     QMenu *modsMenu = menuBar()->addMenu("&Mods");
-    modsMenu->addAction("AutoMod Queue");
-    modsMenu->addAction("Banned Users");
-    modsMenu->addAction("Mod Actions Log");
+    m_autoModAction = modsMenu->addAction("AutoMod Queue");
+    connect(m_autoModAction, &QAction::triggered, this, &MainWindow::showAutoModQueue);
+    QAction *bannedUsersAction = modsMenu->addAction("Banned Users");
+    connect(bannedUsersAction, &QAction::triggered, this, &MainWindow::showBannedUsers);
+    QAction *modLogAction = modsMenu->addAction("Mod Actions Log");
+    connect(modLogAction, &QAction::triggered, this, &MainWindow::showModLog);
     modsMenu->addSeparator();
 
     QAction *createPollAction = modsMenu->addAction("Create Poll");
@@ -120,19 +202,42 @@ void MainWindow::createLayout()
     ChatWidget *defaultChat = new ChatWidget(this);
     m_chatTabs->addTab(defaultChat, "Welcome");
 
-    // Right panel: User list
+    // Right panel: User list above the most active chatters and the
+    // channel's poll or prediction
+    m_rightSplitter = new QSplitter(Qt::Vertical, this);
     m_userList = new UserList(this);
+    m_activityPanel = new ActivityPanel(this);
+    m_liveEvents = new LiveEventsPanel(this);
+    m_rightSplitter->addWidget(m_userList);
+    m_rightSplitter->addWidget(m_activityPanel);
+    m_rightSplitter->addWidget(m_liveEvents);
+    m_rightSplitter->setSizes(QList<int>() << 400 << 250 << 200);
 
     // Add widgets to splitter
     m_mainSplitter->addWidget(m_channelList);
     m_mainSplitter->addWidget(m_chatTabs);
-    m_mainSplitter->addWidget(m_userList);
+    m_mainSplitter->addWidget(m_rightSplitter);
 
     // Set initial splitter sizes (mIRC-style proportions)
     // Left: 200px, Center: flexible, Right: 180px
     m_mainSplitter->setSizes(QList<int>() << 200 << 700 << 180);
 
     mainLayout->addWidget(m_mainSplitter);
+
+    // Sketch queries are cheap, but rebuilding the table per message is not
+    m_activityTimer = new QTimer(this);
+    m_activityTimer->setInterval(1000);
+    connect(m_activityTimer, &QTimer::timeout, this, [this]() {
+        refreshActivityPanel();
+        updatePipelineStatus();
+        updateApiStatus();
+    });
+    m_activityTimer->start();
+
+    m_pipelineLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(m_pipelineLabel);
+    m_apiLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(m_apiLabel);
 }
 
 void MainWindow::setupConnections()
@@ -143,6 +248,206 @@ void MainWindow::setupConnections()
     connect(m_exitAction, &QAction::triggered, this, &QApplication::quit);
     connect(m_aboutAction, &QAction::triggered, this, &MainWindow::onAbout);
 
+    // Helix calls that still failed after the scheduler's retries
+    connect(m_twitchAPI, &TwitchAPI::requestFailed, this,
+            [this](const QString &endpoint, int statusCode, const QString &error) {
+        qWarning() << "API request failed:" << endpoint << statusCode << error;
+        statusBar()->showMessage(QString("API error (%1): %2").arg(statusCode).arg(error), 5000);
+    });
+
+    // User list moderation, single users and multi-selections alike
+    connect(m_userList, &UserList::userBanRequested, this, [this](const QString &username) {
+        moderateUsers(QStringList() << username, 0);
+    });
+    connect(m_userList, &UserList::userTimeoutRequested, this, [this](const QString &username, int seconds) {
+        moderateUsers(QStringList() << username, seconds);
+    });
+    connect(m_userList, &UserList::usersBanRequested, this, [this](const QStringList &usernames) {
+        moderateUsers(usernames, 0);
+    });
+    connect(m_userList, &UserList::usersTimeoutRequested, this, &MainWindow::moderateUsers);
+    connect(m_userList, &UserList::userMessagesDeleteRequested, this, &MainWindow::deleteRecentMessages);
+    connect(m_userList, &UserList::userInfoRequested, this, &MainWindow::showUserCard);
+
+    // Lines change as each deletion lands, not when the whole purge is done
+    connect(m_messagePurge, &MessagePurge::messageFinished, this,
+            [this](quint64, const QString &channel, const QString &username, const QString &messageId, bool deleted) {
+        if (ChatWidget *chatWidget = m_channelWidgets.value(channel)) {
+            if (deleted) {
+                chatWidget->markMessageDeleted(messageId);
+            } else {
+                chatWidget->markMessagePending(messageId, false);
+            }
+        }
+        if (deleted) {
+            ModAction action;
+            action.kind = ModAction::DeleteMessage;
+            action.sources = ModAction::Issued;
+            action.channel = channel;
+            action.targetLogin = username;
+            action.moderatorLogin = m_twitchAuth->getUsername();
+            action.messageId = messageId;
+            m_modLog->record(action);
+        }
+    });
+    connect(m_messagePurge, &MessagePurge::purgeFinished, this, [this](const PurgeSummary &summary) {
+        const QString text = summary.toString();
+        statusBar()->showMessage(text, 10000);
+        if (ChatWidget *chatWidget = m_channelWidgets.value(summary.channel)) {
+            chatWidget->addSystemMessage(text);
+        }
+    });
+
+    // Batch progress and results
+    connect(m_batchModeration, &BatchModeration::itemFinished, this,
+            [this](quint64 batchId, const BatchItemResult &item, int done, int total) {
+        if (QProgressDialog *progress = m_batchProgress.value(batchId)) {
+            progress->setMaximum(total);
+            progress->setValue(done);
+            progress->setLabelText(QString("%1 of %2 done (last: %3)").arg(done).arg(total).arg(item.username));
+        }
+        if (item.status == BatchItemResult::Succeeded && m_batchActions.contains(batchId)) {
+            ModAction action = m_batchActions.value(batchId);
+            action.targetLogin = item.username;
+            action.targetId = item.userId;
+            m_modLog->record(action);
+        }
+    });
+    connect(m_batchModeration, &BatchModeration::batchFinished, this, &MainWindow::onBatchFinished);
+    connect(m_outbox, &ModerationOutbox::replayStarted, this, [this](int count) {
+        statusBar()->showMessage(QString("Resending %1 moderation actions from the last session").arg(count), 5000);
+    });
+
+    // Message pipeline results (always delivered on the GUI thread)
+    connect(m_pipeline, &MessagePipeline::messagesReady, this, &MainWindow::renderMessages);
+    connect(m_pipeline, &MessagePipeline::surgeDetected, this, &MainWindow::promptSurgeResponse);
+    connect(m_pipeline, &MessagePipeline::activityReady, this,
+            [this](const QString &channelName, const QList<HeavyHitters::Entry> &entries) {
+        if (channelName == m_currentChannel) {
+            m_activityPanel->setEntries(entries);
+        }
+    });
+
+    // Full chatter lists from Helix; IRC JOIN/PART only cover small channels
+    connect(m_chattersSync, &ChattersSync::chattersJoined, this,
+            [this](const QString &channelName, const QStringList &logins) {
+        if (ChatWidget *chatWidget = m_channelWidgets.value(channelName)) {
+            chatWidget->usernames().addMembers(logins);
+        }
+        if (channelName == m_currentChannel) {
+            m_userList->addUsers(logins);
+        }
+    });
+    connect(m_chattersSync, &ChattersSync::chattersParted, this,
+            [this](const QString &channelName, const QStringList &logins) {
+        if (ChatWidget *chatWidget = m_channelWidgets.value(channelName)) {
+            chatWidget->usernames().removeMembers(logins);
+        }
+        if (channelName == m_currentChannel) {
+            m_userList->removeUsers(logins);
+        }
+    });
+    connect(m_chattersSync, &ChattersSync::syncFinished, this,
+            [](const QString &channelName, int count, int pages, qint64 elapsedMs) {
+        qDebug() << "Chatters sync for" << channelName << ":" << count << "users," << pages
+                 << "pages in" << elapsedMs << "ms";
+    });
+    connect(m_chattersSync, &ChattersSync::syncFailed, this,
+            [this](const QString &channelName, const QString &error) {
+        statusBar()->showMessage(QString("Chatter list for #%1 unavailable: %2").arg(channelName, error), 5000);
+    });
+
+    // Channel events pushed over EventSub
+    connect(m_eventSub, &EventSubClient::userBanned, this, [this](const BanEvent &event) {
+        if (event.permanent) {
+            m_batchModeration->markBanned(event.channel, event.userLogin);
+            addChannelNotice(event.channel, QString("%1 was banned by %2%3")
+                             .arg(event.userLogin, event.moderatorLogin,
+                                  event.reason.isEmpty() ? QString() : ": " + event.reason));
+        } else {
+            const qint64 seconds = QDateTime::currentDateTimeUtc().secsTo(event.endsAt);
+            addChannelNotice(event.channel, QString("%1 was timed out for %2s by %3%4")
+                             .arg(event.userLogin).arg(qMax<qint64>(0, seconds)).arg(event.moderatorLogin)
+                             .arg(event.reason.isEmpty() ? QString() : ": " + event.reason));
+        }
+        m_profileCache->storeRole(event.userId, event.userLogin, event.broadcasterId,
+                                  ProfileCache::Banned, event.permanent);
+
+        BannedUser ban;
+        ban.userId = event.userId;
+        ban.login = event.userLogin;
+        ban.createdAt = QDateTime::currentDateTimeUtc();
+        if (!event.permanent) {
+            ban.expiresAt = event.endsAt;
+        }
+        ban.reason = event.reason;
+        ban.moderatorLogin = event.moderatorLogin;
+        m_banList->addBan(event.channel, event.broadcasterId, ban);
+
+        ModAction action;
+        action.kind = event.permanent ? ModAction::Ban : ModAction::Timeout;
+        action.sources = ModAction::EventSub;
+        action.channel = event.channel;
+        action.targetLogin = event.userLogin;
+        action.targetId = event.userId;
+        action.moderatorLogin = event.moderatorLogin;
+        if (!event.permanent) {
+            action.durationSeconds = int(qMax<qint64>(0, ban.createdAt.secsTo(event.endsAt)));
+        }
+        action.reason = event.reason;
+        m_modLog->record(action);
+    });
+    connect(m_eventSub, &EventSubClient::userUnbanned, this, [this](const UnbanEvent &event) {
+        m_batchModeration->markUnbanned(event.channel, event.userLogin);
+        m_banList->removeBan(event.channel, event.userId);
+
+        ModAction action;
+        action.kind = ModAction::Unban;
+        action.sources = ModAction::EventSub;
+        action.channel = event.channel;
+        action.targetLogin = event.userLogin;
+        action.targetId = event.userId;
+        action.moderatorLogin = event.moderatorLogin;
+        m_modLog->record(action);
+        m_profileCache->storeRole(event.userId, event.userLogin, event.broadcasterId,
+                                  ProfileCache::Banned, false);
+        addChannelNotice(event.channel, QString("%1 was unbanned by %2").arg(event.userLogin, event.moderatorLogin));
+    });
+    // Held messages go to the queue instead of chat, a raid holds hundreds
+    connect(m_eventSub, &EventSubClient::autoModHeld, m_autoModQueue, &AutoModQueue::add);
+    connect(m_eventSub, &EventSubClient::autoModResolved, m_autoModQueue, &AutoModQueue::resolved);
+    connect(m_autoModQueue, &AutoModQueue::countsChanged, this, [this]() {
+        const int held = m_autoModQueue->pendingCount();
+        m_autoModAction->setText(held > 0 ? QString("AutoMod Queue (%1)").arg(held) : QString("AutoMod Queue"));
+    });
+    connect(m_eventSub, &EventSubClient::chatSettingsChanged, this,
+            [this](const QString &channelName, const ChatSettings &settings) {
+        QStringList modes;
+        if (settings.slowMode) {
+            modes.append(QString("slow %1s").arg(settings.slowModeWaitSeconds));
+        }
+        if (settings.followerMode) {
+            modes.append(QString("followers-only %1m").arg(settings.followerModeDurationMinutes));
+        }
+        if (settings.subscriberMode) {
+            modes.append("subscribers-only");
+        }
+        if (settings.emoteMode) {
+            modes.append("emote-only");
+        }
+        if (settings.uniqueChatMode) {
+            modes.append("unique chat");
+        }
+        addChannelNotice(channelName, "Chat settings: " + (modes.isEmpty() ? QString("all modes off")
+                                                                           : modes.join(", ")));
+    });
+    connect(m_eventSub, &EventSubClient::pollUpdated, this, &MainWindow::onPollUpdated);
+    connect(m_eventSub, &EventSubClient::predictionUpdated, this, &MainWindow::onPredictionUpdated);
+    connect(m_liveEventsPoller, &LiveEventsPoller::pollUpdated, this, &MainWindow::onPollUpdated);
+    connect(m_liveEventsPoller, &LiveEventsPoller::predictionUpdated, this, &MainWindow::onPredictionUpdated);
+    connect(m_liveEvents, &LiveEventsPanel::endPollRequested, this, &MainWindow::endPoll);
+    connect(m_liveEvents, &LiveEventsPanel::endPredictionRequested, this, &MainWindow::endPrediction);
+
     // Channel selection - join IRC channel and create tab
     connect(m_channelList, &ChannelList::channelSelected, [this](const QString &channelName) {
         qDebug() << "Channel selected:" << channelName;
@@ -175,6 +480,22 @@ void MainWindow::setupConnections()
             }
         });
 
+        // Group actions on flagged flood clusters
+        connect(chatWidget, &ChatWidget::clusterBanRequested, this, [this](const FloodCluster &cluster) {
+            moderateFloodCluster(cluster, 0);
+        });
+        connect(chatWidget, &ChatWidget::clusterTimeoutRequested, this,
+                [this](const FloodCluster &cluster, int seconds) {
+            moderateFloodCluster(cluster, seconds);
+        });
+        connect(chatWidget, &ChatWidget::lineActionRequested, this,
+                [this, channelName](const ChatLineAction &action) {
+            moderateLine(channelName, action);
+        });
+        connect(chatWidget, &ChatWidget::commandEntered, this, [this, channelName](const ChatCommand &command) {
+            runCommand(channelName, command);
+        });
+
         // Join IRC channel
         if (m_webSocket && m_webSocket->isConnected()) {
             m_webSocket->joinChannel(channelName);
@@ -183,6 +504,13 @@ void MainWindow::setupConnections()
         // Update current channel for user list
         m_currentChannel = channelName;
         m_userList->clearUsers();
+        m_userList->addUsers(m_chattersSync->members(channelName).values());
+        chatWidget->usernames().setMembers(m_chattersSync->members(channelName).values());
+        m_activityPanel->clearEntries();
+        refreshActivityPanel();
+        m_liveEvents->setChannel(channelName);
+
+        startChannelServices(channelName);
     });
 
     // Join Channel button handler
@@ -206,16 +534,621 @@ void MainWindow::setupConnections()
         }
     });
 
+    // The poll/prediction panel follows the visible tab
+    connect(m_chatTabs, &QTabWidget::currentChanged, [this](int index) {
+        m_liveEvents->setChannel(m_channelWidgets.key(qobject_cast<ChatWidget*>(m_chatTabs->widget(index))));
+    });
+
     // Close tab on close button click
     connect(m_chatTabs, &QTabWidget::tabCloseRequested, [this](int index) {
         if (m_chatTabs->count() > 1) { // Keep at least one tab
             QWidget *widget = m_chatTabs->widget(index);
             m_chatTabs->removeTab(index);
+
+            // Drop the channel mapping so no message is routed to a deleted widget
+            QString channelName = m_channelWidgets.key(qobject_cast<ChatWidget*>(widget));
+            if (!channelName.isEmpty()) {
+                m_channelWidgets.remove(channelName);
+                m_pipeline->removeChannel(channelName);
+                m_chattersSync->stop(channelName);
+                m_eventSub->removeChannel(channelName);
+                m_liveEventsPoller->unwatch(channelName);
+                m_liveEvents->removeChannel(channelName);
+                m_autoModQueue->removeChannel(channelName);
+            }
+
             widget->deleteLater();
         }
     });
 }
 
+void MainWindow::moderateFloodCluster(const FloodCluster &cluster, int timeoutSeconds)
+{
+    QList<BatchTarget> targets;
+    for (int i = 0; i < cluster.usernames.size(); ++i) {
+        targets.append(BatchTarget{cluster.usernames.at(i), cluster.userIds.value(i)});
+    }
+    startModerationBatch(cluster.channel, cluster.roomId, targets, timeoutSeconds, "Copy-pasta flood");
+}
+
+void MainWindow::moderateUsers(const QStringList &usernames, int timeoutSeconds)
+{
+    if (m_currentChannel.isEmpty() || usernames.isEmpty()) {
+        return;
+    }
+
+    if (usernames.size() > 1) {
+        QString action = timeoutSeconds > 0 ? QString("Time out (%1s)").arg(timeoutSeconds) : QString("Ban");
+        QMessageBox::StandardButton answer = QMessageBox::question(
+            this, "Confirm Mass Action",
+            QString("%1 %2 users in #%3?").arg(action).arg(usernames.size()).arg(m_currentChannel));
+        if (answer != QMessageBox::Yes) {
+            return;
+        }
+    }
+
+    QList<BatchTarget> targets;
+    for (const QString &username : usernames) {
+        targets.append(BatchTarget{username, QString()});
+    }
+    startModerationBatch(m_currentChannel, m_channelRoomIds.value(m_currentChannel),
+                         targets, timeoutSeconds, QString());
+}
+
+void MainWindow::startModerationBatch(const QString &channelName, const QString &broadcasterId,
+                                      const QList<BatchTarget> &targets, int timeoutSeconds,
+                                      const QString &reason)
+{
+    if (!m_twitchAuth->isAuthenticated()) {
+        QMessageBox::warning(this, "Not Connected",
+                           "Please connect to Twitch first.");
+        return;
+    }
+
+    quint64 batchId = m_batchModeration->start(channelName, broadcasterId, m_twitchAuth->getUserId(),
+                                               targets, timeoutSeconds, reason);
+
+    ModAction action;
+    action.kind = timeoutSeconds > 0 ? ModAction::Timeout : ModAction::Ban;
+    action.sources = ModAction::Issued;
+    action.channel = channelName;
+    action.moderatorLogin = m_twitchAuth->getUsername();
+    action.durationSeconds = timeoutSeconds;
+    action.reason = reason;
+    m_batchActions.insert(batchId, action);
+
+    // Single actions just report in the status bar
+    if (targets.size() > 1) {
+        QProgressDialog *progress = new QProgressDialog(this);
+        progress->setAttribute(Qt::WA_DeleteOnClose);
+        progress->setWindowTitle(QString("%1 in #%2").arg(timeoutSeconds > 0 ? "Timing out" : "Banning", channelName));
+        progress->setLabelText(QString("Preparing %1 accounts...").arg(targets.size()));
+        progress->setRange(0, int(targets.size()));
+        progress->setMinimumDuration(0);
+        progress->setAutoClose(false);
+        progress->setAutoReset(false);
+        connect(progress, &QProgressDialog::canceled, this, [this, batchId]() {
+            m_batchModeration->cancel(batchId);
+        });
+        m_batchProgress.insert(batchId, progress);
+        progress->show();
+    }
+
+    statusBar()->showMessage(QString("%1 %2 accounts in #%3")
+                             .arg(timeoutSeconds > 0 ? "Timing out" : "Banning")
+                             .arg(targets.size())
+                             .arg(channelName), 5000);
+}
+
+void MainWindow::onBatchFinished(const BatchSummary &summary)
+{
+    if (QProgressDialog *progress = m_batchProgress.take(summary.batchId)) {
+        progress->close();
+    }
+    m_batchActions.remove(summary.batchId);
+
+    QString text = summary.toString();
+    statusBar()->showMessage(text, 10000);
+    if (ChatWidget *chatWidget = m_channelWidgets.value(summary.channel)) {
+        chatWidget->addSystemMessage(text);
+    }
+
+    if (!summary.failures.isEmpty()) {
+        QMessageBox *msgBox = new QMessageBox(QMessageBox::Warning, "Moderation Batch",
+                                              text, QMessageBox::Ok, this);
+        msgBox->setAttribute(Qt::WA_DeleteOnClose);
+        msgBox->setDetailedText(summary.failures.join("\n"));
+        msgBox->open();
+    }
+}
+
+void MainWindow::moderateLine(const QString &channelName, const ChatLineAction &action)
+{
+    if (!m_twitchAuth->isAuthenticated()) {
+        QMessageBox::warning(this, "Not Connected",
+                           "Please connect to Twitch first.");
+        return;
+    }
+    const QString broadcasterId = m_channelRoomIds.value(channelName);
+    if (broadcasterId.isEmpty()) {
+        statusBar()->showMessage(QString("Channel id for #%1 not known yet; try again once chat has loaded.")
+                                 .arg(channelName), 5000);
+        return;
+    }
+    if (action.userId.isEmpty() && action.kind != ChatLineAction::DeleteMessage) {
+        // Lines without tags (shouldn't happen on Twitch) take the lookup path
+        startModerationBatch(channelName, broadcasterId, QList<BatchTarget>() << BatchTarget{action.username, QString()},
+                             action.kind == ChatLineAction::Timeout ? action.durationSeconds : 0, QString());
+        return;
+    }
+
+    const QString moderatorId = m_twitchAuth->getUserId();
+    QFuture<ApiReply> reply;
+    switch (action.kind) {
+    case ChatLineAction::Ban:
+        reply = m_outbox->ban(broadcasterId, moderatorId, action.userId);
+        break;
+    case ChatLineAction::Timeout:
+        reply = m_outbox->timeout(broadcasterId, moderatorId, action.userId, action.durationSeconds);
+        break;
+    case ChatLineAction::DeleteMessage:
+        reply = m_outbox->deleteMessage(broadcasterId, moderatorId, action.messageId);
+        if (ChatWidget *chatWidget = m_channelWidgets.value(channelName)) {
+            chatWidget->markMessagePending(action.messageId, true);
+        }
+        break;
+    }
+
+    // Input to hand-off: everything before the outbox's journal write and
+    // the scheduler, which should fit well inside one frame
+    const qint64 dispatchUs = action.sinceInput.nsecsElapsed() / 1000;
+    if (dispatchUs > 16000) {
+        qWarning() << "Chat line action took" << dispatchUs << "us to dispatch";
+    }
+
+    reply.then(this, [this, channelName, action, dispatchUs](const ApiReply &result) {
+        const qint64 totalMs = action.sinceInput.elapsed();
+        ++m_lineActionStats.count;
+        m_lineActionStats.dispatchTotalUs += dispatchUs;
+        m_lineActionStats.dispatchMaxUs = qMax(m_lineActionStats.dispatchMaxUs, dispatchUs);
+        m_lineActionStats.totalMs += totalMs;
+        m_lineActionStats.maxMs = qMax(m_lineActionStats.maxMs, totalMs);
+        qDebug() << "Chat line action on" << action.username << "in #" + channelName << "dispatched in"
+                 << dispatchUs << "us, response after" << totalMs << "ms, status" << result.statusCode;
+
+        const bool done = result.ok() || (action.kind == ChatLineAction::DeleteMessage && result.statusCode == 404);
+        ChatWidget *chatWidget = m_channelWidgets.value(channelName);
+        if (action.kind == ChatLineAction::DeleteMessage && chatWidget) {
+            if (done) {
+                chatWidget->markMessageDeleted(action.messageId);
+            } else {
+                chatWidget->markMessagePending(action.messageId, false);
+            }
+        }
+
+        if (!done) {
+            statusBar()->showMessage(QString("%1 failed for %2: %3")
+                                     .arg(lineActionName(action.kind), action.username, result.error), 10000);
+            return;
+        }
+        statusBar()->showMessage(QString("%1 %2 in #%3 (%4 ms)")
+                                 .arg(lineActionDone(action.kind), action.username, channelName)
+                                 .arg(totalMs), 5000);
+
+        ModAction logged;
+        logged.kind = action.kind == ChatLineAction::Ban ? ModAction::Ban
+                    : action.kind == ChatLineAction::Timeout ? ModAction::Timeout
+                    : ModAction::DeleteMessage;
+        logged.sources = ModAction::Issued;
+        logged.channel = channelName;
+        logged.targetLogin = action.username;
+        logged.targetId = action.userId;
+        logged.moderatorLogin = m_twitchAuth->getUsername();
+        logged.durationSeconds = action.durationSeconds;
+        if (action.kind == ChatLineAction::DeleteMessage) {
+            logged.messageId = action.messageId;
+        }
+        m_modLog->record(logged);
+    });
+}
+
+void MainWindow::runCommand(const QString &channelName, const ChatCommand &command)
+{
+    ChatWidget *chatWidget = m_channelWidgets.value(channelName);
+    if (!chatWidget) {
+        return;
+    }
+
+    // Local commands; both act on the current channel, where the command was typed
+    if (command.kind == ChatCommand::UserCard) {
+        showUserCard(command.targets.first());
+        return;
+    }
+    if (command.kind == ChatCommand::Purge) {
+        for (const QString &target : command.targets) {
+            deleteRecentMessages(target);
+        }
+        return;
+    }
+
+    if (!m_twitchAuth->isAuthenticated()) {
+        chatWidget->addSystemMessage("Connect to Twitch first.");
+        return;
+    }
+    const QString broadcasterId = m_channelRoomIds.value(channelName);
+    if (broadcasterId.isEmpty()) {
+        chatWidget->addSystemMessage("Channel id not known yet; try again once chat has loaded.");
+        return;
+    }
+    const QString moderatorId = m_twitchAuth->getUserId();
+
+    switch (command.kind) {
+    case ChatCommand::Ban:
+    case ChatCommand::Timeout: {
+        const int seconds = command.kind == ChatCommand::Timeout ? command.durationSeconds : 0;
+        if (command.targets.size() > 1) {
+            // Without "--" a reason's words become targets; show who is affected
+            QMessageBox::StandardButton answer = QMessageBox::question(
+                this, "Confirm Mass Action",
+                QString("%1 %2 users in #%3?\n\n%4")
+                    .arg(seconds > 0 ? QString("Time out (%1s)").arg(seconds) : QString("Ban"))
+                    .arg(command.targets.size())
+                    .arg(channelName)
+                    .arg(command.targets.join(", ")));
+            if (answer != QMessageBox::Yes) {
+                return;
+            }
+        }
+        QList<BatchTarget> targets;
+        for (const QString &login : command.targets) {
+            targets.append(BatchTarget{login, QString()});
+        }
+        startModerationBatch(channelName, broadcasterId, targets, seconds, command.reason);
+        break;
+    }
+    case ChatCommand::Unban:
+    case ChatCommand::Untimeout:
+        // Logged through the EventSub unban event, like the ban browser's
+        for (const QString &login : command.targets) {
+            m_userLookup->lookupByLogin(login, ApiRequest::Interactive)
+                .then(this, [this, channelName, broadcasterId, moderatorId, login](const TwitchUser &user) {
+                    if (!user.isValid()) {
+                        addChannelNotice(channelName, "No account named " + login);
+                        return;
+                    }
+                    m_outbox->unban(broadcasterId, moderatorId, user.id)
+                        .then(this, [this, channelName, login](const ApiReply &reply) {
+                            addChannelNotice(channelName, reply.ok() ? QString("Unbanned %1").arg(login)
+                                                                     : QString("Unban of %1 failed: %2")
+                                                                           .arg(login, reply.error));
+                        });
+                });
+        }
+        break;
+    default: {
+        QJsonObject settings;
+        switch (command.kind) {
+        case ChatCommand::Slow:
+            settings["slow_mode"] = true;
+            settings["slow_mode_wait_time"] = command.durationSeconds;
+            break;
+        case ChatCommand::SlowOff:
+            settings["slow_mode"] = false;
+            break;
+        case ChatCommand::Followers:
+            settings["follower_mode"] = true;
+            settings["follower_mode_duration"] = command.durationSeconds / 60;
+            break;
+        case ChatCommand::FollowersOff:
+            settings["follower_mode"] = false;
+            break;
+        case ChatCommand::Subscribers:
+        case ChatCommand::SubscribersOff:
+            settings["subscriber_mode"] = command.kind == ChatCommand::Subscribers;
+            break;
+        case ChatCommand::EmoteOnly:
+        case ChatCommand::EmoteOnlyOff:
+            settings["emote_mode"] = command.kind == ChatCommand::EmoteOnly;
+            break;
+        case ChatCommand::UniqueChat:
+        case ChatCommand::UniqueChatOff:
+            settings["unique_chat_mode"] = command.kind == ChatCommand::UniqueChat;
+            break;
+        default:
+            return;
+        }
+        m_twitchAPI->updateChatSettings(broadcasterId, moderatorId, settings)
+            .then(this, [this, channelName, name = command.name](const ApiResult<ChatSettings> &result) {
+                addChannelNotice(channelName, result.ok() ? QString("/%1 done").arg(name)
+                                                          : QString("/%1 failed: %2").arg(name, result.error));
+            });
+        break;
+    }
+    }
+}
+
+void MainWindow::deleteRecentMessages(const QString &username)
+{
+    ChatWidget *chatWidget = m_channelWidgets.value(m_currentChannel);
+    if (!chatWidget || username.isEmpty()) {
+        return;
+    }
+    if (!m_twitchAuth->isAuthenticated()) {
+        QMessageBox::warning(this, "Not Connected",
+                           "Please connect to Twitch first.");
+        return;
+    }
+
+    const QString broadcasterId = m_channelRoomIds.value(m_currentChannel);
+    const QStringList messageIds = chatWidget->recentMessageIds(username);
+    if (broadcasterId.isEmpty() || messageIds.isEmpty()) {
+        statusBar()->showMessage(QString("No recent messages from %1 in #%2").arg(username, m_currentChannel), 5000);
+        return;
+    }
+
+    for (const QString &messageId : messageIds) {
+        chatWidget->markMessagePending(messageId, true);
+    }
+    m_messagePurge->start(m_currentChannel, broadcasterId, m_twitchAuth->getUserId(), username, messageIds);
+    statusBar()->showMessage(QString("Deleting %1 messages from %2").arg(messageIds.size()).arg(username), 5000);
+}
+
+void MainWindow::promptSurgeResponse(const QString &channelName, const QList<SurgeAlert> &alerts)
+{
+    QStringList lines;
+    for (const SurgeAlert &alert : alerts) {
+        lines.append(QString("%1: %2/min (usually ~%3/min)")
+                     .arg(SurgeAlert::metricName(alert.metric))
+                     .arg(qRound(alert.perMinute))
+                     .arg(qRound(alert.baseline)));
+    }
+
+    if (ChatWidget *chatWidget = m_channelWidgets.value(channelName)) {
+        chatWidget->addSystemMessage("Possible raid - " + lines.join(", "));
+    }
+
+    QString broadcasterId = m_channelRoomIds.value(channelName);
+
+    // Non-modal so chat keeps flowing while the moderator decides
+    QMessageBox *msgBox = new QMessageBox(this);
+    msgBox->setAttribute(Qt::WA_DeleteOnClose);
+    msgBox->setWindowTitle("Possible Raid in #" + channelName);
+    msgBox->setIcon(QMessageBox::Warning);
+    msgBox->setText(QString("Unusual activity in #%1:\n\n%2")
+                    .arg(channelName, lines.join("\n")));
+
+    QPushButton *followersButton = msgBox->addButton("Followers-Only (10 min)", QMessageBox::ActionRole);
+    QPushButton *emoteButton = msgBox->addButton("Emote-Only", QMessageBox::ActionRole);
+    msgBox->addButton("Ignore", QMessageBox::RejectRole);
+
+    bool canUpdate = m_twitchAuth->isAuthenticated() && !broadcasterId.isEmpty();
+    followersButton->setEnabled(canUpdate);
+    emoteButton->setEnabled(canUpdate);
+
+    connect(msgBox, &QMessageBox::buttonClicked, this,
+            [this, followersButton, emoteButton, broadcasterId, channelName](QAbstractButton *button) {
+        QJsonObject settings;
+        if (button == followersButton) {
+            settings["follower_mode"] = true;
+            settings["follower_mode_duration"] = 10;
+        } else if (button == emoteButton) {
+            settings["emote_mode"] = true;
+        } else {
+            return;
+        }
+
+        statusBar()->showMessage("Updating chat settings for #" + channelName, 3000);
+        m_twitchAPI->updateChatSettings(broadcasterId, m_twitchAuth->getUserId(), settings)
+            .then(this, [this, channelName](const ApiResult<ChatSettings> &result) {
+                if (result.ok()) {
+                    statusBar()->showMessage("Chat settings updated for #" + channelName, 3000);
+                }
+            });
+    });
+
+    msgBox->open();
+}
+
+void MainWindow::refreshActivityPanel()
+{
+    if (!m_currentChannel.isEmpty()) {
+        m_pipeline->requestActivity(m_currentChannel);
+    }
+}
+
+void MainWindow::updatePipelineStatus()
+{
+    PipelineStats stats = m_pipeline->takeStats();
+    if (stats.channels == 0) {
+        m_pipelineLabel->clear();
+        return;
+    }
+
+    m_pipelineLabel->setText(QString("Pipeline: %1 msg/s, %2 queued, %3 ms latency")
+                             .arg(stats.count[PipelineStats::EndToEnd])
+                             .arg(stats.inFlight)
+                             .arg(stats.averageUs[PipelineStats::EndToEnd] / 1000.0, 0, 'f', 1));
+
+    QStringList lines;
+    lines.append(QString("%1 worker threads, %2 channels, %3 tasks queued, %4 awaiting render, %5 steals")
+                 .arg(stats.threads)
+                 .arg(stats.channels)
+                 .arg(stats.poolPending)
+                 .arg(stats.renderBacklog)
+                 .arg(stats.stolenTasks));
+    for (int s = 0; s < PipelineStats::StageCount; ++s) {
+        lines.append(QString("%1: avg %2 us, max %3 us")
+                     .arg(PipelineStats::stageName(PipelineStats::Stage(s)))
+                     .arg(stats.averageUs[s], 0, 'f', 1)
+                     .arg(stats.maxUs[s], 0, 'f', 1));
+    }
+    m_pipelineLabel->setToolTip(lines.join("\n"));
+}
+
+void MainWindow::updateApiStatus()
+{
+    RequestSchedulerStats stats = m_twitchAPI->schedulerStats();
+    if (stats.sent == 0) {
+        m_apiLabel->clear();
+        return;
+    }
+
+    int queued = stats.delayed;
+    for (int p = 0; p < ApiRequest::PriorityCount; ++p) {
+        queued += stats.queued[p];
+    }
+
+    QString text = QString("API: %1/%2").arg(stats.bucketRemaining).arg(stats.bucketLimit);
+    if (queued > 0) {
+        text += QString(", %1 queued").arg(queued);
+    }
+    if (stats.pausedForMs > 0) {
+        text += QString(", rate limited %1s").arg((stats.pausedForMs + 999) / 1000);
+    }
+    m_apiLabel->setText(text);
+
+    const char *names[ApiRequest::PriorityCount] = {"Moderation", "Interactive", "Background"};
+    QStringList lines;
+    lines.append(QString("%1 sent, %2 ok, %3 failed, %4 retries, %5 rate limited, %6 in flight")
+                 .arg(stats.sent).arg(stats.succeeded).arg(stats.failed)
+                 .arg(stats.retries).arg(stats.rateLimited).arg(stats.inFlight));
+    for (int p = 0; p < ApiRequest::PriorityCount; ++p) {
+        lines.append(QString("%1: %2 queued, wait avg %3 ms, max %4 ms")
+                     .arg(names[p])
+                     .arg(stats.queued[p])
+                     .arg(stats.averageWaitMs[p], 0, 'f', 0)
+                     .arg(stats.maxWaitMs[p]));
+    }
+
+    if (m_lineActionStats.count > 0) {
+        lines.append(QString("Chat line actions: %1, input to dispatch avg %2 us, max %3 us; "
+                             "input to response avg %4 ms, max %5 ms")
+                     .arg(m_lineActionStats.count)
+                     .arg(m_lineActionStats.dispatchTotalUs / m_lineActionStats.count)
+                     .arg(m_lineActionStats.dispatchMaxUs)
+                     .arg(m_lineActionStats.totalMs / m_lineActionStats.count)
+                     .arg(m_lineActionStats.maxMs));
+    }
+
+    const QHash<QString, ResponseCacheStats> responses = m_twitchAPI->cacheStats();
+    QStringList paths = responses.keys();
+    paths.sort();
+    for (const QString &path : std::as_const(paths)) {
+        const ResponseCacheStats &counts = responses[path];
+        lines.append(QString("GET %1: %2 hits, %3 misses, %4 joined, %5 revalidated, %6 invalidated")
+                     .arg(path).arg(counts.hits).arg(counts.misses).arg(counts.joined)
+                     .arg(counts.revalidated).arg(counts.invalidated));
+    }
+
+    const QHash<QString, DecodeStats> decoding = m_twitchAPI->decodeStats();
+    paths = decoding.keys();
+    paths.sort();
+    for (const QString &path : std::as_const(paths)) {
+        const DecodeStats &timing = decoding[path];
+        lines.append(QString("Decode %1: %2 responses (%3 off-thread), %4 KiB, avg %5 us, max %6 us")
+                     .arg(path).arg(timing.responses).arg(timing.offThread)
+                     .arg(timing.bytes / 1024).arg(timing.averageUs(), 0, 'f', 0)
+                     .arg(timing.maxUs));
+    }
+
+    const QHash<QString, ConnectionStats> connections = m_network->stats();
+    paths = connections.keys();
+    paths.sort();
+    for (const QString &path : std::as_const(paths)) {
+        const ConnectionStats &timing = connections[path];
+        lines.append(QString("%1: %2 requests (%3 cold, %4 HTTP/2), setup avg %5 ms, max %6 ms, "
+                             "first byte avg %7 ms, max %8 ms")
+                     .arg(path).arg(timing.requests).arg(timing.cold).arg(timing.http2)
+                     .arg(timing.averageSetupMs(), 0, 'f', 0).arg(timing.setupMaxMs)
+                     .arg(timing.averageFirstByteMs(), 0, 'f', 0).arg(timing.firstByteMaxMs));
+    }
+    lines.append(QString("Connection warm-ups: %1").arg(m_network->warmUps()));
+
+    const EventSubStats eventSub = m_eventSub->stats();
+    lines.append(QString("EventSub: %1, %2 subscriptions in %3 channels (%4 failed), %5 notifications, "
+                         "%6 duplicates, %7 sessions, %8 reconnects")
+                 .arg(eventSub.connected ? "connected" : "not connected")
+                 .arg(eventSub.subscriptions).arg(eventSub.channels).arg(eventSub.failedSubscriptions)
+                 .arg(eventSub.notifications).arg(eventSub.duplicates)
+                 .arg(eventSub.sessions).arg(eventSub.reconnects));
+
+    const OutboxStats outbox = m_outbox->stats();
+    lines.append(QString("Outbox: %1 pending, %2 journaled, %3 collapsed, %4 replayed (%5 expired), "
+                         "%6 retries, %7 ok, %8 failed")
+                 .arg(outbox.pending).arg(outbox.journaled).arg(outbox.collapsed)
+                 .arg(outbox.replayed).arg(outbox.expired).arg(outbox.retries)
+                 .arg(outbox.succeeded).arg(outbox.failed));
+    lines.append(QString("Outbox journal: %1 KiB, %2 writes, avg %3 us, max %4 us")
+                 .arg(outbox.journalBytes / 1024).arg(outbox.writes)
+                 .arg(outbox.writes ? outbox.writeTotalUs / qint64(outbox.writes) : 0)
+                 .arg(outbox.writeMaxUs));
+
+    const ProfileCache::Stats cache = m_profileCache->stats();
+    const UserLookupService::Stats lookups = m_userLookup->stats();
+    lines.append(QString("Profile cache: %1% hit rate, %2/%3 in memory, %4 on disk (%5 KiB), %6 evictions")
+                 .arg(cache.hitRate() * 100.0, 0, 'f', 1)
+                 .arg(cache.memoryEntries).arg(cache.capacity)
+                 .arg(cache.diskRecords).arg(cache.diskBytes / 1024)
+                 .arg(cache.evictions));
+    for (int f = 0; f < ProfileCache::FieldCount; ++f) {
+        const ProfileCache::Field field = ProfileCache::Field(f);
+        lines.append(QString("  %1: %2 hits, %3 misses (%4 expired)")
+                     .arg(ProfileCache::fieldName(field))
+                     .arg(cache.hits[f]).arg(cache.misses[f]).arg(cache.expired[f]));
+    }
+    lines.append(QString("User lookups: %1, %2 cached, %3 shared, %4 requests")
+                 .arg(lookups.lookups).arg(lookups.cached)
+                 .arg(lookups.shared).arg(lookups.requests));
+    m_apiLabel->setToolTip(lines.join("\n"));
+}
+
+void MainWindow::renderMessages(const QList<ProcessedMessage> &batch)
+{
+    // Scroll each touched widget once per batch instead of once per line
+    QList<ChatWidget*> touched;
+    for (const ProcessedMessage &processed : batch) {
+        const QString &channel = processed.message.channel;
+        ChatWidget *chatWidget = m_channelWidgets.value(channel);
+        if (!chatWidget) {
+            continue;
+        }
+
+        if (!processed.message.roomId.isEmpty()) {
+            m_channelRoomIds[channel] = processed.message.roomId;
+
+            // Badges confirm the sender's roles in this channel for free
+            const QString badges = processed.message.tags.value("badges");
+            m_profileCache->storeRole(processed.message.userId, processed.message.username,
+                                      processed.message.roomId, ProfileCache::Moderator,
+                                      badges.contains("moderator/") || badges.contains("broadcaster/"));
+            m_profileCache->storeRole(processed.message.userId, processed.message.username,
+                                      processed.message.roomId, ProfileCache::Vip,
+                                      badges.contains("vip/"));
+        }
+
+        chatWidget->appendFormattedMessage(processed.html, processed.message.messageId,
+                                           processed.message.username, processed.message.userId);
+        if (!touched.contains(chatWidget)) {
+            touched.append(chatWidget);
+        }
+
+        if (processed.verdict.flood.flagged && processed.floodCluster.id != 0) {
+            if (processed.verdict.flood.newlyFlagged) {
+                chatWidget->addFloodAlert(processed.floodCluster);
+            } else {
+                chatWidget->updateFloodCluster(processed.floodCluster);
+            }
+        }
+        if (!processed.verdict.surges.isEmpty()) {
+            promptSurgeResponse(channel, processed.verdict.surges);
+        }
+    }
+
+    for (ChatWidget *chatWidget : touched) {
+        chatWidget->scrollToBottom();
+    }
+}
+
 void MainWindow::onConnectTwitch()
 {
     m_twitchAuth->startAuthentication();
@@ -226,6 +1159,9 @@ void MainWindow::onDisconnect()
     // TODO: Implement disconnect logic
     m_connectAction->setEnabled(true);
     m_disconnectAction->setEnabled(false);
+    m_network->setKeepWarm(false);
+    m_eventSub->stop();
+    m_liveEventsPoller->unwatch(m_twitchAuth->getUsername());
     statusBar()->showMessage("Disconnected from Twitch", 3000);
 }
 
@@ -261,6 +1197,9 @@ void MainWindow::onAuthenticationStarted()
 {
     m_connectAction->setEnabled(false);
     statusBar()->showMessage("Requesting device code from Twitch...", 0);
+
+    // The device flow polls id.twitch.tv until the user confirms
+    m_network->warmUp(NetworkStack::ID_HOST);
 }
 
 void MainWindow::onDeviceCodeReady(const QString &userCode, const QString &verificationUri)
@@ -295,6 +1234,123 @@ void MainWindow::onDeviceCodeReady(const QString &userCode, const QString &verif
     msgBox.exec();
 }
 
+void MainWindow::startChannelServices(const QString &channelName)
+{
+    if (!m_twitchAuth->isAuthenticated()) {
+        return;
+    }
+
+    const QString broadcasterId = m_channelRoomIds.value(channelName);
+    if (!broadcasterId.isEmpty()) {
+        attachChannelServices(channelName, broadcasterId);
+        return;
+    }
+
+    // No chat line seen yet, so no room-id tag to take the id from
+    m_userLookup->lookupByLogin(channelName).then(this, [this, channelName](const TwitchUser &user) {
+        if (user.isValid() && m_channelWidgets.contains(channelName)) {
+            m_channelRoomIds[channelName] = user.id;
+            attachChannelServices(channelName, user.id);
+        }
+    });
+}
+
+void MainWindow::attachChannelServices(const QString &channelName, const QString &broadcasterId)
+{
+    m_chattersSync->start(channelName, broadcasterId, m_twitchAuth->getUserId());
+    m_eventSub->addChannel(channelName, broadcasterId);
+    if (broadcasterId == m_twitchAuth->getUserId()) {
+        m_liveEventsPoller->watch(channelName, broadcasterId);
+    }
+}
+
+void MainWindow::addChannelNotice(const QString &channelName, const QString &text)
+{
+    if (ChatWidget *widget = m_channelWidgets.value(channelName)) {
+        widget->addSystemMessage(text);
+    }
+}
+
+void MainWindow::onPollUpdated(const QString &channelName, const Poll &poll)
+{
+    m_liveEvents->updatePoll(channelName, poll);
+    m_fanOut->update(channelName, poll);
+
+    // Progress goes to the panel only; begin and end are announced once
+    if (m_liveEventStatus.value(poll.id) == poll.status) {
+        return;
+    }
+    m_liveEventStatus[poll.id] = poll.status;
+
+    if (poll.status == "ACTIVE") {
+        statusBar()->showMessage(QString("Poll in #%1: %2").arg(channelName, poll.title), 5000);
+        return;
+    }
+    QStringList results;
+    for (const PollChoice &choice : poll.choices) {
+        results.append(QString("%1 (%2)").arg(choice.title).arg(choice.votes));
+    }
+    addChannelNotice(channelName, QString("Poll \"%1\" %2: %3")
+                     .arg(poll.title, poll.status.toLower(), results.join(", ")));
+}
+
+void MainWindow::onPredictionUpdated(const QString &channelName, const Prediction &prediction)
+{
+    m_liveEvents->updatePrediction(channelName, prediction);
+    m_fanOut->update(channelName, prediction);
+
+    if (m_liveEventStatus.value(prediction.id) == prediction.status) {
+        return;
+    }
+    m_liveEventStatus[prediction.id] = prediction.status;
+
+    if (prediction.status == "ACTIVE") {
+        statusBar()->showMessage(QString("Prediction in #%1: %2").arg(channelName, prediction.title), 5000);
+        return;
+    }
+    QString text = QString("Prediction \"%1\" %2").arg(prediction.title, prediction.status.toLower());
+    for (const PredictionOutcome &outcome : prediction.outcomes) {
+        if (outcome.id == prediction.winningOutcomeId) {
+            text += ", winner: " + outcome.title;
+        }
+    }
+    addChannelNotice(channelName, text);
+}
+
+void MainWindow::endPoll(const QString &channelName, const QString &pollId, const QString &status)
+{
+    // Helix only lets broadcasters end polls, so this is normally our own channel
+    const QString broadcasterId = m_channelRoomIds.value(channelName, m_twitchAuth->getUserId());
+
+    statusBar()->showMessage("Ending poll...", 0);
+    m_twitchAPI->endPoll(broadcasterId, pollId, status)
+        .then(this, [this, channelName](const ApiResult<Poll> &result) {
+            if (!result.ok()) {
+                statusBar()->showMessage("Ending poll failed: " + result.error, 5000);
+                return;
+            }
+            statusBar()->clearMessage();
+            onPollUpdated(channelName, result.value);
+        });
+}
+
+void MainWindow::endPrediction(const QString &channelName, const QString &predictionId,
+                               const QString &status, const QString &winningOutcomeId)
+{
+    const QString broadcasterId = m_channelRoomIds.value(channelName, m_twitchAuth->getUserId());
+
+    statusBar()->showMessage(QString("Setting prediction to %1...").arg(status.toLower()), 0);
+    m_twitchAPI->endPrediction(broadcasterId, predictionId, status, winningOutcomeId)
+        .then(this, [this, channelName](const ApiResult<Prediction> &result) {
+            if (!result.ok()) {
+                statusBar()->showMessage("Updating prediction failed: " + result.error, 5000);
+                return;
+            }
+            statusBar()->clearMessage();
+            onPredictionUpdated(channelName, result.value);
+        });
+}
+
 void MainWindow::onAuthenticationSucceeded(const QString &username)
 {
     m_connectAction->setEnabled(false);
@@ -303,6 +1359,19 @@ void MainWindow::onAuthenticationSucceeded(const QString &username)
     // Set up API with auth token
     m_twitchAPI->setAccessToken(m_twitchAuth->getAccessToken());
     m_twitchAPI->setClientId(TwitchAuth::getClientId());
+    m_autoModQueue->setModeratorId(m_twitchAuth->getUserId());
+    if (m_bannedUsersDialog) {
+        m_bannedUsersDialog->setModeratorId(m_twitchAuth->getUserId());
+    }
+
+    // First ban after login or a quiet stretch must not pay for DNS + TLS
+    m_network->setKeepWarm(true);
+
+    // Bans and timeouts left open by the last session go out first
+    m_outbox->resume();
+
+    // Pushed polls, predictions and mod events; channels subscribe below
+    m_eventSub->start(m_twitchAuth->getUserId());
 
     // Connect IRC status signals
     QObject::connect(m_webSocket, &TwitchWebSocket::connected,
@@ -321,17 +1390,11 @@ void MainWindow::onAuthenticationSucceeded(const QString &username)
     m_webSocket->connect(m_twitchAuth->getAccessToken(), username);
     statusBar()->showMessage("Connecting to IRC...", 0);
 
-    // Connect chat signals to display messages
-    QObject::connect(m_webSocket, &TwitchWebSocket::chatMessageReceived,
-                    [this](const QString &channel, const QString &user, const QString &message, const QString &) {
-        qDebug() << "[" << channel << "]" << user << ":" << message;
-
-        // Find the ChatWidget for this channel
+    // Chat lines go through the message pipeline; only rendering is done here
+    QObject::connect(m_webSocket, &TwitchWebSocket::chatLineReceived, this,
+                    [this](const QString &channel, const QString &line) {
         if (m_channelWidgets.contains(channel)) {
-            ChatWidget *chatWidget = m_channelWidgets[channel];
-            // Random color for each user (could be improved with persistent color mapping)
-            QColor userColor = QColor::fromHsl((qHash(user) % 360), 200, 150);
-            chatWidget->addMessage(user, message, userColor);
+            m_pipeline->ingest(channel, line);
         } else {
             qDebug() << "WARNING: No ChatWidget found for channel:" << channel;
         }
@@ -340,20 +1403,94 @@ void MainWindow::onAuthenticationSucceeded(const QString &username)
     // Connect user JOIN/PART signals for user list
     QObject::connect(m_webSocket, &TwitchWebSocket::userJoined,
                     [this](const QString &channel, const QString &username) {
+        m_pipeline->ingestJoin(channel, username);
+        if (ChatWidget *chatWidget = m_channelWidgets.value(channel)) {
+            chatWidget->usernames().addMembers(QStringList() << username);
+        }
+
         if (channel == m_currentChannel) {
             m_userList->addUser(username);
             qDebug() << "Added user to list:" << username;
+
+            // Account age never changes, so any cached record answers it;
+            // otherwise a NAMES burst collapses into 100-user requests
+            const UserProfile cached = m_profileCache->findByLogin(username, ProfileCache::CreatedAt);
+            if (cached.isValid()) {
+                m_userList->setAccountCreated(username, cached.user.createdAt);
+                return;
+            }
+            m_userLookup->lookupByLogin(username).then(this, [this, channel, username](const TwitchUser &user) {
+                if (user.isValid() && channel == m_currentChannel) {
+                    m_userList->setAccountCreated(username, user.createdAt);
+                }
+            });
         }
     });
 
+    // Permanent bans seen on IRC, so batches skip accounts already gone
+    QObject::connect(m_webSocket, &TwitchWebSocket::userBanned,
+                    [this](const QString &channel, const QString &username, const QString &userId) {
+        m_batchModeration->markBanned(channel, username);
+
+        ModAction action;
+        action.kind = ModAction::Ban;
+        action.sources = ModAction::Irc;
+        action.channel = channel;
+        action.targetLogin = username;
+        action.targetId = userId;
+        m_modLog->record(action);
+    });
+    QObject::connect(m_webSocket, &TwitchWebSocket::userTimedOut,
+                    [this](const QString &channel, const QString &username, int seconds, const QString &userId) {
+        ModAction action;
+        action.kind = ModAction::Timeout;
+        action.sources = ModAction::Irc;
+        action.channel = channel;
+        action.targetLogin = username;
+        action.targetId = userId;
+        action.durationSeconds = seconds;
+        m_modLog->record(action);
+    });
+    QObject::connect(m_webSocket, &TwitchWebSocket::messageDeleted,
+                    [this](const QString &channel, const QString &messageId, const QString &username,
+                           const QString &text) {
+        if (ChatWidget *chatWidget = m_channelWidgets.value(channel)) {
+            chatWidget->markMessageDeleted(messageId);
+        }
+
+        ModAction action;
+        action.kind = ModAction::DeleteMessage;
+        action.sources = ModAction::Irc;
+        action.channel = channel;
+        action.targetLogin = username;
+        action.messageId = messageId;
+        action.messageText = text;
+        m_modLog->record(action);
+    });
+    QObject::connect(m_webSocket, &TwitchWebSocket::chatCleared, [this](const QString &channel) {
+        ModAction action;
+        action.kind = ModAction::ClearChat;
+        action.sources = ModAction::Irc;
+        action.channel = channel;
+        m_modLog->record(action);
+    });
+
     QObject::connect(m_webSocket, &TwitchWebSocket::userParted,
                     [this](const QString &channel, const QString &username) {
+        if (ChatWidget *chatWidget = m_channelWidgets.value(channel)) {
+            chatWidget->usernames().removeMembers(QStringList() << username);
+        }
         if (channel == m_currentChannel) {
             m_userList->removeUser(username);
             qDebug() << "Removed user from list:" << username;
         }
     });
 
+    // Tabs opened before login had no token to list chatters or subscribe with
+    for (auto it = m_channelWidgets.constBegin(); it != m_channelWidgets.constEnd(); ++it) {
+        startChannelServices(it.key());
+    }
+
     statusBar()->showMessage("Connected as " + username, 5000);
 
     QMessageBox::information(this, "Success",
@@ -372,6 +1509,93 @@ void MainWindow::onAuthenticationFailed(const QString &error)
                         QString("Failed to authenticate with Twitch:\n\n%1").arg(error));
 }
 
+void MainWindow::showAutoModQueue()
+{
+    if (!m_autoModDialog) {
+        m_autoModDialog = new AutoModDialog(m_autoModQueue, this);
+    }
+    m_autoModDialog->showChannel(m_currentChannel);
+    m_autoModDialog->show();
+    m_autoModDialog->raise();
+    m_autoModDialog->activateWindow();
+}
+
+void MainWindow::showBannedUsers()
+{
+    if (!m_bannedUsersDialog) {
+        m_bannedUsersDialog = new BannedUsersDialog(m_banList, this);
+    }
+    m_bannedUsersDialog->setModeratorId(m_twitchAuth->getUserId());
+
+    QMap<QString, QString> channels = m_channelRoomIds;
+    if (!m_twitchAuth->getUsername().isEmpty()) {
+        channels[m_twitchAuth->getUsername()] = m_twitchAuth->getUserId();
+    }
+    if (!m_currentChannel.isEmpty() && !channels.contains(m_currentChannel)) {
+        channels[m_currentChannel] = QString();
+    }
+    m_bannedUsersDialog->setChannels(channels);
+    m_bannedUsersDialog->showChannel(m_currentChannel.isEmpty() ? m_twitchAuth->getUsername() : m_currentChannel);
+    m_bannedUsersDialog->show();
+    m_bannedUsersDialog->raise();
+    m_bannedUsersDialog->activateWindow();
+}
+
+void MainWindow::showModLog()
+{
+    if (!m_modLogDialog) {
+        m_modLogDialog = new ModLogDialog(m_modLog, this);
+    }
+    m_modLogDialog->setChannels(m_channelWidgets.keys());
+    m_modLogDialog->show();
+    m_modLogDialog->raise();
+    m_modLogDialog->activateWindow();
+}
+
+void MainWindow::showUserCard(const QString &username)
+{
+    if (m_currentChannel.isEmpty() || username.isEmpty()) {
+        return;
+    }
+
+    const QString channelName = m_currentChannel;
+    const QString broadcasterId = m_channelRoomIds.value(channelName);
+    ChatWidget *chatWidget = m_channelWidgets.value(channelName);
+    const QStringList messages = chatWidget ? chatWidget->recentLines(username, 20) : QStringList();
+
+    UserCardDialog *dialog = new UserCardDialog(username, channelName, this);
+    connect(dialog, &UserCardDialog::banRequested, this, [this, channelName, broadcasterId](const QString &login) {
+        startModerationBatch(channelName, broadcasterId, QList<BatchTarget>() << BatchTarget{login, QString()},
+                             0, QString());
+    });
+    connect(dialog, &UserCardDialog::timeoutRequested, this,
+            [this, channelName, broadcasterId](const QString &login, int seconds) {
+        startModerationBatch(channelName, broadcasterId, QList<BatchTarget>() << BatchTarget{login, QString()},
+                             seconds, QString());
+    });
+
+    // Shown once the card is ready, i.e. within the loader's latency budget
+    const quint64 cardId = m_userCards->load(channelName, broadcasterId,
+                                             m_twitchAuth->isAuthenticated() ? m_twitchAuth->getUserId() : QString(),
+                                             username, messages);
+    connect(m_userCards, &UserCardLoader::cardReady, dialog, [dialog, cardId](quint64 id, const UserCard &card) {
+        if (id == cardId) {
+            dialog->setCard(card);
+            dialog->show();
+            dialog->raise();
+            dialog->activateWindow();
+        }
+    });
+    connect(m_userCards, &UserCardLoader::cardChanged, dialog, [dialog, cardId](quint64 id, const UserCard &card) {
+        if (id == cardId) {
+            dialog->setCard(card);
+        }
+    });
+    connect(dialog, &QObject::destroyed, m_userCards, [this, cardId]() {
+        m_userCards->cancel(cardId);
+    });
+}
+
 void MainWindow::onCreatePrediction()
 {
     if (!m_twitchAuth->isAuthenticated()) {
@@ -381,28 +1605,49 @@ void MainWindow::onCreatePrediction()
     }
 
     PredictionDialog dialog(this);
+    dialog.setChannels(pollChannels(), QStringList() << m_twitchAuth->getUsername());
     if (dialog.exec() == QDialog::Accepted) {
         auto data = dialog.getPredictionData();
 
-        // TODO: Get current broadcaster ID (for now use authenticated user)
+        const QStringList channels = dialog.selectedChannels();
+        if (!isOwnChannelOnly(channels)) {
+            showFanOut(m_fanOut->createPredictions(broadcasterIds(channels), data.title,
+                                                   data.outcomes, data.durationSeconds));
+            return;
+        }
         QString broadcasterId = m_twitchAuth->getUserId();
 
         statusBar()->showMessage("Creating prediction...", 0);
 
         // Create prediction via API
         m_twitchAPI->createPrediction(broadcasterId, data.title,
-                                     data.outcomes, data.durationSeconds);
+                                     data.outcomes, data.durationSeconds)
+            .then(this, [this](const ApiResult<Prediction> &result) {
+                if (!result.ok()) {
+                    statusBar()->showMessage("Prediction failed", 3000);
+                    QMessageBox::warning(this, "Prediction Failed",
+                                         "Twitch rejected the prediction:\n\n" + result.error);
+                    return;
+                }
 
-        // TODO: Listen for API response and show success/error
-        QMessageBox::information(this, "Prediction Created",
-                                QString("Prediction '%1' created!\n\n"
-                                       "Duration: %2 seconds\n"
-                                       "Outcomes: %3")
-                                .arg(data.title)
-                                .arg(data.durationSeconds)
-                                .arg(data.outcomes.join(", ")));
+                const Prediction &prediction = result.value;
+                onPredictionUpdated(m_twitchAuth->getUsername(), prediction);
+                m_liveEventsPoller->refresh();
 
-        statusBar()->showMessage("Prediction created successfully", 3000);
+                QStringList outcomes;
+                for (const PredictionOutcome &outcome : prediction.outcomes) {
+                    outcomes.append(outcome.title);
+                }
+                QMessageBox::information(this, "Prediction Created",
+                                        QString("Prediction '%1' created!\n\n"
+                                               "Duration: %2 seconds\n"
+                                               "Outcomes: %3")
+                                        .arg(prediction.title)
+                                        .arg(prediction.predictionWindowSeconds)
+                                        .arg(outcomes.join(", ")));
+
+                statusBar()->showMessage("Prediction created successfully", 3000);
+            });
     }
 }
 
@@ -415,29 +1660,89 @@ void MainWindow::onCreatePoll()
     }
 
     PollDialog dialog(this);
+    dialog.setChannels(pollChannels(), QStringList() << m_twitchAuth->getUsername());
     if (dialog.exec() == QDialog::Accepted) {
         auto data = dialog.getPollData();
 
-        // TODO: Get current broadcaster ID (for now use authenticated user)
+        const QStringList channels = dialog.selectedChannels();
+        if (!isOwnChannelOnly(channels)) {
+            showFanOut(m_fanOut->createPolls(broadcasterIds(channels), data.title,
+                                             data.choices, data.durationSeconds));
+            return;
+        }
         QString broadcasterId = m_twitchAuth->getUserId();
 
         statusBar()->showMessage("Creating poll...", 0);
 
         // Create poll via API
         m_twitchAPI->createPoll(broadcasterId, data.title,
-                               data.choices, data.durationSeconds);
+                               data.choices, data.durationSeconds)
+            .then(this, [this](const ApiResult<Poll> &result) {
+                if (!result.ok()) {
+                    statusBar()->showMessage("Poll failed", 3000);
+                    QMessageBox::warning(this, "Poll Failed",
+                                         "Twitch rejected the poll:\n\n" + result.error);
+                    return;
+                }
 
-        // TODO: Listen for API response and show success/error
-        QMessageBox::information(this, "Poll Created",
-                                QString("Poll '%1' created!\n\n"
-                                       "Duration: %2 seconds\n"
-                                       "Choices: %3\n"
-                                       "Channel Points Voting: %4")
-                                .arg(data.title)
-                                .arg(data.durationSeconds)
-                                .arg(data.choices.join(", "))
-                                .arg(data.channelPointsVotingEnabled ? "Yes" : "No"));
+                const Poll &poll = result.value;
+                onPollUpdated(m_twitchAuth->getUsername(), poll);
+                m_liveEventsPoller->refresh();
 
-        statusBar()->showMessage("Poll created successfully", 3000);
+                QStringList choices;
+                for (const PollChoice &choice : poll.choices) {
+                    choices.append(choice.title);
+                }
+                QMessageBox::information(this, "Poll Created",
+                                        QString("Poll '%1' created!\n\n"
+                                               "Duration: %2 seconds\n"
+                                               "Choices: %3\n"
+                                               "Channel Points Voting: %4")
+                                        .arg(poll.title)
+                                        .arg(poll.durationSeconds)
+                                        .arg(choices.join(", "))
+                                        .arg(poll.channelPointsVotingEnabled ? "Yes" : "No"));
+
+                statusBar()->showMessage("Poll created successfully", 3000);
+            });
     }
 }
+
+QStringList MainWindow::pollChannels() const
+{
+    // Own channel first, then every open tab
+    QStringList channels;
+    channels.append(m_twitchAuth->getUsername());
+    for (const QString &channelName : m_channelWidgets.keys()) {
+        if (!channels.contains(channelName)) {
+            channels.append(channelName);
+        }
+    }
+    return channels;
+}
+
+bool MainWindow::isOwnChannelOnly(const QStringList &channels) const
+{
+    return channels.isEmpty() || (channels.size() == 1 && channels.first() == m_twitchAuth->getUsername());
+}
+
+QMap<QString, QString> MainWindow::broadcasterIds(const QStringList &channels) const
+{
+    // Unknown ids stay empty and are looked up by the fan-out
+    QMap<QString, QString> ids;
+    for (const QString &channelName : channels) {
+        ids[channelName] = channelName == m_twitchAuth->getUsername() ? m_twitchAuth->getUserId()
+                                                                       : m_channelRoomIds.value(channelName);
+    }
+    return ids;
+}
+
+void MainWindow::showFanOut(quint64 groupId)
+{
+    // Closing the view forgets the group; it stops being refreshed
+    FanOutDialog *view = new FanOutDialog(m_fanOut, groupId, this);
+    connect(view, &QObject::destroyed, this, [this, groupId]() {
+        m_fanOut->remove(groupId);
+    });
+    view->show();
+}
@@ -9,13 +9,45 @@
 #include <QAction>
 #include <QStatusBar>
 #include <QMap>
+#include <QTimer>
+#include "moderation/modactionlog.h"
 
 class ChannelList;
 class ChatWidget;
 class UserList;
+class ActivityPanel;
+class LiveEventsPanel;
+class NetworkStack;
 class TwitchAuth;
 class TwitchAPI;
 class TwitchWebSocket;
+class MessagePipeline;
+class BatchModeration;
+class MessagePurge;
+class ModerationOutbox;
+class UserLookupService;
+class ProfileCache;
+class ChattersSync;
+class EventSubClient;
+class LiveEventsPoller;
+class LiveEventsFanOut;
+class AutoModQueue;
+class AutoModDialog;
+class BanList;
+class BannedUsersDialog;
+class ModLogDialog;
+class UserCardLoader;
+class QProgressDialog;
+class QLabel;
+struct FloodCluster;
+struct SurgeAlert;
+struct ProcessedMessage;
+struct BatchTarget;
+struct BatchSummary;
+struct ChatLineAction;
+struct ChatCommand;
+struct Poll;
+struct Prediction;
 
 class MainWindow : public QMainWindow
 {
@@ -41,11 +73,44 @@ private slots:
     void onCreatePrediction();
     void onCreatePoll();
 
+    void showAutoModQueue();
+    void showBannedUsers();
+    void showModLog();
+    void showUserCard(const QString &username);
+
 private:
     void createMenuBar();
     void createLayout();
     void setupConnections();
 
+    // Moderation helpers
+    void renderMessages(const QList<ProcessedMessage> &batch);
+    void moderateFloodCluster(const FloodCluster &cluster, int timeoutSeconds);
+    void moderateUsers(const QStringList &usernames, int timeoutSeconds);
+    void startModerationBatch(const QString &channelName, const QString &broadcasterId,
+                              const QList<BatchTarget> &targets, int timeoutSeconds,
+                              const QString &reason);
+    void onBatchFinished(const BatchSummary &summary);
+    void deleteRecentMessages(const QString &username);
+    void moderateLine(const QString &channelName, const ChatLineAction &action);
+    void runCommand(const QString &channelName, const ChatCommand &command);
+    void promptSurgeResponse(const QString &channelName, const QList<SurgeAlert> &alerts);
+    void refreshActivityPanel();
+    void updatePipelineStatus();
+    void updateApiStatus();
+    void startChannelServices(const QString &channelName);
+    void attachChannelServices(const QString &channelName, const QString &broadcasterId);
+    void addChannelNotice(const QString &channelName, const QString &text);
+    void onPollUpdated(const QString &channelName, const Poll &poll);
+    void onPredictionUpdated(const QString &channelName, const Prediction &prediction);
+    void endPoll(const QString &channelName, const QString &pollId, const QString &status);
+    void endPrediction(const QString &channelName, const QString &predictionId,
+                       const QString &status, const QString &winningOutcomeId);
+    QStringList pollChannels() const;
+    bool isOwnChannelOnly(const QStringList &channels) const;
+    QMap<QString, QString> broadcasterIds(const QStringList &channels) const;
+    void showFanOut(quint64 groupId);
+
     // UI Components (mIRC-style layout)
     QSplitter *m_mainSplitter;
     QSplitter *m_rightSplitter;
@@ -53,17 +118,65 @@ private:
     ChannelList *m_channelList;
     QTabWidget *m_chatTabs;
     UserList *m_userList;
+    ActivityPanel *m_activityPanel;
+    LiveEventsPanel *m_liveEvents;
+
+    // Periodic refresh of the "Most Active" panel and pipeline stats
+    QTimer *m_activityTimer;
+    QLabel *m_pipelineLabel;
+    QLabel *m_apiLabel;
 
     // Channel to ChatWidget mapping
     QMap<QString, ChatWidget*> m_channelWidgets;
 
+    // Parse/enrich/moderate/format off the GUI thread, per-channel ordered
+    MessagePipeline *m_pipeline;
+
+    // Broadcaster id per channel, learned from the room-id tag
+    QMap<QString, QString> m_channelRoomIds;
+
     // Current active channel for user list
     QString m_currentChannel;
 
-    // Twitch components
+    // Last announced status per poll/prediction id, progress isn't announced
+    QMap<QString, QString> m_liveEventStatus;
+
+    // Twitch components, one connection pool for all HTTP traffic
+    NetworkStack *m_network;
     TwitchAuth *m_twitchAuth;
     TwitchAPI *m_twitchAPI;
     TwitchWebSocket *m_webSocket;
+    ProfileCache *m_profileCache;
+    UserLookupService *m_userLookup;
+    ModerationOutbox *m_outbox;
+    BatchModeration *m_batchModeration;
+    MessagePurge *m_messagePurge;
+    ChattersSync *m_chattersSync;
+    EventSubClient *m_eventSub;
+    LiveEventsPoller *m_liveEventsPoller; // when EventSub doesn't cover polls/predictions
+    LiveEventsFanOut *m_fanOut;           // one poll/prediction in many channels
+    AutoModQueue *m_autoModQueue;
+    AutoModDialog *m_autoModDialog;       // created on first use
+    BanList *m_banList;
+    BannedUsersDialog *m_bannedUsersDialog; // created on first use
+    ModActionLog *m_modLog;
+    ModLogDialog *m_modLogDialog;           // created on first use
+    UserCardLoader *m_userCards;
+
+    // Progress of running mass bans/timeouts by batch id
+    QMap<quint64, QProgressDialog*> m_batchProgress;
+    // Channel, kind and reason of running batches, logged per account done
+    QMap<quint64, ModAction> m_batchActions;
+
+    // Keypress/click to Helix response for chat line actions
+    struct LineActionStats {
+        quint64 count = 0;       // responses
+        qint64 dispatchTotalUs = 0;
+        qint64 dispatchMaxUs = 0;
+        qint64 totalMs = 0;
+        qint64 maxMs = 0;
+    };
+    LineActionStats m_lineActionStats;
 
     // Menu actions
     QAction *m_connectAction;
@@ -71,6 +184,7 @@ private:
     QAction *m_settingsAction;
     QAction *m_exitAction;
     QAction *m_aboutAction;
+    QAction *m_autoModAction;
 };
 
 #endif // MAINWINDOW_H
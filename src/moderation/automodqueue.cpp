@@ -0,0 +1,293 @@
+#include "automodqueue.h"
+#include "twitch/twitchapi.h"
+#include <QColor>
+#include <QDebug>
+
+AutoModQueue::AutoModQueue(TwitchAPI *api, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_api(api)
+    , m_inFlight(0)
+{
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(FLUSH_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &AutoModQueue::flushIncoming);
+}
+
+void AutoModQueue::setModeratorId(const QString &moderatorId)
+{
+    m_moderatorId = moderatorId;
+}
+
+void AutoModQueue::setChannel(const QString &channel)
+{
+    if (channel == m_channel) {
+        return;
+    }
+    beginResetModel();
+    m_channel = channel;
+    endResetModel();
+}
+
+QString AutoModQueue::channel() const
+{
+    return m_channel;
+}
+
+QStringList AutoModQueue::channels() const
+{
+    QStringList channels = m_queues.keys();
+    channels.sort();
+    return channels;
+}
+
+int AutoModQueue::pendingCount(const QString &channel) const
+{
+    return int(m_queues.value(channel).size());
+}
+
+int AutoModQueue::pendingCount() const
+{
+    int count = 0;
+    for (const QList<HeldMessage> &queue : m_queues) {
+        count += int(queue.size());
+    }
+    return count;
+}
+
+void AutoModQueue::add(const AutoModHoldEvent &event)
+{
+    if (event.messageId.isEmpty() || m_known.contains(event.messageId)) {
+        return;
+    }
+    m_known.insert(event.messageId);
+    m_incoming.append(event);
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void AutoModQueue::flushIncoming()
+{
+    if (m_incoming.isEmpty()) {
+        return;
+    }
+
+    // One insert per channel and burst
+    QHash<QString, QList<HeldMessage>> batches;
+    for (const AutoModHoldEvent &event : std::as_const(m_incoming)) {
+        HeldMessage message;
+        message.event = event;
+        batches[event.channel].append(message);
+    }
+    m_incoming.clear();
+
+    for (auto it = batches.constBegin(); it != batches.constEnd(); ++it) {
+        QList<HeldMessage> &queue = m_queues[it.key()];
+        const bool visible = it.key() == m_channel;
+        if (visible) {
+            beginInsertRows(QModelIndex(), int(queue.size()), int(queue.size() + it->size()) - 1);
+        }
+        queue.append(it.value());
+        if (visible) {
+            endInsertRows();
+        }
+    }
+    emit countsChanged();
+}
+
+void AutoModQueue::resolved(const AutoModUpdateEvent &event)
+{
+    for (int i = 0; i < m_incoming.size(); ++i) {
+        if (m_incoming.at(i).messageId == event.messageId) {
+            m_incoming.removeAt(i);
+            m_known.remove(event.messageId);
+            return;
+        }
+    }
+    removeMessage(event.channel, event.messageId);
+}
+
+void AutoModQueue::removeChannel(const QString &channel)
+{
+    const bool visible = channel == m_channel;
+    if (visible) {
+        beginResetModel();
+    }
+    for (const HeldMessage &message : m_queues.value(channel)) {
+        m_known.remove(message.event.messageId);
+    }
+    m_queues.remove(channel);
+    for (int i = int(m_incoming.size()) - 1; i >= 0; --i) {
+        if (m_incoming.at(i).channel == channel) {
+            m_known.remove(m_incoming.at(i).messageId);
+            m_incoming.removeAt(i);
+        }
+    }
+    if (visible) {
+        endResetModel();
+    }
+    emit countsChanged();
+}
+
+void AutoModQueue::approve(const QList<int> &rows)
+{
+    resolve(rows, true);
+}
+
+void AutoModQueue::deny(const QList<int> &rows)
+{
+    resolve(rows, false);
+}
+
+void AutoModQueue::resolve(const QList<int> &rows, bool allow)
+{
+    auto it = m_queues.find(m_channel);
+    if (it == m_queues.end() || m_moderatorId.isEmpty()) {
+        return;
+    }
+
+    int first = -1;
+    int last = -1;
+    for (int row : rows) {
+        if (row < 0 || row >= it->size()) {
+            continue;
+        }
+        HeldMessage &message = (*it)[row];
+        if (message.state == HeldMessage::Sending) {
+            continue;
+        }
+        message.state = HeldMessage::Sending;
+        message.allow = allow;
+        message.error.clear();
+        m_calls.push_back(Call{m_channel, message.event.messageId, allow});
+        first = first < 0 ? row : qMin(first, row);
+        last = qMax(last, row);
+    }
+    if (first >= 0) {
+        emit dataChanged(index(first), index(last));
+    }
+    pump();
+}
+
+void AutoModQueue::pump()
+{
+    const int limit = m_api->concurrencyWindow(MAX_WINDOW);
+    while (m_inFlight < limit && !m_calls.empty()) {
+        const Call call = m_calls.front();
+        m_calls.pop_front();
+        ++m_inFlight;
+        m_api->manageHeldAutoModMessage(m_moderatorId, call.messageId, call.allow)
+            .then(this, [this, call](const ApiReply &reply) {
+                onReply(call, reply);
+            });
+    }
+}
+
+void AutoModQueue::onReply(const Call &call, const ApiReply &reply)
+{
+    --m_inFlight;
+
+    // 400/404: already resolved or expired, nothing left to review
+    if (reply.ok() || reply.statusCode == 400 || reply.statusCode == 404) {
+        removeMessage(call.channel, call.messageId);
+    } else {
+        qWarning() << "AutoMod" << (call.allow ? "approve" : "deny") << "failed:"
+                   << reply.statusCode << reply.error;
+        const int row = rowOf(call.channel, call.messageId);
+        if (row >= 0) {
+            HeldMessage &message = m_queues[call.channel][row];
+            message.state = HeldMessage::Failed;
+            message.error = reply.error;
+            if (call.channel == m_channel) {
+                emit dataChanged(index(row), index(row));
+            }
+        }
+    }
+    pump();
+}
+
+void AutoModQueue::removeMessage(const QString &channel, const QString &messageId)
+{
+    const int row = rowOf(channel, messageId);
+    if (row < 0) {
+        return;
+    }
+    const bool visible = channel == m_channel;
+    if (visible) {
+        beginRemoveRows(QModelIndex(), row, row);
+    }
+    m_queues[channel].removeAt(row);
+    m_known.remove(messageId);
+    if (visible) {
+        endRemoveRows();
+    }
+    emit countsChanged();
+}
+
+int AutoModQueue::rowOf(const QString &channel, const QString &messageId) const
+{
+    auto it = m_queues.constFind(channel);
+    if (it == m_queues.constEnd()) {
+        return -1;
+    }
+    for (int i = 0; i < it->size(); ++i) {
+        if (it->at(i).event.messageId == messageId) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int AutoModQueue::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return int(m_queues.value(m_channel).size());
+}
+
+QVariant AutoModQueue::data(const QModelIndex &index, int role) const
+{
+    auto it = m_queues.constFind(m_channel);
+    if (!index.isValid() || it == m_queues.constEnd() || index.row() >= it->size()) {
+        return QVariant();
+    }
+
+    const HeldMessage &message = it->at(index.row());
+    switch (role) {
+    case Qt::DisplayRole: {
+        QString prefix;
+        if (message.state == HeldMessage::Sending) {
+            prefix = message.allow ? "[approving] " : "[denying] ";
+        } else if (message.state == HeldMessage::Failed) {
+            prefix = "[failed] ";
+        }
+        return QString("%1%2  [%3]  %4").arg(prefix, message.event.userLogin,
+                                             message.event.category, message.event.text);
+    }
+    case Qt::ToolTipRole: {
+        QString tip = QString("%1, level %2, held at %3")
+                          .arg(message.event.category).arg(message.event.level)
+                          .arg(message.event.heldAt.toLocalTime().toString("HH:mm:ss"));
+        if (!message.error.isEmpty()) {
+            tip += "\n" + message.error;
+        }
+        return tip;
+    }
+    case Qt::ForegroundRole:
+        if (message.state == HeldMessage::Sending) {
+            return QColor(Qt::gray);
+        }
+        if (message.state == HeldMessage::Failed) {
+            return QColor("#e91916");
+        }
+        return QVariant();
+    case MessageIdRole:
+        return message.event.messageId;
+    case StateRole:
+        return int(message.state);
+    default:
+        return QVariant();
+    }
+}
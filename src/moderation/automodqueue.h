@@ -0,0 +1,105 @@
+#ifndef AUTOMODQUEUE_H
+#define AUTOMODQUEUE_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QTimer>
+#include <deque>
+#include "twitch/eventsubclient.h"
+
+class TwitchAPI;
+
+// A message AutoMod is holding for review
+struct HeldMessage {
+    enum State {
+        Pending,
+        Sending, // approve/deny queued or in flight
+        Failed
+    };
+
+    AutoModHoldEvent event;
+    State state = Pending;
+    bool allow = false; // what was asked for, while Sending
+    QString error;
+};
+
+// Per-channel queues of AutoMod-held messages, one channel at a time
+// exposed as a list model.
+//
+// Holds pushed during a raid arrive in bursts of hundreds; they are
+// buffered and inserted as one row range every FLUSH_MS, so the view lays
+// out once per burst instead of once per message. Approvals and denials
+// for a selection are pipelined: sent concurrently in a window sized from
+// the scheduler's rate-limit bucket, at moderation priority. A message
+// leaves the queue when its call succeeds or AutoMod reports it resolved
+// (by anyone, or expired).
+class AutoModQueue : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    enum Roles {
+        MessageIdRole = Qt::UserRole,
+        StateRole
+    };
+
+    explicit AutoModQueue(TwitchAPI *api, QObject *parent = nullptr);
+
+    void setModeratorId(const QString &moderatorId);
+
+    // Channel whose queue the model exposes
+    void setChannel(const QString &channel);
+    QString channel() const;
+    QStringList channels() const;
+    int pendingCount(const QString &channel) const;
+    int pendingCount() const; // all channels
+
+    void add(const AutoModHoldEvent &event);
+    void resolved(const AutoModUpdateEvent &event);
+    void removeChannel(const QString &channel);
+
+    // Rows of the current channel
+    void approve(const QList<int> &rows);
+    void deny(const QList<int> &rows);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    static constexpr int FLUSH_MS = 100;
+    static constexpr int MAX_WINDOW = 12;
+
+signals:
+    void countsChanged();
+
+private:
+    struct Call {
+        QString channel;
+        QString messageId;
+        bool allow = false;
+    };
+
+    void resolve(const QList<int> &rows, bool allow);
+    void flushIncoming();
+    void pump();
+    void onReply(const Call &call, const ApiReply &reply);
+    void removeMessage(const QString &channel, const QString &messageId);
+    int rowOf(const QString &channel, const QString &messageId) const;
+
+    TwitchAPI *m_api;
+    QString m_moderatorId;
+    QString m_channel;
+
+    QHash<QString, QList<HeldMessage>> m_queues; // channel -> oldest first
+    QList<AutoModHoldEvent> m_incoming;          // not inserted yet
+    QSet<QString> m_known;                       // message ids queued or incoming
+    QTimer *m_flushTimer;
+
+    std::deque<Call> m_calls;
+    int m_inFlight;
+};
+
+#endif // AUTOMODQUEUE_H
@@ -0,0 +1,439 @@
+#include "banlist.h"
+#include "twitch/twitchapi.h"
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QPromise>
+#include <QDebug>
+#include <algorithm>
+#include <memory>
+
+namespace {
+constexpr quint32 STORE_MAGIC = 0x54424c31; // "TBL1"
+constexpr quint32 STORE_VERSION = 1;
+}
+
+BanList::BanList(TwitchAPI *api, const QString &directory, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_directory(directory)
+    , m_nextGeneration(1)
+{
+    m_saveTimer = new QTimer(this);
+    m_saveTimer->setSingleShot(true);
+    m_saveTimer->setInterval(SAVE_DELAY_MS);
+    connect(m_saveTimer, &QTimer::timeout, this, &BanList::saveDirty);
+}
+
+BanList::~BanList()
+{
+    saveDirty();
+}
+
+void BanList::open(const QString &channel)
+{
+    channelFor(channel);
+}
+
+BanList::Channel &BanList::channelFor(const QString &channel)
+{
+    auto it = m_channels.find(channel);
+    if (it != m_channels.end()) {
+        return it.value();
+    }
+
+    Channel &entry = m_channels[channel];
+    QElapsedTimer timer;
+    timer.start();
+    if (load(channel, entry)) {
+        qDebug() << "Ban list for #" + channel + ":" << entry.bans.size() << "bans loaded in"
+                 << timer.elapsed() << "ms";
+    }
+    return entry;
+}
+
+void BanList::sync(const QString &channel, const QString &broadcasterId)
+{
+    Channel &entry = channelFor(channel);
+    entry.broadcasterId = broadcasterId;
+    entry.generation = m_nextGeneration++;
+    entry.syncing = true;
+    entry.pages = 0;
+    entry.seen.clear();
+    entry.removed.clear();
+    entry.timer.start();
+    fetchPage(channel, entry.generation, QString());
+}
+
+bool BanList::isSyncing(const QString &channel) const
+{
+    return m_channels.value(channel).syncing;
+}
+
+bool BanList::hasSynced(const QString &channel) const
+{
+    return m_channels.value(channel).syncedAt.isValid();
+}
+
+QDateTime BanList::syncedAt(const QString &channel) const
+{
+    return m_channels.value(channel).syncedAt;
+}
+
+QString BanList::broadcasterId(const QString &channel) const
+{
+    return m_channels.value(channel).broadcasterId;
+}
+
+int BanList::count(const QString &channel) const
+{
+    return int(m_channels.value(channel).bans.size());
+}
+
+void BanList::fetchPage(const QString &channel, quint64 generation, const QString &cursor)
+{
+    m_api->getBannedUsers(m_channels[channel].broadcasterId, cursor)
+        .then(this, [this, channel, generation](const ApiResult<BannedUserPage> &result) {
+            onPage(channel, generation, result);
+        });
+}
+
+void BanList::onPage(const QString &channel, quint64 generation, const ApiResult<BannedUserPage> &result)
+{
+    auto it = m_channels.find(channel);
+    if (it == m_channels.end() || it->generation != generation || !it->syncing) {
+        return;
+    }
+    Channel &entry = it.value();
+
+    if (!result.ok()) {
+        // Keep what we have; the next sync starts over
+        entry.syncing = false;
+        qWarning() << "Ban list sync for #" + channel + " failed:" << result.statusCode << result.error;
+        emit syncFailed(channel, result.error);
+        return;
+    }
+
+    ++entry.pages;
+    entry.indexStale = true; // a page at a time, rebuilt on the next query
+    for (const BannedUser &ban : result.value.users) {
+        if (ban.userId.isEmpty() || entry.removed.contains(ban.userId)) {
+            continue;
+        }
+        entry.seen.insert(ban.userId);
+        entry.bans.insert(ban.userId, ban);
+    }
+
+    if (!result.value.cursor.isEmpty()) {
+        fetchPage(channel, generation, result.value.cursor);
+        emit syncProgress(channel, int(entry.seen.size()), entry.pages);
+        emit changed(channel);
+        return;
+    }
+
+    // Complete walk: whatever wasn't listed has been lifted meanwhile
+    for (auto ban = entry.bans.begin(); ban != entry.bans.end();) {
+        if (!entry.seen.contains(ban.key())) {
+            ban = entry.bans.erase(ban);
+        } else {
+            ++ban;
+        }
+    }
+    entry.syncing = false;
+    entry.syncedAt = QDateTime::currentDateTimeUtc();
+    entry.seen.clear();
+    entry.removed.clear();
+    const qint64 elapsedMs = entry.timer.elapsed();
+
+    save(channel, entry);
+    m_dirty.remove(channel);
+    emit syncFinished(channel, int(entry.bans.size()), elapsedMs);
+    emit changed(channel);
+}
+
+void BanList::addBan(const QString &channel, const QString &broadcasterId, const BannedUser &ban)
+{
+    if (ban.userId.isEmpty()) {
+        return;
+    }
+    Channel &entry = channelFor(channel);
+    if (entry.broadcasterId.isEmpty()) {
+        entry.broadcasterId = broadcasterId;
+    }
+    if (entry.syncing) {
+        entry.seen.insert(ban.userId);
+        entry.removed.remove(ban.userId);
+    }
+    erase(entry, ban.userId); // a timeout turned into a ban replaces it
+    insert(entry, ban);
+    scheduleSave(channel);
+    emit changed(channel);
+}
+
+void BanList::removeBan(const QString &channel, const QString &userId)
+{
+    Channel &entry = channelFor(channel);
+    if (entry.syncing) {
+        entry.seen.remove(userId);
+        entry.removed.insert(userId);
+    }
+    if (!entry.bans.contains(userId)) {
+        return;
+    }
+    erase(entry, userId);
+    scheduleSave(channel);
+    emit changed(channel);
+}
+
+QFuture<ApiReply> BanList::unban(const QString &channel, const QString &moderatorId, const QString &userId)
+{
+    Channel &entry = channelFor(channel);
+    const BannedUser ban = entry.bans.value(userId);
+    const QString broadcasterId = entry.broadcasterId;
+    removeBan(channel, userId);
+
+    auto promise = std::make_shared<QPromise<ApiReply>>();
+    promise->start();
+    m_api->unbanUser(broadcasterId, moderatorId, userId)
+        .then(this, [this, channel, ban, promise](const ApiReply &reply) {
+            // 400: not banned any more, which is what the index says now
+            if (!reply.ok() && reply.statusCode != 400 && !ban.userId.isEmpty()) {
+                addBan(channel, QString(), ban);
+            }
+            promise->addResult(reply);
+            promise->finish();
+        });
+    return promise->future();
+}
+
+void BanList::insert(Channel &entry, const BannedUser &ban)
+{
+    entry.bans.insert(ban.userId, ban);
+    if (entry.indexStale) {
+        return;
+    }
+
+    LoginKey loginKey{ban.login.toLower(), ban.userId};
+    auto loginAt = std::lower_bound(entry.byLogin.begin(), entry.byLogin.end(), loginKey,
+                                    [](const LoginKey &a, const LoginKey &b) {
+        return a.login < b.login;
+    });
+    entry.byLogin.insert(loginAt, loginKey);
+
+    TimeKey timeKey{ban.createdAt.toMSecsSinceEpoch(), ban.userId};
+    auto timeAt = std::lower_bound(entry.byTime.begin(), entry.byTime.end(), timeKey,
+                                   [](const TimeKey &a, const TimeKey &b) {
+        return a.createdMs < b.createdMs;
+    });
+    entry.byTime.insert(timeAt, timeKey);
+}
+
+void BanList::erase(Channel &entry, const QString &userId)
+{
+    auto it = entry.bans.find(userId);
+    if (it == entry.bans.end()) {
+        return;
+    }
+    const QString login = it->login.toLower();
+    const qint64 createdMs = it->createdAt.toMSecsSinceEpoch();
+    entry.bans.erase(it);
+    if (entry.indexStale) {
+        return;
+    }
+
+    // Equal keys are adjacent; find ours among them
+    auto loginAt = std::lower_bound(entry.byLogin.begin(), entry.byLogin.end(), login,
+                                    [](const LoginKey &a, const QString &b) {
+        return a.login < b;
+    });
+    while (loginAt != entry.byLogin.end() && loginAt->login == login) {
+        if (loginAt->userId == userId) {
+            entry.byLogin.erase(loginAt);
+            break;
+        }
+        ++loginAt;
+    }
+
+    auto timeAt = std::lower_bound(entry.byTime.begin(), entry.byTime.end(), createdMs,
+                                   [](const TimeKey &a, qint64 b) {
+        return a.createdMs < b;
+    });
+    while (timeAt != entry.byTime.end() && timeAt->createdMs == createdMs) {
+        if (timeAt->userId == userId) {
+            entry.byTime.erase(timeAt);
+            break;
+        }
+        ++timeAt;
+    }
+}
+
+void BanList::rebuildIndex(const Channel &entry) const
+{
+    entry.byLogin.clear();
+    entry.byTime.clear();
+    entry.byLogin.reserve(entry.bans.size());
+    entry.byTime.reserve(entry.bans.size());
+    for (const BannedUser &ban : entry.bans) {
+        entry.byLogin.push_back(LoginKey{ban.login.toLower(), ban.userId});
+        entry.byTime.push_back(TimeKey{ban.createdAt.toMSecsSinceEpoch(), ban.userId});
+    }
+    std::sort(entry.byLogin.begin(), entry.byLogin.end(), [](const LoginKey &a, const LoginKey &b) {
+        return a.login < b.login;
+    });
+    std::sort(entry.byTime.begin(), entry.byTime.end(), [](const TimeKey &a, const TimeKey &b) {
+        return a.createdMs < b.createdMs;
+    });
+    entry.indexStale = false;
+}
+
+QList<BannedUser> BanList::search(const QString &channel, const QString &prefix, SortOrder order,
+                                  int limit) const
+{
+    QList<BannedUser> result;
+    auto it = m_channels.constFind(channel);
+    if (it == m_channels.constEnd()) {
+        return result;
+    }
+    const Channel &entry = it.value();
+    if (entry.indexStale) {
+        rebuildIndex(entry);
+    }
+
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    const QString needle = prefix.trimmed().toLower();
+    auto full = [&]() { return limit >= 0 && result.size() >= limit; };
+
+    if (needle.isEmpty() && order != ByLogin) {
+        // Straight off the time index
+        if (order == NewestFirst) {
+            for (auto key = entry.byTime.crbegin(); key != entry.byTime.crend() && !full(); ++key) {
+                const BannedUser ban = entry.bans.value(key->userId);
+                if (!ban.isExpired(now)) {
+                    result.append(ban);
+                }
+            }
+        } else {
+            for (auto key = entry.byTime.cbegin(); key != entry.byTime.cend() && !full(); ++key) {
+                const BannedUser ban = entry.bans.value(key->userId);
+                if (!ban.isExpired(now)) {
+                    result.append(ban);
+                }
+            }
+        }
+        return result;
+    }
+
+    // Login range [needle, first login not starting with it)
+    auto key = std::lower_bound(entry.byLogin.cbegin(), entry.byLogin.cend(), needle,
+                                [](const LoginKey &a, const QString &b) {
+        return a.login < b;
+    });
+    const bool sortByTime = order != ByLogin;
+    for (; key != entry.byLogin.cend() && key->login.startsWith(needle); ++key) {
+        if (!sortByTime && full()) {
+            break;
+        }
+        const BannedUser ban = entry.bans.value(key->userId);
+        if (!ban.isExpired(now)) {
+            result.append(ban);
+        }
+    }
+
+    if (sortByTime) {
+        std::sort(result.begin(), result.end(), [order](const BannedUser &a, const BannedUser &b) {
+            return order == NewestFirst ? a.createdAt > b.createdAt : a.createdAt < b.createdAt;
+        });
+        if (limit >= 0 && result.size() > limit) {
+            result.resize(limit);
+        }
+    }
+    return result;
+}
+
+void BanList::scheduleSave(const QString &channel)
+{
+    m_dirty.insert(channel);
+    m_saveTimer->start();
+}
+
+void BanList::saveDirty()
+{
+    for (const QString &channel : std::as_const(m_dirty)) {
+        auto it = m_channels.constFind(channel);
+        if (it != m_channels.constEnd()) {
+            save(channel, it.value());
+        }
+    }
+    m_dirty.clear();
+}
+
+QString BanList::pathFor(const QString &channel) const
+{
+    return m_directory + "/" + channel.toLower() + ".bans";
+}
+
+bool BanList::load(const QString &channel, Channel &entry) const
+{
+    QFile file(pathFor(channel));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_5);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != STORE_MAGIC || version != STORE_VERSION) {
+        qWarning() << "Ban list: ignoring unreadable" << file.fileName();
+        return false;
+    }
+    in >> entry.broadcasterId >> entry.syncedAt >> count;
+
+    entry.bans.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        BannedUser ban;
+        in >> ban.userId >> ban.login >> ban.displayName >> ban.createdAt >> ban.expiresAt
+           >> ban.reason >> ban.moderatorId >> ban.moderatorLogin;
+        entry.bans.insert(ban.userId, ban);
+    }
+    entry.indexStale = true;
+    return in.status() == QDataStream::Ok;
+}
+
+bool BanList::save(const QString &channel, const Channel &entry) const
+{
+    QDir().mkpath(m_directory);
+    QSaveFile out(pathFor(channel));
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning() << "Ban list: cannot write" << out.fileName() << out.errorString();
+        return false;
+    }
+
+    QDataStream stream(&out);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream << STORE_MAGIC << STORE_VERSION;
+
+    // Lapsed timeouts aren't worth keeping
+    const QDateTime now = QDateTime::currentDateTimeUtc();
+    QList<BannedUser> active;
+    active.reserve(entry.bans.size());
+    for (const BannedUser &ban : entry.bans) {
+        if (!ban.isExpired(now)) {
+            active.append(ban);
+        }
+    }
+    stream << entry.broadcasterId << entry.syncedAt << quint32(active.size());
+    for (const BannedUser &ban : std::as_const(active)) {
+        stream << ban.userId << ban.login << ban.displayName << ban.createdAt << ban.expiresAt
+               << ban.reason << ban.moderatorId << ban.moderatorLogin;
+    }
+
+    if (!out.commit()) {
+        qWarning() << "Ban list: saving" << out.fileName() << "failed:" << out.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,126 @@
+#ifndef BANLIST_H
+#define BANLIST_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QTimer>
+#include <vector>
+#include "twitch/helixtypes.h"
+
+class TwitchAPI;
+
+// Local copy of each channel's ban list, indexed for the ban browser.
+//
+// A full sync walks GET /moderation/banned page by page (100 per page);
+// every page lands in the store as it arrives, and bans missing from a
+// complete walk are dropped at the end. After that the list is kept
+// current from EventSub ban/unban events and our own unbans, which apply
+// immediately, instead of walking tens of thousands of entries again.
+//
+// Two sorted indexes are kept next to the entries: lowercase login (prefix
+// search is a binary search plus a walk over the matches) and ban time.
+// Single changes are inserted in place; bulk loads mark the indexes stale
+// and they are rebuilt once on the next query.
+//
+// Each channel is saved to its own file in the given directory, after a
+// sync and SAVE_DELAY_MS after the last incremental change, so the
+// browser opens from disk on later launches before any request is made.
+class BanList : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum SortOrder {
+        NewestFirst,
+        OldestFirst,
+        ByLogin
+    };
+
+    BanList(TwitchAPI *api, const QString &directory, QObject *parent = nullptr);
+    ~BanList();
+
+    // Loads the channel's saved list if it isn't in memory yet
+    void open(const QString &channel);
+    void sync(const QString &channel, const QString &broadcasterId);
+    bool isSyncing(const QString &channel) const;
+    bool hasSynced(const QString &channel) const;
+    QDateTime syncedAt(const QString &channel) const;
+    QString broadcasterId(const QString &channel) const;
+    int count(const QString &channel) const;
+
+    // Active bans and timeouts whose login starts with prefix (any case);
+    // limit < 0 returns all
+    QList<BannedUser> search(const QString &channel, const QString &prefix, SortOrder order,
+                             int limit = -1) const;
+
+    // From EventSub
+    void addBan(const QString &channel, const QString &broadcasterId, const BannedUser &ban);
+    void removeBan(const QString &channel, const QString &userId);
+
+    // Removed from the index right away, put back if Twitch refuses
+    QFuture<ApiReply> unban(const QString &channel, const QString &moderatorId, const QString &userId);
+
+    static constexpr int SAVE_DELAY_MS = 5000;
+
+signals:
+    void changed(const QString &channel);
+    void syncProgress(const QString &channel, int fetched, int pages);
+    void syncFinished(const QString &channel, int count, qint64 elapsedMs);
+    void syncFailed(const QString &channel, const QString &error);
+
+private:
+    struct LoginKey {
+        QString login; // lowercase
+        QString userId;
+    };
+    struct TimeKey {
+        qint64 createdMs = 0;
+        QString userId;
+    };
+
+    struct Channel {
+        QString broadcasterId;
+        QHash<QString, BannedUser> bans; // user id -> ban
+        QDateTime syncedAt;
+
+        mutable std::vector<LoginKey> byLogin;
+        mutable std::vector<TimeKey> byTime;
+        mutable bool indexStale = true;
+
+        // Running sync
+        quint64 generation = 0;
+        bool syncing = false;
+        int pages = 0;
+        QSet<QString> seen;    // user ids listed or banned during this walk
+        QSet<QString> removed; // unbanned during this walk, stale in later pages
+        QElapsedTimer timer;
+    };
+
+    Channel &channelFor(const QString &channel);
+    void fetchPage(const QString &channel, quint64 generation, const QString &cursor);
+    void onPage(const QString &channel, quint64 generation, const ApiResult<BannedUserPage> &result);
+    void insert(Channel &entry, const BannedUser &ban);
+    void erase(Channel &entry, const QString &userId);
+    void rebuildIndex(const Channel &entry) const;
+    void scheduleSave(const QString &channel);
+    void saveDirty();
+
+    bool load(const QString &channel, Channel &entry) const;
+    bool save(const QString &channel, const Channel &entry) const;
+    QString pathFor(const QString &channel) const;
+
+    TwitchAPI *m_api;
+    QString m_directory;
+    QHash<QString, Channel> m_channels;
+    QSet<QString> m_dirty;
+    QTimer *m_saveTimer;
+    quint64 m_nextGeneration;
+};
+
+#endif // BANLIST_H
@@ -0,0 +1,342 @@
+#include "batchmoderation.h"
+#include "moderationoutbox.h"
+#include "twitch/twitchapi.h"
+#include "twitch/userlookupservice.h"
+#include "twitch/profilecache.h"
+#include <QMetaObject>
+
+namespace {
+// Failure lines kept in a summary, the rest is only counted
+constexpr int MAX_SUMMARY_FAILURES = 20;
+}
+
+QString BatchSummary::toString() const
+{
+    QString action = ban ? "Banned" : QString("Timed out (%1s)").arg(durationSeconds);
+    QString text = QString("%1 %2 of %3 accounts in #%4 in %5 s")
+                       .arg(action)
+                       .arg(succeeded)
+                       .arg(total)
+                       .arg(channel)
+                       .arg(elapsedMs / 1000.0, 0, 'f', 1);
+
+    QStringList details;
+    if (alreadyBanned > 0) {
+        details.append(QString("%1 already banned").arg(alreadyBanned));
+    }
+    if (unresolved > 0) {
+        details.append(QString("%1 unknown").arg(unresolved));
+    }
+    if (failed > 0) {
+        details.append(QString("%1 failed").arg(failed));
+    }
+    if (cancelled > 0) {
+        details.append(QString("%1 cancelled").arg(cancelled));
+    }
+    if (!details.isEmpty()) {
+        text += " (" + details.join(", ") + ")";
+    }
+    return text;
+}
+
+BatchModeration::BatchModeration(TwitchAPI *api, UserLookupService *lookups, ModerationOutbox *outbox,
+                                 QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_lookups(lookups)
+    , m_outbox(outbox)
+    , m_nextBatchId(1)
+{
+}
+
+quint64 BatchModeration::start(const QString &channel, const QString &broadcasterId,
+                               const QString &moderatorId, const QList<BatchTarget> &targets,
+                               int timeoutSeconds, const QString &reason)
+{
+    Batch batch;
+    batch.id = m_nextBatchId++;
+    batch.channel = channel;
+    batch.broadcasterId = broadcasterId;
+    batch.moderatorId = moderatorId;
+    batch.timeoutSeconds = timeoutSeconds;
+    batch.reason = reason;
+    batch.timer.start();
+
+    QSet<QString> seen;
+    for (const BatchTarget &target : targets) {
+        const QString key = target.username.toLower();
+        if (key.isEmpty() || seen.contains(key)) {
+            continue;
+        }
+        seen.insert(key);
+
+        BatchItemResult item;
+        item.username = target.username;
+        item.userId = target.userId;
+        batch.items.append(item);
+    }
+
+    const quint64 batchId = batch.id;
+    m_batches.insert(batchId, batch);
+
+    // Start on the next event loop pass, so every signal of the batch
+    // arrives after the caller has its id
+    QMetaObject::invokeMethod(this, [this, batchId]() {
+        auto it = m_batches.find(batchId);
+        if (it == m_batches.end()) {
+            return;
+        }
+        Batch &batch = it.value();
+        for (int i = 0; i < batch.items.size(); ++i) {
+            if (isBanned(batch.channel, batch.items.at(i).username)) {
+                finishItem(batch, i, BatchItemResult::AlreadyBanned);
+            } else if (!batch.items.at(i).userId.isEmpty()) {
+                batch.queue.push_back(i);
+            }
+        }
+        resolve(batch);
+        pump(batch);
+        finishIfDone(batchId);
+    }, Qt::QueuedConnection);
+
+    return batchId;
+}
+
+void BatchModeration::cancel(quint64 batchId)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end()) {
+        return;
+    }
+
+    // Requests already handed to the API still complete and are counted
+    Batch &batch = it.value();
+    batch.cancelled = true;
+    while (!batch.queue.empty()) {
+        const int index = batch.queue.front();
+        batch.queue.pop_front();
+        finishItem(batch, index, BatchItemResult::Cancelled);
+    }
+    finishIfDone(batchId);
+}
+
+void BatchModeration::markBanned(const QString &channel, const QString &username)
+{
+    m_banned[channel.toLower()].insert(username.toLower());
+}
+
+void BatchModeration::markUnbanned(const QString &channel, const QString &username)
+{
+    auto it = m_banned.find(channel.toLower());
+    if (it != m_banned.end()) {
+        it->remove(username.toLower());
+    }
+}
+
+bool BatchModeration::isBanned(const QString &channel, const QString &username) const
+{
+    auto it = m_banned.constFind(channel.toLower());
+    return it != m_banned.constEnd() && it->contains(username.toLower());
+}
+
+void BatchModeration::resolve(Batch &batch)
+{
+    const quint64 batchId = batch.id;
+    for (int i = 0; i < batch.items.size(); ++i) {
+        const BatchItemResult &item = batch.items.at(i);
+        if (item.status != BatchItemResult::Pending || !item.userId.isEmpty()) {
+            continue;
+        }
+        ++batch.lookups;
+        m_lookups->lookupByLogin(item.username, ApiRequest::Moderation)
+            .then(this, [this, batchId, i](const TwitchUser &user) {
+                onUserResolved(batchId, i, user);
+            });
+    }
+
+    if (batch.broadcasterId.isEmpty()) {
+        ++batch.lookups;
+        m_lookups->lookupByLogin(batch.channel, ApiRequest::Moderation)
+            .then(this, [this, batchId](const TwitchUser &user) {
+                onBroadcasterResolved(batchId, user);
+            });
+    }
+}
+
+void BatchModeration::onUserResolved(quint64 batchId, int index, const TwitchUser &user)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end()) {
+        return;
+    }
+    Batch &batch = it.value();
+    --batch.lookups;
+
+    BatchItemResult &item = batch.items[index];
+    if (item.status == BatchItemResult::Pending) {
+        if (!user.isValid()) {
+            finishItem(batch, index, BatchItemResult::Unresolved, 0, "No such user");
+        } else if (batch.cancelled) {
+            item.userId = user.id;
+            finishItem(batch, index, BatchItemResult::Cancelled);
+        } else {
+            item.userId = user.id;
+            batch.queue.push_back(index);
+        }
+    }
+
+    failUnsendable(batch);
+    pump(batch);
+    finishIfDone(batchId);
+}
+
+void BatchModeration::onBroadcasterResolved(quint64 batchId, const TwitchUser &user)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end()) {
+        return;
+    }
+    Batch &batch = it.value();
+    --batch.lookups;
+    batch.broadcasterId = user.id;
+
+    failUnsendable(batch);
+    pump(batch);
+    finishIfDone(batchId);
+}
+
+void BatchModeration::failUnsendable(Batch &batch)
+{
+    // Without a broadcaster id nothing can be sent
+    if (batch.lookups > 0 || !batch.broadcasterId.isEmpty()) {
+        return;
+    }
+    while (!batch.queue.empty()) {
+        const int index = batch.queue.front();
+        batch.queue.pop_front();
+        finishItem(batch, index, BatchItemResult::Failed, 0,
+                   "Channel #" + batch.channel + " not found");
+    }
+}
+
+void BatchModeration::pump(Batch &batch)
+{
+    if (batch.broadcasterId.isEmpty() || batch.cancelled) {
+        return;
+    }
+
+    const int limit = m_api->concurrencyWindow(MAX_WINDOW);
+    while (batch.inFlight.size() < limit && !batch.queue.empty()) {
+        const int index = batch.queue.front();
+        batch.queue.pop_front();
+
+        const QString &userId = batch.items.at(index).userId;
+        QFuture<ApiReply> action;
+        if (batch.timeoutSeconds > 0) {
+            action = m_outbox->timeout(batch.broadcasterId, batch.moderatorId, userId,
+                                       batch.timeoutSeconds, batch.reason);
+        } else {
+            action = m_outbox->ban(batch.broadcasterId, batch.moderatorId, userId, batch.reason);
+        }
+        batch.inFlight.insert(index);
+
+        const quint64 batchId = batch.id;
+        action.then(this, [this, batchId, index](const ApiReply &result) {
+            onActionFinished(batchId, index, result);
+        });
+    }
+}
+
+void BatchModeration::finishItem(Batch &batch, int index, BatchItemResult::Status status,
+                                 int statusCode, const QString &error)
+{
+    BatchItemResult &item = batch.items[index];
+    item.status = status;
+    item.statusCode = statusCode;
+    item.error = error;
+    ++batch.done;
+    emit itemFinished(batch.id, item, batch.done, int(batch.items.size()));
+}
+
+void BatchModeration::finishIfDone(quint64 batchId)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end() || it->done < it->items.size()) {
+        return;
+    }
+
+    const Batch &batch = it.value();
+    BatchSummary summary;
+    summary.batchId = batch.id;
+    summary.channel = batch.channel;
+    summary.ban = batch.timeoutSeconds == 0;
+    summary.durationSeconds = batch.timeoutSeconds;
+    summary.total = int(batch.items.size());
+    summary.elapsedMs = batch.timer.elapsed();
+
+    for (const BatchItemResult &item : batch.items) {
+        switch (item.status) {
+        case BatchItemResult::Succeeded:
+            ++summary.succeeded;
+            break;
+        case BatchItemResult::AlreadyBanned:
+            ++summary.alreadyBanned;
+            break;
+        case BatchItemResult::Unresolved:
+            ++summary.unresolved;
+            break;
+        case BatchItemResult::Cancelled:
+            ++summary.cancelled;
+            break;
+        case BatchItemResult::Failed:
+        case BatchItemResult::Pending:
+            ++summary.failed;
+            if (summary.failures.size() < MAX_SUMMARY_FAILURES) {
+                summary.failures.append(item.username + ": " + item.error);
+            }
+            break;
+        }
+    }
+
+    m_batches.erase(it);
+    emit batchFinished(summary);
+}
+
+void BatchModeration::onActionFinished(quint64 batchId, int index, const ApiReply &result)
+{
+    auto it = m_batches.find(batchId);
+    if (it == m_batches.end()) {
+        return;
+    }
+    Batch &batch = it.value();
+
+    if (batch.inFlight.remove(index)) {
+        const int statusCode = result.statusCode;
+        const QString &error = result.error;
+        const QString &username = batch.items.at(index).username;
+        ProfileCache *cache = m_lookups->profileCache();
+
+        if (error.isEmpty()) {
+            if (batch.timeoutSeconds == 0) {
+                markBanned(batch.channel, username);
+                if (cache) {
+                    cache->storeRole(batch.items.at(index).userId, username, batch.broadcasterId,
+                                     ProfileCache::Banned, true);
+                }
+            }
+            finishItem(batch, index, BatchItemResult::Succeeded, statusCode);
+        } else if (statusCode == 400 && error.contains("already banned", Qt::CaseInsensitive)) {
+            markBanned(batch.channel, username);
+            if (cache) {
+                cache->storeRole(batch.items.at(index).userId, username, batch.broadcasterId,
+                                 ProfileCache::Banned, true);
+            }
+            finishItem(batch, index, BatchItemResult::AlreadyBanned, statusCode, error);
+        } else {
+            finishItem(batch, index, BatchItemResult::Failed, statusCode, error);
+        }
+    }
+
+    pump(batch);
+    finishIfDone(batchId);
+}
@@ -0,0 +1,131 @@
+#ifndef BATCHMODERATION_H
+#define BATCHMODERATION_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QElapsedTimer>
+#include <deque>
+
+class TwitchAPI;
+class UserLookupService;
+class ModerationOutbox;
+struct TwitchUser;
+struct ApiReply;
+
+// Account to act on; userId may be empty and is then looked up by login
+struct BatchTarget {
+    QString username;
+    QString userId;
+};
+
+struct BatchItemResult {
+    enum Status {
+        Pending,
+        Succeeded,
+        AlreadyBanned, // skipped locally, or Twitch reported it
+        Unresolved,    // no account with that login
+        Failed,
+        Cancelled
+    };
+
+    QString username;
+    QString userId;
+    Status status = Pending;
+    int statusCode = 0;
+    QString error;
+};
+
+struct BatchSummary {
+    quint64 batchId = 0;
+    QString channel;
+    bool ban = true;
+    int durationSeconds = 0;
+
+    int total = 0;
+    int succeeded = 0;
+    int alreadyBanned = 0;
+    int unresolved = 0;
+    int failed = 0;
+    int cancelled = 0;
+    qint64 elapsedMs = 0;
+    QStringList failures; // "username: error", capped
+
+    QString toString() const;
+};
+
+// Bans or times out many accounts as one operation.
+//
+// Targets are deduplicated and checked against the accounts this client
+// already knows to be banned in the channel; missing user ids are resolved
+// through UserLookupService (100 logins per request). The remaining calls go
+// through the ModerationOutbox, so they survive a crash, in a small
+// concurrency window sized from the scheduler's rate-limit bucket,
+// so a 500-account batch never queues ahead of a manual ban for long and
+// never drains the bucket in one go. Progress is reported per item.
+class BatchModeration : public QObject
+{
+    Q_OBJECT
+
+public:
+    BatchModeration(TwitchAPI *api, UserLookupService *lookups, ModerationOutbox *outbox,
+                    QObject *parent = nullptr);
+
+    // timeoutSeconds == 0 bans. broadcasterId may be empty, it is then
+    // resolved from the channel name with the first lookup.
+    quint64 start(const QString &channel, const QString &broadcasterId,
+                  const QString &moderatorId, const QList<BatchTarget> &targets,
+                  int timeoutSeconds, const QString &reason);
+    void cancel(quint64 batchId);
+
+    // Fed from IRC CLEARCHAT so later batches skip accounts already banned
+    void markBanned(const QString &channel, const QString &username);
+    void markUnbanned(const QString &channel, const QString &username);
+    bool isBanned(const QString &channel, const QString &username) const;
+
+    static constexpr int MAX_WINDOW = 12;
+
+signals:
+    void itemFinished(quint64 batchId, const BatchItemResult &item, int done, int total);
+    void batchFinished(const BatchSummary &summary);
+
+private:
+    struct Batch {
+        quint64 id = 0;
+        QString channel;
+        QString broadcasterId;
+        QString moderatorId;
+        int timeoutSeconds = 0;
+        QString reason;
+
+        QList<BatchItemResult> items;
+        std::deque<int> queue;            // item indexes ready to send
+        QSet<int> inFlight;               // item indexes with a call pending
+        int lookups = 0;                  // user lookups still pending
+        int done = 0;
+        bool cancelled = false;
+        QElapsedTimer timer;
+    };
+
+    void resolve(Batch &batch);
+    void onUserResolved(quint64 batchId, int index, const TwitchUser &user);
+    void onBroadcasterResolved(quint64 batchId, const TwitchUser &user);
+    void onActionFinished(quint64 batchId, int index, const ApiReply &result);
+    void failUnsendable(Batch &batch);
+    void pump(Batch &batch);
+    void finishItem(Batch &batch, int index, BatchItemResult::Status status,
+                    int statusCode = 0, const QString &error = QString());
+    void finishIfDone(quint64 batchId);
+
+    TwitchAPI *m_api;
+    UserLookupService *m_lookups;
+    ModerationOutbox *m_outbox;
+    QHash<quint64, Batch> m_batches;
+    QHash<QString, QSet<QString>> m_banned;  // channel -> lowercase logins
+    quint64 m_nextBatchId;
+};
+
+#endif // BATCHMODERATION_H
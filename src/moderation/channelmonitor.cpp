@@ -0,0 +1,51 @@
+#include "channelmonitor.h"
+
+ChannelMonitor::ChannelMonitor(const QString &channelName)
+    : m_channelName(channelName)
+{
+}
+
+QString ChannelMonitor::channelName() const
+{
+    return m_channelName;
+}
+
+QString ChannelMonitor::roomId() const
+{
+    return m_roomId;
+}
+
+MonitorVerdict ChannelMonitor::processMessage(const ChatMessage &message)
+{
+    if (!message.roomId.isEmpty()) {
+        m_roomId = message.roomId;
+    }
+
+    MonitorVerdict verdict;
+    verdict.flood = m_floodDetector.addMessage(message);
+    verdict.surges = m_surgeDetector.recordMessage(message);
+    m_heavyHitters.record(message.username, message.receivedMs);
+    return verdict;
+}
+
+MonitorVerdict ChannelMonitor::processJoin(const QString &username, qint64 timestamp)
+{
+    MonitorVerdict verdict;
+    verdict.surges = m_surgeDetector.recordJoin(username, timestamp);
+    return verdict;
+}
+
+const FloodDetector &ChannelMonitor::floodDetector() const
+{
+    return m_floodDetector;
+}
+
+const SurgeDetector &ChannelMonitor::surgeDetector() const
+{
+    return m_surgeDetector;
+}
+
+const HeavyHitters &ChannelMonitor::heavyHitters() const
+{
+    return m_heavyHitters;
+}
@@ -0,0 +1,41 @@
+#ifndef CHANNELMONITOR_H
+#define CHANNELMONITOR_H
+
+#include <QString>
+#include <QList>
+#include "twitch/chatmessage.h"
+#include "flooddetector.h"
+#include "surgedetector.h"
+#include "heavyhitters.h"
+
+struct MonitorVerdict {
+    FloodVerdict flood;
+    QList<SurgeAlert> surges;
+};
+
+// Per-channel bundle of the streaming moderation detectors. Plain class,
+// no QObject: every call for a channel must come from one thread at a time.
+class ChannelMonitor
+{
+public:
+    explicit ChannelMonitor(const QString &channelName);
+
+    QString channelName() const;
+    QString roomId() const;
+
+    MonitorVerdict processMessage(const ChatMessage &message);
+    MonitorVerdict processJoin(const QString &username, qint64 timestamp);
+
+    const FloodDetector &floodDetector() const;
+    const SurgeDetector &surgeDetector() const;
+    const HeavyHitters &heavyHitters() const;
+
+private:
+    QString m_channelName;
+    QString m_roomId;
+    FloodDetector m_floodDetector;
+    SurgeDetector m_surgeDetector;
+    HeavyHitters m_heavyHitters;
+};
+
+#endif // CHANNELMONITOR_H
@@ -0,0 +1,193 @@
+#include "chatcommand.h"
+#include <QRegularExpression>
+#include <climits>
+
+namespace {
+struct CommandName {
+    const char *name;
+    ChatCommand::Kind kind;
+};
+
+const CommandName COMMANDS[] = {
+    {"ban", ChatCommand::Ban},
+    {"emoteonly", ChatCommand::EmoteOnly},
+    {"emoteonlyoff", ChatCommand::EmoteOnlyOff},
+    {"followers", ChatCommand::Followers},
+    {"followersoff", ChatCommand::FollowersOff},
+    {"help", ChatCommand::Help},
+    {"purge", ChatCommand::Purge},
+    {"slow", ChatCommand::Slow},
+    {"slowoff", ChatCommand::SlowOff},
+    {"subscribers", ChatCommand::Subscribers},
+    {"subscribersoff", ChatCommand::SubscribersOff},
+    {"timeout", ChatCommand::Timeout},
+    {"unban", ChatCommand::Unban},
+    {"uniquechat", ChatCommand::UniqueChat},
+    {"uniquechatoff", ChatCommand::UniqueChatOff},
+    {"untimeout", ChatCommand::Untimeout},
+    {"user", ChatCommand::UserCard},
+};
+
+bool takesTargets(ChatCommand::Kind kind)
+{
+    switch (kind) {
+    case ChatCommand::Ban:
+    case ChatCommand::Unban:
+    case ChatCommand::Timeout:
+    case ChatCommand::Untimeout:
+    case ChatCommand::Purge:
+    case ChatCommand::UserCard:
+        return true;
+    default:
+        return false;
+    }
+}
+
+// "600", "10m", "1h"; -1 if it isn't a duration
+int parseDuration(const QString &word, int bareUnitSeconds)
+{
+    static const QRegularExpression pattern("^(\\d{1,7})([smhdw]?)$");
+    const QRegularExpressionMatch match = pattern.match(word.toLower());
+    if (!match.hasMatch()) {
+        return -1;
+    }
+    const qint64 value = match.captured(1).toLongLong();
+    const QString unit = match.captured(2);
+    const qint64 seconds = unit == "s" ? value
+                         : unit == "m" ? value * 60
+                         : unit == "h" ? value * 3600
+                         : unit == "d" ? value * 86400
+                         : unit == "w" ? value * 604800
+                         : value * bareUnitSeconds;
+    return int(qMin<qint64>(seconds, INT_MAX));
+}
+
+ChatCommand invalid(ChatCommand command, const QString &error)
+{
+    command.kind = ChatCommand::Invalid;
+    command.error = error;
+    return command;
+}
+}
+
+ChatCommand ChatCommand::parse(const QString &text)
+{
+    ChatCommand command;
+    QString body = text.trimmed();
+    if (!body.startsWith('/')) {
+        return invalid(command, "Not a command");
+    }
+    body.remove(0, 1);
+
+    // Everything after "--" is the reason, verbatim
+    const qsizetype separator = body.indexOf(QRegularExpression("(^|\\s)--(\\s|$)"));
+    if (separator >= 0) {
+        command.reason = body.mid(separator).trimmed().mid(2).trimmed();
+        body.truncate(separator);
+    }
+
+    QStringList words = body.split(' ', Qt::SkipEmptyParts);
+    if (words.isEmpty()) {
+        return invalid(command, "Empty command; /help lists them");
+    }
+    command.name = words.takeFirst().toLower();
+
+    for (const CommandName &entry : COMMANDS) {
+        if (command.name == QLatin1String(entry.name)) {
+            command.kind = entry.kind;
+            break;
+        }
+    }
+    if (command.kind == Invalid) {
+        return invalid(command, QString("Unknown command /%1; /help lists them").arg(command.name));
+    }
+    if (!command.reason.isEmpty() && command.kind != Ban && command.kind != Timeout) {
+        return invalid(command, QString("/%1 takes no reason").arg(command.name));
+    }
+
+    if (command.kind == Timeout && words.size() > 1) {
+        const int seconds = parseDuration(words.last(), 1);
+        if (seconds >= 0) {
+            words.removeLast();
+            command.durationSeconds = seconds;
+        }
+    }
+
+    if (takesTargets(command.kind)) {
+        static const QRegularExpression loginPattern("^[a-z0-9_]{1,25}$");
+        for (QString word : std::as_const(words)) {
+            word = word.toLower();
+            if (word.startsWith('@')) {
+                word.remove(0, 1);
+            }
+            if (word.endsWith(',')) {
+                word.chop(1);
+            }
+            if (!loginPattern.match(word).hasMatch()) {
+                return invalid(command, QString("Not a login: %1").arg(word));
+            }
+            if (!command.targets.contains(word)) {
+                command.targets.append(word);
+            }
+        }
+        if (command.targets.isEmpty()) {
+            return invalid(command, QString("Usage: /%1 <user> [user...]").arg(command.name));
+        }
+        if (command.kind == UserCard && command.targets.size() > 1) {
+            return invalid(command, "Usage: /user <user>");
+        }
+        if (command.kind == Timeout) {
+            if (command.durationSeconds == 0) {
+                command.durationSeconds = DEFAULT_TIMEOUT_SECONDS;
+            }
+            if (command.durationSeconds > MAX_TIMEOUT_SECONDS) {
+                return invalid(command, "Timeouts are at most 2 weeks");
+            }
+        }
+        return command;
+    }
+
+    if (command.kind == Slow || command.kind == Followers) {
+        if (words.size() > 1) {
+            return invalid(command, QString("Usage: /%1 [duration]").arg(command.name));
+        }
+        if (command.kind == Slow) {
+            command.durationSeconds = words.isEmpty() ? 30 : parseDuration(words.first(), 1);
+            if (command.durationSeconds < 3 || command.durationSeconds > 120) {
+                return invalid(command, "Slow mode waits 3 to 120 seconds");
+            }
+        } else {
+            // Bare numbers are minutes, as in Twitch's own /followers
+            command.durationSeconds = words.isEmpty() ? 0 : parseDuration(words.first(), 60);
+            if (command.durationSeconds < 0 || command.durationSeconds > 90 * 86400) {
+                return invalid(command, "Followers-only takes a duration up to 3 months");
+            }
+            // Helix takes whole minutes; 30s must not become "no minimum"
+            command.durationSeconds = (command.durationSeconds + 59) / 60 * 60;
+        }
+        return command;
+    }
+
+    if (!words.isEmpty()) {
+        return invalid(command, QString("/%1 takes no arguments").arg(command.name));
+    }
+    return command;
+}
+
+QStringList ChatCommand::names()
+{
+    QStringList result;
+    for (const CommandName &entry : COMMANDS) {
+        result.append(QString("/") + entry.name);
+    }
+    return result;
+}
+
+QString ChatCommand::helpText()
+{
+    return "Commands: /ban <users> [-- reason], /timeout <users> [duration] [-- reason], "
+           "/unban <users>, /untimeout <users>, /purge <users>, /user <user>, "
+           "/slow [seconds], /slowoff, /followers [duration], /followersoff, "
+           "/subscribers, /subscribersoff, /emoteonly, /emoteonlyoff, /uniquechat, /uniquechatoff. "
+           "Tab completes names.";
+}
@@ -0,0 +1,58 @@
+#ifndef CHATCOMMAND_H
+#define CHATCOMMAND_H
+
+#include <QString>
+#include <QStringList>
+
+// A slash command typed into the chat input.
+//
+// Moderation commands take any number of targets, so a wave of accounts
+// can be handled in one line:
+//
+//   /ban spambot1 spambot2 @spambot3 -- follow bots
+//   /timeout user1 user2 10m -- caps
+//   /unban user1 user2
+//
+// A reason follows "--"; without one every word is a target. Durations
+// are seconds or a number with s/m/h/d/w, and go last.
+struct ChatCommand {
+    enum Kind {
+        Invalid,
+        Help,
+        Ban,
+        Unban,
+        Timeout,
+        Untimeout,
+        Purge,       // delete the targets' messages still on screen
+        UserCard,
+        Slow,
+        SlowOff,
+        Followers,
+        FollowersOff,
+        Subscribers,
+        SubscribersOff,
+        EmoteOnly,
+        EmoteOnlyOff,
+        UniqueChat,
+        UniqueChatOff
+    };
+
+    Kind kind = Invalid;
+    QString name;      // as typed, without the slash
+    QStringList targets; // lowercase logins, unique, in the order given
+    int durationSeconds = 0;
+    QString reason;
+    QString error;     // set when kind is Invalid
+
+    bool isValid() const { return kind != Invalid; }
+
+    static ChatCommand parse(const QString &text);
+    // Command names for completion, sorted
+    static QStringList names();
+    static QString helpText();
+
+    static constexpr int DEFAULT_TIMEOUT_SECONDS = 600;
+    static constexpr int MAX_TIMEOUT_SECONDS = 14 * 24 * 60 * 60;
+};
+
+#endif // CHATCOMMAND_H
@@ -0,0 +1,241 @@
+#include "flooddetector.h"
+#include "sketchhash.h"
+#include <QtAlgorithms>
+
+FloodDetector::FloodDetector()
+    : FloodDetector(Config())
+{
+}
+
+FloodDetector::FloodDetector(const Config &config)
+    : m_config(config)
+    , m_nextSeq(1)
+    , m_nextClusterId(1)
+{
+}
+
+QString FloodDetector::normalize(const QString &text)
+{
+    // Lowercase letters and digits only, punctuation/whitespace collapsed to
+    // one space, combining marks dropped and character runs capped at two,
+    // so "BUY FOLLOWERS!!!" and "buy  followerssss" normalize alike.
+    QString out;
+    out.reserve(text.size());
+    bool pendingSpace = false;
+
+    for (const QChar c : text) {
+        if (c.isMark()) {
+            continue;
+        }
+        if (!c.isLetterOrNumber()) {
+            pendingSpace = true;
+            continue;
+        }
+
+        if (pendingSpace && !out.isEmpty()) {
+            out.append(' ');
+        }
+        pendingSpace = false;
+
+        const QChar lower = c.toLower();
+        const qsizetype n = out.size();
+        if (n >= 2 && out.at(n - 1) == lower && out.at(n - 2) == lower) {
+            continue;
+        }
+        out.append(lower);
+    }
+
+    return out;
+}
+
+quint64 FloodDetector::simHash(const QString &normalizedText)
+{
+    const qsizetype length = normalizedText.size();
+    if (length == 0) {
+        return 0;
+    }
+    if (length < 3) {
+        return SketchHash::hash(normalizedText);
+    }
+
+    // Count set bits per position over all shingles; a signature bit is set
+    // when the majority of shingle hashes have it set.
+    int ones[64] = {};
+    const qsizetype shingles = length - 2;
+    for (qsizetype i = 0; i < shingles; ++i) {
+        quint64 h = SketchHash::hash(normalizedText.constData() + i, 3);
+        for (int bit = 0; bit < 64; ++bit) {
+            ones[bit] += int((h >> bit) & 1u);
+        }
+    }
+
+    quint64 signature = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (2 * qsizetype(ones[bit]) > shingles) {
+            signature |= (Q_UINT64_C(1) << bit);
+        }
+    }
+    return signature;
+}
+
+int FloodDetector::hammingDistance(quint64 a, quint64 b)
+{
+    return int(qPopulationCount(a ^ b));
+}
+
+quint32 FloodDetector::bucketKey(int band, quint64 signature)
+{
+    const quint32 bits = quint32((signature >> (band * 16)) & 0xFFFFu);
+    return (quint32(band) << 16) | bits;
+}
+
+FloodVerdict FloodDetector::addMessage(const ChatMessage &message)
+{
+    FloodVerdict verdict;
+    const qint64 now = message.receivedMs;
+    expire(now);
+
+    const QString normalized = normalize(message.text);
+    if (normalized.size() < m_config.minNormalizedLength) {
+        return verdict;
+    }
+
+    Entry entry{m_nextSeq++, simHash(normalized), now, 0,
+                message.username, message.userId, message.messageId};
+
+    // LSH lookup, newest candidates first - one match is enough to join a
+    // cluster, so floods resolve in O(1) comparisons.
+    qsizetype matchIndex = -1;
+    const quint64 frontSeq = m_entries.isEmpty() ? 0 : m_entries.first().seq;
+    for (int band = 0; band < BANDS && matchIndex < 0; ++band) {
+        auto it = m_buckets.constFind(bucketKey(band, entry.signature));
+        if (it == m_buckets.constEnd()) {
+            continue;
+        }
+        const QList<quint64> &seqs = it.value();
+        for (qsizetype j = seqs.size() - 1; j >= 0; --j) {
+            const qsizetype index = qsizetype(seqs.at(j) - frontSeq);
+            if (hammingDistance(m_entries.at(index).signature, entry.signature)
+                    <= m_config.maxHammingDistance) {
+                matchIndex = index;
+                break;
+            }
+        }
+    }
+
+    if (matchIndex >= 0) {
+        Entry &other = m_entries[matchIndex];
+        if (other.clusterId == 0 || !m_clusters.contains(other.clusterId)) {
+            other.clusterId = m_nextClusterId++;
+            ClusterState &state = m_clusters[other.clusterId];
+            state.cluster.id = other.clusterId;
+            state.cluster.channel = message.channel;
+            state.cluster.roomId = message.roomId;
+            state.cluster.sampleText = message.text;
+            state.cluster.firstSeen = other.timestamp;
+            addToCluster(state, other);
+        }
+
+        entry.clusterId = other.clusterId;
+        ClusterState &state = m_clusters[entry.clusterId];
+        addToCluster(state, entry);
+
+        verdict.clusterId = entry.clusterId;
+        if (!state.flagged && state.users.size() >= m_config.minDistinctUsers) {
+            state.flagged = true;
+            verdict.newlyFlagged = true;
+        }
+        verdict.flagged = state.flagged;
+    }
+
+    for (int band = 0; band < BANDS; ++band) {
+        m_buckets[bucketKey(band, entry.signature)].append(entry.seq);
+    }
+    m_entries.append(entry);
+
+    return verdict;
+}
+
+void FloodDetector::addToCluster(ClusterState &state, const Entry &entry)
+{
+    FloodCluster &cluster = state.cluster;
+    ++cluster.messageCount;
+    cluster.lastSeen = qMax(cluster.lastSeen, entry.timestamp);
+
+    if (!state.users.contains(entry.username)) {
+        state.users.insert(entry.username);
+        cluster.usernames.append(entry.username);
+        cluster.userIds.append(entry.userId);
+    }
+    if (!entry.messageId.isEmpty() && cluster.messageIds.size() < m_config.maxClusterMessages) {
+        cluster.messageIds.append(entry.messageId);
+    }
+}
+
+void FloodDetector::expire(qint64 now)
+{
+    bool evicted = false;
+    while (!m_entries.isEmpty()
+           && (m_entries.first().timestamp < now - m_config.windowMs
+               || m_entries.size() >= m_config.maxEntries)) {
+        removeFromBuckets(m_entries.first());
+        m_entries.removeFirst();
+        evicted = true;
+    }
+
+    // Clusters outlive their entries for one extra window so a bulk action
+    // still covers the whole wave after it has died down.
+    if (evicted && !m_clusters.isEmpty()) {
+        for (auto it = m_clusters.begin(); it != m_clusters.end();) {
+            if (it->cluster.lastSeen < now - 2 * m_config.windowMs) {
+                it = m_clusters.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void FloodDetector::removeFromBuckets(const Entry &entry)
+{
+    for (int band = 0; band < BANDS; ++band) {
+        auto it = m_buckets.find(bucketKey(band, entry.signature));
+        if (it == m_buckets.end()) {
+            continue;
+        }
+        QList<quint64> &seqs = it.value();
+        // Oldest entries are evicted first, so this is almost always the front
+        if (!seqs.isEmpty() && seqs.first() == entry.seq) {
+            seqs.removeFirst();
+        } else {
+            seqs.removeOne(entry.seq);
+        }
+        if (seqs.isEmpty()) {
+            m_buckets.erase(it);
+        }
+    }
+}
+
+const FloodCluster *FloodDetector::cluster(quint64 clusterId) const
+{
+    auto it = m_clusters.constFind(clusterId);
+    return it == m_clusters.constEnd() ? nullptr : &it->cluster;
+}
+
+QList<FloodCluster> FloodDetector::flaggedClusters() const
+{
+    QList<FloodCluster> result;
+    for (const ClusterState &state : m_clusters) {
+        if (state.flagged) {
+            result.append(state.cluster);
+        }
+    }
+    return result;
+}
+
+void FloodDetector::clear()
+{
+    m_entries.clear();
+    m_buckets.clear();
+    m_clusters.clear();
+}
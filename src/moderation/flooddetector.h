@@ -0,0 +1,96 @@
+#ifndef FLOODDETECTOR_H
+#define FLOODDETECTOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include "twitch/chatmessage.h"
+
+// A group of near-identical messages posted by several accounts
+struct FloodCluster {
+    quint64 id = 0;
+    QString channel;
+    QString roomId;
+    QString sampleText;
+    QStringList usernames;   // distinct accounts, in arrival order
+    QStringList userIds;     // aligned with usernames (may contain empty ids)
+    QStringList messageIds;
+    int messageCount = 0;
+    qint64 firstSeen = 0;
+    qint64 lastSeen = 0;
+};
+
+struct FloodVerdict {
+    quint64 clusterId = 0;     // 0 = message is not part of any cluster
+    bool flagged = false;      // cluster has crossed the distinct-user threshold
+    bool newlyFlagged = false; // this message made it cross
+};
+
+// Copy-pasta / bot-raid detector for one channel.
+//
+// Each message gets a 64-bit SimHash over character 3-grams of its
+// normalized text. Signatures are split into 4 bands of 16 bits and indexed
+// in LSH buckets: two signatures within Hamming distance 3 must agree on at
+// least one band, so a lookup only touches entries that can possibly match.
+// Entries live in a sliding time window; clusters are flagged once enough
+// distinct accounts have posted into them.
+class FloodDetector
+{
+public:
+    struct Config {
+        qint64 windowMs = 60000;
+        int maxHammingDistance = 3;   // must stay below BANDS for the LSH guarantee
+        int minDistinctUsers = 4;
+        int minNormalizedLength = 12; // ignore short messages ("lol", single emotes)
+        int maxEntries = 8192;
+        int maxClusterMessages = 1000;
+    };
+
+    FloodDetector();
+    explicit FloodDetector(const Config &config);
+
+    FloodVerdict addMessage(const ChatMessage &message);
+
+    const FloodCluster *cluster(quint64 clusterId) const;
+    QList<FloodCluster> flaggedClusters() const;
+    void clear();
+
+    static QString normalize(const QString &text);
+    static quint64 simHash(const QString &normalizedText);
+    static int hammingDistance(quint64 a, quint64 b);
+
+    static constexpr int BANDS = 4;
+
+private:
+    struct Entry {
+        quint64 seq;
+        quint64 signature;
+        qint64 timestamp;
+        quint64 clusterId;
+        QString username;
+        QString userId;
+        QString messageId;
+    };
+
+    struct ClusterState {
+        FloodCluster cluster;
+        QSet<QString> users;
+        bool flagged = false;
+    };
+
+    void expire(qint64 now);
+    void removeFromBuckets(const Entry &entry);
+    void addToCluster(ClusterState &state, const Entry &entry);
+    static quint32 bucketKey(int band, quint64 signature);
+
+    Config m_config;
+    QList<Entry> m_entries;                   // oldest first, contiguous seqs
+    QHash<quint32, QList<quint64>> m_buckets; // band key -> entry seqs
+    QHash<quint64, ClusterState> m_clusters;
+    quint64 m_nextSeq;
+    quint64 m_nextClusterId;
+};
+
+#endif // FLOODDETECTOR_H
@@ -0,0 +1,248 @@
+#include "heavyhitters.h"
+#include "sketchhash.h"
+#include <QSet>
+#include <cmath>
+#include <utility>
+
+namespace {
+// Rebase once weights reach e^20 (~4.9e8), far from float overflow
+constexpr double MAX_EXPONENT = 20.0;
+}
+
+DecayingCountMinSketch::DecayingCountMinSketch(qint64 tauMs, int width, int depth)
+    : m_tauMs(tauMs)
+    , m_width(width)
+    , m_depth(depth)
+    , m_landmark(0)
+    , m_lastRescale(1.0f)
+    , m_counters(width * depth, 0.0f)
+{
+    Q_ASSERT((width & (width - 1)) == 0); // power of two, columns are masked
+}
+
+int DecayingCountMinSketch::column(quint64 hash, int row) const
+{
+    // Kirsch-Mitzenmacher: d row hashes derived from two 32-bit halves
+    const quint32 h1 = quint32(hash);
+    const quint32 h2 = quint32(hash >> 32) | 1u;
+    return int((h1 + quint32(row) * h2) & quint32(m_width - 1));
+}
+
+bool DecayingCountMinSketch::rebaseIfNeeded(qint64 now)
+{
+    const double exponent = double(now - m_landmark) / double(m_tauMs);
+    if (exponent <= MAX_EXPONENT) {
+        return false;
+    }
+
+    const float factor = float(std::exp(-exponent));
+    for (float &counter : m_counters) {
+        counter *= factor;
+    }
+    m_landmark = now;
+    m_lastRescale = factor;
+    return true;
+}
+
+float DecayingCountMinSketch::lastRescaleFactor() const
+{
+    return m_lastRescale;
+}
+
+float DecayingCountMinSketch::add(quint64 hash, qint64 now)
+{
+    const float weight = float(std::exp(double(now - m_landmark) / double(m_tauMs)));
+
+    // Conservative update: raise only the rows that are at the minimum
+    float minimum = m_counters[column(hash, 0)];
+    for (int row = 1; row < m_depth; ++row) {
+        minimum = qMin(minimum, m_counters[row * m_width + column(hash, row)]);
+    }
+
+    const float updated = minimum + weight;
+    for (int row = 0; row < m_depth; ++row) {
+        float &counter = m_counters[row * m_width + column(hash, row)];
+        counter = qMax(counter, updated);
+    }
+    return updated;
+}
+
+double DecayingCountMinSketch::estimate(quint64 hash, qint64 now) const
+{
+    float minimum = m_counters[column(hash, 0)];
+    for (int row = 1; row < m_depth; ++row) {
+        minimum = qMin(minimum, m_counters[row * m_width + column(hash, row)]);
+    }
+    return decayed(minimum, now);
+}
+
+double DecayingCountMinSketch::decayed(float scaled, qint64 now) const
+{
+    return double(scaled) * std::exp(-double(now - m_landmark) / double(m_tauMs));
+}
+
+qsizetype DecayingCountMinSketch::memoryBytes() const
+{
+    return m_counters.size() * qsizetype(sizeof(float));
+}
+
+HeavyHitters::TopK::TopK(int capacity)
+    : m_capacity(capacity)
+{
+    m_heap.reserve(capacity);
+    m_positions.reserve(capacity);
+}
+
+void HeavyHitters::TopK::offer(const QString &username, float score)
+{
+    auto it = m_positions.constFind(username);
+    if (it != m_positions.constEnd()) {
+        // Scores only grow, so a candidate can only sink in a min-heap
+        const int index = it.value();
+        m_heap[index].score = score;
+        siftDown(index);
+        return;
+    }
+
+    if (m_heap.size() < m_capacity) {
+        m_heap.append(Candidate{username, score});
+        m_positions.insert(username, int(m_heap.size() - 1));
+        siftUp(int(m_heap.size() - 1));
+        return;
+    }
+
+    if (!m_heap.isEmpty() && score > m_heap.first().score) {
+        m_positions.remove(m_heap.first().username);
+        m_heap[0] = Candidate{username, score};
+        m_positions.insert(username, 0);
+        siftDown(0);
+    }
+}
+
+void HeavyHitters::TopK::rescale(float factor)
+{
+    // Uniform scaling keeps the heap order intact
+    for (Candidate &candidate : m_heap) {
+        candidate.score *= factor;
+    }
+}
+
+QList<QString> HeavyHitters::TopK::usernames() const
+{
+    QList<QString> result;
+    result.reserve(m_heap.size());
+    for (const Candidate &candidate : m_heap) {
+        result.append(candidate.username);
+    }
+    return result;
+}
+
+void HeavyHitters::TopK::swapNodes(int a, int b)
+{
+    std::swap(m_heap[a], m_heap[b]);
+    m_positions[m_heap[a].username] = a;
+    m_positions[m_heap[b].username] = b;
+}
+
+void HeavyHitters::TopK::siftUp(int index)
+{
+    while (index > 0) {
+        const int parent = (index - 1) / 2;
+        if (m_heap[parent].score <= m_heap[index].score) {
+            break;
+        }
+        swapNodes(parent, index);
+        index = parent;
+    }
+}
+
+void HeavyHitters::TopK::siftDown(int index)
+{
+    const int size = int(m_heap.size());
+    while (true) {
+        const int left = 2 * index + 1;
+        const int right = left + 1;
+        int smallest = index;
+        if (left < size && m_heap[left].score < m_heap[smallest].score) {
+            smallest = left;
+        }
+        if (right < size && m_heap[right].score < m_heap[smallest].score) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        swapNodes(smallest, index);
+        index = smallest;
+    }
+}
+
+HeavyHitters::HeavyHitters(int topK, int width, int depth)
+    : m_topK(topK)
+{
+    for (int h = 0; h < HorizonCount; ++h) {
+        m_sketches.append(DecayingCountMinSketch(horizonMs(Horizon(h)), width, depth));
+        m_tops.append(TopK(topK));
+    }
+}
+
+qint64 HeavyHitters::horizonMs(Horizon horizon)
+{
+    switch (horizon) {
+    case OneMinute:
+        return 60 * 1000;
+    case FiveMinutes:
+        return 5 * 60 * 1000;
+    case FifteenMinutes:
+    case HorizonCount:
+        break;
+    }
+    return 15 * 60 * 1000;
+}
+
+void HeavyHitters::record(const QString &username, qint64 now)
+{
+    const quint64 hash = SketchHash::hash(username);
+    for (int h = 0; h < HorizonCount; ++h) {
+        DecayingCountMinSketch &sketch = m_sketches[h];
+        if (sketch.rebaseIfNeeded(now)) {
+            m_tops[h].rescale(sketch.lastRescaleFactor());
+        }
+        m_tops[h].offer(username, sketch.add(hash, now));
+    }
+}
+
+QList<HeavyHitters::Entry> HeavyHitters::top(qint64 now) const
+{
+    QSet<QString> candidates;
+    for (const TopK &topK : m_tops) {
+        const QList<QString> names = topK.usernames();
+        for (const QString &name : names) {
+            candidates.insert(name);
+        }
+    }
+
+    QList<Entry> result;
+    result.reserve(candidates.size());
+    for (const QString &name : std::as_const(candidates)) {
+        Entry entry;
+        entry.username = name;
+        const quint64 hash = SketchHash::hash(name);
+        for (int h = 0; h < HorizonCount; ++h) {
+            entry.counts[h] = m_sketches[h].estimate(hash, now);
+        }
+        result.append(entry);
+    }
+    return result;
+}
+
+qsizetype HeavyHitters::memoryBytes() const
+{
+    qsizetype bytes = 0;
+    for (const DecayingCountMinSketch &sketch : m_sketches) {
+        bytes += sketch.memoryBytes();
+    }
+    // Heap slot + index entry per candidate (excluding string payloads)
+    bytes += qsizetype(HorizonCount) * m_topK * qsizetype(sizeof(QString) * 2 + sizeof(float) + sizeof(int));
+    return bytes;
+}
@@ -0,0 +1,139 @@
+#include "hyperloglog.h"
+#include "sketchhash.h"
+#include <QtAlgorithms>
+#include <cmath>
+
+HyperLogLog::HyperLogLog()
+    : m_registers(REGISTERS, 0)
+    , m_empty(true)
+{
+}
+
+void HyperLogLog::add(quint64 hash)
+{
+    // Top PRECISION bits pick the register, the rest feed the rank
+    const int index = int(hash >> (64 - PRECISION));
+    const quint64 rest = hash << PRECISION;
+    const int rank = rest == 0 ? (64 - PRECISION + 1)
+                               : int(qCountLeadingZeroBits(rest)) + 1;
+
+    if (m_registers[index] < rank) {
+        m_registers[index] = quint8(rank);
+    }
+    m_empty = false;
+}
+
+void HyperLogLog::add(const QString &item)
+{
+    add(SketchHash::hash(item));
+}
+
+void HyperLogLog::merge(const HyperLogLog &other)
+{
+    if (other.m_empty) {
+        return;
+    }
+    quint8 *dst = m_registers.data();
+    const quint8 *src = other.m_registers.constData();
+    for (int i = 0; i < REGISTERS; ++i) {
+        dst[i] = qMax(dst[i], src[i]);
+    }
+    m_empty = false;
+}
+
+void HyperLogLog::clear()
+{
+    if (!m_empty) {
+        m_registers.fill(0);
+        m_empty = true;
+    }
+}
+
+bool HyperLogLog::isEmpty() const
+{
+    return m_empty;
+}
+
+double HyperLogLog::estimate() const
+{
+    if (m_empty) {
+        return 0.0;
+    }
+
+    const double m = REGISTERS;
+    double sum = 0.0;
+    int zeros = 0;
+    for (quint8 r : m_registers) {
+        sum += std::ldexp(1.0, -int(r));
+        if (r == 0) {
+            ++zeros;
+        }
+    }
+
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+
+    // Small-range correction: linear counting is more accurate while
+    // many registers are still empty
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return estimate;
+}
+
+SlidingHyperLogLog::SlidingHyperLogLog(qint64 bucketMs, int bucketCount)
+    : m_bucketMs(bucketMs)
+    , m_buckets(bucketCount)
+    , m_currentBucket(-1)
+    , m_closedEstimate(0.0)
+{
+}
+
+bool SlidingHyperLogLog::advance(qint64 now)
+{
+    const qint64 bucket = now / m_bucketMs;
+    if (m_currentBucket < 0) {
+        m_currentBucket = bucket;
+        return false;
+    }
+    if (bucket <= m_currentBucket) {
+        return false;
+    }
+
+    // The buckets before the new one form the window that just closed
+    m_closedEstimate = windowEstimate();
+
+    const int count = m_buckets.size();
+    const qint64 steps = qMin<qint64>(bucket - m_currentBucket, count);
+    for (qint64 i = 1; i <= steps; ++i) {
+        m_buckets[int((m_currentBucket + i) % count)].clear();
+    }
+    m_currentBucket = bucket;
+    return true;
+}
+
+bool SlidingHyperLogLog::add(const QString &item, qint64 now)
+{
+    const bool rotated = advance(now);
+    m_buckets[int(m_currentBucket % m_buckets.size())].add(item);
+    return rotated;
+}
+
+double SlidingHyperLogLog::windowEstimate() const
+{
+    HyperLogLog merged;
+    for (const HyperLogLog &bucket : m_buckets) {
+        merged.merge(bucket);
+    }
+    return merged.estimate();
+}
+
+double SlidingHyperLogLog::closedWindowEstimate() const
+{
+    return m_closedEstimate;
+}
+
+qint64 SlidingHyperLogLog::windowMs() const
+{
+    return m_bucketMs * m_buckets.size();
+}
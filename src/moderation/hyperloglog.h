@@ -0,0 +1,56 @@
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// HyperLogLog distinct counter with 2^PRECISION one-byte registers.
+// PRECISION 10 = 1 KiB per sketch, standard error 1.04/sqrt(1024) ~ 3.3%,
+// independent of how many distinct items are added.
+class HyperLogLog
+{
+public:
+    static constexpr int PRECISION = 10;
+    static constexpr int REGISTERS = 1 << PRECISION;
+
+    HyperLogLog();
+
+    void add(quint64 hash);
+    void add(const QString &item);
+    void merge(const HyperLogLog &other);
+    void clear();
+
+    double estimate() const;
+    bool isEmpty() const;
+
+private:
+    QVector<quint8> m_registers;
+    bool m_empty;
+};
+
+// Distinct count over a sliding time window, built from a ring of
+// per-bucket sketches that are merged on demand. Memory is
+// bucketCount * 1 KiB regardless of traffic.
+class SlidingHyperLogLog
+{
+public:
+    SlidingHyperLogLog(qint64 bucketMs, int bucketCount);
+
+    // Returns true when the timestamp moved into a new bucket; the window
+    // that just closed is then available from closedWindowEstimate().
+    bool add(const QString &item, qint64 now);
+    bool advance(qint64 now);
+
+    double closedWindowEstimate() const;
+    double windowEstimate() const;
+    qint64 windowMs() const;
+
+private:
+    qint64 m_bucketMs;
+    QVector<HyperLogLog> m_buckets;
+    qint64 m_currentBucket;
+    double m_closedEstimate;
+};
+
+#endif // HYPERLOGLOG_H
@@ -0,0 +1,109 @@
+#include "messagepurge.h"
+#include "moderationoutbox.h"
+#include "twitch/twitchapi.h"
+#include <QMetaObject>
+
+QString PurgeSummary::toString() const
+{
+    QString text = QString("Deleted %1 of %2 messages from %3 in #%4 in %5 s")
+                       .arg(deleted + gone)
+                       .arg(total)
+                       .arg(username)
+                       .arg(channel)
+                       .arg(elapsedMs / 1000.0, 0, 'f', 1);
+    if (failed > 0) {
+        text += QString(" (%1 failed: %2)").arg(failed).arg(lastError);
+    }
+    return text;
+}
+
+MessagePurge::MessagePurge(TwitchAPI *api, ModerationOutbox *outbox, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_outbox(outbox)
+    , m_nextPurgeId(1)
+{
+}
+
+quint64 MessagePurge::start(const QString &channel, const QString &broadcasterId, const QString &moderatorId,
+                            const QString &username, const QStringList &messageIds)
+{
+    Purge purge;
+    purge.summary.purgeId = m_nextPurgeId++;
+    purge.summary.channel = channel;
+    purge.summary.username = username;
+    purge.summary.total = int(messageIds.size());
+    purge.broadcasterId = broadcasterId;
+    purge.moderatorId = moderatorId;
+    purge.messageIds = messageIds;
+    for (int i = 0; i < messageIds.size(); ++i) {
+        purge.queue.push_back(i);
+    }
+    purge.timer.start();
+
+    const quint64 purgeId = purge.summary.purgeId;
+    m_purges.insert(purgeId, purge);
+
+    // Signals only after the caller has the id, as with BatchModeration
+    QMetaObject::invokeMethod(this, [this, purgeId]() {
+        auto it = m_purges.find(purgeId);
+        if (it == m_purges.end()) {
+            return;
+        }
+        if (it->summary.total == 0) {
+            emit purgeFinished(m_purges.take(purgeId).summary);
+            return;
+        }
+        pump(it.value());
+    }, Qt::QueuedConnection);
+
+    return purgeId;
+}
+
+void MessagePurge::pump(Purge &purge)
+{
+    const int limit = m_api->concurrencyWindow(MAX_WINDOW);
+    while (purge.inFlight < limit && !purge.queue.empty()) {
+        const int index = purge.queue.front();
+        purge.queue.pop_front();
+        ++purge.inFlight;
+
+        const quint64 purgeId = purge.summary.purgeId;
+        m_outbox->deleteMessage(purge.broadcasterId, purge.moderatorId, purge.messageIds.at(index))
+            .then(this, [this, purgeId, index](const ApiReply &reply) {
+                onReply(purgeId, index, reply);
+            });
+    }
+}
+
+void MessagePurge::onReply(quint64 purgeId, int index, const ApiReply &reply)
+{
+    auto it = m_purges.find(purgeId);
+    if (it == m_purges.end()) {
+        return;
+    }
+    Purge &purge = it.value();
+    --purge.inFlight;
+    ++purge.done;
+
+    // 404: deleted by someone else already
+    bool deleted = true;
+    if (reply.ok()) {
+        ++purge.summary.deleted;
+    } else if (reply.statusCode == 404) {
+        ++purge.summary.gone;
+    } else {
+        ++purge.summary.failed;
+        purge.summary.lastError = reply.error;
+        deleted = false;
+    }
+    emit messageFinished(purgeId, purge.summary.channel, purge.summary.username,
+                         purge.messageIds.at(index), deleted);
+
+    if (purge.done < purge.summary.total) {
+        pump(purge);
+        return;
+    }
+    purge.summary.elapsedMs = purge.timer.elapsed();
+    emit purgeFinished(m_purges.take(purgeId).summary);
+}
@@ -0,0 +1,76 @@
+#ifndef MESSAGEPURGE_H
+#define MESSAGEPURGE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QElapsedTimer>
+#include <deque>
+
+class TwitchAPI;
+class ModerationOutbox;
+struct ApiReply;
+
+struct PurgeSummary {
+    quint64 purgeId = 0;
+    QString channel;
+    QString username;
+
+    int total = 0;
+    int deleted = 0;
+    int gone = 0; // deleted by someone else first
+    int failed = 0;
+    qint64 elapsedMs = 0;
+    QString lastError;
+
+    QString toString() const;
+};
+
+// Deletes a list of chat messages, e.g. one account's recent lines.
+//
+// Calls go through the ModerationOutbox (journaled, DELETE
+// /moderation/chat per message) in a concurrency window sized from the
+// scheduler's rate-limit bucket (TwitchAPI::concurrencyWindow), so 50
+// deletions finish in a few seconds without starving manual actions.
+// Each message is reported as soon as its call completes.
+class MessagePurge : public QObject
+{
+    Q_OBJECT
+
+public:
+    MessagePurge(TwitchAPI *api, ModerationOutbox *outbox, QObject *parent = nullptr);
+
+    quint64 start(const QString &channel, const QString &broadcasterId, const QString &moderatorId,
+                  const QString &username, const QStringList &messageIds);
+
+    static constexpr int MAX_WINDOW = 12;
+
+signals:
+    // deleted is also true when the message was already gone
+    void messageFinished(quint64 purgeId, const QString &channel, const QString &username,
+                         const QString &messageId, bool deleted);
+    void purgeFinished(const PurgeSummary &summary);
+
+private:
+    struct Purge {
+        PurgeSummary summary;
+        QString broadcasterId;
+        QString moderatorId;
+        QStringList messageIds;
+        std::deque<int> queue; // indexes into messageIds
+        int inFlight = 0;
+        int done = 0;
+        QElapsedTimer timer;
+    };
+
+    void pump(Purge &purge);
+    void onReply(quint64 purgeId, int index, const ApiReply &reply);
+
+    TwitchAPI *m_api;
+    ModerationOutbox *m_outbox;
+    QHash<quint64, Purge> m_purges;
+    quint64 m_nextPurgeId;
+};
+
+#endif // MESSAGEPURGE_H
@@ -0,0 +1,418 @@
+#include "modactionlog.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr quint32 LOG_MAGIC = 0x544d4c31; // "TML1"
+constexpr quint32 LOG_VERSION = 1;
+
+enum RecordType : quint8 {
+    StringRecord = 1,
+    ActionRecord = 2
+};
+
+qint64 nowMs()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+// Length-prefixed like the outbox journal, so a torn tail is detected
+QByteArray frame(const QByteArray &payload)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << payload;
+    return bytes;
+}
+
+void insertSorted(std::vector<quint32> &numbers, quint32 number)
+{
+    numbers.insert(std::upper_bound(numbers.begin(), numbers.end(), number), number);
+}
+}
+
+QString ModAction::kindName(Kind kind)
+{
+    switch (kind) {
+    case Ban:
+        return "Ban";
+    case Timeout:
+        return "Timeout";
+    case Unban:
+        return "Unban";
+    case DeleteMessage:
+        return "Delete";
+    case ClearChat:
+        return "Clear chat";
+    }
+    return QString();
+}
+
+ModActionLog::ModActionLog(const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+    , m_flushTimer(new QTimer(this))
+    , m_recordsWritten(0)
+    , m_stringsWritten(0)
+{
+    m_strings.append(QString());
+    m_stringIds.insert(QString(), 0);
+
+    m_flushTimer->setInterval(FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, [this]() { writePending(false); });
+
+    QElapsedTimer timer;
+    timer.start();
+    if (load()) {
+        qDebug() << "Mod action log:" << m_records.size() << "actions," << m_strings.size()
+                 << "strings loaded in" << timer.elapsed() << "ms";
+    }
+}
+
+ModActionLog::~ModActionLog()
+{
+    writePending(true);
+}
+
+bool ModActionLog::load()
+{
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    m_file.setFileName(m_path);
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Mod action log: cannot open" << m_path << m_file.errorString()
+                   << "- actions are kept for this session only";
+        return false;
+    }
+    if (m_file.size() == 0) {
+        QDataStream out(&m_file);
+        out.setVersion(QDataStream::Qt_6_5);
+        out << LOG_MAGIC << LOG_VERSION;
+        m_file.flush();
+        return true;
+    }
+
+    // One read, then parse from memory
+    const QByteArray bytes = m_file.readAll();
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_6_5);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != LOG_MAGIC || version != LOG_VERSION) {
+        // Not ours to overwrite; log this session in memory only
+        qWarning() << "Mod action log: unknown file format in" << m_path;
+        m_file.close();
+        return false;
+    }
+
+    qint64 goodEnd = in.device()->pos();
+    while (!in.atEnd()) {
+        QByteArray payload;
+        in >> payload;
+        if (in.status() != QDataStream::Ok) {
+            qWarning() << "Mod action log: dropping a partial record at the end of the file";
+            break;
+        }
+
+        QDataStream record(payload);
+        record.setVersion(QDataStream::Qt_6_5);
+        quint8 type = 0;
+        record >> type;
+        if (type == StringRecord) {
+            QByteArray utf8;
+            record >> utf8;
+            const QString string = QString::fromUtf8(utf8);
+            m_stringIds.insert(string, quint32(m_strings.size()));
+            m_strings.append(string);
+        } else if (type == ActionRecord) {
+            Record entry;
+            record >> entry.timeMs >> entry.kind >> entry.sources >> entry.channel
+                   >> entry.targetLogin >> entry.targetId >> entry.moderatorLogin
+                   >> entry.reason >> entry.messageId >> entry.messageText >> entry.durationSeconds;
+            const quint32 strings = quint32(m_strings.size());
+            if (record.status() != QDataStream::Ok || entry.kind > ModAction::ClearChat
+                || entry.channel >= strings || entry.targetLogin >= strings || entry.targetId >= strings
+                || entry.moderatorLogin >= strings || entry.reason >= strings
+                || entry.messageId >= strings || entry.messageText >= strings) {
+                continue;
+            }
+            m_records.push_back(entry);
+            index(quint32(m_records.size() - 1));
+        }
+        goodEnd = in.device()->pos();
+    }
+
+    if (goodEnd < m_file.size()) {
+        m_file.resize(goodEnd);
+    }
+    m_file.seek(goodEnd);
+    m_recordsWritten = m_records.size();
+    m_stringsWritten = int(m_strings.size());
+    return true;
+}
+
+quint32 ModActionLog::intern(const QString &text)
+{
+    auto it = m_stringIds.constFind(text);
+    if (it != m_stringIds.constEnd()) {
+        return it.value();
+    }
+    const quint32 id = quint32(m_strings.size());
+    m_strings.append(text);
+    m_stringIds.insert(text, id);
+    return id;
+}
+
+const QString &ModActionLog::text(quint32 id) const
+{
+    return m_strings.at(int(id));
+}
+
+void ModActionLog::index(quint32 number)
+{
+    const Record &entry = m_records[number];
+    if (entry.targetLogin != 0) {
+        m_byTarget[entry.targetLogin].push_back(number);
+    }
+    if (entry.moderatorLogin != 0) {
+        m_byModerator[entry.moderatorLogin].push_back(number);
+    }
+}
+
+ModAction ModActionLog::decode(const Record &entry) const
+{
+    ModAction action;
+    action.timeMs = entry.timeMs;
+    action.kind = ModAction::Kind(entry.kind);
+    action.sources = entry.sources;
+    action.channel = text(entry.channel);
+    action.targetLogin = text(entry.targetLogin);
+    action.targetId = text(entry.targetId);
+    action.moderatorLogin = text(entry.moderatorLogin);
+    action.durationSeconds = entry.durationSeconds;
+    action.reason = text(entry.reason);
+    action.messageId = text(entry.messageId);
+    action.messageText = text(entry.messageText);
+    return action;
+}
+
+void ModActionLog::record(ModAction action)
+{
+    if (action.timeMs == 0) {
+        action.timeMs = nowMs();
+    }
+    action.targetLogin = action.targetLogin.toLower();
+    action.moderatorLogin = action.moderatorLogin.toLower();
+    if (merge(action)) {
+        emit changed();
+        return;
+    }
+
+    // Records stay in time order even if the clock steps back
+    Record entry;
+    entry.timeMs = m_records.empty() ? action.timeMs : qMax(action.timeMs, m_records.back().timeMs);
+    entry.kind = action.kind;
+    entry.sources = action.sources;
+    entry.channel = intern(action.channel);
+    entry.targetLogin = intern(action.targetLogin);
+    entry.targetId = intern(action.targetId);
+    entry.moderatorLogin = intern(action.moderatorLogin);
+    entry.reason = intern(action.reason);
+    entry.messageId = intern(action.messageId);
+    entry.messageText = intern(action.messageText);
+    entry.durationSeconds = action.durationSeconds;
+    m_records.push_back(entry);
+    index(quint32(m_records.size() - 1));
+
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+    emit changed();
+}
+
+bool ModActionLog::merge(const ModAction &action)
+{
+    const quint32 channel = m_stringIds.value(action.channel, 0);
+    if (channel == 0 && !action.channel.isEmpty()) {
+        return false;
+    }
+
+    // Only entries still in the merge window, which are never on disk yet
+    for (size_t i = m_records.size(); i > m_recordsWritten; --i) {
+        const quint32 number = quint32(i - 1);
+        Record &entry = m_records[number];
+        if (entry.timeMs < action.timeMs - MERGE_MS) {
+            break;
+        }
+        if (entry.channel != channel || entry.kind != action.kind) {
+            continue;
+        }
+
+        bool same = false;
+        if (action.kind == ModAction::ClearChat) {
+            same = true;
+        } else if (action.kind == ModAction::DeleteMessage && entry.messageId != 0 && !action.messageId.isEmpty()) {
+            same = text(entry.messageId) == action.messageId;
+        } else if (entry.targetId != 0 && !action.targetId.isEmpty()) {
+            same = text(entry.targetId) == action.targetId;
+        } else if (entry.targetLogin != 0 && !action.targetLogin.isEmpty()) {
+            same = text(entry.targetLogin) == action.targetLogin;
+        }
+        if (!same) {
+            continue;
+        }
+
+        // Fill in what the earlier report didn't know
+        entry.sources |= action.sources;
+        if (entry.targetLogin == 0 && !action.targetLogin.isEmpty()) {
+            entry.targetLogin = intern(action.targetLogin);
+            insertSorted(m_byTarget[entry.targetLogin], number);
+        }
+        if (entry.moderatorLogin == 0 && !action.moderatorLogin.isEmpty()) {
+            entry.moderatorLogin = intern(action.moderatorLogin);
+            insertSorted(m_byModerator[entry.moderatorLogin], number);
+        }
+        if (entry.targetId == 0) {
+            entry.targetId = intern(action.targetId);
+        }
+        if (entry.reason == 0) {
+            entry.reason = intern(action.reason);
+        }
+        if (entry.messageId == 0) {
+            entry.messageId = intern(action.messageId);
+        }
+        if (entry.messageText == 0) {
+            entry.messageText = intern(action.messageText);
+        }
+        if (entry.durationSeconds == 0) {
+            entry.durationSeconds = action.durationSeconds;
+        }
+        return true;
+    }
+    return false;
+}
+
+QList<ModAction> ModActionLog::collect(const std::vector<quint32> *numbers, const QString &channel,
+                                       int limit) const
+{
+    QList<ModAction> actions;
+    if (!numbers) {
+        return actions;
+    }
+    const quint32 channelId = m_stringIds.value(channel, 0);
+    if (!channel.isEmpty() && channelId == 0) {
+        return actions;
+    }
+    for (auto it = numbers->rbegin(); it != numbers->rend(); ++it) {
+        const Record &entry = m_records[*it];
+        if (!channel.isEmpty() && entry.channel != channelId) {
+            continue;
+        }
+        actions.append(decode(entry));
+        if (limit >= 0 && actions.size() >= limit) {
+            break;
+        }
+    }
+    return actions;
+}
+
+QList<ModAction> ModActionLog::byTarget(const QString &login, const QString &channel, int limit) const
+{
+    auto key = m_stringIds.constFind(login.toLower());
+    if (key == m_stringIds.constEnd()) {
+        return QList<ModAction>();
+    }
+    auto it = m_byTarget.constFind(key.value());
+    return collect(it == m_byTarget.constEnd() ? nullptr : &it.value(), channel, limit);
+}
+
+QList<ModAction> ModActionLog::byModerator(const QString &login, const QString &channel, int limit) const
+{
+    auto key = m_stringIds.constFind(login.toLower());
+    if (key == m_stringIds.constEnd()) {
+        return QList<ModAction>();
+    }
+    auto it = m_byModerator.constFind(key.value());
+    return collect(it == m_byModerator.constEnd() ? nullptr : &it.value(), channel, limit);
+}
+
+QList<ModAction> ModActionLog::between(qint64 fromMs, qint64 toMs, const QString &channel, int limit) const
+{
+    QList<ModAction> actions;
+    const quint32 channelId = m_stringIds.value(channel, 0);
+    if (!channel.isEmpty() && channelId == 0) {
+        return actions;
+    }
+
+    auto first = std::lower_bound(m_records.begin(), m_records.end(), fromMs,
+                                  [](const Record &entry, qint64 ms) { return entry.timeMs < ms; });
+    auto last = std::upper_bound(first, m_records.end(), toMs,
+                                 [](qint64 ms, const Record &entry) { return ms < entry.timeMs; });
+    while (last != first) {
+        --last;
+        if (!channel.isEmpty() && last->channel != channelId) {
+            continue;
+        }
+        actions.append(decode(*last));
+        if (limit >= 0 && actions.size() >= limit) {
+            break;
+        }
+    }
+    return actions;
+}
+
+int ModActionLog::count() const
+{
+    return int(m_records.size());
+}
+
+void ModActionLog::writePending(bool all)
+{
+    const qint64 settledBefore = nowMs() - MERGE_MS;
+    size_t end = m_recordsWritten;
+    while (end < m_records.size() && (all || m_records[end].timeMs < settledBefore)) {
+        ++end;
+    }
+    if (end == m_recordsWritten) {
+        if (m_recordsWritten == m_records.size()) {
+            m_flushTimer->stop();
+        }
+        return;
+    }
+    if (!m_file.isOpen()) {
+        m_recordsWritten = end;
+        return;
+    }
+
+    // Strings are numbered in the order they were interned, so writing all
+    // new ones keeps the file's numbering equal to ours
+    QByteArray buffer;
+    for (; m_stringsWritten < m_strings.size(); ++m_stringsWritten) {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_5);
+        out << quint8(StringRecord) << m_strings.at(m_stringsWritten).toUtf8();
+        buffer.append(frame(payload));
+    }
+    for (; m_recordsWritten < end; ++m_recordsWritten) {
+        const Record &entry = m_records[m_recordsWritten];
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_5);
+        out << quint8(ActionRecord) << entry.timeMs << entry.kind << entry.sources << entry.channel
+            << entry.targetLogin << entry.targetId << entry.moderatorLogin
+            << entry.reason << entry.messageId << entry.messageText << entry.durationSeconds;
+        buffer.append(frame(payload));
+    }
+
+    if (m_file.write(buffer) != buffer.size()) {
+        qWarning() << "Mod action log: write failed" << m_file.errorString();
+    }
+    m_file.flush();
+}
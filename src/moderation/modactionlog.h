@@ -0,0 +1,132 @@
+#ifndef MODACTIONLOG_H
+#define MODACTIONLOG_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QFile>
+#include <QTimer>
+#include <vector>
+
+// One moderation action, issued by us or seen in chat
+struct ModAction {
+    enum Kind : quint8 {
+        Ban,
+        Timeout,
+        Unban,
+        DeleteMessage,
+        ClearChat
+    };
+
+    // Where the action was seen; one action reported by several sources
+    // is merged into a single entry
+    enum Source : quint8 {
+        Issued = 1,
+        Irc = 2,
+        EventSub = 4
+    };
+
+    qint64 timeMs = 0;
+    Kind kind = Ban;
+    quint8 sources = 0;
+    QString channel;
+    QString targetLogin;
+    QString targetId;
+    QString moderatorLogin;  // empty when only IRC saw it
+    int durationSeconds = 0; // Timeout only
+    QString reason;
+    QString messageId;       // DeleteMessage only
+    QString messageText;
+
+    static QString kindName(Kind kind);
+};
+
+// Every moderation action in every channel, kept for good.
+//
+// Entries live in memory as fixed-size records whose strings (channels,
+// logins, ids, reasons) are interned in one table, so a login that shows up
+// in thousands of actions is stored once. Next to the records, which are in
+// time order, sit two secondary indexes: target login and moderator login
+// (lowercased when recorded) -> record numbers. "Everything against X" is
+// one hash lookup plus a walk over X's records, time ranges are a binary
+// search.
+//
+// The same ban usually arrives two or three times (our own call, IRC
+// CLEARCHAT, EventSub channel.ban). Reports of the same kind against the
+// same account in the same channel within MERGE_MS fill in the first
+// entry instead of adding another one.
+//
+// On disk it is an append-only file of length-prefixed records: a string
+// record the first time a string is used, then small action records that
+// refer to strings by number. Entries are appended once they are out of
+// the merge window, at most every FLUSH_INTERVAL_MS.
+class ModActionLog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModActionLog(const QString &path, QObject *parent = nullptr);
+    ~ModActionLog() override;
+
+    void record(ModAction action);
+
+    // Newest first; empty channel = all channels, limit < 0 = all
+    QList<ModAction> byTarget(const QString &login, const QString &channel = QString(),
+                              int limit = -1) const;
+    QList<ModAction> byModerator(const QString &login, const QString &channel = QString(),
+                                 int limit = -1) const;
+    QList<ModAction> between(qint64 fromMs, qint64 toMs, const QString &channel = QString(),
+                             int limit = -1) const;
+
+    int count() const;
+
+    static constexpr qint64 MERGE_MS = 10 * 1000;
+    static constexpr int FLUSH_INTERVAL_MS = 2000;
+
+signals:
+    // New entry, or more details for a recent one
+    void changed();
+
+private:
+    struct Record {
+        qint64 timeMs = 0;
+        quint32 channel = 0;
+        quint32 targetLogin = 0;
+        quint32 targetId = 0;
+        quint32 moderatorLogin = 0;
+        quint32 reason = 0;
+        quint32 messageId = 0;
+        quint32 messageText = 0;
+        qint32 durationSeconds = 0;
+        quint8 kind = 0;
+        quint8 sources = 0;
+    };
+
+    quint32 intern(const QString &text);
+    const QString &text(quint32 id) const;
+    ModAction decode(const Record &record) const;
+    void index(quint32 number);
+    bool merge(const ModAction &action);
+    QList<ModAction> collect(const std::vector<quint32> *numbers, const QString &channel,
+                             int limit) const;
+
+    bool load();
+    void writePending(bool all);
+
+    QString m_path;
+    QFile m_file;
+    QTimer *m_flushTimer;
+
+    std::vector<Record> m_records;                      // time order
+    QStringList m_strings;                              // 0 = empty string
+    QHash<QString, quint32> m_stringIds;
+    QHash<quint32, std::vector<quint32>> m_byTarget;    // login -> record numbers
+    QHash<quint32, std::vector<quint32>> m_byModerator; // login -> record numbers
+
+    size_t m_recordsWritten;
+    int m_stringsWritten;
+};
+
+#endif // MODACTIONLOG_H
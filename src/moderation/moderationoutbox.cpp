@@ -0,0 +1,511 @@
+#include "moderationoutbox.h"
+#include "twitch/twitchapi.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMetaObject>
+#include <QSaveFile>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr quint32 JOURNAL_MAGIC = 0x544d4f31; // "TMO1"
+constexpr quint32 JOURNAL_VERSION = 1;
+
+enum RecordType : quint8 {
+    QueuedRecord = 1,
+    FinishedRecord = 2
+};
+
+qint64 nowMs()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+QByteArray encodeQueued(const OutboxAction &action)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << quint8(QueuedRecord) << action.id << quint8(action.kind)
+        << action.broadcasterId << action.moderatorId << action.targetId
+        << qint32(action.durationSeconds) << action.reason << action.createdMs;
+    return bytes;
+}
+
+QByteArray encodeFinished(quint64 id)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << quint8(FinishedRecord) << id;
+    return bytes;
+}
+
+// Records go into the journal length-prefixed, so a torn tail is detected
+QByteArray frame(const QByteArray &payload)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << payload;
+    return bytes;
+}
+}
+
+QString OutboxAction::key() const
+{
+    switch (kind) {
+    case Ban:
+    case Timeout:
+    case Unban:
+        return "user/" + broadcasterId + "/" + targetId;
+    case DeleteMessage:
+        return "delete/" + broadcasterId + "/" + targetId;
+    }
+    return QString();
+}
+
+ModerationOutbox::ModerationOutbox(TwitchAPI *api, const QString &path, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_path(path)
+    , m_flushScheduled(false)
+    , m_ready(false)
+    , m_nextId(1)
+{
+    if (!openJournal()) {
+        return;
+    }
+
+    // Open actions from the last session wait for resume(); the journal is
+    // rewritten down to them so it never grows across sessions. Ids are in
+    // submission order, so chaining them in id order restores the order
+    // of actions on the same account.
+    m_waiting = m_entries.keys();
+    std::sort(m_waiting.begin(), m_waiting.end());
+    for (quint64 id : std::as_const(m_waiting)) {
+        Entry &entry = m_entries[id];
+        entry.promise = std::make_shared<QPromise<ApiReply>>();
+        entry.promise->start();
+        chain(entry);
+    }
+    m_stats.replayed = quint64(m_waiting.size());
+    rewriteJournal();
+
+    qDebug() << "Moderation outbox:" << m_waiting.size() << "actions to replay";
+}
+
+ModerationOutbox::~ModerationOutbox()
+{
+    writeJournal();
+}
+
+bool ModerationOutbox::openJournal()
+{
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    m_journal.setFileName(m_path);
+    if (!m_journal.open(QIODevice::ReadWrite)) {
+        qWarning() << "Moderation outbox: cannot open" << m_path << m_journal.errorString()
+                   << "- actions are not journaled";
+        return false;
+    }
+    if (m_journal.size() == 0) {
+        return true;
+    }
+
+    QDataStream in(&m_journal);
+    in.setVersion(QDataStream::Qt_6_5);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != JOURNAL_MAGIC || version != JOURNAL_VERSION) {
+        qWarning() << "Moderation outbox: unknown journal format, starting empty";
+        return true;
+    }
+
+    while (!in.atEnd()) {
+        QByteArray payload;
+        in >> payload;
+        if (in.status() != QDataStream::Ok) {
+            // A crash mid-append; rewriteJournal() drops the rest
+            qWarning() << "Moderation outbox: ignoring a partial record at the end of the journal";
+            break;
+        }
+
+        QDataStream record(payload);
+        record.setVersion(QDataStream::Qt_6_5);
+        quint8 type = 0;
+        quint64 id = 0;
+        record >> type >> id;
+        if (type == QueuedRecord) {
+            Entry entry;
+            quint8 kind = 0;
+            qint32 duration = 0;
+            record >> kind >> entry.action.broadcasterId >> entry.action.moderatorId
+                   >> entry.action.targetId >> duration >> entry.action.reason >> entry.action.createdMs;
+            if (record.status() != QDataStream::Ok || kind > OutboxAction::DeleteMessage) {
+                continue;
+            }
+            entry.action.id = id;
+            entry.action.kind = OutboxAction::Kind(kind);
+            entry.action.durationSeconds = duration;
+            m_entries.insert(id, entry);
+        } else if (type == FinishedRecord) {
+            m_entries.remove(id);
+        }
+        m_nextId = qMax(m_nextId, id + 1);
+    }
+    return true;
+}
+
+void ModerationOutbox::rewriteJournal()
+{
+    if (!m_journal.isOpen()) {
+        return;
+    }
+    writeJournal();
+
+    QSaveFile out(m_path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning() << "Moderation outbox: cannot rewrite journal" << out.errorString();
+        return;
+    }
+    QDataStream stream(&out);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream << JOURNAL_MAGIC << JOURNAL_VERSION;
+
+    QList<quint64> ids = m_entries.keys();
+    std::sort(ids.begin(), ids.end());
+    for (quint64 id : std::as_const(ids)) {
+        stream << encodeQueued(m_entries.value(id).action);
+    }
+
+    m_journal.close();
+    if (!out.commit()) {
+        qWarning() << "Moderation outbox: journal rewrite failed" << out.errorString();
+    }
+    if (!m_journal.open(QIODevice::ReadWrite)) {
+        qWarning() << "Moderation outbox: cannot reopen" << m_path << m_journal.errorString();
+        return;
+    }
+    m_journal.seek(m_journal.size());
+}
+
+void ModerationOutbox::appendQueued(const OutboxAction &action)
+{
+    m_buffer.append(frame(encodeQueued(action)));
+    ++m_stats.journaled;
+    scheduleFlush();
+}
+
+void ModerationOutbox::appendFinished(quint64 id)
+{
+    m_buffer.append(frame(encodeFinished(id)));
+    scheduleFlush();
+}
+
+void ModerationOutbox::scheduleFlush()
+{
+    if (m_flushScheduled) {
+        return;
+    }
+    m_flushScheduled = true;
+    QMetaObject::invokeMethod(this, &ModerationOutbox::flushJournal, Qt::QueuedConnection);
+}
+
+void ModerationOutbox::writeJournal()
+{
+    if (m_buffer.isEmpty()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    if (m_journal.isOpen()
+            && (m_journal.write(m_buffer) != m_buffer.size() || !m_journal.flush())) {
+        qWarning() << "Moderation outbox: journal write failed" << m_journal.errorString();
+    }
+    m_buffer.clear();
+
+    const qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+    ++m_stats.writes;
+    m_stats.writeTotalUs += elapsedUs;
+    m_stats.writeMaxUs = qMax(m_stats.writeMaxUs, elapsedUs);
+}
+
+void ModerationOutbox::flushJournal()
+{
+    m_flushScheduled = false;
+    writeJournal();
+
+    // Only now is every action of this pass on disk
+    const QList<quint64> written = m_unsent;
+    m_unsent.clear();
+    for (quint64 id : written) {
+        if (!m_entries.contains(id)) {
+            continue;
+        }
+        if (!m_ready) {
+            m_waiting.append(id);
+        } else if (!isBlocked(m_entries.value(id))) {
+            send(id); // blocked ones go when the action before them finishes
+        }
+    }
+
+    if (m_entries.isEmpty() && m_journal.size() > COMPACT_BYTES) {
+        rewriteJournal();
+    }
+}
+
+QFuture<ApiReply> ModerationOutbox::ban(const QString &broadcasterId, const QString &moderatorId,
+                                        const QString &userId, const QString &reason)
+{
+    OutboxAction action;
+    action.kind = OutboxAction::Ban;
+    action.broadcasterId = broadcasterId;
+    action.moderatorId = moderatorId;
+    action.targetId = userId;
+    action.reason = reason;
+    return submit(action);
+}
+
+QFuture<ApiReply> ModerationOutbox::timeout(const QString &broadcasterId, const QString &moderatorId,
+                                            const QString &userId, int durationSeconds,
+                                            const QString &reason)
+{
+    OutboxAction action;
+    action.kind = OutboxAction::Timeout;
+    action.broadcasterId = broadcasterId;
+    action.moderatorId = moderatorId;
+    action.targetId = userId;
+    action.durationSeconds = durationSeconds;
+    action.reason = reason;
+    return submit(action);
+}
+
+QFuture<ApiReply> ModerationOutbox::unban(const QString &broadcasterId, const QString &moderatorId,
+                                          const QString &userId)
+{
+    OutboxAction action;
+    action.kind = OutboxAction::Unban;
+    action.broadcasterId = broadcasterId;
+    action.moderatorId = moderatorId;
+    action.targetId = userId;
+    return submit(action);
+}
+
+QFuture<ApiReply> ModerationOutbox::deleteMessage(const QString &broadcasterId, const QString &moderatorId,
+                                                  const QString &messageId)
+{
+    OutboxAction action;
+    action.kind = OutboxAction::DeleteMessage;
+    action.broadcasterId = broadcasterId;
+    action.moderatorId = moderatorId;
+    action.targetId = messageId;
+    return submit(action);
+}
+
+bool ModerationOutbox::collapses(const OutboxAction &pending, const OutboxAction &action) const
+{
+    // A pending ban covers any later ban or timeout, a pending timeout
+    // covers timeouts that are not longer
+    if (pending.kind == OutboxAction::Ban) {
+        return action.kind == OutboxAction::Ban || action.kind == OutboxAction::Timeout;
+    }
+    if (pending.kind == OutboxAction::Timeout) {
+        return action.kind == OutboxAction::Timeout && action.durationSeconds <= pending.durationSeconds;
+    }
+    return pending.kind == action.kind;
+}
+
+QFuture<ApiReply> ModerationOutbox::submit(OutboxAction action)
+{
+    const QString key = action.key();
+    auto pending = m_byKey.constFind(key);
+    if (pending != m_byKey.constEnd()) {
+        const Entry &entry = m_entries[pending.value()];
+        if (collapses(entry.action, action)) {
+            ++m_stats.collapsed;
+            return entry.promise->future();
+        }
+    }
+
+    action.id = m_nextId++;
+    action.createdMs = nowMs();
+
+    Entry entry;
+    entry.action = action;
+    entry.promise = std::make_shared<QPromise<ApiReply>>();
+    entry.promise->start();
+    chain(entry);
+    m_entries.insert(action.id, entry);
+
+    appendQueued(action);
+    m_unsent.append(action.id);
+    return entry.promise->future();
+}
+
+// Queues entry behind the newest pending action on its key
+void ModerationOutbox::chain(Entry &entry)
+{
+    const QString key = entry.action.key();
+    auto last = m_entries.find(m_byKey.value(key));
+    if (last != m_entries.end() && last.key() != entry.action.id) {
+        last->next = entry.action.id;
+        entry.after = last.key();
+    }
+    m_byKey.insert(key, entry.action.id);
+}
+
+bool ModerationOutbox::isBlocked(const Entry &entry) const
+{
+    return entry.after != 0 && m_entries.contains(entry.after);
+}
+
+void ModerationOutbox::resume()
+{
+    if (m_ready) {
+        return;
+    }
+    m_ready = true;
+
+    const QList<quint64> waiting = m_waiting;
+    m_waiting.clear();
+    int replaying = 0;
+    for (quint64 id : waiting) {
+        auto it = m_entries.find(id);
+        // Started by an earlier one finishing, or waiting for one
+        if (it == m_entries.end() || it->attempts > 0 || isBlocked(*it)) {
+            continue;
+        }
+        if (isStale(it->action)) {
+            ++m_stats.expired;
+            ApiReply reply;
+            reply.error = "Too old to replay";
+            finish(id, reply);
+            continue;
+        }
+        ++replaying;
+        send(id);
+    }
+    if (replaying > 0) {
+        emit replayStarted(replaying);
+    }
+}
+
+bool ModerationOutbox::isStale(const OutboxAction &action) const
+{
+    const qint64 ageMs = nowMs() - action.createdMs;
+    if (action.kind == OutboxAction::Timeout && ageMs >= qint64(action.durationSeconds) * 1000) {
+        return true;
+    }
+    return ageMs > MAX_REPLAY_AGE_MS;
+}
+
+void ModerationOutbox::send(quint64 id)
+{
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+        return;
+    }
+    ++it->attempts;
+    const OutboxAction &action = it->action;
+
+    switch (action.kind) {
+    case OutboxAction::Ban:
+        m_api->banUser(action.broadcasterId, action.moderatorId, action.targetId, action.reason)
+            .then(this, [this, id](const ApiResult<BanResult> &result) {
+                onReply(id, result);
+            });
+        break;
+    case OutboxAction::Timeout:
+        m_api->timeoutUser(action.broadcasterId, action.moderatorId, action.targetId,
+                           action.durationSeconds, action.reason)
+            .then(this, [this, id](const ApiResult<BanResult> &result) {
+                onReply(id, result);
+            });
+        break;
+    case OutboxAction::Unban:
+        m_api->unbanUser(action.broadcasterId, action.moderatorId, action.targetId)
+            .then(this, [this, id](const ApiReply &reply) {
+                onReply(id, reply);
+            });
+        break;
+    case OutboxAction::DeleteMessage:
+        m_api->deleteMessage(action.broadcasterId, action.moderatorId, action.targetId)
+            .then(this, [this, id](const ApiReply &reply) {
+                onReply(id, reply);
+            });
+        break;
+    }
+}
+
+void ModerationOutbox::onReply(quint64 id, const ApiReply &reply)
+{
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+        return;
+    }
+
+    // The scheduler has already retried these quickly; keep trying at a
+    // slower pace while the action still makes sense
+    const bool retryable = reply.statusCode == 0 || reply.statusCode == 429 || reply.statusCode >= 500;
+    if (!reply.ok() && retryable && it->attempts < MAX_ATTEMPTS && !isStale(it->action)) {
+        const qint64 delayMs = qMin(MAX_RETRY_MS, BASE_RETRY_MS << (it->attempts - 1));
+        ++m_stats.retries;
+        qWarning() << "Moderation outbox: retrying" << it->action.key() << "in" << delayMs << "ms ("
+                   << reply.error << ")";
+        QTimer::singleShot(int(delayMs), this, [this, id]() {
+            send(id);
+        });
+        return;
+    }
+    finish(id, reply);
+}
+
+void ModerationOutbox::finish(quint64 id, const ApiReply &reply)
+{
+    Entry entry = m_entries.take(id);
+    const QString key = entry.action.key();
+    if (m_byKey.value(key) == id) {
+        m_byKey.remove(key);
+    }
+    appendFinished(id);
+
+    // The next action on the same account can go now, unless its record
+    // is still on its way to the journal or sending has not resumed
+    auto next = m_entries.find(entry.next);
+    if (next != m_entries.end()) {
+        next->after = 0;
+        if (m_ready && next->attempts == 0 && !m_unsent.contains(next.key())) {
+            if (isStale(next->action)) {
+                ++m_stats.expired;
+                ApiReply expired;
+                expired.error = "Too old to replay";
+                finish(next.key(), expired);
+            } else {
+                send(next.key());
+            }
+        }
+    }
+
+    if (reply.ok()) {
+        ++m_stats.succeeded;
+    } else {
+        ++m_stats.failed;
+    }
+    entry.promise->addResult(reply);
+    entry.promise->finish();
+}
+
+OutboxStats ModerationOutbox::stats() const
+{
+    OutboxStats stats = m_stats;
+    stats.pending = int(m_entries.size());
+    stats.journalBytes = m_journal.isOpen() ? m_journal.size() : 0;
+    return stats;
+}
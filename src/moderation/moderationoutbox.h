@@ -0,0 +1,148 @@
+#ifndef MODERATIONOUTBOX_H
+#define MODERATIONOUTBOX_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QFile>
+#include <QFuture>
+#include <QPromise>
+#include <memory>
+#include "twitch/helixtypes.h"
+
+class TwitchAPI;
+
+// One journaled moderation call
+struct OutboxAction {
+    enum Kind : quint8 {
+        Ban,
+        Timeout,
+        Unban,
+        DeleteMessage
+    };
+
+    quint64 id = 0;
+    Kind kind = Ban;
+    QString broadcasterId;
+    QString moderatorId;
+    QString targetId;        // user id, or message id for DeleteMessage
+    int durationSeconds = 0; // Timeout only
+    QString reason;
+    qint64 createdMs = 0;    // wall clock, replays drop stale actions
+
+    // Actions with the same key act on the same thing; bans, timeouts
+    // and unbans of one account in one channel share a key
+    QString key() const;
+};
+
+struct OutboxStats {
+    int pending = 0;
+    quint64 journaled = 0;
+    quint64 collapsed = 0; // submitted while an equal or stronger one was pending
+    quint64 replayed = 0;  // loaded from the journal at startup
+    quint64 retries = 0;
+    quint64 succeeded = 0;
+    quint64 failed = 0;
+    quint64 expired = 0;   // too old to replay
+    quint64 writes = 0;    // journal appends, one per event loop pass
+    qint64 writeTotalUs = 0;
+    qint64 writeMaxUs = 0;
+    qint64 journalBytes = 0;
+};
+
+// Durable queue in front of TwitchAPI for bans, timeouts, unbans and
+// message deletions.
+//
+// Every action is appended to a journal file before it is sent and a
+// completion record follows once it has its final outcome, so actions
+// still open when the app crashes or is closed mid-raid are replayed
+// at the next login. Appends are grouped: everything submitted during one
+// event loop pass is written with a single write() and only then handed
+// to the scheduler, which keeps a 500-account batch in the low
+// milliseconds. The journal is flushed to the OS, not fsynced; it survives
+// the app going away, not the machine.
+//
+// Transport errors, 5xx and 429s that the scheduler gave up on are
+// retried here with a longer backoff. A ban or timeout of an account that
+// already has an equal or stronger action pending joins that action's
+// future instead of being sent twice. Any other action on the same
+// account waits until the pending one has finished, so a ban followed by
+// an unban reaches Twitch in that order.
+class ModerationOutbox : public QObject
+{
+    Q_OBJECT
+
+public:
+    ModerationOutbox(TwitchAPI *api, const QString &path, QObject *parent = nullptr);
+    ~ModerationOutbox();
+
+    QFuture<ApiReply> ban(const QString &broadcasterId, const QString &moderatorId,
+                          const QString &userId, const QString &reason = QString());
+    QFuture<ApiReply> timeout(const QString &broadcasterId, const QString &moderatorId,
+                              const QString &userId, int durationSeconds,
+                              const QString &reason = QString());
+    QFuture<ApiReply> unban(const QString &broadcasterId, const QString &moderatorId,
+                            const QString &userId);
+    QFuture<ApiReply> deleteMessage(const QString &broadcasterId, const QString &moderatorId,
+                                    const QString &messageId);
+    QFuture<ApiReply> submit(OutboxAction action);
+
+    // Starts sending, journal replays first. Until then actions are only
+    // journaled; call once the API has a token.
+    void resume();
+
+    OutboxStats stats() const;
+
+    static constexpr int MAX_ATTEMPTS = 6;
+    static constexpr qint64 BASE_RETRY_MS = 2000;
+    static constexpr qint64 MAX_RETRY_MS = 60 * 1000;
+    static constexpr qint64 MAX_REPLAY_AGE_MS = 60 * 60 * 1000;
+    static constexpr qint64 COMPACT_BYTES = 1024 * 1024;
+
+signals:
+    void replayStarted(int count);
+
+private:
+    struct Entry {
+        OutboxAction action;
+        std::shared_ptr<QPromise<ApiReply>> promise;
+        int attempts = 0;
+        quint64 after = 0; // pending action on the same key to wait for
+        quint64 next = 0;  // action waiting for this one
+    };
+
+    bool openJournal();
+    void rewriteJournal();
+    void appendQueued(const OutboxAction &action);
+    void appendFinished(quint64 id);
+    void scheduleFlush();
+    void writeJournal();
+    void flushJournal();
+
+    bool collapses(const OutboxAction &pending, const OutboxAction &action) const;
+    bool isStale(const OutboxAction &action) const;
+    bool isBlocked(const Entry &entry) const;
+    void chain(Entry &entry);
+    void send(quint64 id);
+    void onReply(quint64 id, const ApiReply &reply);
+    void finish(quint64 id, const ApiReply &reply);
+
+    TwitchAPI *m_api;
+    QString m_path;
+    QFile m_journal;
+    QByteArray m_buffer;      // records not written yet
+    QList<quint64> m_unsent;  // waiting for their record to reach the file
+    QList<quint64> m_waiting; // journaled, sent on resume()
+    bool m_flushScheduled;
+    bool m_ready;
+
+    QHash<quint64, Entry> m_entries;
+    QHash<QString, quint64> m_byKey; // key -> newest pending action id
+    quint64 m_nextId;
+
+    OutboxStats m_stats;
+};
+
+#endif // MODERATIONOUTBOX_H
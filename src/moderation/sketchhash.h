@@ -0,0 +1,41 @@
+#ifndef SKETCHHASH_H
+#define SKETCHHASH_H
+
+#include <QString>
+#include <QtGlobal>
+
+// 64-bit hashing shared by the streaming sketches (SimHash, HyperLogLog,
+// Count-Min). qHash() is seeded per process and only size_t wide, so the
+// sketches use their own stable, well-mixed hash instead.
+namespace SketchHash {
+
+// splitmix64 finalizer - full avalanche on all 64 bits
+inline quint64 mix64(quint64 x)
+{
+    x ^= x >> 30;
+    x *= Q_UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= Q_UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+    return x;
+}
+
+inline quint64 hash(const QChar *data, qsizetype length, quint64 seed = 0)
+{
+    // FNV-1a over UTF-16 code units, finalized with mix64
+    quint64 h = Q_UINT64_C(0xcbf29ce484222325) ^ seed;
+    for (qsizetype i = 0; i < length; ++i) {
+        h ^= data[i].unicode();
+        h *= Q_UINT64_C(0x100000001b3);
+    }
+    return mix64(h);
+}
+
+inline quint64 hash(const QString &text, quint64 seed = 0)
+{
+    return hash(text.constData(), text.size(), seed);
+}
+
+} // namespace SketchHash
+
+#endif // SKETCHHASH_H
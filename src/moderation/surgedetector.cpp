@@ -0,0 +1,127 @@
+#include "surgedetector.h"
+#include <cmath>
+
+QString SurgeAlert::metricName(Metric metric)
+{
+    switch (metric) {
+    case UniqueChatters:
+        return "unique chatters";
+    case FirstTimeChatters:
+        return "first-time chatters";
+    case Joins:
+        return "joins";
+    }
+    return QString();
+}
+
+SurgeDetector::SurgeDetector()
+    : SurgeDetector(Config())
+{
+}
+
+SurgeDetector::SurgeDetector(const Config &config)
+    : m_config(config)
+    , m_chatters{SlidingHyperLogLog(config.bucketMs, config.bucketCount), Baseline(),
+                 config.minUniqueChatters, SurgeAlert::UniqueChatters}
+    , m_firstTimers{SlidingHyperLogLog(config.bucketMs, config.bucketCount), Baseline(),
+                    config.minFirstTimeChatters, SurgeAlert::FirstTimeChatters}
+    , m_joins{SlidingHyperLogLog(config.bucketMs, config.bucketCount), Baseline(),
+              config.minJoins, SurgeAlert::Joins}
+{
+}
+
+QList<SurgeAlert> SurgeDetector::recordMessage(const ChatMessage &message)
+{
+    QList<SurgeAlert> alerts;
+    // Local receive time, as for joins: tmi-sent-ts is the server's clock
+    const qint64 now = message.receivedMs;
+
+    // Advance every counter so quiet metrics still close their windows
+    if (m_chatters.window.add(message.username, now)) {
+        evaluate(m_chatters, now, alerts);
+    }
+    if (message.isFirstMessage) {
+        if (m_firstTimers.window.add(message.username, now)) {
+            evaluate(m_firstTimers, now, alerts);
+        }
+    } else if (m_firstTimers.window.advance(now)) {
+        evaluate(m_firstTimers, now, alerts);
+    }
+    if (m_joins.window.advance(now)) {
+        evaluate(m_joins, now, alerts);
+    }
+
+    return alerts;
+}
+
+QList<SurgeAlert> SurgeDetector::recordJoin(const QString &username, qint64 now)
+{
+    QList<SurgeAlert> alerts;
+    if (m_joins.window.add(username, now)) {
+        evaluate(m_joins, now, alerts);
+    }
+    return alerts;
+}
+
+double SurgeDetector::perMinute(const Counter &counter, double windowValue) const
+{
+    return windowValue * 60000.0 / double(counter.window.windowMs());
+}
+
+void SurgeDetector::evaluate(Counter &counter, qint64 now, QList<SurgeAlert> &alerts)
+{
+    Baseline &b = counter.baseline;
+    const double value = perMinute(counter, counter.window.closedWindowEstimate());
+
+    // The first full window after joining contains the NAMES burst and
+    // a partially filled ring - don't learn from it.
+    if (b.skipped < m_config.bucketCount) {
+        ++b.skipped;
+        return;
+    }
+
+    bool spike = false;
+    if (b.samples >= m_config.warmupSamples) {
+        const double stddev = std::sqrt(b.variance);
+        spike = value >= counter.minimum
+             && value > b.mean + m_config.sigmaThreshold * stddev
+             && value > b.mean * m_config.ratioThreshold;
+
+        if (spike && now - b.lastAlert >= m_config.cooldownMs) {
+            b.lastAlert = now;
+            SurgeAlert alert;
+            alert.metric = counter.metric;
+            alert.perMinute = value;
+            alert.baseline = b.mean;
+            alerts.append(alert);
+        }
+    }
+
+    // EWMA mean and variance. Spikes are learned ten times slower so a raid
+    // doesn't become the new normal, but a channel that really grew adapts.
+    if (b.samples == 0) {
+        b.mean = value;
+        b.variance = 0.0;
+    } else {
+        const double a = spike ? m_config.smoothing * 0.1 : m_config.smoothing;
+        const double diff = value - b.mean;
+        b.mean += a * diff;
+        b.variance = (1.0 - a) * (b.variance + a * diff * diff);
+    }
+    ++b.samples;
+}
+
+double SurgeDetector::uniqueChattersPerMinute() const
+{
+    return perMinute(m_chatters, m_chatters.window.windowEstimate());
+}
+
+double SurgeDetector::firstTimeChattersPerMinute() const
+{
+    return perMinute(m_firstTimers, m_firstTimers.window.windowEstimate());
+}
+
+double SurgeDetector::joinsPerMinute() const
+{
+    return perMinute(m_joins, m_joins.window.windowEstimate());
+}
@@ -0,0 +1,82 @@
+#ifndef SURGEDETECTOR_H
+#define SURGEDETECTOR_H
+
+#include <QString>
+#include <QList>
+#include "hyperloglog.h"
+#include "twitch/chatmessage.h"
+
+struct SurgeAlert {
+    enum Metric {
+        UniqueChatters,
+        FirstTimeChatters,
+        Joins
+    };
+
+    Metric metric;
+    double perMinute = 0.0; // estimate over the window that just closed
+    double baseline = 0.0;  // learned mean for that window
+
+    static QString metricName(Metric metric);
+};
+
+// Raid / first-chatter surge detection for one channel.
+//
+// Unique chatters, first-message chatters ("first-msg" tag) and unique
+// joiners are counted with sliding HyperLogLog windows (6 x 10s buckets),
+// so memory stays at ~18 KiB per channel however large it is. Each time a
+// bucket closes, the one-minute estimate is compared against an EWMA
+// baseline (mean and variance) learned from earlier windows.
+class SurgeDetector
+{
+public:
+    struct Config {
+        qint64 bucketMs = 10000;
+        int bucketCount = 6;           // 6 x 10s = one-minute windows
+        double smoothing = 0.05;       // EWMA weight of each new sample
+        double sigmaThreshold = 4.0;   // spike = mean + k * stddev ...
+        double ratioThreshold = 3.0;   // ... and at least k x the mean
+        int warmupSamples = 12;        // samples learned before alerting
+        qint64 cooldownMs = 300000;    // one alert per metric per 5 minutes
+        double minUniqueChatters = 20.0;
+        double minFirstTimeChatters = 8.0;
+        double minJoins = 30.0;
+    };
+
+    SurgeDetector();
+    explicit SurgeDetector(const Config &config);
+
+    QList<SurgeAlert> recordMessage(const ChatMessage &message);
+    QList<SurgeAlert> recordJoin(const QString &username, qint64 now);
+
+    // Current (open) one-minute window estimates
+    double uniqueChattersPerMinute() const;
+    double firstTimeChattersPerMinute() const;
+    double joinsPerMinute() const;
+
+private:
+    struct Baseline {
+        double mean = 0.0;
+        double variance = 0.0;
+        int samples = 0;
+        int skipped = 0;
+        qint64 lastAlert = 0;
+    };
+
+    struct Counter {
+        SlidingHyperLogLog window;
+        Baseline baseline;
+        double minimum;
+        SurgeAlert::Metric metric;
+    };
+
+    void evaluate(Counter &counter, qint64 now, QList<SurgeAlert> &alerts);
+    double perMinute(const Counter &counter, double windowValue) const;
+
+    Config m_config;
+    Counter m_chatters;
+    Counter m_firstTimers;
+    Counter m_joins;
+};
+
+#endif // SURGEDETECTOR_H
@@ -0,0 +1,571 @@
+#include "textfeatures.h"
+#include <QtAlgorithms>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define TEXTFEATURES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define TEXTFEATURES_TARGET_SSE2
+#define TEXTFEATURES_TARGET_AVX2
+#else
+#define TEXTFEATURES_TARGET_SSE2 __attribute__((target("sse2")))
+#define TEXTFEATURES_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+bool TextFeatures::operator==(const TextFeatures &other) const
+{
+    return length == other.length
+        && uppercase == other.uppercase
+        && lowercase == other.lowercase
+        && digits == other.digits
+        && spaces == other.spaces
+        && symbols == other.symbols
+        && nonAscii == other.nonAscii
+        && combining == other.combining
+        && repeated == other.repeated
+        && longestRun == other.longestRun
+        && urlHits == other.urlHits;
+}
+
+namespace {
+
+struct ScanState {
+    TextFeatures features;
+    int currentRun = 0;
+};
+
+inline bool isCombiningMark(quint16 c)
+{
+    return (c >= 0x0300 && c <= 0x036F)
+        || (c >= 0x1AB0 && c <= 0x1AFF)
+        || (c >= 0x1DC0 && c <= 0x1DFF)
+        || (c >= 0x20D0 && c <= 0x20FF)
+        || (c >= 0xFE20 && c <= 0xFE2F);
+}
+
+// Reference implementation for a single code unit. The SIMD kernels use it
+// for the head and tail of the buffer, so it must stay the single source of
+// truth for what every counter means.
+inline void scanOne(const quint16 *s, qsizetype i, qsizetype n, ScanState &st)
+{
+    TextFeatures &f = st.features;
+    const quint16 c = s[i];
+
+    if (c >= 'A' && c <= 'Z') {
+        ++f.uppercase;
+    } else if (c >= 'a' && c <= 'z') {
+        ++f.lowercase;
+    } else if (c >= '0' && c <= '9') {
+        ++f.digits;
+    } else if (c == ' ') {
+        ++f.spaces;
+    } else if (c >= 0x21 && c <= 0x7E) {
+        ++f.symbols;
+    } else if (c >= 0x80) {
+        ++f.nonAscii;
+        if (isCombiningMark(c)) {
+            ++f.combining;
+        }
+    }
+
+    if (i > 0 && s[i - 1] == c) {
+        ++f.repeated;
+        ++st.currentRun;
+    } else {
+        st.currentRun = 1;
+    }
+    f.longestRun = qMax(f.longestRun, st.currentRun);
+
+    if (c == ':' && i + 2 < n && s[i + 1] == '/' && s[i + 2] == '/') {
+        ++f.urlHits;
+    } else if ((c | 0x20) == 'w' && i + 3 < n
+               && (s[i + 1] | 0x20) == 'w'
+               && (s[i + 2] | 0x20) == 'w'
+               && s[i + 3] == '.') {
+        ++f.urlHits;
+    }
+}
+
+// Folds a per-element "equal to predecessor" bitmask into the run state.
+// Bit k set means element k continues the run of element k - 1.
+inline void applyRunMask(ScanState &st, quint32 eqMask, int width)
+{
+    const quint32 full = (width >= 32) ? 0xFFFFFFFFu : ((1u << width) - 1);
+    TextFeatures &f = st.features;
+
+    if (eqMask == 0) {
+        st.currentRun = 1;
+        return;
+    }
+    if (eqMask == full) {
+        st.currentRun += width;
+        f.longestRun = qMax(f.longestRun, st.currentRun);
+        return;
+    }
+
+    // Ones at the bottom extend the run carried in from the previous block
+    const int prefix = int(qCountTrailingZeroBits(~eqMask));
+    f.longestRun = qMax(f.longestRun, st.currentRun + prefix);
+
+    // Longest run of ones strictly inside the block; each such run follows
+    // a zero bit, which is the run's first element.
+    quint32 inner = eqMask >> prefix;
+    int innerLength = 0;
+    while (inner) {
+        inner &= inner >> 1;
+        ++innerLength;
+    }
+    if (innerLength > 0) {
+        f.longestRun = qMax(f.longestRun, innerLength + 1);
+    }
+
+    // Ones at the top carry over into the next block
+    const quint32 zeros = ~eqMask & full;
+    const int highestZero = 31 - int(qCountLeadingZeroBits(zeros));
+    st.currentRun = width - highestZero;
+}
+
+TextFeatures computeScalar(const quint16 *s, qsizetype n)
+{
+    ScanState st;
+    st.features.length = int(n);
+    for (qsizetype i = 0; i < n; ++i) {
+        scanOne(s, i, n, st);
+    }
+    return st.features;
+}
+
+#ifdef TEXTFEATURES_X86
+
+// SIMD kernels keep one 16-bit counter lane per class and subtract the
+// all-ones compare results into it, so the hot loop never leaves vector
+// registers. Lanes are folded into the scalar counters every
+// FLUSH_BLOCKS blocks, well before a 16-bit lane could overflow.
+constexpr int FLUSH_BLOCKS = 4096;
+
+// ---------------------------------------------------------------------------
+// SSE2: 8 code units per block
+// ---------------------------------------------------------------------------
+
+struct Sse2Counters {
+    __m128i uppercase;
+    __m128i lowercase;
+    __m128i digits;
+    __m128i spaces;
+    __m128i symbols;
+    __m128i nonAscii;
+    __m128i combining;
+    __m128i repeated;
+    __m128i urlHits;
+};
+
+TEXTFEATURES_TARGET_SSE2
+static inline __m128i sse2InRange(__m128i v, quint16 lo, quint16 hi)
+{
+    // Unsigned (v - lo) < (hi - lo + 1), via the sign-bias trick since SSE2
+    // only has signed 16-bit compares.
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+    __m128i d = _mm_xor_si128(_mm_sub_epi16(v, _mm_set1_epi16(static_cast<short>(lo))), bias);
+    __m128i limit = _mm_set1_epi16(static_cast<short>((hi - lo + 1) ^ 0x8000));
+    return _mm_cmplt_epi16(d, limit);
+}
+
+TEXTFEATURES_TARGET_SSE2
+static inline __m128i sse2Eq(__m128i v, quint16 c)
+{
+    return _mm_cmpeq_epi16(v, _mm_set1_epi16(static_cast<short>(c)));
+}
+
+TEXTFEATURES_TARGET_SSE2
+static inline int sse2Sum(__m128i lanes)
+{
+    __m128i sums = _mm_madd_epi16(lanes, _mm_set1_epi16(1));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sums);
+}
+
+TEXTFEATURES_TARGET_SSE2
+static inline void sse2Reset(Sse2Counters &acc)
+{
+    acc.uppercase = acc.lowercase = acc.digits = _mm_setzero_si128();
+    acc.spaces = acc.symbols = acc.nonAscii = _mm_setzero_si128();
+    acc.combining = acc.repeated = acc.urlHits = _mm_setzero_si128();
+}
+
+TEXTFEATURES_TARGET_SSE2
+static void sse2Flush(Sse2Counters &acc, TextFeatures &f)
+{
+    f.uppercase += sse2Sum(acc.uppercase);
+    f.lowercase += sse2Sum(acc.lowercase);
+    f.digits += sse2Sum(acc.digits);
+    f.spaces += sse2Sum(acc.spaces);
+    f.symbols += sse2Sum(acc.symbols);
+    f.nonAscii += sse2Sum(acc.nonAscii);
+    f.combining += sse2Sum(acc.combining);
+    f.repeated += sse2Sum(acc.repeated);
+    f.urlHits += sse2Sum(acc.urlHits);
+    sse2Reset(acc);
+}
+
+TEXTFEATURES_TARGET_SSE2
+static inline void sse2Block(const quint16 *s, qsizetype i, Sse2Counters &acc, ScanState &st)
+{
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i));
+    const __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i - 1));
+
+    const __m128i upper = sse2InRange(c, 'A', 'Z');
+    const __m128i lower = sse2InRange(c, 'a', 'z');
+    const __m128i digit = sse2InRange(c, '0', '9');
+    const __m128i printable = sse2InRange(c, 0x21, 0x7E);
+    const __m128i ascii = sse2InRange(c, 0x00, 0x7F);
+
+    acc.uppercase = _mm_sub_epi16(acc.uppercase, upper);
+    acc.lowercase = _mm_sub_epi16(acc.lowercase, lower);
+    acc.digits = _mm_sub_epi16(acc.digits, digit);
+    acc.spaces = _mm_sub_epi16(acc.spaces, sse2Eq(c, ' '));
+    acc.symbols = _mm_sub_epi16(acc.symbols,
+                                _mm_andnot_si128(_mm_or_si128(upper, _mm_or_si128(lower, digit)),
+                                                 printable));
+
+    // Combining marks only exist outside ASCII; skip the range checks for
+    // the common all-ASCII block.
+    if (_mm_movemask_epi8(ascii) != 0xFFFF) {
+        acc.nonAscii = _mm_sub_epi16(acc.nonAscii, _mm_andnot_si128(ascii, _mm_set1_epi16(-1)));
+        __m128i comb = sse2InRange(c, 0x0300, 0x036F);
+        comb = _mm_or_si128(comb, sse2InRange(c, 0x1AB0, 0x1AFF));
+        comb = _mm_or_si128(comb, sse2InRange(c, 0x1DC0, 0x1DFF));
+        comb = _mm_or_si128(comb, sse2InRange(c, 0x20D0, 0x20FF));
+        comb = _mm_or_si128(comb, sse2InRange(c, 0xFE20, 0xFE2F));
+        acc.combining = _mm_sub_epi16(acc.combining, comb);
+    }
+
+    const __m128i eq = _mm_cmpeq_epi16(c, prev);
+    if (_mm_movemask_epi8(eq) == 0) {
+        st.currentRun = 1;
+    } else {
+        acc.repeated = _mm_sub_epi16(acc.repeated, eq);
+        const quint32 mask = quint32(_mm_movemask_epi8(_mm_packs_epi16(eq, _mm_setzero_si128()))) & 0xFFu;
+        applyRunMask(st, mask, 8);
+    }
+
+    const __m128i n1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + 1));
+    const __m128i n2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + 2));
+    const __m128i n3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(s + i + 3));
+    const __m128i fold = _mm_set1_epi16(0x20);
+
+    __m128i scheme = _mm_and_si128(sse2Eq(c, ':'),
+                                   _mm_and_si128(sse2Eq(n1, '/'), sse2Eq(n2, '/')));
+    __m128i www = _mm_and_si128(sse2Eq(_mm_or_si128(c, fold), 'w'),
+                                sse2Eq(_mm_or_si128(n1, fold), 'w'));
+    www = _mm_and_si128(www, _mm_and_si128(sse2Eq(_mm_or_si128(n2, fold), 'w'),
+                                           sse2Eq(n3, '.')));
+    acc.urlHits = _mm_sub_epi16(acc.urlHits, _mm_or_si128(scheme, www));
+}
+
+TEXTFEATURES_TARGET_SSE2
+TextFeatures computeSse2(const quint16 *s, qsizetype n)
+{
+    ScanState st;
+    st.features.length = int(n);
+    if (n == 0) {
+        return st.features;
+    }
+
+    Sse2Counters acc;
+    sse2Reset(acc);
+
+    // Element 0 has no predecessor and each block peeks 3 units ahead,
+    // so the scalar path covers the head and the tail.
+    scanOne(s, 0, n, st);
+    qsizetype i = 1;
+    int blocks = 0;
+    for (; i + 8 + 3 <= n; i += 8) {
+        sse2Block(s, i, acc, st);
+        if (++blocks == FLUSH_BLOCKS) {
+            sse2Flush(acc, st.features);
+            blocks = 0;
+        }
+    }
+    sse2Flush(acc, st.features);
+    for (; i < n; ++i) {
+        scanOne(s, i, n, st);
+    }
+    return st.features;
+}
+
+// ---------------------------------------------------------------------------
+// AVX2: 16 code units per block
+// ---------------------------------------------------------------------------
+
+struct Avx2Counters {
+    __m256i uppercase;
+    __m256i lowercase;
+    __m256i digits;
+    __m256i spaces;
+    __m256i symbols;
+    __m256i nonAscii;
+    __m256i combining;
+    __m256i repeated;
+    __m256i urlHits;
+};
+
+TEXTFEATURES_TARGET_AVX2
+static inline __m256i avx2InRange(__m256i v, quint16 lo, quint16 hi)
+{
+    const __m256i bias = _mm256_set1_epi16(static_cast<short>(0x8000));
+    __m256i d = _mm256_xor_si256(_mm256_sub_epi16(v, _mm256_set1_epi16(static_cast<short>(lo))), bias);
+    __m256i limit = _mm256_set1_epi16(static_cast<short>((hi - lo + 1) ^ 0x8000));
+    return _mm256_cmpgt_epi16(limit, d);
+}
+
+TEXTFEATURES_TARGET_AVX2
+static inline __m256i avx2Eq(__m256i v, quint16 c)
+{
+    return _mm256_cmpeq_epi16(v, _mm256_set1_epi16(static_cast<short>(c)));
+}
+
+TEXTFEATURES_TARGET_AVX2
+static inline int avx2Sum(__m256i lanes)
+{
+    __m256i wide = _mm256_madd_epi16(lanes, _mm256_set1_epi16(1));
+    __m128i sums = _mm_add_epi32(_mm256_castsi256_si128(wide), _mm256_extracti128_si256(wide, 1));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(1, 0, 3, 2)));
+    sums = _mm_add_epi32(sums, _mm_shuffle_epi32(sums, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sums);
+}
+
+TEXTFEATURES_TARGET_AVX2
+static inline void avx2Reset(Avx2Counters &acc)
+{
+    acc.uppercase = acc.lowercase = acc.digits = _mm256_setzero_si256();
+    acc.spaces = acc.symbols = acc.nonAscii = _mm256_setzero_si256();
+    acc.combining = acc.repeated = acc.urlHits = _mm256_setzero_si256();
+}
+
+TEXTFEATURES_TARGET_AVX2
+static void avx2Flush(Avx2Counters &acc, TextFeatures &f)
+{
+    f.uppercase += avx2Sum(acc.uppercase);
+    f.lowercase += avx2Sum(acc.lowercase);
+    f.digits += avx2Sum(acc.digits);
+    f.spaces += avx2Sum(acc.spaces);
+    f.symbols += avx2Sum(acc.symbols);
+    f.nonAscii += avx2Sum(acc.nonAscii);
+    f.combining += avx2Sum(acc.combining);
+    f.repeated += avx2Sum(acc.repeated);
+    f.urlHits += avx2Sum(acc.urlHits);
+    avx2Reset(acc);
+}
+
+TEXTFEATURES_TARGET_AVX2
+static inline void avx2Block(const quint16 *s, qsizetype i, Avx2Counters &acc, ScanState &st)
+{
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i));
+    const __m256i prev = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i - 1));
+
+    const __m256i upper = avx2InRange(c, 'A', 'Z');
+    const __m256i lower = avx2InRange(c, 'a', 'z');
+    const __m256i digit = avx2InRange(c, '0', '9');
+    const __m256i printable = avx2InRange(c, 0x21, 0x7E);
+    const __m256i ascii = avx2InRange(c, 0x00, 0x7F);
+
+    acc.uppercase = _mm256_sub_epi16(acc.uppercase, upper);
+    acc.lowercase = _mm256_sub_epi16(acc.lowercase, lower);
+    acc.digits = _mm256_sub_epi16(acc.digits, digit);
+    acc.spaces = _mm256_sub_epi16(acc.spaces, avx2Eq(c, ' '));
+    acc.symbols = _mm256_sub_epi16(acc.symbols,
+                                   _mm256_andnot_si256(_mm256_or_si256(upper, _mm256_or_si256(lower, digit)),
+                                                       printable));
+
+    if (quint32(_mm256_movemask_epi8(ascii)) != 0xFFFFFFFFu) {
+        acc.nonAscii = _mm256_sub_epi16(acc.nonAscii, _mm256_andnot_si256(ascii, _mm256_set1_epi16(-1)));
+        __m256i comb = avx2InRange(c, 0x0300, 0x036F);
+        comb = _mm256_or_si256(comb, avx2InRange(c, 0x1AB0, 0x1AFF));
+        comb = _mm256_or_si256(comb, avx2InRange(c, 0x1DC0, 0x1DFF));
+        comb = _mm256_or_si256(comb, avx2InRange(c, 0x20D0, 0x20FF));
+        comb = _mm256_or_si256(comb, avx2InRange(c, 0xFE20, 0xFE2F));
+        acc.combining = _mm256_sub_epi16(acc.combining, comb);
+    }
+
+    const __m256i eq = _mm256_cmpeq_epi16(c, prev);
+    if (_mm256_movemask_epi8(eq) == 0) {
+        st.currentRun = 1;
+    } else {
+        acc.repeated = _mm256_sub_epi16(acc.repeated, eq);
+        // packs works per 128-bit lane: elements 0-7 land in bytes 0-7 and
+        // elements 8-15 in bytes 16-23.
+        const quint32 bytes = quint32(_mm256_movemask_epi8(_mm256_packs_epi16(eq, _mm256_setzero_si256())));
+        applyRunMask(st, (bytes & 0xFFu) | ((bytes >> 8) & 0xFF00u), 16);
+    }
+
+    const __m256i n1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + 1));
+    const __m256i n2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + 2));
+    const __m256i n3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(s + i + 3));
+    const __m256i fold = _mm256_set1_epi16(0x20);
+
+    __m256i scheme = _mm256_and_si256(avx2Eq(c, ':'),
+                                      _mm256_and_si256(avx2Eq(n1, '/'), avx2Eq(n2, '/')));
+    __m256i www = _mm256_and_si256(avx2Eq(_mm256_or_si256(c, fold), 'w'),
+                                   avx2Eq(_mm256_or_si256(n1, fold), 'w'));
+    www = _mm256_and_si256(www, _mm256_and_si256(avx2Eq(_mm256_or_si256(n2, fold), 'w'),
+                                                 avx2Eq(n3, '.')));
+    acc.urlHits = _mm256_sub_epi16(acc.urlHits, _mm256_or_si256(scheme, www));
+}
+
+TEXTFEATURES_TARGET_AVX2
+TextFeatures computeAvx2(const quint16 *s, qsizetype n)
+{
+    ScanState st;
+    st.features.length = int(n);
+    if (n == 0) {
+        return st.features;
+    }
+
+    Avx2Counters acc;
+    avx2Reset(acc);
+
+    scanOne(s, 0, n, st);
+    qsizetype i = 1;
+    int blocks = 0;
+    for (; i + 16 + 3 <= n; i += 16) {
+        avx2Block(s, i, acc, st);
+        if (++blocks == FLUSH_BLOCKS) {
+            avx2Flush(acc, st.features);
+            blocks = 0;
+        }
+    }
+    avx2Flush(acc, st.features);
+    for (; i < n; ++i) {
+        scanOne(s, i, n, st);
+    }
+    return st.features;
+}
+
+bool cpuHasAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool cpuHasSse2()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return true; // Part of the x86-64 baseline
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+#endif // TEXTFEATURES_X86
+
+TextFeatureKernels::Kernel detectKernel()
+{
+#ifdef TEXTFEATURES_X86
+    if (cpuHasAvx2()) {
+        return TextFeatureKernels::Kernel::AVX2;
+    }
+    if (cpuHasSse2()) {
+        return TextFeatureKernels::Kernel::SSE2;
+    }
+#endif
+    return TextFeatureKernels::Kernel::Scalar;
+}
+
+} // namespace
+
+namespace TextFeatureKernels {
+
+Kernel activeKernel()
+{
+    static const Kernel kernel = detectKernel();
+    return kernel;
+}
+
+bool isSupported(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+#ifdef TEXTFEATURES_X86
+    case Kernel::SSE2: {
+        static const bool sse2 = cpuHasSse2();
+        return sse2;
+    }
+    case Kernel::AVX2: {
+        static const bool avx2 = cpuHasAvx2();
+        return avx2;
+    }
+#else
+    case Kernel::SSE2:
+    case Kernel::AVX2:
+        return false;
+#endif
+    }
+    return false;
+}
+
+const char *kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Scalar:
+        return "scalar";
+    case Kernel::SSE2:
+        return "sse2";
+    case Kernel::AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+TextFeatures computeWith(Kernel kernel, const QChar *data, qsizetype length)
+{
+    const quint16 *s = reinterpret_cast<const quint16 *>(data);
+
+#ifdef TEXTFEATURES_X86
+    if (kernel == Kernel::AVX2 && isSupported(Kernel::AVX2)) {
+        return computeAvx2(s, length);
+    }
+    if (kernel == Kernel::SSE2 && isSupported(Kernel::SSE2)) {
+        return computeSse2(s, length);
+    }
+#else
+    Q_UNUSED(kernel)
+#endif
+    return computeScalar(s, length);
+}
+
+TextFeatures compute(const QChar *data, qsizetype length)
+{
+    return computeWith(activeKernel(), data, length);
+}
+
+TextFeatures compute(const QString &text)
+{
+    return compute(text.constData(), text.size());
+}
+
+} // namespace TextFeatureKernels
@@ -0,0 +1,73 @@
+#ifndef TEXTFEATURES_H
+#define TEXTFEATURES_H
+
+#include <QString>
+#include <QtGlobal>
+
+// Per-message text features used by the spam heuristics.
+//
+// Every counter is defined purely on UTF-16 code units so the scalar,
+// SSE2 and AVX2 kernels produce bit-identical results:
+// - uppercase/lowercase/digits: ASCII ranges only
+// - symbols: printable ASCII that is not alphanumeric or a space
+// - combining: combining mark blocks (U+0300-036F, U+1AB0-1AFF,
+//   U+1DC0-1DFF, U+20D0-20FF, U+FE20-FE2F) - the "zalgo" signal
+// - repeated/longestRun: code units equal to their predecessor
+// - urlHits: occurrences of "://" and "www." (case-insensitive)
+struct TextFeatures {
+    int length = 0;
+    int uppercase = 0;
+    int lowercase = 0;
+    int digits = 0;
+    int spaces = 0;
+    int symbols = 0;
+    int nonAscii = 0;
+    int combining = 0;
+    int repeated = 0;
+    int longestRun = 0;
+    int urlHits = 0;
+
+    float uppercaseRatio() const
+    {
+        int letters = uppercase + lowercase;
+        return letters > 0 ? float(uppercase) / letters : 0.0f;
+    }
+
+    float symbolRatio() const
+    {
+        return length > 0 ? float(symbols) / length : 0.0f;
+    }
+
+    float combiningDensity() const
+    {
+        return length > 0 ? float(combining) / length : 0.0f;
+    }
+
+    bool operator==(const TextFeatures &other) const;
+    bool operator!=(const TextFeatures &other) const { return !(*this == other); }
+};
+
+namespace TextFeatureKernels {
+
+enum class Kernel {
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+// Computes all features in a single pass using the best kernel
+// supported by the running CPU (selected once, on first use).
+TextFeatures compute(const QString &text);
+TextFeatures compute(const QChar *data, qsizetype length);
+
+// Runs a specific kernel. Falls back to scalar if the kernel is not
+// available on this CPU/build. Used for cross-checking and benchmarks.
+TextFeatures computeWith(Kernel kernel, const QChar *data, qsizetype length);
+
+Kernel activeKernel();
+bool isSupported(Kernel kernel);
+const char *kernelName(Kernel kernel);
+
+} // namespace TextFeatureKernels
+
+#endif // TEXTFEATURES_H
@@ -0,0 +1,292 @@
+#include "usercardloader.h"
+#include "banlist.h"
+#include "twitch/twitchapi.h"
+#include "twitch/userlookupservice.h"
+#include "twitch/profilecache.h"
+#include <QTimer>
+#include <QDebug>
+#include <memory>
+
+UserCardLoader::UserCardLoader(TwitchAPI *api, UserLookupService *lookups, ProfileCache *cache,
+                               BanList *banList, ModActionLog *modLog, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_lookups(lookups)
+    , m_cache(cache)
+    , m_banList(banList)
+    , m_modLog(modLog)
+    , m_nextCardId(1)
+{
+}
+
+quint64 UserCardLoader::load(const QString &channel, const QString &broadcasterId, const QString &moderatorId,
+                             const QString &login, const QStringList &recentMessages)
+{
+    const quint64 cardId = m_nextCardId++;
+    Entry &entry = m_cards[cardId];
+    entry.timer.start();
+    entry.broadcasterId = broadcasterId;
+    entry.moderatorId = moderatorId;
+    entry.card.channel = channel;
+    entry.card.login = login.toLower();
+    entry.card.recentMessages = recentMessages;
+    fillLocal(entry);
+
+    QTimer::singleShot(LATENCY_BUDGET_MS, this, [this, cardId]() {
+        auto it = m_cards.find(cardId);
+        if (it != m_cards.end() && !it->ready) {
+            it->ready = true;
+            emit cardReady(cardId, it->card);
+        }
+    });
+
+    // Held until load() returns, so replies that complete synchronously
+    // can't settle the card while it is still being set up
+    ++entry.pending;
+    if (moderatorId.isEmpty()) {
+        for (int piece = 0; piece < UserCard::PieceCount; ++piece) {
+            if (!entry.card.has(UserCard::Piece(piece))) {
+                entry.card.failed |= 1u << piece;
+                entry.card.errors[piece] = "Not connected";
+            }
+        }
+    } else if (!entry.card.user.isValid()) {
+        // Everything else needs the id
+        fetchAccount(cardId);
+    } else {
+        if (!entry.card.has(UserCard::Account)) {
+            fetchAccount(cardId);
+        }
+        fetchById(cardId);
+    }
+
+    // Signals wait for the caller to have the id, even when nothing is fetched
+    QMetaObject::invokeMethod(this, [this, cardId]() {
+        auto it = m_cards.find(cardId);
+        if (it != m_cards.end()) {
+            --it->pending;
+            settle(cardId);
+        }
+    }, Qt::QueuedConnection);
+    return cardId;
+}
+
+void UserCardLoader::cancel(quint64 cardId)
+{
+    m_cards.remove(cardId);
+}
+
+void UserCardLoader::markLoaded(Entry &entry, UserCard::Piece piece)
+{
+    entry.card.loaded |= 1u << piece;
+    entry.card.pieceMs[piece] = entry.timer.elapsed();
+}
+
+void UserCardLoader::fillLocal(Entry &entry)
+{
+    UserCard &card = entry.card;
+    markLoaded(entry, UserCard::Messages);
+
+    // Account age never changes, so a stale profile still gives the id and age
+    if (m_cache) {
+        UserProfile profile = m_cache->findByLogin(card.login, ProfileCache::Profile);
+        if (profile.isValid()) {
+            card.user = profile.user;
+            markLoaded(entry, UserCard::Account);
+        } else {
+            profile = m_cache->findByLogin(card.login, ProfileCache::CreatedAt);
+            if (profile.isValid()) {
+                card.user = profile.user;
+            }
+        }
+    }
+
+    if (m_cache && card.user.isValid() && !entry.broadcasterId.isEmpty()) {
+        const UserProfile moderator = m_cache->findById(card.user.id, ProfileCache::Moderator, entry.broadcasterId);
+        const UserProfile vip = m_cache->findById(card.user.id, ProfileCache::Vip, entry.broadcasterId);
+        if (moderator.isValid() && vip.isValid()) {
+            card.rolesKnown = true;
+            card.moderator = moderator.channels.value(entry.broadcasterId).moderator;
+            card.vip = vip.channels.value(entry.broadcasterId).vip;
+            markLoaded(entry, UserCard::Roles);
+        }
+    }
+
+    // History is local by nature; the current ban is too once the channel's
+    // ban list has been synced
+    card.history = m_modLog->byTarget(card.login, QString(), HISTORY_LIMIT);
+    m_banList->open(card.channel);
+    const QList<BannedUser> bans = m_banList->search(card.channel, card.login, BanList::ByLogin, 1);
+    if (!bans.isEmpty() && bans.first().login.compare(card.login, Qt::CaseInsensitive) == 0) {
+        card.banned = true;
+        card.ban = bans.first();
+    }
+    if (m_banList->hasSynced(card.channel)) {
+        markLoaded(entry, UserCard::Bans);
+    } else if (m_cache && card.user.isValid() && !entry.broadcasterId.isEmpty()) {
+        const UserProfile banned = m_cache->findById(card.user.id, ProfileCache::Banned, entry.broadcasterId);
+        if (banned.isValid()) {
+            card.banned = card.banned || banned.channels.value(entry.broadcasterId).banned;
+            markLoaded(entry, UserCard::Bans);
+        }
+    }
+}
+
+void UserCardLoader::fetchAccount(quint64 cardId)
+{
+    Entry &entry = m_cards[cardId];
+    const bool haveId = entry.card.user.isValid();
+    ++entry.pending;
+
+    m_lookups->lookupByLogin(entry.card.login, ApiRequest::Interactive)
+        .then(this, [this, cardId, haveId](const TwitchUser &user) {
+            auto it = m_cards.find(cardId);
+            if (it == m_cards.end()) {
+                return;
+            }
+            if (user.isValid()) {
+                it->card.user = user;
+                if (!haveId) {
+                    fetchById(cardId);
+                }
+                finishPiece(cardId, UserCard::Account);
+                return;
+            }
+            if (!haveId) {
+                for (UserCard::Piece piece : {UserCard::Follow, UserCard::Roles, UserCard::Bans}) {
+                    if (!it->card.has(piece)) {
+                        it->card.failed |= 1u << piece;
+                        it->card.errors[piece] = "Unknown account";
+                    }
+                }
+            }
+            finishPiece(cardId, UserCard::Account, "No account with that login");
+        });
+}
+
+void UserCardLoader::fetchById(quint64 cardId)
+{
+    Entry &entry = m_cards[cardId];
+    const QString userId = entry.card.user.id;
+    const QString login = entry.card.login;
+    const QString broadcasterId = entry.broadcasterId;
+
+    if (broadcasterId.isEmpty()) {
+        for (UserCard::Piece piece : {UserCard::Follow, UserCard::Roles, UserCard::Bans}) {
+            if (!entry.card.has(piece)) {
+                entry.card.failed |= 1u << piece;
+                entry.card.errors[piece] = "Channel id not known yet";
+            }
+        }
+        return;
+    }
+
+    ++entry.pending;
+    m_api->getChannelFollower(broadcasterId, userId)
+        .then(this, [this, cardId](const ApiResult<ChannelFollower> &result) {
+            auto it = m_cards.find(cardId);
+            if (it == m_cards.end()) {
+                return;
+            }
+            it->card.following = result.value.isValid();
+            it->card.followedAt = result.value.followedAt;
+            finishPiece(cardId, UserCard::Follow, result.error);
+        });
+
+    if (!entry.card.has(UserCard::Roles)) {
+        if (broadcasterId != entry.moderatorId) {
+            // Helix lists roles to the broadcaster only; badges will tell
+            // once the account chats
+            markLoaded(entry, UserCard::Roles);
+        } else {
+            ++entry.pending;
+            auto replies = std::make_shared<int>(0);
+            auto onRole = [this, cardId, userId, login, broadcasterId, replies](ProfileCache::Field field,
+                                                                               const ApiResult<QList<UserRef>> &result) {
+                auto it = m_cards.find(cardId);
+                if (it == m_cards.end()) {
+                    return;
+                }
+                const bool value = !result.value.isEmpty();
+                if (result.ok()) {
+                    (field == ProfileCache::Moderator ? it->card.moderator : it->card.vip) = value;
+                    if (m_cache) {
+                        m_cache->storeRole(userId, login, broadcasterId, field, value);
+                    }
+                } else {
+                    it->card.errors[UserCard::Roles] = result.error;
+                }
+                if (++*replies == 2) {
+                    it->card.rolesKnown = it->card.errors[UserCard::Roles].isEmpty();
+                    finishPiece(cardId, UserCard::Roles, it->card.errors[UserCard::Roles]);
+                }
+            };
+            m_api->getModerators(broadcasterId, QStringList() << userId, ApiRequest::Interactive)
+                .then(this, [onRole](const ApiResult<QList<UserRef>> &result) {
+                    onRole(ProfileCache::Moderator, result);
+                });
+            m_api->getVips(broadcasterId, QStringList() << userId, ApiRequest::Interactive)
+                .then(this, [onRole](const ApiResult<QList<UserRef>> &result) {
+                    onRole(ProfileCache::Vip, result);
+                });
+        }
+    }
+
+    if (!entry.card.has(UserCard::Bans)) {
+        ++entry.pending;
+        m_api->getBannedUser(broadcasterId, userId)
+            .then(this, [this, cardId, userId, login, broadcasterId](const ApiResult<BannedUserPage> &result) {
+                auto it = m_cards.find(cardId);
+                if (it == m_cards.end()) {
+                    return;
+                }
+                if (result.ok()) {
+                    it->card.banned = !result.value.users.isEmpty();
+                    it->card.ban = it->card.banned ? result.value.users.first() : BannedUser();
+                    if (m_cache) {
+                        m_cache->storeRole(userId, login, broadcasterId, ProfileCache::Banned,
+                                           it->card.banned && !it->card.ban.expiresAt.isValid());
+                    }
+                }
+                finishPiece(cardId, UserCard::Bans, result.error);
+            });
+    }
+}
+
+void UserCardLoader::finishPiece(quint64 cardId, UserCard::Piece piece, const QString &error)
+{
+    auto it = m_cards.find(cardId);
+    if (it == m_cards.end()) {
+        return;
+    }
+    Entry &entry = it.value();
+    --entry.pending;
+    if (error.isEmpty()) {
+        markLoaded(entry, piece);
+    } else {
+        entry.card.failed |= 1u << piece;
+        entry.card.errors[piece] = error;
+        entry.card.pieceMs[piece] = entry.timer.elapsed();
+    }
+    if (entry.ready) {
+        emit cardChanged(cardId, entry.card);
+    }
+    settle(cardId);
+}
+
+void UserCardLoader::settle(quint64 cardId)
+{
+    auto it = m_cards.find(cardId);
+    if (it == m_cards.end() || it->pending > 0) {
+        return;
+    }
+    const UserCard card = it->card;
+    const bool wasReady = it->ready;
+    qDebug() << "User card for" << card.login << "complete in" << it->timer.elapsed() << "ms; account"
+             << card.pieceMs[UserCard::Account] << "follow" << card.pieceMs[UserCard::Follow]
+             << "roles" << card.pieceMs[UserCard::Roles] << "bans" << card.pieceMs[UserCard::Bans];
+    m_cards.erase(it);
+    if (!wasReady) {
+        emit cardReady(cardId, card);
+    }
+}
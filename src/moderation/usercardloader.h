@@ -0,0 +1,111 @@
+#ifndef USERCARDLOADER_H
+#define USERCARDLOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include "twitch/helixtypes.h"
+#include "modactionlog.h"
+
+class TwitchAPI;
+class UserLookupService;
+class ProfileCache;
+class BanList;
+
+// Everything the user card shows about one account in one channel
+struct UserCard {
+    enum Piece {
+        Account,  // GET /users: age, display name, type
+        Follow,   // GET /channels/followers
+        Roles,    // moderator / VIP
+        Bans,     // current ban and the mod actions log
+        Messages, // lines still in the chat view
+        PieceCount
+    };
+
+    QString channel;
+    QString login;
+
+    TwitchUser user;
+    bool following = false;
+    QDateTime followedAt;
+    bool rolesKnown = false; // other channels' roles are only known from chat badges
+    bool moderator = false;
+    bool vip = false;
+    bool banned = false;
+    BannedUser ban;          // valid while banned
+    QList<ModAction> history;
+    QStringList recentMessages;
+
+    quint32 loaded = 0;      // bit per Piece: has an answer, cached or fetched
+    quint32 failed = 0;      // bit per Piece: the request failed
+    QString errors[PieceCount];
+    qint64 pieceMs[PieceCount] = {};
+
+    bool has(Piece piece) const { return loaded & (1u << piece); }
+    bool hasFailed(Piece piece) const { return failed & (1u << piece); }
+};
+
+// Loads a user card from every source at once.
+//
+// Cached and local pieces (profile cache, ban list, mod actions log, chat
+// lines) are filled in synchronously; the Helix calls for what is missing
+// or stale (user, follower, moderator, VIP, ban) all go out in parallel,
+// at interactive priority. Only a login that no cache knows needs GET
+// /users first, and the rest follows as soon as it has the id.
+//
+// cardReady fires once: when every piece has arrived or LATENCY_BUDGET_MS
+// after the start, whichever comes first, so a card that is mostly cached
+// opens complete and at once, and a cold one doesn't wait on the slowest
+// request. Pieces landing after that come as cardChanged.
+class UserCardLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    UserCardLoader(TwitchAPI *api, UserLookupService *lookups, ProfileCache *cache, BanList *banList,
+                   ModActionLog *modLog, QObject *parent = nullptr);
+
+    // moderatorId empty: cached and local pieces only
+    quint64 load(const QString &channel, const QString &broadcasterId, const QString &moderatorId,
+                 const QString &login, const QStringList &recentMessages);
+    // Late replies for the card are dropped
+    void cancel(quint64 cardId);
+
+    static constexpr int LATENCY_BUDGET_MS = 100;
+    static constexpr int HISTORY_LIMIT = 50;
+
+signals:
+    void cardReady(quint64 cardId, const UserCard &card);
+    void cardChanged(quint64 cardId, const UserCard &card);
+
+private:
+    struct Entry {
+        UserCard card;
+        QString broadcasterId;
+        QString moderatorId;
+        int pending = 0; // requests in flight
+        bool ready = false;
+        QElapsedTimer timer;
+    };
+
+    void fillLocal(Entry &entry);
+    void fetchAccount(quint64 cardId);
+    void fetchById(quint64 cardId);
+    void finishPiece(quint64 cardId, UserCard::Piece piece, const QString &error = QString());
+    void markLoaded(Entry &entry, UserCard::Piece piece);
+    void settle(quint64 cardId);
+
+    TwitchAPI *m_api;
+    UserLookupService *m_lookups;
+    ProfileCache *m_cache;
+    BanList *m_banList;
+    ModActionLog *m_modLog;
+    QHash<quint64, Entry> m_cards;
+    quint64 m_nextCardId;
+};
+
+#endif // USERCARDLOADER_H
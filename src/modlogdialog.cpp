@@ -0,0 +1,169 @@
+#include "modlogdialog.h"
+#include "moderation/modactionlog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QDateTime>
+#include <QElapsedTimer>
+
+namespace {
+QString describe(const ModAction &action)
+{
+    QStringList parts;
+    if (action.kind == ModAction::Timeout) {
+        parts.append(QString("%1s").arg(action.durationSeconds));
+    }
+    if (!action.reason.isEmpty()) {
+        parts.append(action.reason);
+    }
+    if (!action.messageText.isEmpty()) {
+        parts.append("\"" + action.messageText + "\"");
+    }
+    return parts.join(" - ");
+}
+}
+
+ModLogDialog::ModLogDialog(ModActionLog *log, QWidget *parent)
+    : QDialog(parent)
+    , m_log(log)
+{
+    setWindowTitle("Mod Actions Log");
+    resize(860, 520);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *topLayout = new QHBoxLayout();
+    m_modeCombo = new QComboBox(this);
+    m_modeCombo->addItem("Against user", ByTarget);
+    m_modeCombo->addItem("By moderator", ByModerator);
+    m_modeCombo->addItem(QString("Last %1 days").arg(RECENT_DAYS), Recent);
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setClearButtonEnabled(true);
+    m_channelCombo = new QComboBox(this);
+    m_channelCombo->addItem("All channels", QString());
+    topLayout->addWidget(m_modeCombo);
+    topLayout->addWidget(m_searchEdit, 1);
+    topLayout->addWidget(m_channelCombo);
+    mainLayout->addLayout(topLayout);
+
+    m_tree = new QTreeWidget(this);
+    m_tree->setRootIsDecorated(false);
+    m_tree->setUniformRowHeights(true);
+    m_tree->setHeaderLabels(QStringList() << "Time" << "Channel" << "Action" << "User"
+                            << "Moderator" << "Details");
+    m_tree->header()->setStretchLastSection(true);
+    mainLayout->addWidget(m_tree);
+
+    QHBoxLayout *bottomLayout = new QHBoxLayout();
+    m_statusLabel = new QLabel(this);
+    QPushButton *closeButton = new QPushButton("Close", this);
+    bottomLayout->addWidget(m_statusLabel, 1);
+    bottomLayout->addWidget(closeButton);
+    mainLayout->addLayout(bottomLayout);
+
+    m_redrawTimer = new QTimer(this);
+    m_redrawTimer->setSingleShot(true);
+    m_redrawTimer->setInterval(REDRAW_MS);
+    connect(m_redrawTimer, &QTimer::timeout, this, &ModLogDialog::requery);
+
+    connect(m_modeCombo, &QComboBox::activated, this, [this]() {
+        updateSearchEdit();
+        requery();
+    });
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, &ModLogDialog::requery);
+    connect(m_channelCombo, &QComboBox::activated, this, &ModLogDialog::requery);
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+    connect(m_log, &ModActionLog::changed, this, [this]() {
+        if (isVisible() && !m_redrawTimer->isActive()) {
+            m_redrawTimer->start();
+        }
+    });
+
+    // Double-click a moderator to see their actions, anything else for the user's
+    connect(m_tree, &QTreeWidget::itemDoubleClicked, this, [this](QTreeWidgetItem *item, int column) {
+        const int mode = column == 4 ? ByModerator : ByTarget;
+        const QString login = item->text(column == 4 ? 4 : 3);
+        if (login.isEmpty()) {
+            return;
+        }
+        m_modeCombo->setCurrentIndex(m_modeCombo->findData(mode));
+        updateSearchEdit();
+        m_searchEdit->setText(login);
+        requery();
+    });
+
+    m_modeCombo->setCurrentIndex(m_modeCombo->findData(Recent));
+    updateSearchEdit();
+    requery();
+}
+
+void ModLogDialog::setChannels(const QStringList &channels)
+{
+    const QString current = m_channelCombo->currentData().toString();
+    m_channelCombo->clear();
+    m_channelCombo->addItem("All channels", QString());
+    for (const QString &channel : channels) {
+        m_channelCombo->addItem("#" + channel, channel);
+    }
+    m_channelCombo->setCurrentIndex(qMax(0, m_channelCombo->findData(current)));
+}
+
+void ModLogDialog::showTarget(const QString &login)
+{
+    m_modeCombo->setCurrentIndex(m_modeCombo->findData(ByTarget));
+    updateSearchEdit();
+    m_searchEdit->setText(login);
+    requery();
+}
+
+void ModLogDialog::updateSearchEdit()
+{
+    const int mode = m_modeCombo->currentData().toInt();
+    m_searchEdit->setEnabled(mode != Recent);
+    m_searchEdit->setPlaceholderText(mode == ByModerator ? "Moderator login, Enter to search"
+                                                         : "User login, Enter to search");
+}
+
+void ModLogDialog::requery()
+{
+    const int mode = m_modeCombo->currentData().toInt();
+    const QString login = m_searchEdit->text().trimmed();
+    const QString channel = m_channelCombo->currentData().toString();
+
+    QElapsedTimer timer;
+    timer.start();
+    QList<ModAction> actions;
+    if (mode == ByTarget && !login.isEmpty()) {
+        actions = m_log->byTarget(login, channel, MAX_ROWS);
+    } else if (mode == ByModerator && !login.isEmpty()) {
+        actions = m_log->byModerator(login, channel, MAX_ROWS);
+    } else if (mode == Recent) {
+        const QDateTime now = QDateTime::currentDateTime();
+        actions = m_log->between(now.addDays(-RECENT_DAYS).toMSecsSinceEpoch(), now.toMSecsSinceEpoch(),
+                                 channel, MAX_ROWS);
+    }
+    const qint64 queryMs = timer.elapsed();
+
+    m_tree->setUpdatesEnabled(false);
+    m_tree->clear();
+    QList<QTreeWidgetItem *> items;
+    items.reserve(actions.size());
+    for (const ModAction &action : std::as_const(actions)) {
+        QTreeWidgetItem *item = new QTreeWidgetItem();
+        item->setText(0, QDateTime::fromMSecsSinceEpoch(action.timeMs).toString("yyyy-MM-dd HH:mm:ss"));
+        item->setText(1, "#" + action.channel);
+        item->setText(2, ModAction::kindName(action.kind));
+        item->setText(3, action.targetLogin);
+        item->setText(4, action.moderatorLogin);
+        item->setText(5, describe(action));
+        item->setToolTip(5, describe(action));
+        items.append(item);
+    }
+    m_tree->addTopLevelItems(items);
+    m_tree->setUpdatesEnabled(true);
+
+    m_statusLabel->setText(QString("%1%2 shown of %3 logged, query %4 ms")
+                           .arg(actions.size()).arg(actions.size() >= MAX_ROWS ? " newest" : "")
+                           .arg(m_log->count()).arg(queryMs));
+}
@@ -0,0 +1,50 @@
+#ifndef MODLOGDIALOG_H
+#define MODLOGDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QTreeWidget>
+#include <QLabel>
+#include <QTimer>
+
+class ModActionLog;
+
+// Mod actions log browser: everything against one account, everything one
+// moderator did, or the last days, optionally limited to one channel. Each
+// query answers from the log's indexes; at most MAX_ROWS newest rows are
+// shown and new actions redraw at most every REDRAW_MS.
+class ModLogDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        ByTarget,
+        ByModerator,
+        Recent
+    };
+
+    ModLogDialog(ModActionLog *log, QWidget *parent = nullptr);
+
+    void setChannels(const QStringList &channels);
+    void showTarget(const QString &login);
+
+    static constexpr int MAX_ROWS = 1000;
+    static constexpr int RECENT_DAYS = 7;
+    static constexpr int REDRAW_MS = 250;
+
+private:
+    void requery();
+    void updateSearchEdit();
+
+    ModActionLog *m_log;
+    QComboBox *m_modeCombo;
+    QLineEdit *m_searchEdit;
+    QComboBox *m_channelCombo;
+    QTreeWidget *m_tree;
+    QLabel *m_statusLabel;
+    QTimer *m_redrawTimer;
+};
+
+#endif // MODLOGDIALOG_H
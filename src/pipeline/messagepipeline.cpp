@@ -0,0 +1,303 @@
+#include "messagepipeline.h"
+#include "chatwidget.h"
+#include "twitch/twitchwebsocket.h"
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QDateTime>
+
+namespace {
+// Bounds the per-channel name/colour cache; it is rebuilt from scratch
+// when exceeded (a cache miss only costs an allocation)
+constexpr int MAX_INTERNED_USERS = 20000;
+
+// Lines handed to the GUI per flush, so a backlog cannot freeze the UI
+constexpr int MAX_RENDER_BATCH = 500;
+}
+
+QString PipelineStats::stageName(Stage stage)
+{
+    switch (stage) {
+    case Ingest:
+        return "Ingest";
+    case Queue:
+        return "Queue";
+    case Parse:
+        return "Parse";
+    case Enrich:
+        return "Enrich";
+    case Moderate:
+        return "Moderate";
+    case Format:
+        return "Format";
+    case Render:
+        return "Render";
+    case EndToEnd:
+        return "End-to-end";
+    case StageCount:
+        break;
+    }
+    return QString();
+}
+
+MessagePipeline::ChannelState::ChannelState(const QString &channelName, WorkStealingPool *pool)
+    : strand(std::make_shared<Strand>(pool))
+    , monitor(channelName)
+{
+}
+
+MessagePipeline::MessagePipeline(QObject *parent, int threadCount)
+    : QObject(parent)
+    , m_pool(threadCount)
+    , m_renderScheduled(false)
+    , m_inFlight(0)
+{
+    m_clock.start();
+    qDebug() << "Message pipeline started with" << m_pool.threadCount() << "worker threads";
+}
+
+MessagePipeline::~MessagePipeline()
+{
+    // Workers reference this object - stop them before members go away
+    m_pool.shutdown();
+}
+
+qint64 MessagePipeline::now() const
+{
+    return m_clock.nsecsElapsed();
+}
+
+qint64 MessagePipeline::lap(PipelineStats::Stage stage, qint64 since)
+{
+    const qint64 t = now();
+    record(stage, t - since);
+    return t;
+}
+
+void MessagePipeline::record(PipelineStats::Stage stage, qint64 ns, quint64 count)
+{
+    StageCounter &counter = m_stages[stage];
+    const quint64 value = quint64(qMax<qint64>(0, ns));
+    counter.count.fetch_add(count, std::memory_order_relaxed);
+    counter.totalNs.fetch_add(value, std::memory_order_relaxed);
+
+    const quint64 perItem = value / qMax<quint64>(1, count);
+    quint64 seen = counter.maxNs.load(std::memory_order_relaxed);
+    while (perItem > seen
+           && !counter.maxNs.compare_exchange_weak(seen, perItem, std::memory_order_relaxed)) {
+    }
+}
+
+std::shared_ptr<MessagePipeline::ChannelState> MessagePipeline::channelState(const QString &channelName)
+{
+    std::shared_ptr<ChannelState> &state = m_channels[channelName];
+    if (!state) {
+        state = std::make_shared<ChannelState>(channelName, &m_pool);
+    }
+    return state;
+}
+
+void MessagePipeline::ingest(const QString &channelName, const QString &line)
+{
+    const qint64 start = now();
+    // Same clock as ingestJoin(), taken before the line waits for its strand
+    const qint64 receivedMs = QDateTime::currentMSecsSinceEpoch();
+    std::shared_ptr<ChannelState> state = channelState(channelName);
+    m_inFlight.fetch_add(1, std::memory_order_relaxed);
+
+    // Tasks hold the state weakly: it owns their strand, so a strong
+    // reference from a queued task would keep both alive forever once the
+    // channel is removed. A running task holds it for the whole stage.
+    std::weak_ptr<ChannelState> weak = state;
+    state->strand->post([this, weak, line, start, receivedMs]() {
+        if (std::shared_ptr<ChannelState> locked = weak.lock()) {
+            process(*locked, line, start, receivedMs);
+        } else {
+            m_inFlight.fetch_sub(1, std::memory_order_relaxed);
+        }
+    });
+    record(PipelineStats::Ingest, now() - start);
+}
+
+void MessagePipeline::ingestJoin(const QString &channelName, const QString &username)
+{
+    std::shared_ptr<ChannelState> state = m_channels.value(channelName);
+    if (!state) {
+        return;
+    }
+
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+    std::weak_ptr<ChannelState> weak = state;
+    state->strand->post([this, weak, channelName, username, timestamp]() {
+        std::shared_ptr<ChannelState> locked = weak.lock();
+        if (!locked) {
+            return;
+        }
+        MonitorVerdict verdict = locked->monitor.processJoin(username, timestamp);
+        if (verdict.surges.isEmpty()) {
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, channelName, alerts = verdict.surges]() {
+            emit surgeDetected(channelName, alerts);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MessagePipeline::removeChannel(const QString &channelName)
+{
+    m_channels.remove(channelName);
+}
+
+void MessagePipeline::requestActivity(const QString &channelName)
+{
+    std::shared_ptr<ChannelState> state = m_channels.value(channelName);
+    if (!state) {
+        return;
+    }
+
+    std::weak_ptr<ChannelState> weak = state;
+    state->strand->post([this, weak, channelName]() {
+        std::shared_ptr<ChannelState> locked = weak.lock();
+        if (!locked) {
+            return;
+        }
+        QList<HeavyHitters::Entry> entries =
+            locked->monitor.heavyHitters().top(QDateTime::currentMSecsSinceEpoch());
+        QMetaObject::invokeMethod(this, [this, channelName, entries]() {
+            emit activityReady(channelName, entries);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MessagePipeline::process(ChannelState &state, const QString &line, qint64 ingestNs, qint64 receivedMs)
+{
+    qint64 t = lap(PipelineStats::Queue, ingestNs);
+
+    ProcessedMessage result;
+    result.ingestNs = ingestNs;
+
+    result.message = TwitchWebSocket::parseChatMessage(line);
+    result.message.receivedMs = receivedMs;
+    t = lap(PipelineStats::Parse, t);
+
+    enrich(state, result);
+    t = lap(PipelineStats::Enrich, t);
+
+    result.verdict = state.monitor.processMessage(result.message);
+    if (result.verdict.flood.flagged) {
+        if (const FloodCluster *cluster = state.monitor.floodDetector().cluster(result.verdict.flood.clusterId)) {
+            result.floodCluster = *cluster;
+        }
+    }
+    t = lap(PipelineStats::Moderate, t);
+
+    result.html = ChatWidget::formatMessageHtml(result.message.username, result.message.text,
+                                                result.color, result.message.timestamp);
+    lap(PipelineStats::Format, t);
+
+    queueRender(std::move(result));
+}
+
+void MessagePipeline::enrich(ChannelState &state, ProcessedMessage &result)
+{
+    ChatMessage &message = result.message;
+
+    // Intern names: every message of a user shares one string buffer
+    message.channel = state.monitor.channelName();
+    auto it = state.users.find(message.username);
+    if (it == state.users.end()) {
+        if (state.users.size() >= MAX_INTERNED_USERS) {
+            state.users.clear();
+        }
+        it = state.users.insert(message.username, UserInfo{message.username, QString(), QColor()});
+    }
+    UserInfo &user = it.value();
+    message.username = user.username;
+    if (message.displayName.compare(user.username, Qt::CaseInsensitive) == 0) {
+        message.displayName = user.username;
+    }
+
+    // Colour: the user's Twitch colour when set, else a stable hashed hue
+    const QString colorTag = message.tags.value("color");
+    if (!colorTag.isEmpty() && colorTag != user.colorTag) {
+        user.colorTag = colorTag;
+        user.color = QColor(colorTag);
+    }
+    if (!user.color.isValid()) {
+        user.color = QColor::fromHsl((qHash(user.username) % 360), 200, 150);
+    }
+    result.color = user.color;
+}
+
+void MessagePipeline::queueRender(ProcessedMessage &&result)
+{
+    bool schedule = false;
+    {
+        QMutexLocker locker(&m_renderMutex);
+        m_renderQueue.append(std::move(result));
+        if (!m_renderScheduled) {
+            m_renderScheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        QMetaObject::invokeMethod(this, [this]() { flushRender(); }, Qt::QueuedConnection);
+    }
+}
+
+void MessagePipeline::flushRender()
+{
+    QList<ProcessedMessage> batch;
+    {
+        QMutexLocker locker(&m_renderMutex);
+        if (m_renderQueue.size() <= MAX_RENDER_BATCH) {
+            batch.swap(m_renderQueue);
+            m_renderScheduled = false;
+        } else {
+            // Leave the rest for the next pass so input and paints get a turn
+            batch = m_renderQueue.mid(0, MAX_RENDER_BATCH);
+            m_renderQueue.remove(0, MAX_RENDER_BATCH);
+            QMetaObject::invokeMethod(this, [this]() { flushRender(); }, Qt::QueuedConnection);
+        }
+    }
+
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    const qint64 start = now();
+    emit messagesReady(batch);
+    const qint64 end = now();
+
+    record(PipelineStats::Render, end - start, quint64(batch.size()));
+    for (const ProcessedMessage &message : batch) {
+        record(PipelineStats::EndToEnd, end - message.ingestNs);
+    }
+    m_inFlight.fetch_sub(int(batch.size()), std::memory_order_relaxed);
+}
+
+PipelineStats MessagePipeline::takeStats()
+{
+    PipelineStats stats;
+    for (int s = 0; s < PipelineStats::StageCount; ++s) {
+        StageCounter &counter = m_stages[s];
+        const quint64 count = counter.count.exchange(0, std::memory_order_relaxed);
+        const quint64 totalNs = counter.totalNs.exchange(0, std::memory_order_relaxed);
+        const quint64 maxNs = counter.maxNs.exchange(0, std::memory_order_relaxed);
+
+        stats.count[s] = count;
+        stats.averageUs[s] = count ? double(totalNs) / double(count) / 1000.0 : 0.0;
+        stats.maxUs[s] = double(maxNs) / 1000.0;
+    }
+
+    {
+        QMutexLocker locker(&m_renderMutex);
+        stats.renderBacklog = int(m_renderQueue.size());
+    }
+    stats.inFlight = m_inFlight.load(std::memory_order_relaxed);
+    stats.poolPending = m_pool.pendingTasks();
+    stats.channels = int(m_channels.size());
+    stats.threads = m_pool.threadCount();
+    stats.stolenTasks = m_pool.stolenTasks();
+    return stats;
+}
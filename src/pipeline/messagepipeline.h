@@ -0,0 +1,134 @@
+#ifndef MESSAGEPIPELINE_H
+#define MESSAGEPIPELINE_H
+
+#include <QObject>
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QColor>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include "workstealingpool.h"
+#include "twitch/chatmessage.h"
+#include "moderation/channelmonitor.h"
+
+// One chat line after the worker stages, ready to be rendered
+struct ProcessedMessage {
+    ChatMessage message;
+    QColor color;
+    QString html;
+    MonitorVerdict verdict;
+    FloodCluster floodCluster; // snapshot, set when verdict.flood.flagged
+    qint64 ingestNs = 0;
+};
+
+struct PipelineStats {
+    enum Stage {
+        Ingest,   // GUI thread: route the raw line to its channel strand
+        Queue,    // waiting for the strand / a worker
+        Parse,
+        Enrich,
+        Moderate,
+        Format,
+        Render,   // GUI thread: append to the chat widget
+        EndToEnd, // ingest to rendered
+        StageCount
+    };
+
+    quint64 count[StageCount] = {};
+    double averageUs[StageCount] = {};
+    double maxUs[StageCount] = {};
+
+    int inFlight = 0;      // ingested, not yet rendered
+    int poolPending = 0;   // tasks queued on the workers
+    int renderBacklog = 0; // formatted, waiting for the GUI thread
+    int channels = 0;
+    int threads = 0;
+    quint64 stolenTasks = 0;
+
+    static QString stageName(Stage stage);
+};
+
+// Staged chat message pipeline:
+//
+//   ingest (GUI) -> parse -> enrich -> moderate -> format (workers) -> render (GUI)
+//
+// The worker stages run on a work-stealing pool. Each channel has its own
+// strand, so a channel's messages are processed in order while different
+// channels run in parallel. Channel state (ChannelMonitor, interned names,
+// colours) is only ever touched on that channel's strand. Formatted lines
+// are handed back to the GUI thread in batches, at most one flush per
+// event loop pass.
+//
+// ingest*, request* and removeChannel must be called on the GUI thread.
+class MessagePipeline : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MessagePipeline(QObject *parent = nullptr, int threadCount = 0);
+    ~MessagePipeline();
+
+    void ingest(const QString &channelName, const QString &line);
+    void ingestJoin(const QString &channelName, const QString &username);
+    void removeChannel(const QString &channelName);
+
+    // Answered asynchronously through activityReady()
+    void requestActivity(const QString &channelName);
+
+    // Per-stage figures since the previous call, plus current queue depths
+    PipelineStats takeStats();
+
+signals:
+    void messagesReady(const QList<ProcessedMessage> &batch);
+    void surgeDetected(const QString &channelName, const QList<SurgeAlert> &alerts);
+    void activityReady(const QString &channelName, const QList<HeavyHitters::Entry> &entries);
+
+private:
+    struct UserInfo {
+        QString username; // canonical copy, shared by every message of the user
+        QString colorTag;
+        QColor color;
+    };
+
+    struct ChannelState {
+        ChannelState(const QString &channelName, WorkStealingPool *pool);
+
+        std::shared_ptr<Strand> strand;
+        ChannelMonitor monitor;
+        QHash<QString, UserInfo> users;
+    };
+
+    struct StageCounter {
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> totalNs{0};
+        std::atomic<quint64> maxNs{0};
+    };
+
+    std::shared_ptr<ChannelState> channelState(const QString &channelName);
+    void process(ChannelState &state, const QString &line, qint64 ingestNs, qint64 receivedMs);
+    void enrich(ChannelState &state, ProcessedMessage &result);
+    void queueRender(ProcessedMessage &&result);
+    void flushRender();
+
+    qint64 now() const;
+    qint64 lap(PipelineStats::Stage stage, qint64 since);
+    void record(PipelineStats::Stage stage, qint64 ns, quint64 count = 1);
+
+    WorkStealingPool m_pool;
+    QElapsedTimer m_clock;
+
+    // GUI thread only
+    QHash<QString, std::shared_ptr<ChannelState>> m_channels;
+
+    QMutex m_renderMutex;
+    QList<ProcessedMessage> m_renderQueue;
+    bool m_renderScheduled;
+
+    StageCounter m_stages[PipelineStats::StageCount];
+    std::atomic<int> m_inFlight;
+};
+
+#endif // MESSAGEPIPELINE_H
@@ -0,0 +1,221 @@
+#include "workstealingpool.h"
+#include <QMutexLocker>
+#include <QtGlobal>
+
+namespace {
+// Identifies the calling worker so submit() can use its own deque
+thread_local const WorkStealingPool *t_pool = nullptr;
+thread_local int t_workerIndex = -1;
+
+// Tasks a strand runs before yielding its worker to other strands
+constexpr int STRAND_BATCH = 64;
+}
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : m_pending(0)
+    , m_stopping(false)
+    , m_nextWorker(0)
+    , m_stolen(0)
+{
+    if (threadCount <= 0) {
+        threadCount = qMax(1, QThread::idealThreadCount() - 1);
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        QThread *thread = QThread::create([this, i]() { run(i); });
+        thread->setObjectName(QString("pipeline-%1").arg(i));
+        m_threads.append(thread);
+        thread->start();
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    shutdown();
+}
+
+void WorkStealingPool::shutdown()
+{
+    if (m_stopping.exchange(true)) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&m_sleepMutex);
+        m_wake.wakeAll();
+    }
+    for (QThread *thread : m_threads) {
+        thread->wait();
+        delete thread;
+    }
+    m_threads.clear();
+
+    for (const auto &worker : m_workers) {
+        QMutexLocker locker(&worker->mutex);
+        worker->tasks.clear();
+    }
+    m_pending = 0;
+}
+
+void WorkStealingPool::submit(Task task)
+{
+    enqueue(std::move(task), false);
+}
+
+void WorkStealingPool::submitLater(Task task)
+{
+    enqueue(std::move(task), true);
+}
+
+void WorkStealingPool::enqueue(Task task, bool toFront)
+{
+    if (m_stopping) {
+        return;
+    }
+
+    int index;
+    if (t_pool == this) {
+        index = t_workerIndex;
+    } else {
+        index = int(m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size());
+    }
+
+    {
+        // The owner pops at the back, so the front is "last" locally
+        QMutexLocker locker(&m_workers[index]->mutex);
+        if (toFront) {
+            m_workers[index]->tasks.push_front(std::move(task));
+        } else {
+            m_workers[index]->tasks.push_back(std::move(task));
+        }
+    }
+
+    // Count before waking: a worker checks the count under m_sleepMutex, so
+    // it either sees the task or receives the wake-up
+    m_pending.fetch_add(1);
+    QMutexLocker locker(&m_sleepMutex);
+    m_wake.wakeOne();
+}
+
+int WorkStealingPool::threadCount() const
+{
+    return int(m_workers.size());
+}
+
+int WorkStealingPool::pendingTasks() const
+{
+    return m_pending.load(std::memory_order_relaxed);
+}
+
+quint64 WorkStealingPool::stolenTasks() const
+{
+    return m_stolen.load(std::memory_order_relaxed);
+}
+
+void WorkStealingPool::run(int index)
+{
+    t_pool = this;
+    t_workerIndex = index;
+
+    Task task;
+    while (!m_stopping) {
+        if (popLocal(index, task) || steal(index, task)) {
+            m_pending.fetch_sub(1);
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        QMutexLocker locker(&m_sleepMutex);
+        if (m_pending.load() == 0 && !m_stopping) {
+            m_wake.wait(&m_sleepMutex);
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(int index, Task &task)
+{
+    Worker &worker = *m_workers[index];
+    QMutexLocker locker(&worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(int thief, Task &task)
+{
+    const int count = int(m_workers.size());
+    for (int offset = 1; offset < count; ++offset) {
+        Worker &victim = *m_workers[(thief + offset) % count];
+        // Never block on a busy victim, just try the next one
+        if (!victim.mutex.tryLock()) {
+            continue;
+        }
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            victim.mutex.unlock();
+            m_stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        victim.mutex.unlock();
+    }
+    return false;
+}
+
+Strand::Strand(WorkStealingPool *pool)
+    : m_pool(pool)
+    , m_scheduled(false)
+{
+}
+
+void Strand::post(WorkStealingPool::Task task)
+{
+    bool schedule = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_queue.push_back(std::move(task));
+        if (!m_scheduled) {
+            m_scheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        std::shared_ptr<Strand> self = shared_from_this();
+        m_pool->submit([self]() { self->drain(); });
+    }
+}
+
+int Strand::pendingTasks() const
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_queue.size());
+}
+
+void Strand::drain()
+{
+    for (int i = 0; i < STRAND_BATCH; ++i) {
+        WorkStealingPool::Task task;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_queue.empty()) {
+                m_scheduled = false;
+                return;
+            }
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        task();
+    }
+
+    // Still busy: requeue behind other strands instead of hogging the worker
+    std::shared_ptr<Strand> self = shared_from_this();
+    m_pool->submitLater([self]() { self->drain(); });
+}
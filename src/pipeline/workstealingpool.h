@@ -0,0 +1,88 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QList>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Fixed-size thread pool with one task deque per worker.
+//
+// A worker pushes and pops its own deque at the back (LIFO, cache-warm),
+// idle workers steal from the front of the others' deques (FIFO, oldest
+// and usually largest work first). Tasks submitted from outside the pool
+// are spread round-robin over the workers.
+class WorkStealingPool
+{
+public:
+    using Task = std::function<void()>;
+
+    // threadCount <= 0 uses one thread per core, minus one for the GUI
+    explicit WorkStealingPool(int threadCount = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    void submit(Task task);
+
+    // Like submit(), but from a worker the task goes behind everything that
+    // worker already has queued (used by strands to yield)
+    void submitLater(Task task);
+
+    // Stops the workers; queued tasks are dropped. Called by the destructor.
+    void shutdown();
+
+    int threadCount() const;
+    int pendingTasks() const;
+    quint64 stolenTasks() const;
+
+private:
+    struct Worker {
+        QMutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void enqueue(Task task, bool toFront);
+    void run(int index);
+    bool popLocal(int index, Task &task);
+    bool steal(int thief, Task &task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    QList<QThread*> m_threads;
+
+    QMutex m_sleepMutex;
+    QWaitCondition m_wake;
+    std::atomic<int> m_pending;
+    std::atomic<bool> m_stopping;
+    std::atomic<unsigned> m_nextWorker;
+    std::atomic<quint64> m_stolen;
+};
+
+// Serializes tasks on top of a pool: tasks posted to one strand run one at
+// a time and in order, tasks on different strands run in parallel. Used to
+// keep each channel's messages ordered without a thread per channel.
+// Always held by shared_ptr - a scheduled drain keeps its strand alive.
+class Strand : public std::enable_shared_from_this<Strand>
+{
+public:
+    explicit Strand(WorkStealingPool *pool);
+
+    void post(WorkStealingPool::Task task);
+    int pendingTasks() const;
+
+private:
+    void drain();
+
+    WorkStealingPool *m_pool;
+    mutable QMutex m_mutex;
+    std::deque<WorkStealingPool::Task> m_queue;
+    bool m_scheduled;
+};
+
+#endif // WORKSTEALINGPOOL_H
@@ -86,6 +86,16 @@ void PollDialog::setupUI()
 
     mainLayout->addWidget(choicesGroup);
 
+    // Channels to fan out to
+    m_channelsGroup = new QGroupBox("Channels", this);
+    QVBoxLayout *channelsLayout = new QVBoxLayout(m_channelsGroup);
+    m_channelList = new QListWidget(this);
+    m_channelList->setMaximumHeight(120);
+    channelsLayout->addWidget(m_channelList);
+    m_channelsGroup->setVisible(false);
+
+    mainLayout->addWidget(m_channelsGroup);
+
     // Dialog buttons
     mainLayout->addStretch();
 
@@ -172,9 +182,39 @@ void PollDialog::onCreateClicked()
         choices.append(choice);
     }
 
+    if (m_channelsGroup->isVisible() && selectedChannels().isEmpty()) {
+        QMessageBox::warning(this, "Invalid Input", "Select at least one channel.");
+        m_channelList->setFocus();
+        return;
+    }
+
     accept();
 }
 
+void PollDialog::setChannels(const QStringList &channels, const QStringList &checked)
+{
+    m_channelList->clear();
+    for (const QString &channel : channels) {
+        QListWidgetItem *item = new QListWidgetItem("#" + channel, m_channelList);
+        item->setData(Qt::UserRole, channel);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(checked.contains(channel) ? Qt::Checked : Qt::Unchecked);
+    }
+    m_channelsGroup->setVisible(channels.size() > 1);
+}
+
+QStringList PollDialog::selectedChannels() const
+{
+    QStringList channels;
+    for (int i = 0; i < m_channelList->count(); ++i) {
+        QListWidgetItem *item = m_channelList->item(i);
+        if (item->checkState() == Qt::Checked) {
+            channels.append(item->data(Qt::UserRole).toString());
+        }
+    }
+    return channels;
+}
+
 PollDialog::PollData PollDialog::getPollData() const
 {
     PollData data;
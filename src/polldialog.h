@@ -11,6 +11,7 @@
 #include <QLabel>
 #include <QGroupBox>
 #include <QVector>
+#include <QListWidget>
 
 class PollDialog : public QDialog
 {
@@ -28,6 +29,10 @@ public:
 
     PollData getPollData() const;
 
+    // Offers several channels to start the poll in; hidden until called
+    void setChannels(const QStringList &channels, const QStringList &checked);
+    QStringList selectedChannels() const;
+
 private slots:
     void onAddChoice();
     void onRemoveChoice();
@@ -45,6 +50,8 @@ private:
     QPushButton *m_addChoiceButton;
     QPushButton *m_removeChoiceButton;
     QPushButton *m_createButton;
+    QGroupBox *m_channelsGroup;
+    QListWidget *m_channelList;
     QPushButton *m_cancelButton;
 
     static constexpr int MIN_CHOICES = 2;
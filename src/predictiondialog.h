@@ -10,6 +10,7 @@
 #include <QLabel>
 #include <QGroupBox>
 #include <QVector>
+#include <QListWidget>
 
 class PredictionDialog : public QDialog
 {
@@ -26,6 +27,10 @@ public:
 
     PredictionData getPredictionData() const;
 
+    // Offers several channels to start the prediction in; hidden until called
+    void setChannels(const QStringList &channels, const QStringList &checked);
+    QStringList selectedChannels() const;
+
 private slots:
     void onAddOutcome();
     void onRemoveOutcome();
@@ -42,6 +47,8 @@ private:
     QPushButton *m_addOutcomeButton;
     QPushButton *m_removeOutcomeButton;
     QPushButton *m_createButton;
+    QGroupBox *m_channelsGroup;
+    QListWidget *m_channelList;
     QPushButton *m_cancelButton;
 
     static constexpr int MIN_OUTCOMES = 2;
@@ -0,0 +1,28 @@
+#ifndef CHATMESSAGE_H
+#define CHATMESSAGE_H
+
+#include <QString>
+#include <QHash>
+#include "moderation/textfeatures.h"
+
+// A parsed PRIVMSG with its IRCv3 tags and the per-message text features
+// used by the moderation heuristics.
+struct ChatMessage {
+    QString channel;
+    QString username;
+    QString displayName;
+    QString userId;      // "user-id" tag
+    QString messageId;   // "id" tag
+    QString roomId;      // "room-id" tag (broadcaster id)
+    QString text;
+    QHash<QString, QString> tags;
+
+    qint64 timestamp = 0;        // "tmi-sent-ts" in ms since epoch, or receive time
+    qint64 receivedMs = 0;       // local clock on arrival; drives every detection window,
+                                 // so messages and joins never mix clocks
+    bool isFirstMessage = false; // "first-msg" tag
+
+    TextFeatures features;
+};
+
+#endif // CHATMESSAGE_H
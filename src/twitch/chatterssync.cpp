@@ -0,0 +1,191 @@
+#include "chatterssync.h"
+#include "twitchapi.h"
+#include <QDebug>
+
+namespace {
+// Every page is one request out of the shared rate-limit bucket
+constexpr qint64 INTERVAL_PER_PAGE_MS = 5 * 1000;
+constexpr double HIGH_CHURN = 0.05;
+constexpr double LOW_CHURN = 0.01;
+}
+
+ChattersSync::ChattersSync(TwitchAPI *api, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_nextGeneration(1)
+{
+}
+
+void ChattersSync::start(const QString &channel, const QString &broadcasterId, const QString &moderatorId)
+{
+    auto it = m_jobs.constFind(channel);
+    if (it != m_jobs.constEnd() && it->broadcasterId == broadcasterId && it->moderatorId == moderatorId) {
+        return;
+    }
+    stop(channel);
+
+    Job job;
+    job.broadcasterId = broadcasterId;
+    job.moderatorId = moderatorId;
+    job.generation = m_nextGeneration++;
+    job.timer = new QTimer(this);
+    job.timer->setSingleShot(true);
+    connect(job.timer, &QTimer::timeout, this, [this, channel]() {
+        beginRound(channel);
+    });
+    m_jobs.insert(channel, job);
+
+    beginRound(channel);
+}
+
+void ChattersSync::stop(const QString &channel)
+{
+    auto it = m_jobs.find(channel);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    it->timer->stop();
+    it->timer->deleteLater();
+    m_jobs.erase(it);
+}
+
+bool ChattersSync::isSyncing(const QString &channel) const
+{
+    return m_jobs.contains(channel);
+}
+
+QSet<QString> ChattersSync::members(const QString &channel) const
+{
+    auto it = m_jobs.constFind(channel);
+    if (it == m_jobs.constEnd()) {
+        return QSet<QString>();
+    }
+    // Accounts missing from this round are only dropped once it is complete
+    QSet<QString> result = it->snapshot;
+    result.unite(it->seen);
+    return result;
+}
+
+int ChattersSync::total(const QString &channel) const
+{
+    return m_jobs.value(channel).total;
+}
+
+void ChattersSync::beginRound(const QString &channel)
+{
+    auto it = m_jobs.find(channel);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    it->seen.clear();
+    it->pages = 0;
+    it->roundTimer.start();
+    fetchPage(channel, it->generation, QString());
+}
+
+void ChattersSync::fetchPage(const QString &channel, quint64 generation, const QString &cursor)
+{
+    const Job &job = m_jobs[channel];
+    m_api->getChatters(job.broadcasterId, job.moderatorId, cursor)
+        .then(this, [this, channel, generation](const ApiResult<ChatterPage> &result) {
+            onPage(channel, generation, result);
+        });
+}
+
+void ChattersSync::onPage(const QString &channel, quint64 generation, const ApiResult<ChatterPage> &result)
+{
+    auto it = m_jobs.find(channel);
+    if (it == m_jobs.end() || it->generation != generation) {
+        return;
+    }
+    Job &job = it.value();
+
+    if (!result.ok()) {
+        if (result.statusCode == 401 || result.statusCode == 403) {
+            stop(channel);
+            emit syncFailed(channel, result.error);
+            return;
+        }
+        // Keep the snapshot and retry the whole round later
+        qWarning() << "Chatters sync for" << channel << "failed:" << result.statusCode << result.error;
+        job.timer->start(int(job.intervalMs));
+        return;
+    }
+
+    ++job.pages;
+    job.total = result.value.total;
+
+    QStringList joined;
+    for (const UserRef &chatter : result.value.chatters) {
+        // Pages can overlap while the list shifts underneath the cursor
+        if (chatter.login.isEmpty() || job.seen.contains(chatter.login)) {
+            continue;
+        }
+        job.seen.insert(chatter.login);
+        if (!job.snapshot.contains(chatter.login)) {
+            joined.append(chatter.login);
+        }
+    }
+
+    const QString cursor = result.value.cursor;
+    if (!cursor.isEmpty()) {
+        fetchPage(channel, generation, cursor);
+    }
+
+    // Before syncFinished, so listeners that settle on it have the last
+    // page's logins too
+    if (!joined.isEmpty()) {
+        emit chattersJoined(channel, joined);
+    }
+
+    if (cursor.isEmpty()) {
+        // A receiver may have stopped or restarted the channel
+        it = m_jobs.find(channel);
+        if (it != m_jobs.end() && it->generation == generation) {
+            finishRound(channel, it.value());
+        }
+    }
+}
+
+void ChattersSync::finishRound(const QString &channel, Job &job)
+{
+    QStringList parted;
+    for (const QString &login : std::as_const(job.snapshot)) {
+        if (!job.seen.contains(login)) {
+            parted.append(login);
+        }
+    }
+
+    // Churn only means something against a previous snapshot
+    if (job.hasSnapshot) {
+        int joined = 0;
+        for (const QString &login : std::as_const(job.seen)) {
+            if (!job.snapshot.contains(login)) {
+                ++joined;
+            }
+        }
+        const double churn = double(joined + parted.size()) / double(qMax<qsizetype>(1, job.seen.size()));
+        if (churn > HIGH_CHURN) {
+            job.intervalMs /= 2;
+        } else if (churn < LOW_CHURN) {
+            job.intervalMs = job.intervalMs * 3 / 2;
+        }
+    }
+    const qint64 floorMs = qMax(MIN_INTERVAL_MS, job.pages * INTERVAL_PER_PAGE_MS);
+    job.intervalMs = qBound(floorMs, job.intervalMs, qMax(floorMs, MAX_INTERVAL_MS));
+
+    job.snapshot.swap(job.seen);
+    job.seen.clear();
+    job.hasSnapshot = true;
+    job.timer->start(int(job.intervalMs));
+
+    const int count = int(job.snapshot.size());
+    const int pages = job.pages;
+    const qint64 elapsedMs = job.roundTimer.elapsed();
+
+    // Signals last: a receiver may stop the channel and invalidate job
+    if (!parted.isEmpty()) {
+        emit chattersParted(channel, parted);
+    }
+    emit syncFinished(channel, count, pages, elapsedMs);
+}
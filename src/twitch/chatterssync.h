@@ -0,0 +1,76 @@
+#ifndef CHATTERSSYNC_H
+#define CHATTERSSYNC_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "helixtypes.h"
+
+class TwitchAPI;
+
+// Keeps the full chatter list of each open channel in sync with Helix.
+//
+// A round walks every page of GET /chat/chatters (1000 per page) and
+// streams it into the channel's membership store: accounts not seen
+// before are reported as joined as soon as their page arrives, so the
+// user list fills while the walk continues. When the last page is in,
+// the previous snapshot minus everything seen this round are the parts.
+//
+// Rounds repeat on an adaptive interval: large channels (many pages) and
+// quiet ones back off, channels with high churn are polled sooner. Helix
+// only lists chatters to moderators; a 401/403 stops that channel.
+class ChattersSync : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChattersSync(TwitchAPI *api, QObject *parent = nullptr);
+
+    void start(const QString &channel, const QString &broadcasterId, const QString &moderatorId);
+    void stop(const QString &channel);
+    bool isSyncing(const QString &channel) const;
+
+    // Membership store: last complete snapshot plus this round's pages
+    QSet<QString> members(const QString &channel) const;
+    int total(const QString &channel) const; // Helix's count, may exceed members
+
+    static constexpr qint64 MIN_INTERVAL_MS = 15 * 1000;
+    static constexpr qint64 BASE_INTERVAL_MS = 30 * 1000;
+    static constexpr qint64 MAX_INTERVAL_MS = 5 * 60 * 1000;
+
+signals:
+    void chattersJoined(const QString &channel, const QStringList &logins);
+    void chattersParted(const QString &channel, const QStringList &logins);
+    void syncFinished(const QString &channel, int count, int pages, qint64 elapsedMs);
+    void syncFailed(const QString &channel, const QString &error);
+
+private:
+    struct Job {
+        QString broadcasterId;
+        QString moderatorId;
+        QSet<QString> snapshot; // last complete round
+        QSet<QString> seen;     // this round so far
+        int total = 0;
+        int pages = 0;
+        quint64 generation = 0; // bumped by stop()/start(), stale pages are dropped
+        qint64 intervalMs = BASE_INTERVAL_MS;
+        bool hasSnapshot = false;
+        QElapsedTimer roundTimer;
+        QTimer *timer = nullptr;
+    };
+
+    void beginRound(const QString &channel);
+    void fetchPage(const QString &channel, quint64 generation, const QString &cursor);
+    void onPage(const QString &channel, quint64 generation, const ApiResult<ChatterPage> &result);
+    void finishRound(const QString &channel, Job &job);
+
+    TwitchAPI *m_api;
+    QHash<QString, Job> m_jobs;
+    quint64 m_nextGeneration;
+};
+
+#endif // CHATTERSSYNC_H
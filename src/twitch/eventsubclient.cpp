@@ -0,0 +1,588 @@
+#include "eventsubclient.h"
+#include "twitchapi.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QUrl>
+#include <QDebug>
+
+namespace {
+constexpr int INITIAL_BACKOFF_MS = 1000;
+constexpr int KEEPALIVE_GRACE_MS = 5000;
+constexpr int DEFAULT_KEEPALIVE_S = 10;
+constexpr int MAX_SEEN_IDS = 1000;
+
+enum class Condition {
+    Broadcaster,          // broadcaster_user_id
+    BroadcasterModerator, // + moderator_user_id
+    BroadcasterUser       // + user_id
+};
+
+enum class Channels {
+    All,
+    Own,       // needs the broadcaster's own authorization
+    Moderated  // channels the user moderates but doesn't own
+};
+
+struct SubscriptionSpec {
+    const char *type;
+    const char *version;
+    Condition condition;
+    Channels channels;
+};
+
+// channel.ban/unban are broadcaster-only; in other channels the same
+// actions come from channel.moderate, which a moderator may subscribe to
+const SubscriptionSpec SUBSCRIPTIONS[] = {
+    {"channel.ban", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.unban", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.moderate", "2", Condition::BroadcasterModerator, Channels::Moderated},
+    {"automod.message.hold", "2", Condition::BroadcasterModerator, Channels::All},
+    {"automod.message.update", "2", Condition::BroadcasterModerator, Channels::All},
+    {"channel.chat_settings.update", "1", Condition::BroadcasterUser, Channels::All},
+    {"channel.poll.begin", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.poll.progress", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.poll.end", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.prediction.begin", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.prediction.progress", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.prediction.lock", "1", Condition::Broadcaster, Channels::Own},
+    {"channel.prediction.end", "1", Condition::Broadcaster, Channels::Own},
+};
+
+QDateTime parseTime(const QJsonValue &value)
+{
+    return QDateTime::fromString(value.toString(), Qt::ISODate);
+}
+
+Poll pollFromEvent(const QJsonObject &event, const QString &status)
+{
+    Poll poll;
+    poll.id = event.value("id").toString();
+    poll.broadcasterId = event.value("broadcaster_user_id").toString();
+    poll.title = event.value("title").toString();
+    poll.status = status;
+    poll.channelPointsVotingEnabled = event.value("channel_points_voting").toObject()
+                                          .value("is_enabled").toBool();
+    poll.startedAt = parseTime(event.value("started_at"));
+    const QDateTime endsAt = parseTime(event.value("ends_at"));
+    if (poll.startedAt.isValid() && endsAt.isValid()) {
+        poll.durationSeconds = int(poll.startedAt.secsTo(endsAt));
+    }
+
+    const QJsonArray choices = event.value("choices").toArray();
+    for (const QJsonValue &value : choices) {
+        const QJsonObject object = value.toObject();
+        PollChoice choice;
+        choice.id = object.value("id").toString();
+        choice.title = object.value("title").toString();
+        choice.votes = object.value("votes").toInt();
+        choice.channelPointsVotes = object.value("channel_points_votes").toInt();
+        poll.choices.append(choice);
+    }
+    return poll;
+}
+
+Prediction predictionFromEvent(const QJsonObject &event, const QString &status)
+{
+    Prediction prediction;
+    prediction.id = event.value("id").toString();
+    prediction.broadcasterId = event.value("broadcaster_user_id").toString();
+    prediction.title = event.value("title").toString();
+    prediction.status = status;
+    prediction.winningOutcomeId = event.value("winning_outcome_id").toString();
+    prediction.createdAt = parseTime(event.value("started_at"));
+    const QDateTime locksAt = parseTime(event.value("locks_at"));
+    if (prediction.createdAt.isValid() && locksAt.isValid()) {
+        prediction.predictionWindowSeconds = int(prediction.createdAt.secsTo(locksAt));
+    }
+
+    const QJsonArray outcomes = event.value("outcomes").toArray();
+    for (const QJsonValue &value : outcomes) {
+        const QJsonObject object = value.toObject();
+        PredictionOutcome outcome;
+        outcome.id = object.value("id").toString();
+        outcome.title = object.value("title").toString();
+        outcome.color = object.value("color").toString().toUpper();
+        outcome.users = object.value("users").toInt();
+        outcome.channelPoints = qint64(object.value("channel_points").toDouble());
+        prediction.outcomes.append(outcome);
+    }
+    return prediction;
+}
+
+ChatSettings chatSettingsFromEvent(const QJsonObject &event)
+{
+    ChatSettings settings;
+    settings.broadcasterId = event.value("broadcaster_user_id").toString();
+    settings.emoteMode = event.value("emote_mode").toBool();
+    settings.followerMode = event.value("follower_mode").toBool();
+    settings.followerModeDurationMinutes = event.value("follower_mode_duration_minutes").toInt();
+    settings.slowMode = event.value("slow_mode").toBool();
+    settings.slowModeWaitSeconds = event.value("slow_mode_wait_time_seconds").toInt();
+    settings.subscriberMode = event.value("subscriber_mode").toBool();
+    settings.uniqueChatMode = event.value("unique_chat_mode").toBool();
+    return settings;
+}
+}
+
+EventSubClient::EventSubClient(TwitchAPI *api, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_running(false)
+    , m_socket(nullptr)
+    , m_pendingSocket(nullptr)
+    , m_keepaliveMs(0)
+    , m_keepaliveTimer(new QTimer(this))
+    , m_reconnectTimer(new QTimer(this))
+    , m_backoffMs(INITIAL_BACKOFF_MS)
+{
+    m_keepaliveTimer->setSingleShot(true);
+    connect(m_keepaliveTimer, &QTimer::timeout, this, [this]() {
+        qWarning() << "EventSub: no message for" << m_keepaliveMs << "ms, reconnecting";
+        dropSession();
+    });
+
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, [this]() {
+        if (m_running && !m_socket && !m_channels.isEmpty()) {
+            m_socket = openSocket(QUrl(SESSION_URL));
+        }
+    });
+}
+
+EventSubClient::~EventSubClient()
+{
+    stop();
+}
+
+void EventSubClient::start(const QString &userId)
+{
+    if (m_running && m_userId == userId) {
+        return;
+    }
+    stop();
+    m_userId = userId;
+    m_running = true;
+    m_backoffMs = INITIAL_BACKOFF_MS;
+    // Twitch closes a session that has no subscription after 10 seconds,
+    // so there is no connection until a channel is open
+    if (!m_channels.isEmpty()) {
+        m_socket = openSocket(QUrl(SESSION_URL));
+    }
+}
+
+void EventSubClient::stop()
+{
+    m_running = false;
+    closeSession();
+}
+
+void EventSubClient::closeSession()
+{
+    m_reconnectTimer->stop();
+    if (m_pendingSocket) {
+        m_pendingSocket->disconnect(this);
+        m_pendingSocket->abort();
+        m_pendingSocket->deleteLater();
+        m_pendingSocket = nullptr;
+    }
+    dropSession();
+}
+
+QWebSocket *EventSubClient::openSocket(const QUrl &url)
+{
+    QWebSocket *socket = new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this);
+    connect(socket, &QWebSocket::textMessageReceived, this, [this, socket](const QString &message) {
+        onMessage(socket, message);
+    });
+    connect(socket, &QWebSocket::disconnected, this, [this, socket]() {
+        onClosed(socket);
+    });
+    // A connect that never succeeds reports an error, not a disconnect
+    connect(socket, &QWebSocket::errorOccurred, this, [this, socket]() {
+        if (socket->state() == QAbstractSocket::UnconnectedState) {
+            onClosed(socket);
+        }
+    });
+    qDebug() << "EventSub: connecting to" << url.toString();
+    socket->open(url);
+    return socket;
+}
+
+void EventSubClient::onClosed(QWebSocket *socket)
+{
+    if (socket == m_pendingSocket) {
+        // The old connection still works until Twitch closes it
+        qWarning() << "EventSub: reconnect URL closed before its welcome";
+        m_pendingSocket = nullptr;
+    }
+    else if (socket == m_socket) {
+        qWarning() << "EventSub: session closed" << socket->closeCode() << socket->closeReason();
+        dropSession();
+        return;
+    }
+    // Otherwise the old connection after a session_reconnect
+    socket->disconnect(this);
+    socket->deleteLater();
+}
+
+void EventSubClient::dropSession()
+{
+    if (m_socket) {
+        m_socket->disconnect(this);
+        m_socket->abort();
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+    m_sessionId.clear();
+    m_keepaliveTimer->stop();
+
+    // Subscriptions die with their session
+    for (Channel &channel : m_channels) {
+        channel.subscriptions.clear();
+        channel.requested.clear();
+        channel.failed = 0;
+    }
+
+    if (m_running && !m_channels.isEmpty()) {
+        scheduleReconnect();
+    }
+}
+
+void EventSubClient::scheduleReconnect()
+{
+    if (m_reconnectTimer->isActive()) {
+        return;
+    }
+    qDebug() << "EventSub: reconnecting in" << m_backoffMs << "ms";
+    m_reconnectTimer->start(m_backoffMs);
+    m_backoffMs = qMin(MAX_BACKOFF_MS, m_backoffMs * 2);
+}
+
+void EventSubClient::armKeepalive()
+{
+    if (m_keepaliveMs > 0) {
+        m_keepaliveTimer->start(int(m_keepaliveMs));
+    }
+}
+
+bool EventSubClient::isDuplicate(const QString &messageId)
+{
+    if (messageId.isEmpty()) {
+        return false;
+    }
+    if (m_seenIds.contains(messageId)) {
+        return true;
+    }
+    m_seenIds.insert(messageId);
+    m_seenOrder.push_back(messageId);
+    if (int(m_seenOrder.size()) > MAX_SEEN_IDS) {
+        m_seenIds.remove(m_seenOrder.front());
+        m_seenOrder.pop_front();
+    }
+    return false;
+}
+
+void EventSubClient::onMessage(QWebSocket *socket, const QString &message)
+{
+    const QJsonObject root = QJsonDocument::fromJson(message.toUtf8()).object();
+    const QJsonObject metadata = root.value("metadata").toObject();
+    const QJsonObject payload = root.value("payload").toObject();
+    const QString messageType = metadata.value("message_type").toString();
+
+    if (messageType == "session_welcome") {
+        onWelcome(socket, payload.value("session").toObject());
+        return;
+    }
+    if (socket != m_socket) {
+        return;
+    }
+
+    // Any message proves the connection alive
+    armKeepalive();
+
+    if (messageType == "session_keepalive") {
+        ++m_stats.keepalives;
+    }
+    else if (messageType == "notification") {
+        if (isDuplicate(metadata.value("message_id").toString())) {
+            ++m_stats.duplicates;
+            return;
+        }
+        ++m_stats.notifications;
+        onNotification(metadata.value("subscription_type").toString(), payload.value("event").toObject());
+    }
+    else if (messageType == "session_reconnect") {
+        const QString url = payload.value("session").toObject().value("reconnect_url").toString();
+        qDebug() << "EventSub: server asked to reconnect";
+        if (!url.isEmpty() && !m_pendingSocket) {
+            m_pendingSocket = openSocket(QUrl(url));
+        }
+    }
+    else if (messageType == "revocation") {
+        onRevocation(payload.value("subscription").toObject());
+    }
+}
+
+void EventSubClient::onWelcome(QWebSocket *socket, const QJsonObject &session)
+{
+    const QString sessionId = session.value("id").toString();
+    const int keepaliveSeconds = session.value("keepalive_timeout_seconds").toInt(DEFAULT_KEEPALIVE_S);
+    m_keepaliveMs = qint64(keepaliveSeconds) * 1000 + KEEPALIVE_GRACE_MS;
+
+    if (socket == m_pendingSocket) {
+        // Same session on a new connection, subscriptions carry over
+        QWebSocket *old = m_socket;
+        m_socket = socket;
+        m_pendingSocket = nullptr;
+        m_sessionId = sessionId;
+        ++m_stats.reconnects;
+        if (old) {
+            old->close();
+        }
+        armKeepalive();
+        return;
+    }
+    if (socket != m_socket) {
+        return;
+    }
+
+    m_sessionId = sessionId;
+    m_backoffMs = INITIAL_BACKOFF_MS;
+    ++m_stats.sessions;
+    armKeepalive();
+    qDebug() << "EventSub: session" << m_sessionId << "started, keepalive" << keepaliveSeconds << "s";
+
+    // Twitch closes a session without subscriptions after 10 seconds
+    for (auto it = m_channels.constBegin(); it != m_channels.constEnd(); ++it) {
+        subscribe(it.key());
+    }
+}
+
+void EventSubClient::addChannel(const QString &channel, const QString &broadcasterId)
+{
+    Channel &entry = m_channels[channel];
+    if (entry.broadcasterId != broadcasterId) {
+        entry = Channel();
+        entry.broadcasterId = broadcasterId;
+    }
+    if (m_running && !m_socket && !m_reconnectTimer->isActive()) {
+        m_backoffMs = INITIAL_BACKOFF_MS;
+        m_socket = openSocket(QUrl(SESSION_URL));
+        return; // subscribed on the welcome
+    }
+    subscribe(channel);
+}
+
+void EventSubClient::removeChannel(const QString &channel)
+{
+    auto it = m_channels.find(channel);
+    if (it == m_channels.end()) {
+        return;
+    }
+    for (const QString &subscriptionId : std::as_const(it->subscriptions)) {
+        if (!subscriptionId.isEmpty()) {
+            m_api->deleteEventSubSubscription(subscriptionId);
+        }
+    }
+    m_channels.erase(it);
+
+    // The last channel's subscriptions are going away; an empty session
+    // would be closed by Twitch and reconnected in a loop
+    if (m_channels.isEmpty()) {
+        closeSession();
+    }
+}
+
+void EventSubClient::subscribe(const QString &channel)
+{
+    if (m_sessionId.isEmpty()) {
+        return; // done on the welcome
+    }
+    auto it = m_channels.find(channel);
+    if (it == m_channels.end()) {
+        return;
+    }
+
+    int used = 0;
+    for (const Channel &entry : std::as_const(m_channels)) {
+        used += int(entry.requested.size());
+    }
+
+    const QString broadcasterId = it->broadcasterId;
+    const QString sessionId = m_sessionId;
+    for (const SubscriptionSpec &spec : SUBSCRIPTIONS) {
+        const QString type = spec.type;
+        const bool own = broadcasterId == m_userId;
+        if (it->requested.contains(type)
+            || (spec.channels == Channels::Own && !own)
+            || (spec.channels == Channels::Moderated && own)) {
+            continue;
+        }
+        if (used >= MAX_SUBSCRIPTIONS) {
+            qWarning() << "EventSub: subscription limit reached, #" + channel << "is not fully covered";
+            break;
+        }
+
+        QJsonObject condition{{"broadcaster_user_id", broadcasterId}};
+        if (spec.condition == Condition::BroadcasterModerator) {
+            condition["moderator_user_id"] = m_userId;
+        } else if (spec.condition == Condition::BroadcasterUser) {
+            condition["user_id"] = m_userId;
+        }
+
+        it->requested.insert(type);
+        ++used;
+        m_api->createEventSubSubscription(type, spec.version, condition, sessionId)
+            .then(this, [this, channel, type, sessionId](const ApiResult<EventSubSubscription> &result) {
+                auto entry = m_channels.find(channel);
+                if (sessionId != m_sessionId || entry == m_channels.end()) {
+                    return;
+                }
+                if (result.ok()) {
+                    entry->subscriptions.insert(type, result.value.id);
+                } else if (result.statusCode == 409) {
+                    // Already exists on this session (the id is not returned);
+                    // it dies with the session like the others
+                    entry->subscriptions.insert(type, QString());
+                } else {
+                    ++entry->failed;
+                    qWarning() << "EventSub:" << type << "for #" + channel << "failed:"
+                               << result.statusCode << result.error;
+                }
+            });
+    }
+}
+
+void EventSubClient::onRevocation(const QJsonObject &subscription)
+{
+    const QString id = subscription.value("id").toString();
+    const QString type = subscription.value("type").toString();
+    qWarning() << "EventSub:" << type << "revoked:" << subscription.value("status").toString();
+
+    for (Channel &channel : m_channels) {
+        if (channel.subscriptions.value(type) == id) {
+            channel.subscriptions.remove(type);
+            ++channel.failed;
+        }
+    }
+}
+
+void EventSubClient::onNotification(const QString &type, const QJsonObject &event)
+{
+    const QString channel = event.value("broadcaster_user_login").toString();
+
+    if (type == "channel.poll.begin" || type == "channel.poll.progress") {
+        emit pollUpdated(channel, pollFromEvent(event, "ACTIVE"));
+    }
+    else if (type == "channel.poll.end") {
+        emit pollUpdated(channel, pollFromEvent(event, event.value("status").toString().toUpper()));
+    }
+    else if (type == "channel.prediction.begin" || type == "channel.prediction.progress") {
+        emit predictionUpdated(channel, predictionFromEvent(event, "ACTIVE"));
+    }
+    else if (type == "channel.prediction.lock") {
+        emit predictionUpdated(channel, predictionFromEvent(event, "LOCKED"));
+    }
+    else if (type == "channel.prediction.end") {
+        emit predictionUpdated(channel, predictionFromEvent(event, event.value("status").toString().toUpper()));
+    }
+    else if (type == "channel.ban") {
+        BanEvent ban;
+        ban.broadcasterId = event.value("broadcaster_user_id").toString();
+        ban.channel = channel;
+        ban.userId = event.value("user_id").toString();
+        ban.userLogin = event.value("user_login").toString();
+        ban.moderatorLogin = event.value("moderator_user_login").toString();
+        ban.reason = event.value("reason").toString();
+        ban.permanent = event.value("is_permanent").toBool(true);
+        ban.endsAt = parseTime(event.value("ends_at"));
+        emit userBanned(ban);
+    }
+    else if (type == "channel.unban") {
+        UnbanEvent unban;
+        unban.broadcasterId = event.value("broadcaster_user_id").toString();
+        unban.channel = channel;
+        unban.userId = event.value("user_id").toString();
+        unban.userLogin = event.value("user_login").toString();
+        unban.moderatorLogin = event.value("moderator_user_login").toString();
+        emit userUnbanned(unban);
+    }
+    else if (type == "channel.moderate") {
+        // Only the ban-list actions; the user/moderator fields sit in an
+        // object named after the action
+        const QString action = event.value("action").toString();
+        const QJsonObject target = event.value(action).toObject();
+        if (action == "ban" || action == "timeout") {
+            BanEvent ban;
+            ban.broadcasterId = event.value("broadcaster_user_id").toString();
+            ban.channel = channel;
+            ban.userId = target.value("user_id").toString();
+            ban.userLogin = target.value("user_login").toString();
+            ban.moderatorLogin = event.value("moderator_user_login").toString();
+            ban.reason = target.value("reason").toString();
+            ban.permanent = action == "ban";
+            ban.endsAt = parseTime(target.value("expires_at"));
+            emit userBanned(ban);
+        }
+        else if (action == "unban" || action == "untimeout") {
+            UnbanEvent unban;
+            unban.broadcasterId = event.value("broadcaster_user_id").toString();
+            unban.channel = channel;
+            unban.userId = target.value("user_id").toString();
+            unban.userLogin = target.value("user_login").toString();
+            unban.moderatorLogin = event.value("moderator_user_login").toString();
+            emit userUnbanned(unban);
+        }
+    }
+    else if (type == "automod.message.hold") {
+        AutoModHoldEvent hold;
+        hold.broadcasterId = event.value("broadcaster_user_id").toString();
+        hold.channel = channel;
+        hold.messageId = event.value("message_id").toString();
+        hold.userId = event.value("user_id").toString();
+        hold.userLogin = event.value("user_login").toString();
+        hold.text = event.value("message").toObject().value("text").toString();
+        hold.heldAt = parseTime(event.value("held_at"));
+        if (event.value("reason").toString() == "blocked_term") {
+            hold.category = "blocked term";
+        } else {
+            const QJsonObject automod = event.value("automod").toObject();
+            hold.category = automod.value("category").toString();
+            hold.level = automod.value("level").toInt();
+        }
+        emit autoModHeld(hold);
+    }
+    else if (type == "automod.message.update") {
+        AutoModUpdateEvent update;
+        update.broadcasterId = event.value("broadcaster_user_id").toString();
+        update.channel = channel;
+        update.messageId = event.value("message_id").toString();
+        update.userLogin = event.value("user_login").toString();
+        update.status = event.value("status").toString();
+        update.moderatorLogin = event.value("moderator_user_login").toString();
+        emit autoModResolved(update);
+    }
+    else if (type == "channel.chat_settings.update") {
+        emit chatSettingsChanged(channel, chatSettingsFromEvent(event));
+    }
+}
+
+bool EventSubClient::isSubscribed(const QString &channel, const QString &type) const
+{
+    auto it = m_channels.constFind(channel);
+    return !m_sessionId.isEmpty() && it != m_channels.constEnd() && it->subscriptions.contains(type);
+}
+
+EventSubStats EventSubClient::stats() const
+{
+    EventSubStats stats = m_stats;
+    stats.connected = !m_sessionId.isEmpty();
+    stats.channels = int(m_channels.size());
+    stats.subscriptions = 0;
+    stats.failedSubscriptions = 0;
+    for (const Channel &channel : m_channels) {
+        stats.subscriptions += int(channel.subscriptions.size());
+        stats.failedSubscriptions += channel.failed;
+    }
+    return stats;
+}
@@ -0,0 +1,165 @@
+#ifndef EVENTSUBCLIENT_H
+#define EVENTSUBCLIENT_H
+
+#include <QObject>
+#include <QWebSocket>
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+#include <QDateTime>
+#include <QJsonObject>
+#include <deque>
+#include "helixtypes.h"
+
+class TwitchAPI;
+
+// channel.ban, or a ban/timeout from channel.moderate; timeouts are bans
+// with an end time
+struct BanEvent {
+    QString broadcasterId;
+    QString channel; // broadcaster login
+    QString userId;
+    QString userLogin;
+    QString moderatorLogin;
+    QString reason;
+    bool permanent = true;
+    QDateTime endsAt;
+};
+
+// channel.unban, or an unban/untimeout from channel.moderate
+struct UnbanEvent {
+    QString broadcasterId;
+    QString channel;
+    QString userId;
+    QString userLogin;
+    QString moderatorLogin;
+};
+
+// automod.message.hold
+struct AutoModHoldEvent {
+    QString broadcasterId;
+    QString channel;
+    QString messageId;
+    QString userId;
+    QString userLogin;
+    QString text;
+    QString category; // AutoMod category, or "blocked term"
+    int level = 0;
+    QDateTime heldAt;
+};
+
+// automod.message.update
+struct AutoModUpdateEvent {
+    QString broadcasterId;
+    QString channel;
+    QString messageId;
+    QString userLogin;
+    QString status; // "Approved", "Denied" or "Expired"
+    QString moderatorLogin;
+};
+
+struct EventSubStats {
+    bool connected = false;
+    int channels = 0;
+    int subscriptions = 0;
+    int failedSubscriptions = 0;
+    quint64 notifications = 0;
+    quint64 duplicates = 0;  // redelivered message ids, dropped
+    quint64 keepalives = 0;
+    quint64 sessions = 0;    // welcomes on a fresh connection
+    quint64 reconnects = 0;  // server-requested moves to a new URL
+};
+
+// EventSub WebSocket session for the logged-in moderator.
+//
+// Polls, predictions, bans, unbans, AutoMod holds and chat settings
+// changes are pushed over one WebSocket instead of being polled. After
+// the welcome, every open channel's subscriptions are created through
+// Helix in one pass; they are bound to the session and die with it, so a
+// fresh session (after a dropped connection) subscribes again. A
+// session_reconnect is followed without losing them: the new URL is
+// opened next to the old connection and swapped in on its welcome.
+//
+// The WebSocket is only open while at least one channel is: Twitch closes
+// a session that has no subscription within 10 seconds.
+//
+// Silence longer than the session's keepalive timeout counts as a dead
+// connection. Notifications are de-duplicated by message id.
+// Poll, prediction, ban and unban events are only available to the
+// broadcaster, so they are subscribed for the user's own channel only;
+// in channels the user moderates, bans and unbans come from
+// channel.moderate instead.
+class EventSubClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EventSubClient(TwitchAPI *api, QObject *parent = nullptr);
+    ~EventSubClient();
+
+    void start(const QString &userId);
+    void stop();
+
+    void addChannel(const QString &channel, const QString &broadcasterId);
+    void removeChannel(const QString &channel);
+
+    // Whether events of this type are currently being delivered for channel
+    bool isSubscribed(const QString &channel, const QString &type) const;
+
+    EventSubStats stats() const;
+
+    static constexpr const char *SESSION_URL = "wss://eventsub.wss.twitch.tv/ws";
+    static constexpr int MAX_SUBSCRIPTIONS = 300; // per WebSocket session
+    static constexpr int MAX_BACKOFF_MS = 60 * 1000;
+
+signals:
+    void pollUpdated(const QString &channel, const Poll &poll);
+    void predictionUpdated(const QString &channel, const Prediction &prediction);
+    void userBanned(const BanEvent &event);
+    void userUnbanned(const UnbanEvent &event);
+    void autoModHeld(const AutoModHoldEvent &event);
+    void autoModResolved(const AutoModUpdateEvent &event);
+    void chatSettingsChanged(const QString &channel, const ChatSettings &settings);
+
+private:
+    struct Channel {
+        QString broadcasterId;
+        QHash<QString, QString> subscriptions; // type -> subscription id, empty after a 409
+        QSet<QString> requested;               // types created or being created
+        int failed = 0;
+    };
+
+    QWebSocket *openSocket(const QUrl &url);
+    void onMessage(QWebSocket *socket, const QString &message);
+    void onClosed(QWebSocket *socket);
+    void onWelcome(QWebSocket *socket, const QJsonObject &session);
+    void onNotification(const QString &type, const QJsonObject &event);
+    void onRevocation(const QJsonObject &subscription);
+    void dropSession();
+    void closeSession(); // drops the session without reconnecting
+    void scheduleReconnect();
+    void armKeepalive();
+    void subscribe(const QString &channel);
+    bool isDuplicate(const QString &messageId);
+
+    TwitchAPI *m_api;
+    QString m_userId;
+    bool m_running;
+
+    QWebSocket *m_socket;        // the session's connection
+    QWebSocket *m_pendingSocket; // session_reconnect target until its welcome
+    QString m_sessionId;
+    qint64 m_keepaliveMs;
+    QTimer *m_keepaliveTimer;
+    QTimer *m_reconnectTimer;
+    int m_backoffMs;
+
+    QHash<QString, Channel> m_channels;
+    QSet<QString> m_seenIds;
+    std::deque<QString> m_seenOrder;
+
+    EventSubStats m_stats;
+};
+
+#endif // EVENTSUBCLIENT_H
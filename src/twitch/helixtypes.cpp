@@ -0,0 +1,269 @@
+#include "helixtypes.h"
+#include "jsonreader.h"
+
+namespace {
+QDateTime parseTime(const QJsonValue &value)
+{
+    return QDateTime::fromString(value.toString(), Qt::ISODate);
+}
+
+// Reader is on the element's BeginObject; leaves it on its EndObject
+TwitchUser readUser(JsonReader &reader)
+{
+    TwitchUser user;
+    while (reader.next() == JsonReader::Name) {
+        const QByteArrayView name = reader.rawValue();
+        reader.next();
+        if (name == "id") {
+            user.id = reader.stringValue();
+        } else if (name == "login") {
+            user.login = reader.stringValue();
+        } else if (name == "display_name") {
+            user.displayName = reader.stringValue();
+        } else if (name == "type") {
+            user.type = reader.stringValue();
+        } else if (name == "broadcaster_type") {
+            user.broadcasterType = reader.stringValue();
+        } else if (name == "description") {
+            user.description = reader.stringValue();
+        } else if (name == "profile_image_url") {
+            user.profileImageUrl = reader.stringValue();
+        } else if (name == "created_at") {
+            user.createdAt = QDateTime::fromString(reader.stringValue(), Qt::ISODate);
+        } else {
+            reader.skipValue();
+        }
+    }
+    return user;
+}
+
+UserRef readUserRef(JsonReader &reader)
+{
+    UserRef user;
+    while (reader.next() == JsonReader::Name) {
+        const QByteArrayView name = reader.rawValue();
+        reader.next();
+        if (name == "user_id") {
+            user.id = reader.stringValue();
+        } else if (name == "user_login") {
+            user.login = reader.stringValue();
+        } else if (name == "user_name") {
+            user.displayName = reader.stringValue();
+        } else {
+            reader.skipValue();
+        }
+    }
+    return user;
+}
+
+BannedUser readBannedUser(JsonReader &reader)
+{
+    BannedUser ban;
+    while (reader.next() == JsonReader::Name) {
+        const QByteArrayView name = reader.rawValue();
+        reader.next();
+        if (name == "user_id") {
+            ban.userId = reader.stringValue();
+        } else if (name == "user_login") {
+            ban.login = reader.stringValue();
+        } else if (name == "user_name") {
+            ban.displayName = reader.stringValue();
+        } else if (name == "created_at") {
+            ban.createdAt = QDateTime::fromString(reader.stringValue(), Qt::ISODate);
+        } else if (name == "expires_at") {
+            // "" for permanent bans
+            ban.expiresAt = QDateTime::fromString(reader.stringValue(), Qt::ISODate);
+        } else if (name == "reason") {
+            ban.reason = reader.stringValue();
+        } else if (name == "moderator_id") {
+            ban.moderatorId = reader.stringValue();
+        } else if (name == "moderator_login") {
+            ban.moderatorLogin = reader.stringValue();
+        } else {
+            reader.skipValue();
+        }
+    }
+    return ban;
+}
+
+// Walks the top-level object of a listing: every "data" element goes to
+// readElement, "total" and the pagination cursor are picked up on the way
+template <typename T, typename ReadElement>
+QList<T> readListing(const QByteArray &body, ReadElement readElement,
+                     int *total = nullptr, QString *cursor = nullptr)
+{
+    QList<T> result;
+    JsonReader reader(body);
+    if (reader.next() != JsonReader::BeginObject) {
+        return result;
+    }
+
+    while (reader.next() == JsonReader::Name) {
+        const QByteArrayView name = reader.rawValue();
+        reader.next();
+        if (name == "data" && reader.token() == JsonReader::BeginArray) {
+            while (reader.next() == JsonReader::BeginObject) {
+                result.append(readElement(reader));
+            }
+        } else if (name == "total" && total) {
+            *total = int(reader.integerValue());
+        } else if (name == "pagination" && cursor && reader.token() == JsonReader::BeginObject) {
+            while (reader.next() == JsonReader::Name) {
+                const QByteArrayView member = reader.rawValue();
+                reader.next();
+                if (member == "cursor") {
+                    *cursor = reader.stringValue();
+                } else {
+                    reader.skipValue();
+                }
+            }
+        } else {
+            reader.skipValue();
+        }
+    }
+    return result;
+}
+}
+
+TwitchUser TwitchUser::fromJson(const QJsonObject &json)
+{
+    TwitchUser user;
+    user.id = json.value("id").toString();
+    user.login = json.value("login").toString();
+    user.displayName = json.value("display_name").toString();
+    user.type = json.value("type").toString();
+    user.broadcasterType = json.value("broadcaster_type").toString();
+    user.description = json.value("description").toString();
+    user.profileImageUrl = json.value("profile_image_url").toString();
+    user.createdAt = parseTime(json.value("created_at"));
+    return user;
+}
+
+UserRef UserRef::fromJson(const QJsonObject &json)
+{
+    UserRef user;
+    user.id = json.value("user_id").toString();
+    user.login = json.value("user_login").toString();
+    user.displayName = json.value("user_name").toString();
+    return user;
+}
+
+BanResult BanResult::fromJson(const QJsonObject &json)
+{
+    BanResult ban;
+    ban.userId = json.value("user_id").toString();
+    ban.createdAt = parseTime(json.value("created_at"));
+    ban.endTime = parseTime(json.value("end_time"));
+    return ban;
+}
+
+ChatSettings ChatSettings::fromJson(const QJsonObject &json)
+{
+    ChatSettings settings;
+    settings.broadcasterId = json.value("broadcaster_id").toString();
+    settings.emoteMode = json.value("emote_mode").toBool();
+    settings.followerMode = json.value("follower_mode").toBool();
+    settings.followerModeDurationMinutes = json.value("follower_mode_duration").toInt();
+    settings.slowMode = json.value("slow_mode").toBool();
+    settings.slowModeWaitSeconds = json.value("slow_mode_wait_time").toInt();
+    settings.subscriberMode = json.value("subscriber_mode").toBool();
+    settings.uniqueChatMode = json.value("unique_chat_mode").toBool();
+    return settings;
+}
+
+Prediction Prediction::fromJson(const QJsonObject &json)
+{
+    Prediction prediction;
+    prediction.id = json.value("id").toString();
+    prediction.broadcasterId = json.value("broadcaster_id").toString();
+    prediction.title = json.value("title").toString();
+    prediction.status = json.value("status").toString();
+    prediction.winningOutcomeId = json.value("winning_outcome_id").toString();
+    prediction.predictionWindowSeconds = json.value("prediction_window").toInt();
+    prediction.createdAt = parseTime(json.value("created_at"));
+
+    const QJsonArray outcomes = json.value("outcomes").toArray();
+    for (const QJsonValue &value : outcomes) {
+        const QJsonObject object = value.toObject();
+        PredictionOutcome outcome;
+        outcome.id = object.value("id").toString();
+        outcome.title = object.value("title").toString();
+        outcome.color = object.value("color").toString();
+        outcome.users = object.value("users").toInt();
+        outcome.channelPoints = qint64(object.value("channel_points").toDouble());
+        prediction.outcomes.append(outcome);
+    }
+    return prediction;
+}
+
+Poll Poll::fromJson(const QJsonObject &json)
+{
+    Poll poll;
+    poll.id = json.value("id").toString();
+    poll.broadcasterId = json.value("broadcaster_id").toString();
+    poll.title = json.value("title").toString();
+    poll.status = json.value("status").toString();
+    poll.channelPointsVotingEnabled = json.value("channel_points_voting_enabled").toBool();
+    poll.durationSeconds = json.value("duration").toInt();
+    poll.startedAt = parseTime(json.value("started_at"));
+
+    const QJsonArray choices = json.value("choices").toArray();
+    for (const QJsonValue &value : choices) {
+        const QJsonObject object = value.toObject();
+        PollChoice choice;
+        choice.id = object.value("id").toString();
+        choice.title = object.value("title").toString();
+        choice.votes = object.value("votes").toInt();
+        choice.channelPointsVotes = object.value("channel_points_votes").toInt();
+        poll.choices.append(choice);
+    }
+    return poll;
+}
+
+ChannelFollower ChannelFollower::fromJson(const QJsonObject &json)
+{
+    ChannelFollower follower;
+    follower.userId = json.value("user_id").toString();
+    follower.login = json.value("user_login").toString();
+    follower.followedAt = parseTime(json.value("followed_at"));
+    return follower;
+}
+
+EventSubSubscription EventSubSubscription::fromJson(const QJsonObject &json)
+{
+    EventSubSubscription subscription;
+    subscription.id = json.value("id").toString();
+    subscription.type = json.value("type").toString();
+    subscription.version = json.value("version").toString();
+    subscription.status = json.value("status").toString();
+    subscription.cost = json.value("cost").toInt();
+    return subscription;
+}
+
+namespace Helix {
+
+QList<TwitchUser> parseUsers(const QByteArray &body)
+{
+    return readListing<TwitchUser>(body, readUser);
+}
+
+QList<UserRef> parseUserRefs(const QByteArray &body)
+{
+    return readListing<UserRef>(body, readUserRef);
+}
+
+ChatterPage parseChatterPage(const QByteArray &body)
+{
+    ChatterPage page;
+    page.chatters = readListing<UserRef>(body, readUserRef, &page.total, &page.cursor);
+    return page;
+}
+
+BannedUserPage parseBannedUserPage(const QByteArray &body)
+{
+    BannedUserPage page;
+    page.users = readListing<BannedUser>(body, readBannedUser, nullptr, &page.cursor);
+    return page;
+}
+
+}
@@ -0,0 +1,204 @@
+#ifndef HELIXTYPES_H
+#define HELIXTYPES_H
+
+#include <QString>
+#include <QList>
+#include <QDateTime>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+// Typed results of Helix calls. Each parser reads only the fields the
+// client uses and ignores the rest of the response. Parsers take the raw
+// body and run on TwitchAPI's decode pool for large responses.
+
+// Outcome of a call without a payload, and the base of ApiResult
+struct ApiReply {
+    int statusCode = 0; // 0 for transport errors
+    QString error;      // empty on success, Twitch's message when it sent one
+
+    bool ok() const { return error.isEmpty(); }
+};
+
+template <typename T>
+struct ApiResult : ApiReply {
+    T value;
+};
+
+// GET /users
+struct TwitchUser {
+    QString id;
+    QString login;
+    QString displayName;
+    QString type;            // "staff", "admin", "global_mod" or empty
+    QString broadcasterType; // "partner", "affiliate" or empty
+    QString description;
+    QString profileImageUrl;
+    QDateTime createdAt;
+
+    bool isValid() const { return !id.isEmpty(); }
+    static TwitchUser fromJson(const QJsonObject &json);
+};
+
+// Account reference in listings (moderators, chatters)
+struct UserRef {
+    QString id;
+    QString login;
+    QString displayName;
+
+    static UserRef fromJson(const QJsonObject &json);
+};
+
+// POST /moderation/bans
+struct BanResult {
+    QString userId;
+    QDateTime createdAt;
+    QDateTime endTime; // invalid for permanent bans
+
+    static BanResult fromJson(const QJsonObject &json);
+};
+
+// GET /moderation/banned; timeouts are bans with an expiry
+struct BannedUser {
+    QString userId;
+    QString login;
+    QString displayName;
+    QDateTime createdAt;
+    QDateTime expiresAt; // invalid for permanent bans
+    QString reason;
+    QString moderatorId;
+    QString moderatorLogin;
+
+    bool isExpired(const QDateTime &now) const { return expiresAt.isValid() && expiresAt <= now; }
+};
+
+// One page of GET /moderation/banned
+struct BannedUserPage {
+    QList<BannedUser> users;
+    QString cursor; // empty on the last page
+};
+
+// GET/PATCH /chat/settings
+struct ChatSettings {
+    QString broadcasterId;
+    bool emoteMode = false;
+    bool followerMode = false;
+    int followerModeDurationMinutes = 0;
+    bool slowMode = false;
+    int slowModeWaitSeconds = 0;
+    bool subscriberMode = false;
+    bool uniqueChatMode = false;
+
+    static ChatSettings fromJson(const QJsonObject &json);
+};
+
+struct PredictionOutcome {
+    QString id;
+    QString title;
+    QString color; // "BLUE" or "PINK"
+    int users = 0;
+    qint64 channelPoints = 0;
+};
+
+// /predictions
+struct Prediction {
+    QString id;
+    QString broadcasterId;
+    QString title;
+    QString status; // ACTIVE, LOCKED, RESOLVED, CANCELED
+    QString winningOutcomeId;
+    QList<PredictionOutcome> outcomes;
+    int predictionWindowSeconds = 0;
+    QDateTime createdAt;
+
+    bool isValid() const { return !id.isEmpty(); }
+    static Prediction fromJson(const QJsonObject &json);
+};
+
+struct PollChoice {
+    QString id;
+    QString title;
+    int votes = 0;
+    int channelPointsVotes = 0;
+};
+
+// /polls
+struct Poll {
+    QString id;
+    QString broadcasterId;
+    QString title;
+    QString status; // ACTIVE, COMPLETED, TERMINATED, ARCHIVED, ...
+    QList<PollChoice> choices;
+    bool channelPointsVotingEnabled = false;
+    int durationSeconds = 0;
+    QDateTime startedAt;
+
+    bool isValid() const { return !id.isEmpty(); }
+    static Poll fromJson(const QJsonObject &json);
+};
+
+// GET /channels/followers filtered to one user; invalid when not following
+struct ChannelFollower {
+    QString userId;
+    QString login;
+    QDateTime followedAt;
+
+    bool isValid() const { return !userId.isEmpty(); }
+    static ChannelFollower fromJson(const QJsonObject &json);
+};
+
+// POST /eventsub/subscriptions
+struct EventSubSubscription {
+    QString id;
+    QString type;
+    QString version;
+    QString status; // "enabled", or why it is not
+    int cost = 0;
+
+    static EventSubSubscription fromJson(const QJsonObject &json);
+};
+
+// One page of GET /chat/chatters
+struct ChatterPage {
+    QList<UserRef> chatters;
+    int total = 0;
+    QString cursor; // empty on the last page
+};
+
+namespace Helix {
+
+// Small single-object responses go through QJsonDocument; the listings
+// that can reach thousands of entries are decoded by the streaming
+// parsers below.
+
+// Elements of the response's "data" array
+template <typename T>
+QList<T> parseList(const QByteArray &body)
+{
+    const QJsonArray data = QJsonDocument::fromJson(body).object().value("data").toArray();
+    QList<T> result;
+    result.reserve(data.size());
+    for (const QJsonValue &value : data) {
+        result.append(T::fromJson(value.toObject()));
+    }
+    return result;
+}
+
+// First element of "data", for calls that act on a single object
+template <typename T>
+T parseFirst(const QByteArray &body)
+{
+    const QJsonArray data = QJsonDocument::fromJson(body).object().value("data").toArray();
+    return T::fromJson(data.at(0).toObject());
+}
+
+// Streaming: GET /users, and the user_id/user_login/user_name listings
+QList<TwitchUser> parseUsers(const QByteArray &body);
+QList<UserRef> parseUserRefs(const QByteArray &body);
+ChatterPage parseChatterPage(const QByteArray &body);
+BannedUserPage parseBannedUserPage(const QByteArray &body);
+
+}
+
+#endif // HELIXTYPES_H
@@ -0,0 +1,223 @@
+#include "jsonreader.h"
+
+namespace {
+int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+}
+
+JsonReader::JsonReader(QByteArrayView json)
+    : m_json(json)
+    , m_pos(0)
+    , m_token(End)
+    , m_valueStart(0)
+    , m_valueEnd(0)
+    , m_escaped(false)
+{
+}
+
+bool JsonReader::isSeparator(char c) const
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',' || c == ':';
+}
+
+JsonReader::Token JsonReader::next()
+{
+    if (m_token == Error) {
+        return m_token;
+    }
+
+    const qsizetype size = m_json.size();
+    while (m_pos < size && isSeparator(m_json[m_pos])) {
+        ++m_pos;
+    }
+    if (m_pos >= size) {
+        return m_token = End;
+    }
+
+    const char c = m_json[m_pos];
+    switch (c) {
+    case '{':
+        ++m_pos;
+        return m_token = BeginObject;
+    case '}':
+        ++m_pos;
+        return m_token = EndObject;
+    case '[':
+        ++m_pos;
+        return m_token = BeginArray;
+    case ']':
+        ++m_pos;
+        return m_token = EndArray;
+    case '"': {
+        if (!scanString()) {
+            return m_token = Error;
+        }
+        // A string followed by ':' is a member name
+        qsizetype peek = m_pos;
+        while (peek < size && (m_json[peek] == ' ' || m_json[peek] == '\n'
+                               || m_json[peek] == '\r' || m_json[peek] == '\t')) {
+            ++peek;
+        }
+        return m_token = (peek < size && m_json[peek] == ':') ? Name : String;
+    }
+    default:
+        break;
+    }
+
+    // Literals and numbers run until the next structural character
+    m_valueStart = m_pos;
+    while (m_pos < size && !isSeparator(m_json[m_pos]) && m_json[m_pos] != '}'
+           && m_json[m_pos] != ']') {
+        ++m_pos;
+    }
+    m_valueEnd = m_pos;
+
+    const QByteArrayView literal = rawValue();
+    if (literal == "true" || literal == "false") {
+        return m_token = Bool;
+    }
+    if (literal == "null") {
+        return m_token = Null;
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+        return m_token = Number;
+    }
+    return m_token = Error;
+}
+
+bool JsonReader::scanString()
+{
+    // m_pos is on the opening quote
+    const qsizetype size = m_json.size();
+    m_escaped = false;
+    m_valueStart = ++m_pos;
+    while (m_pos < size) {
+        const char c = m_json[m_pos];
+        if (c == '"') {
+            m_valueEnd = m_pos++;
+            return true;
+        }
+        if (c == '\\') {
+            m_escaped = true;
+            m_pos += 2;
+        } else {
+            ++m_pos;
+        }
+    }
+    return false;
+}
+
+QByteArrayView JsonReader::rawValue() const
+{
+    return m_json.sliced(m_valueStart, m_valueEnd - m_valueStart);
+}
+
+QString JsonReader::stringValue() const
+{
+    if (m_token != String && m_token != Name) {
+        return QString();
+    }
+    const QByteArrayView raw = rawValue();
+    if (!m_escaped) {
+        return QString::fromUtf8(raw);
+    }
+
+    QString out;
+    out.reserve(raw.size());
+    qsizetype runStart = 0;
+    qsizetype i = 0;
+    while (i < raw.size()) {
+        if (raw[i] != '\\') {
+            ++i;
+            continue;
+        }
+        out.append(QString::fromUtf8(raw.sliced(runStart, i - runStart)));
+        if (i + 1 >= raw.size()) {
+            break;
+        }
+
+        const char escape = raw[i + 1];
+        i += 2;
+        switch (escape) {
+        case 'n': out.append(QChar('\n')); break;
+        case 't': out.append(QChar('\t')); break;
+        case 'r': out.append(QChar('\r')); break;
+        case 'b': out.append(QChar('\b')); break;
+        case 'f': out.append(QChar('\f')); break;
+        case 'u': {
+            // UTF-16 code unit; surrogate pairs arrive as two escapes and
+            // combine on their own
+            int code = 0;
+            for (int d = 0; d < 4 && i < raw.size(); ++d, ++i) {
+                const int value = hexDigit(raw[i]);
+                if (value < 0) {
+                    break;
+                }
+                code = code * 16 + value;
+            }
+            out.append(QChar(char16_t(code)));
+            break;
+        }
+        default:
+            // \" \\ \/
+            out.append(QChar(escape));
+            break;
+        }
+        runStart = i;
+    }
+    out.append(QString::fromUtf8(raw.sliced(runStart)));
+    return out;
+}
+
+qint64 JsonReader::integerValue() const
+{
+    return m_token == Number ? rawValue().toLongLong() : 0;
+}
+
+double JsonReader::doubleValue() const
+{
+    return m_token == Number ? rawValue().toDouble() : 0.0;
+}
+
+bool JsonReader::boolValue() const
+{
+    return m_token == Bool && rawValue() == "true";
+}
+
+void JsonReader::skipValue()
+{
+    if (m_token != BeginObject && m_token != BeginArray) {
+        return;
+    }
+
+    const qsizetype size = m_json.size();
+    int depth = 1;
+    while (m_pos < size && depth > 0) {
+        const char c = m_json[m_pos];
+        if (c == '"') {
+            if (!scanString()) {
+                m_token = Error;
+                return;
+            }
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+        ++m_pos;
+    }
+    m_token = depth == 0 ? (m_json[m_pos - 1] == '}' ? EndObject : EndArray) : Error;
+}
@@ -0,0 +1,69 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <QByteArrayView>
+#include <QString>
+
+// Pull tokenizer over UTF-8 JSON that never builds a document.
+//
+// Decoders walk the tokens and copy out only the members they need;
+// everything else is skipped at byte level without allocating. Strings
+// are only unescaped and converted to QString when asked for. It is not a
+// validator: separators are not checked, which is fine for Helix output.
+//
+//     JsonReader reader(body);
+//     if (reader.next() == JsonReader::BeginObject) {
+//         while (reader.next() == JsonReader::Name) {
+//             const QByteArrayView name = reader.rawValue();
+//             reader.next();
+//             if (name == "total") total = reader.integerValue();
+//             else reader.skipValue();
+//         }
+//     }
+class JsonReader
+{
+public:
+    enum Token {
+        BeginObject,
+        EndObject,
+        BeginArray,
+        EndArray,
+        Name,   // object member name, the value follows with the next call
+        String,
+        Number,
+        Bool,
+        Null,
+        End,
+        Error
+    };
+
+    explicit JsonReader(QByteArrayView json);
+
+    Token next();
+    Token token() const { return m_token; }
+
+    // Name/String: contents between the quotes, escapes intact.
+    // Number/Bool/Null: the literal.
+    QByteArrayView rawValue() const;
+    QString stringValue() const;
+    qint64 integerValue() const;
+    double doubleValue() const;
+    bool boolValue() const;
+
+    // On BeginObject/BeginArray skips to the matching end; scalars are
+    // already consumed and need nothing
+    void skipValue();
+
+private:
+    bool scanString();
+    bool isSeparator(char c) const;
+
+    QByteArrayView m_json;
+    qsizetype m_pos;
+    Token m_token;
+    qsizetype m_valueStart;
+    qsizetype m_valueEnd;
+    bool m_escaped;
+};
+
+#endif // JSONREADER_H
@@ -0,0 +1,344 @@
+#include "liveeventsfanout.h"
+#include "twitchapi.h"
+#include "userlookupservice.h"
+#include <QDebug>
+
+bool FanOutChannel::isOpen() const
+{
+    const QString current = status();
+    return current == "ACTIVE" || (prediction.isValid() && current == "LOCKED");
+}
+
+QList<qint64> FanOutGroup::counts() const
+{
+    QList<qint64> totals(choices.size(), 0);
+    for (const FanOutChannel &channel : channels) {
+        for (int i = 0; i < totals.size(); ++i) {
+            if (kind == Polls) {
+                totals[i] += channel.poll.choices.value(i).votes;
+            } else {
+                totals[i] += channel.prediction.outcomes.value(i).users;
+            }
+        }
+    }
+    return totals;
+}
+
+QList<qint64> FanOutGroup::points() const
+{
+    QList<qint64> totals(choices.size(), 0);
+    for (const FanOutChannel &channel : channels) {
+        for (int i = 0; i < totals.size(); ++i) {
+            if (kind == Polls) {
+                totals[i] += channel.poll.choices.value(i).channelPointsVotes;
+            } else {
+                totals[i] += channel.prediction.outcomes.value(i).channelPoints;
+            }
+        }
+    }
+    return totals;
+}
+
+int FanOutGroup::created() const
+{
+    int count = 0;
+    for (const FanOutChannel &channel : channels) {
+        count += channel.id().isEmpty() ? 0 : 1;
+    }
+    return count;
+}
+
+int FanOutGroup::failed() const
+{
+    int count = 0;
+    for (const FanOutChannel &channel : channels) {
+        count += channel.error.isEmpty() ? 0 : 1;
+    }
+    return count;
+}
+
+int FanOutGroup::open() const
+{
+    int count = 0;
+    for (const FanOutChannel &channel : channels) {
+        count += channel.isOpen() ? 1 : 0;
+    }
+    return count;
+}
+
+LiveEventsFanOut::LiveEventsFanOut(TwitchAPI *api, UserLookupService *lookups, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_lookups(lookups)
+    , m_nextGroupId(1)
+{
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(REFRESH_MS);
+    connect(m_refreshTimer, &QTimer::timeout, this, &LiveEventsFanOut::refresh);
+}
+
+quint64 LiveEventsFanOut::createPolls(const QMap<QString, QString> &channels, const QString &title,
+                                      const QStringList &choices, int durationSeconds)
+{
+    FanOutGroup group;
+    group.kind = FanOutGroup::Polls;
+    group.title = title;
+    group.choices = choices;
+    group.durationSeconds = durationSeconds;
+    for (auto it = channels.constBegin(); it != channels.constEnd(); ++it) {
+        FanOutChannel channel;
+        channel.channel = it.key();
+        channel.broadcasterId = it.value();
+        group.channels.append(channel);
+    }
+    return start(group);
+}
+
+quint64 LiveEventsFanOut::createPredictions(const QMap<QString, QString> &channels, const QString &title,
+                                            const QStringList &outcomes, int durationSeconds)
+{
+    FanOutGroup group;
+    group.kind = FanOutGroup::Predictions;
+    group.title = title;
+    group.choices = outcomes;
+    group.durationSeconds = durationSeconds;
+    for (auto it = channels.constBegin(); it != channels.constEnd(); ++it) {
+        FanOutChannel channel;
+        channel.channel = it.key();
+        channel.broadcasterId = it.value();
+        group.channels.append(channel);
+    }
+    return start(group);
+}
+
+quint64 LiveEventsFanOut::start(FanOutGroup data)
+{
+    const quint64 groupId = m_nextGroupId++;
+    data.id = groupId;
+
+    Group &group = m_groups[groupId];
+    group.data = data;
+
+    for (int i = 0; i < group.data.channels.size(); ++i) {
+        FanOutChannel &channel = group.data.channels[i];
+        channel.busy = true;
+        if (!channel.broadcasterId.isEmpty()) {
+            group.queue.push_back(Job{i, QString(), -1});
+            continue;
+        }
+        m_lookups->lookupByLogin(channel.channel, ApiRequest::Interactive)
+            .then(this, [this, groupId, i](const TwitchUser &user) {
+                onBroadcasterResolved(groupId, i, user);
+            });
+    }
+
+    m_refreshTimer->start();
+    pump(groupId);
+    return groupId;
+}
+
+void LiveEventsFanOut::onBroadcasterResolved(quint64 groupId, int index, const TwitchUser &user)
+{
+    auto it = m_groups.find(groupId);
+    if (it == m_groups.end()) {
+        return;
+    }
+
+    FanOutChannel &channel = it->data.channels[index];
+    if (!user.isValid()) {
+        channel.busy = false;
+        channel.error = "No such channel";
+        it->deferred.remove(index);
+        emit groupChanged(groupId);
+        return;
+    }
+    channel.broadcasterId = user.id;
+    it->queue.push_back(Job{index, QString(), -1});
+    pump(groupId);
+}
+
+void LiveEventsFanOut::endPolls(quint64 groupId, const QString &status)
+{
+    end(groupId, status, -1);
+}
+
+void LiveEventsFanOut::endPredictions(quint64 groupId, const QString &status, int winningIndex)
+{
+    end(groupId, status, winningIndex);
+}
+
+void LiveEventsFanOut::end(quint64 groupId, const QString &status, int winningIndex)
+{
+    auto it = m_groups.find(groupId);
+    if (it == m_groups.end()) {
+        return;
+    }
+
+    for (int i = 0; i < it->data.channels.size(); ++i) {
+        FanOutChannel &channel = it->data.channels[i];
+        const Job job{i, status, winningIndex};
+        if (channel.busy) {
+            it->deferred.insert(i, job); // after the create or previous end
+        } else if (channel.isOpen() || (status == "ARCHIVED" && channel.poll.isValid())) {
+            channel.busy = true;
+            it->queue.push_back(job);
+        }
+    }
+    pump(groupId);
+}
+
+void LiveEventsFanOut::pump(quint64 groupId)
+{
+    auto it = m_groups.find(groupId);
+    if (it == m_groups.end()) {
+        return;
+    }
+
+    const int limit = m_api->concurrencyWindow(MAX_WINDOW);
+    while (it->inFlight < limit && !it->queue.empty()) {
+        const Job job = it->queue.front();
+        it->queue.pop_front();
+        ++it->inFlight;
+        send(groupId, job);
+    }
+}
+
+void LiveEventsFanOut::send(quint64 groupId, const Job &job)
+{
+    const FanOutGroup &group = m_groups[groupId].data;
+    const FanOutChannel &channel = group.channels.at(job.index);
+    const int index = job.index;
+
+    if (group.kind == FanOutGroup::Polls) {
+        QFuture<ApiResult<Poll>> call = job.status.isEmpty()
+            ? m_api->createPoll(channel.broadcasterId, group.title, group.choices, group.durationSeconds)
+            : m_api->endPoll(channel.broadcasterId, channel.poll.id, job.status);
+        call.then(this, [this, groupId, index](const ApiResult<Poll> &result) {
+            auto it = m_groups.find(groupId);
+            if (it != m_groups.end() && result.ok()) {
+                it->data.channels[index].poll = result.value;
+            }
+            onReply(groupId, index, result);
+        });
+        return;
+    }
+
+    QFuture<ApiResult<Prediction>> call;
+    if (job.status.isEmpty()) {
+        call = m_api->createPrediction(channel.broadcasterId, group.title, group.choices,
+                                       group.durationSeconds);
+    } else {
+        const QString winningId = channel.prediction.outcomes.value(job.winningIndex).id;
+        call = m_api->endPrediction(channel.broadcasterId, channel.prediction.id, job.status, winningId);
+    }
+    call.then(this, [this, groupId, index](const ApiResult<Prediction> &result) {
+        auto it = m_groups.find(groupId);
+        if (it != m_groups.end() && result.ok()) {
+            it->data.channels[index].prediction = result.value;
+        }
+        onReply(groupId, index, result);
+    });
+}
+
+void LiveEventsFanOut::onReply(quint64 groupId, int index, const ApiReply &reply)
+{
+    auto it = m_groups.find(groupId);
+    if (it == m_groups.end()) {
+        return;
+    }
+
+    --it->inFlight;
+    FanOutChannel &channel = it->data.channels[index];
+    channel.busy = false;
+    channel.statusCode = reply.statusCode;
+    channel.error = reply.error;
+    if (!reply.ok()) {
+        qWarning() << "Fan-out call for #" + channel.channel + " failed:" << reply.statusCode << reply.error;
+    }
+
+    auto deferred = it->deferred.find(index);
+    if (deferred != it->deferred.end()) {
+        const Job job = deferred.value();
+        it->deferred.erase(deferred);
+        if (channel.isOpen()) {
+            channel.busy = true;
+            it->queue.push_back(job);
+        }
+    }
+
+    emit groupChanged(groupId);
+    pump(groupId);
+}
+
+void LiveEventsFanOut::update(const QString &channelName, const Poll &poll)
+{
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it) {
+        for (FanOutChannel &channel : it->data.channels) {
+            if (channel.channel == channelName && channel.poll.isValid() && channel.poll.id == poll.id) {
+                channel.poll = poll;
+                emit groupChanged(it.key());
+            }
+        }
+    }
+}
+
+void LiveEventsFanOut::update(const QString &channelName, const Prediction &prediction)
+{
+    for (auto it = m_groups.begin(); it != m_groups.end(); ++it) {
+        for (FanOutChannel &channel : it->data.channels) {
+            if (channel.channel == channelName && channel.prediction.isValid()
+                && channel.prediction.id == prediction.id) {
+                channel.prediction = prediction;
+                emit groupChanged(it.key());
+            }
+        }
+    }
+}
+
+void LiveEventsFanOut::refresh()
+{
+    bool anyOpen = false;
+    for (const Group &group : std::as_const(m_groups)) {
+        for (const FanOutChannel &channel : group.data.channels) {
+            if (channel.busy) {
+                anyOpen = true; // may be open once the call returns
+                continue;
+            }
+            if (!channel.isOpen()) {
+                continue;
+            }
+            anyOpen = true;
+
+            // Newest first; only a match with the fanned-out id is applied
+            const QString name = channel.channel;
+            if (group.data.kind == FanOutGroup::Polls) {
+                m_api->getPolls(channel.broadcasterId)
+                    .then(this, [this, name](const ApiResult<QList<Poll>> &result) {
+                        if (result.ok() && !result.value.isEmpty()) {
+                            update(name, result.value.first());
+                        }
+                    });
+            } else {
+                m_api->getPredictions(channel.broadcasterId)
+                    .then(this, [this, name](const ApiResult<QList<Prediction>> &result) {
+                        if (result.ok() && !result.value.isEmpty()) {
+                            update(name, result.value.first());
+                        }
+                    });
+            }
+        }
+    }
+    if (!anyOpen) {
+        m_refreshTimer->stop();
+    }
+}
+
+FanOutGroup LiveEventsFanOut::group(quint64 groupId) const
+{
+    return m_groups.value(groupId).data;
+}
+
+void LiveEventsFanOut::remove(quint64 groupId)
+{
+    m_groups.remove(groupId);
+}
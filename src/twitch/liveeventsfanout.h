@@ -0,0 +1,125 @@
+#ifndef LIVEEVENTSFANOUT_H
+#define LIVEEVENTSFANOUT_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QTimer>
+#include <deque>
+#include "helixtypes.h"
+
+class TwitchAPI;
+class UserLookupService;
+
+// One channel of a fan-out group
+struct FanOutChannel {
+    QString channel;
+    QString broadcasterId;
+    Poll poll;             // Polls groups
+    Prediction prediction; // Predictions groups
+    int statusCode = 0;
+    QString error;         // last create/end failure
+    bool busy = false;     // lookup or call in flight
+
+    QString id() const { return poll.isValid() ? poll.id : prediction.id; }
+    QString status() const { return poll.isValid() ? poll.status : prediction.status; }
+    bool isOpen() const;
+};
+
+// The same poll or prediction started in several channels
+struct FanOutGroup {
+    enum Kind {
+        Polls,
+        Predictions
+    };
+
+    quint64 id = 0;
+    Kind kind = Polls;
+    QString title;
+    QStringList choices; // poll choices or prediction outcomes, in order
+    int durationSeconds = 0;
+    QList<FanOutChannel> channels;
+
+    // Summed over channels by choice position: votes or predicting users,
+    // and channel points
+    QList<qint64> counts() const;
+    QList<qint64> points() const;
+    int created() const;
+    int failed() const;
+    int open() const;
+};
+
+// Starts one poll or prediction in many channels and ends them together.
+//
+// Creates, ends and resolves go out concurrently, in a window sized from
+// the scheduler's rate-limit bucket (TwitchAPI::concurrencyWindow), so 15
+// channels take about one round trip without draining the bucket. An end
+// requested while a channel's create is still in flight is sent once the
+// create returns. Predictions are resolved by outcome position, since
+// every channel has its own outcome ids.
+//
+// Progress comes in through update() (EventSub or the poller) and, for
+// channels nothing pushes, from a GET every REFRESH_MS while open.
+class LiveEventsFanOut : public QObject
+{
+    Q_OBJECT
+
+public:
+    LiveEventsFanOut(TwitchAPI *api, UserLookupService *lookups, QObject *parent = nullptr);
+
+    // channel -> broadcaster id; empty ids are looked up by login
+    quint64 createPolls(const QMap<QString, QString> &channels, const QString &title,
+                        const QStringList &choices, int durationSeconds);
+    quint64 createPredictions(const QMap<QString, QString> &channels, const QString &title,
+                              const QStringList &outcomes, int durationSeconds);
+
+    // status as for TwitchAPI::endPoll()/endPrediction(); winningIndex is
+    // the outcome position for "RESOLVED"
+    void endPolls(quint64 groupId, const QString &status);
+    void endPredictions(quint64 groupId, const QString &status, int winningIndex = -1);
+
+    void update(const QString &channel, const Poll &poll);
+    void update(const QString &channel, const Prediction &prediction);
+
+    FanOutGroup group(quint64 groupId) const;
+    void remove(quint64 groupId);
+
+    static constexpr int MAX_WINDOW = 8;
+    static constexpr int REFRESH_MS = 10 * 1000;
+
+signals:
+    void groupChanged(quint64 groupId);
+
+private:
+    struct Job {
+        int index = 0;
+        QString status;       // empty = create
+        int winningIndex = -1;
+    };
+
+    struct Group {
+        FanOutGroup data;
+        std::deque<Job> queue;
+        QHash<int, Job> deferred; // ends waiting for their channel's create
+        int inFlight = 0;
+    };
+
+    quint64 start(FanOutGroup group);
+    void end(quint64 groupId, const QString &status, int winningIndex);
+    void onBroadcasterResolved(quint64 groupId, int index, const TwitchUser &user);
+    void pump(quint64 groupId);
+    void send(quint64 groupId, const Job &job);
+    void onReply(quint64 groupId, int index, const ApiReply &reply);
+    void refresh();
+
+    TwitchAPI *m_api;
+    UserLookupService *m_lookups;
+    QHash<quint64, Group> m_groups;
+    quint64 m_nextGroupId;
+    QTimer *m_refreshTimer;
+};
+
+#endif // LIVEEVENTSFANOUT_H
@@ -0,0 +1,116 @@
+#include "liveeventspoller.h"
+#include "twitchapi.h"
+#include "eventsubclient.h"
+#include <QDebug>
+
+LiveEventsPoller::LiveEventsPoller(TwitchAPI *api, EventSubClient *eventSub, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_eventSub(eventSub)
+    , m_generation(0)
+    , m_outstanding(0)
+    , m_active(false)
+{
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &LiveEventsPoller::poll);
+}
+
+void LiveEventsPoller::watch(const QString &channel, const QString &broadcasterId)
+{
+    if (channel == m_channel && broadcasterId == m_broadcasterId) {
+        return;
+    }
+    m_channel = channel;
+    m_broadcasterId = broadcasterId;
+    ++m_generation;
+    m_outstanding = 0;
+    m_active = false;
+    poll();
+}
+
+void LiveEventsPoller::unwatch(const QString &channel)
+{
+    if (channel != m_channel) {
+        return;
+    }
+    m_channel.clear();
+    m_broadcasterId.clear();
+    ++m_generation;
+    m_outstanding = 0;
+    m_timer->stop();
+}
+
+void LiveEventsPoller::refresh()
+{
+    if (!m_channel.isEmpty() && m_outstanding == 0) {
+        m_active = true;
+        m_timer->start(ACTIVE_INTERVAL_MS / 5);
+    }
+}
+
+bool LiveEventsPoller::coveredByEventSub() const
+{
+    return m_eventSub->isSubscribed(m_channel, "channel.poll.progress")
+        && m_eventSub->isSubscribed(m_channel, "channel.prediction.progress");
+}
+
+void LiveEventsPoller::poll()
+{
+    if (m_channel.isEmpty()) {
+        return;
+    }
+    if (coveredByEventSub()) {
+        // Check again later in case the session drops
+        m_timer->start(IDLE_INTERVAL_MS);
+        return;
+    }
+
+    const quint64 generation = m_generation;
+    const QString channel = m_channel;
+    m_outstanding = 2;
+    m_active = false;
+
+    // Newest first; only the latest of each matters
+    m_api->getPolls(m_broadcasterId).then(this, [this, generation, channel](const ApiResult<QList<Poll>> &result) {
+        if (generation != m_generation) {
+            return;
+        }
+        if (!result.ok()) {
+            stopOnAuthError(result);
+        } else if (!result.value.isEmpty()) {
+            m_active = m_active || result.value.first().status == "ACTIVE";
+            emit pollUpdated(channel, result.value.first());
+        }
+        scheduleNext();
+    });
+    m_api->getPredictions(m_broadcasterId).then(this, [this, generation, channel](const ApiResult<QList<Prediction>> &result) {
+        if (generation != m_generation) {
+            return;
+        }
+        if (!result.ok()) {
+            stopOnAuthError(result);
+        } else if (!result.value.isEmpty()) {
+            const QString &status = result.value.first().status;
+            m_active = m_active || status == "ACTIVE" || status == "LOCKED";
+            emit predictionUpdated(channel, result.value.first());
+        }
+        scheduleNext();
+    });
+}
+
+void LiveEventsPoller::scheduleNext()
+{
+    if (--m_outstanding > 0 || m_channel.isEmpty()) {
+        return;
+    }
+    m_timer->start(m_active ? ACTIVE_INTERVAL_MS : IDLE_INTERVAL_MS);
+}
+
+void LiveEventsPoller::stopOnAuthError(const ApiReply &reply)
+{
+    if (reply.statusCode == 401 || reply.statusCode == 403) {
+        qWarning() << "Poll/prediction polling stopped for #" + m_channel + ":" << reply.error;
+        unwatch(m_channel);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef LIVEEVENTSPOLLER_H
+#define LIVEEVENTSPOLLER_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include "helixtypes.h"
+
+class TwitchAPI;
+class EventSubClient;
+
+// Fallback for poll and prediction progress when EventSub doesn't deliver
+// it: polls GET /polls and /predictions for the user's own channel (the
+// only one Helix lists them for). Every ACTIVE_INTERVAL_MS while one of
+// them is running, IDLE_INTERVAL_MS otherwise; rounds are skipped while
+// the EventSub session has the progress subscriptions. A 401/403 stops it.
+class LiveEventsPoller : public QObject
+{
+    Q_OBJECT
+
+public:
+    LiveEventsPoller(TwitchAPI *api, EventSubClient *eventSub, QObject *parent = nullptr);
+
+    void watch(const QString &channel, const QString &broadcasterId);
+    void unwatch(const QString &channel);
+
+    // Poll again soon, e.g. after creating or ending one
+    void refresh();
+
+    static constexpr int ACTIVE_INTERVAL_MS = 5 * 1000;
+    static constexpr int IDLE_INTERVAL_MS = 60 * 1000;
+
+signals:
+    void pollUpdated(const QString &channel, const Poll &poll);
+    void predictionUpdated(const QString &channel, const Prediction &prediction);
+
+private:
+    void poll();
+    bool coveredByEventSub() const;
+    void scheduleNext();
+    void stopOnAuthError(const ApiReply &reply);
+
+    TwitchAPI *m_api;
+    EventSubClient *m_eventSub;
+    QString m_channel;
+    QString m_broadcasterId;
+    QTimer *m_timer;
+    quint64 m_generation; // bumped by watch()/unwatch(), stale replies are dropped
+    int m_outstanding;    // replies of the current round
+    bool m_active;        // something was running in the last round
+};
+
+#endif // LIVEEVENTSPOLLER_H
@@ -0,0 +1,146 @@
+#include "networkstack.h"
+#include <QDebug>
+#include <memory>
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
+
+namespace {
+constexpr int KEEP_WARM_CHECK_MS = 15 * 1000;
+
+// Filled in by the reply's signals, all relative to track()
+struct Trace {
+    QElapsedTimer timer;
+    qint64 connectStartMs = -1;
+    qint64 encryptedMs = -1;
+    qint64 firstByteMs = -1;
+};
+}
+
+NetworkStack::NetworkStack(QObject *parent)
+    : QObject(parent)
+    , m_manager(new QNetworkAccessManager(this))
+    , m_keepWarmTimer(new QTimer(this))
+    , m_warmUps(0)
+{
+    m_clock.start();
+    m_keepWarmTimer->setInterval(KEEP_WARM_CHECK_MS);
+    connect(m_keepWarmTimer, &QTimer::timeout, this, &NetworkStack::rewarmIdleHosts);
+}
+
+QNetworkAccessManager *NetworkStack::manager() const
+{
+    return m_manager;
+}
+
+QNetworkRequest NetworkStack::request(const QUrl &url) const
+{
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    return request;
+}
+
+void NetworkStack::warmUp()
+{
+    warmUp(HELIX_HOST);
+    warmUp(ID_HOST);
+}
+
+void NetworkStack::warmUp(const QString &host)
+{
+    ++m_warmUps;
+    noteActivity(host);
+#if QT_CONFIG(ssl)
+    // Offer h2 in ALPN, or the warmed connection can't carry HTTP/2 requests
+    QSslConfiguration config = QSslConfiguration::defaultConfiguration();
+    config.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                    QSslConfiguration::NextProtocolHttp1_1});
+    m_manager->connectToHostEncrypted(host, 443, config);
+#else
+    qWarning() << "No TLS support, can't pre-warm" << host;
+#endif
+}
+
+void NetworkStack::setKeepWarm(bool enabled)
+{
+    if (!enabled) {
+        m_keepWarmTimer->stop();
+        return;
+    }
+    if (!m_keepWarmTimer->isActive()) {
+        warmUp();
+        m_keepWarmTimer->start();
+    }
+}
+
+void NetworkStack::noteActivity(const QString &host)
+{
+    m_lastUsedMs[host] = m_clock.elapsed();
+}
+
+void NetworkStack::rewarmIdleHosts()
+{
+    const qint64 now = m_clock.elapsed();
+    for (const QString &host : {QString(HELIX_HOST), QString(ID_HOST)}) {
+        if (now - m_lastUsedMs.value(host, 0) >= IDLE_REWARM_MS) {
+            warmUp(host);
+        }
+    }
+}
+
+void NetworkStack::track(QNetworkReply *reply)
+{
+    const QUrl url = reply->url();
+    noteActivity(url.host());
+
+    auto trace = std::make_shared<Trace>();
+    trace->timer.start();
+
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [trace]() {
+        if (trace->connectStartMs < 0) {
+            trace->connectStartMs = trace->timer.elapsed();
+        }
+    });
+#if QT_CONFIG(ssl)
+    connect(reply, &QNetworkReply::encrypted, this, [trace]() {
+        trace->encryptedMs = trace->timer.elapsed();
+    });
+#endif
+    connect(reply, &QNetworkReply::metaDataChanged, this, [trace]() {
+        if (trace->firstByteMs < 0) {
+            trace->firstByteMs = trace->timer.elapsed();
+        }
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, reply, trace, url]() {
+        const qint64 firstByteMs = trace->firstByteMs >= 0 ? trace->firstByteMs : trace->timer.elapsed();
+        const bool cold = trace->connectStartMs >= 0;
+
+        ConnectionStats &stats = m_stats[url.path()];
+        ++stats.requests;
+        if (reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool()) {
+            ++stats.http2;
+        }
+        stats.firstByteTotalMs += firstByteMs;
+        stats.firstByteMaxMs = qMax(stats.firstByteMaxMs, firstByteMs);
+        if (cold) {
+            ++stats.cold;
+            const qint64 setupMs = (trace->encryptedMs >= 0 ? trace->encryptedMs : firstByteMs)
+                                   - trace->connectStartMs;
+            stats.setupTotalMs += setupMs;
+            stats.setupMaxMs = qMax(stats.setupMaxMs, setupMs);
+            qDebug() << "Cold connection for" << url.host() + url.path() << "- setup" << setupMs
+                     << "ms, first byte after" << firstByteMs << "ms";
+        }
+        noteActivity(url.host());
+    });
+}
+
+QHash<QString, ConnectionStats> NetworkStack::stats() const
+{
+    return m_stats;
+}
+
+quint64 NetworkStack::warmUps() const
+{
+    return m_warmUps;
+}
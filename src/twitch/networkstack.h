@@ -0,0 +1,80 @@
+#ifndef NETWORKSTACK_H
+#define NETWORKSTACK_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QUrl>
+
+// Connection timings for one request path
+struct ConnectionStats {
+    quint64 requests = 0;
+    quint64 cold = 0;   // had to open a new connection (DNS + TCP + TLS)
+    quint64 http2 = 0;
+    qint64 setupTotalMs = 0; // connect start until the TLS handshake is done
+    qint64 setupMaxMs = 0;
+    qint64 firstByteTotalMs = 0; // request handed to Qt until the response headers
+    qint64 firstByteMaxMs = 0;
+
+    double averageSetupMs() const { return cold ? double(setupTotalMs) / double(cold) : 0.0; }
+    double averageFirstByteMs() const { return requests ? double(firstByteTotalMs) / double(requests) : 0.0; }
+};
+
+// The one QNetworkAccessManager shared by TwitchAuth and TwitchAPI.
+//
+// Sharing it means both use the same connection cache, so a Helix call
+// reuses whatever connection the last one left open. Requests built with
+// request() allow HTTP/2, which multiplexes the whole scheduler window
+// over a single TLS connection.
+//
+// warmUp() opens an encrypted connection ahead of the first request. With
+// keep-warm on (while logged in) every host that has been idle for
+// IDLE_REWARM_MS is warmed again, so a connection the server closed while
+// nothing was happening is back before the next ban needs it.
+//
+// track() records per request whether it found a hot connection and how
+// long connect + TLS and the first byte took. Qt reports the start of the
+// connect and the end of the handshake, not the TCP/TLS boundary, so
+// setup is the two together.
+class NetworkStack : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit NetworkStack(QObject *parent = nullptr);
+
+    QNetworkAccessManager *manager() const;
+    QNetworkRequest request(const QUrl &url) const;
+
+    void warmUp();
+    void warmUp(const QString &host);
+    void setKeepWarm(bool enabled);
+
+    void track(QNetworkReply *reply);
+
+    QHash<QString, ConnectionStats> stats() const;
+    quint64 warmUps() const;
+
+    static constexpr const char *HELIX_HOST = "api.twitch.tv";
+    static constexpr const char *ID_HOST = "id.twitch.tv";
+    static constexpr qint64 IDLE_REWARM_MS = 45 * 1000;
+
+private:
+    void rewarmIdleHosts();
+    void noteActivity(const QString &host);
+
+    QNetworkAccessManager *m_manager;
+    QTimer *m_keepWarmTimer;
+    QElapsedTimer m_clock;
+    QHash<QString, qint64> m_lastUsedMs; // host -> last request or warm-up
+    QHash<QString, ConnectionStats> m_stats;
+    quint64 m_warmUps;
+};
+
+#endif // NETWORKSTACK_H
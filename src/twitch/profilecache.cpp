@@ -0,0 +1,537 @@
+#include "profilecache.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTimeZone>
+#include <QDebug>
+
+namespace {
+constexpr quint32 STORE_MAGIC = 0x54504331; // "TPC1"
+constexpr quint32 STORE_VERSION = 1;
+constexpr int MIN_DEAD_FOR_COMPACTION = 256;
+
+qint64 nowMs()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+}
+
+qint64 UserProfile::lastConfirmedMs() const
+{
+    qint64 latest = qMax(loginAtMs, profileAtMs);
+    for (const ChannelRole &role : channels) {
+        latest = qMax(latest, qMax(role.moderatorAtMs, qMax(role.vipAtMs, role.bannedAtMs)));
+    }
+    return latest;
+}
+
+ProfileCache::ProfileCache(const QString &path, int capacity, QObject *parent)
+    : QObject(parent)
+    , m_capacity(qMax(1, capacity))
+    , m_path(path)
+    , m_deadRecords(0)
+    , m_flushTimer(new QTimer(this))
+{
+    m_memory.reserve(m_capacity);
+
+    if (openStore() && m_deadRecords >= MIN_DEAD_FOR_COMPACTION
+            && m_deadRecords > m_diskIndex.size()) {
+        compactStore();
+    }
+    qDebug() << "Profile cache:" << m_diskIndex.size() << "accounts on disk," << m_deadRecords
+             << "superseded records";
+
+    m_flushTimer->setInterval(int(FLUSH_INTERVAL_MS));
+    connect(m_flushTimer, &QTimer::timeout, this, &ProfileCache::flush);
+    m_flushTimer->start();
+}
+
+ProfileCache::~ProfileCache()
+{
+    flush();
+}
+
+qint64 ProfileCache::ttlMs(Field field)
+{
+    switch (field) {
+    case CreatedAt:
+        return -1;
+    case Profile:
+        return 24 * 60 * 60 * 1000;
+    case Moderator:
+    case Vip:
+        return 10 * 60 * 1000;
+    case Banned:
+        // Unbans by other moderators are not seen on IRC
+        return 2 * 60 * 1000;
+    case FieldCount:
+        break;
+    }
+    return 0;
+}
+
+const char *ProfileCache::fieldName(Field field)
+{
+    switch (field) {
+    case CreatedAt:
+        return "created_at";
+    case Profile:
+        return "profile";
+    case Moderator:
+        return "moderator";
+    case Vip:
+        return "vip";
+    case Banned:
+        return "banned";
+    case FieldCount:
+        break;
+    }
+    return "";
+}
+
+UserProfile ProfileCache::findById(const QString &userId, Field field, const QString &broadcasterId)
+{
+    return find(userId, QString(), field, broadcasterId);
+}
+
+UserProfile ProfileCache::findByLogin(const QString &login, Field field, const QString &broadcasterId)
+{
+    const QString key = login.toLower();
+    return find(m_loginIndex.value(key), key, field, broadcasterId);
+}
+
+UserProfile ProfileCache::find(const QString &userId, const QString &loginKey, Field field,
+                               const QString &broadcasterId)
+{
+    bool promoted = false;
+    Node *found = userId.isEmpty() ? nullptr : node(userId, &promoted);
+    if (!found) {
+        ++m_stats.misses[field];
+        return UserProfile();
+    }
+
+    const qint64 now = nowMs();
+    const UserProfile &profile = found->profile;
+    bool fresh = isFresh(profile, field, broadcasterId, now);
+    if (fresh && !loginKey.isEmpty()) {
+        // The account may have been renamed since the login was indexed
+        fresh = profile.user.login.toLower() == loginKey
+                && now - profile.loginAtMs < ttlMs(Profile);
+    }
+
+    if (!fresh) {
+        ++m_stats.misses[field];
+        ++m_stats.expired[field];
+        return UserProfile();
+    }
+
+    ++m_stats.hits[field];
+    if (promoted) {
+        ++m_stats.diskHits;
+    } else {
+        ++m_stats.memoryHits;
+    }
+    return profile;
+}
+
+bool ProfileCache::isFresh(const UserProfile &profile, Field field, const QString &broadcasterId,
+                           qint64 now) const
+{
+    switch (field) {
+    case CreatedAt:
+        return profile.user.createdAt.isValid();
+    case Profile:
+        return profile.profileAtMs > 0 && now - profile.profileAtMs < ttlMs(Profile);
+    case Moderator:
+    case Vip:
+    case Banned: {
+        auto it = profile.channels.constFind(broadcasterId);
+        if (it == profile.channels.constEnd()) {
+            return false;
+        }
+        const qint64 at = field == Moderator ? it->moderatorAtMs
+                        : field == Vip ? it->vipAtMs
+                        : it->bannedAtMs;
+        return at > 0 && now - at < ttlMs(field);
+    }
+    case FieldCount:
+        break;
+    }
+    return false;
+}
+
+void ProfileCache::storeUser(const TwitchUser &user)
+{
+    if (!user.isValid()) {
+        return;
+    }
+
+    Node *found = node(user.id);
+    if (!found) {
+        UserProfile empty;
+        empty.user.id = user.id;
+        found = &insertNode(empty, true);
+    }
+
+    UserProfile &profile = found->profile;
+    const QString oldLogin = profile.user.login.toLower();
+    if (!oldLogin.isEmpty() && oldLogin != user.login.toLower()
+            && m_loginIndex.value(oldLogin) == user.id) {
+        m_loginIndex.remove(oldLogin);
+    }
+
+    const qint64 now = nowMs();
+    profile.user = user;
+    profile.loginAtMs = now;
+    profile.profileAtMs = now;
+    found->dirty = true;
+    indexLogin(user.login, user.id);
+}
+
+void ProfileCache::storeRole(const QString &userId, const QString &login, const QString &broadcasterId,
+                             Field field, bool value)
+{
+    if (userId.isEmpty() || broadcasterId.isEmpty() || field < Moderator || field >= FieldCount) {
+        return;
+    }
+
+    Node *found = node(userId);
+    if (!found) {
+        UserProfile stub;
+        stub.user.id = userId;
+        found = &insertNode(stub, true);
+    }
+
+    UserProfile &profile = found->profile;
+    const qint64 now = nowMs();
+
+    // Confirming an unchanged value only reaches the disk once it is half
+    // stale, so busy chatters don't rewrite their record on every flush
+    if (!login.isEmpty()) {
+        if (profile.user.login.compare(login, Qt::CaseInsensitive) != 0) {
+            profile.user.login = login.toLower();
+            indexLogin(login, userId);
+            found->dirty = true;
+        } else if (now - profile.loginAtMs > ttlMs(Profile) / 2) {
+            found->dirty = true;
+        }
+        profile.loginAtMs = now;
+    }
+
+    UserProfile::ChannelRole &role = profile.channels[broadcasterId];
+    bool *state = field == Moderator ? &role.moderator
+                : field == Vip ? &role.vip
+                : &role.banned;
+    qint64 *at = field == Moderator ? &role.moderatorAtMs
+               : field == Vip ? &role.vipAtMs
+               : &role.bannedAtMs;
+    if (*state != value || now - *at > ttlMs(field) / 2) {
+        found->dirty = true;
+    }
+    *state = value;
+    *at = now;
+}
+
+void ProfileCache::indexLogin(const QString &login, const QString &userId)
+{
+    if (!login.isEmpty()) {
+        m_loginIndex.insert(login.toLower(), userId);
+    }
+}
+
+ProfileCache::Node *ProfileCache::node(const QString &userId, bool *promoted)
+{
+    auto it = m_memory.find(userId);
+    if (it != m_memory.end()) {
+        touch(it.value());
+        return &it.value();
+    }
+
+    auto disk = m_diskIndex.constFind(userId);
+    if (disk == m_diskIndex.constEnd()) {
+        return nullptr;
+    }
+
+    UserProfile profile;
+    if (!readRecord(disk.value(), &profile) || profile.user.id != userId) {
+        qWarning() << "Profile store: unreadable record for user" << userId;
+        m_diskIndex.remove(userId);
+        return nullptr;
+    }
+    if (promoted) {
+        *promoted = true;
+    }
+    return &insertNode(profile, false);
+}
+
+ProfileCache::Node &ProfileCache::insertNode(const UserProfile &profile, bool dirty)
+{
+    while (m_memory.size() >= m_capacity) {
+        evict();
+    }
+
+    const QString &userId = profile.user.id;
+    m_lru.push_front(userId);
+    Node entry;
+    entry.profile = profile;
+    entry.lru = m_lru.begin();
+    entry.dirty = dirty;
+    return m_memory.insert(userId, entry).value();
+}
+
+void ProfileCache::touch(Node &node)
+{
+    m_lru.splice(m_lru.begin(), m_lru, node.lru);
+}
+
+void ProfileCache::evict()
+{
+    const QString userId = m_lru.back();
+    m_lru.pop_back();
+
+    auto it = m_memory.find(userId);
+    if (it != m_memory.end()) {
+        if (it->dirty) {
+            writeRecord(it->profile);
+        }
+        m_memory.erase(it);
+    }
+    ++m_stats.evictions;
+}
+
+void ProfileCache::flush()
+{
+    bool wrote = false;
+    for (Node &entry : m_memory) {
+        if (entry.dirty) {
+            writeRecord(entry.profile);
+            entry.dirty = false;
+            wrote = true;
+        }
+    }
+    if (wrote) {
+        m_store.flush();
+    }
+}
+
+QByteArray ProfileCache::encode(const UserProfile &profile)
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_5);
+
+    const TwitchUser &user = profile.user;
+    out << user.id << user.login << profile.loginAtMs << profile.profileAtMs
+        << user.displayName << user.type << user.broadcasterType << user.description
+        << user.profileImageUrl
+        << qint64(user.createdAt.isValid() ? user.createdAt.toMSecsSinceEpoch() : -1);
+
+    out << quint32(profile.channels.size());
+    for (auto it = profile.channels.constBegin(); it != profile.channels.constEnd(); ++it) {
+        const UserProfile::ChannelRole &role = it.value();
+        const quint8 flags = (role.moderator ? 1 : 0) | (role.vip ? 2 : 0) | (role.banned ? 4 : 0);
+        out << it.key() << flags << role.moderatorAtMs << role.vipAtMs << role.bannedAtMs;
+    }
+    return bytes;
+}
+
+bool ProfileCache::decode(const QByteArray &bytes, UserProfile *profile)
+{
+    QDataStream in(bytes);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    TwitchUser &user = profile->user;
+    qint64 createdAtMs = -1;
+    in >> user.id >> user.login >> profile->loginAtMs >> profile->profileAtMs
+       >> user.displayName >> user.type >> user.broadcasterType >> user.description
+       >> user.profileImageUrl >> createdAtMs;
+    if (createdAtMs >= 0) {
+        user.createdAt = QDateTime::fromMSecsSinceEpoch(createdAtMs, QTimeZone::UTC);
+    }
+
+    quint32 channelCount = 0;
+    in >> channelCount;
+    for (quint32 i = 0; i < channelCount && in.status() == QDataStream::Ok; ++i) {
+        QString broadcasterId;
+        quint8 flags = 0;
+        UserProfile::ChannelRole role;
+        in >> broadcasterId >> flags >> role.moderatorAtMs >> role.vipAtMs >> role.bannedAtMs;
+        role.moderator = flags & 1;
+        role.vip = flags & 2;
+        role.banned = flags & 4;
+        profile->channels.insert(broadcasterId, role);
+    }
+    return in.status() == QDataStream::Ok && !user.id.isEmpty();
+}
+
+bool ProfileCache::openStore()
+{
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    m_store.setFileName(m_path);
+    if (!m_store.open(QIODevice::ReadWrite)) {
+        qWarning() << "Profile store: cannot open" << m_path << m_store.errorString()
+                   << "- caching in memory only";
+        return false;
+    }
+
+    if (m_store.size() > 0 && scanStore()) {
+        return true;
+    }
+    if (m_store.size() > 0) {
+        qWarning() << "Profile store: unknown format, starting empty";
+    }
+
+    m_store.resize(0);
+    m_diskIndex.clear();
+    m_loginIndex.clear();
+    m_deadRecords = 0;
+    QDataStream out(&m_store);
+    out << STORE_MAGIC << STORE_VERSION;
+    return true;
+}
+
+bool ProfileCache::scanStore()
+{
+    m_store.seek(0);
+    QDataStream in(&m_store);
+    in.setVersion(QDataStream::Qt_6_5);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != STORE_MAGIC || version != STORE_VERSION) {
+        return false;
+    }
+
+    const qint64 cutoff = nowMs() - RETENTION_MS;
+    qint64 offset = m_store.pos();
+    while (!in.atEnd()) {
+        QByteArray payload;
+        in >> payload;
+        UserProfile profile;
+        if (in.status() != QDataStream::Ok || !decode(payload, &profile)) {
+            break;
+        }
+
+        // Later records supersede earlier ones; long-unseen accounts are
+        // dropped and disappear with the next compaction
+        if (m_diskIndex.contains(profile.user.id)) {
+            ++m_deadRecords;
+        }
+        if (profile.lastConfirmedMs() < cutoff) {
+            m_diskIndex.remove(profile.user.id);
+            ++m_deadRecords;
+        } else {
+            m_diskIndex.insert(profile.user.id, offset);
+            indexLogin(profile.user.login, profile.user.id);
+        }
+        offset = m_store.pos();
+    }
+
+    // A crash mid-append leaves a partial record at the end
+    if (offset < m_store.size()) {
+        qWarning() << "Profile store: dropping" << (m_store.size() - offset) << "trailing bytes";
+        m_store.resize(offset);
+    }
+    return true;
+}
+
+void ProfileCache::compactStore()
+{
+    QSaveFile out(m_path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning() << "Profile store: cannot compact" << out.errorString();
+        return;
+    }
+
+    QDataStream stream(&out);
+    stream.setVersion(QDataStream::Qt_6_5);
+    stream << STORE_MAGIC << STORE_VERSION;
+
+    QHash<QString, qint64> index;
+    index.reserve(m_diskIndex.size());
+    for (auto it = m_diskIndex.constBegin(); it != m_diskIndex.constEnd(); ++it) {
+        UserProfile profile;
+        if (!readRecord(it.value(), &profile)) {
+            continue;
+        }
+        index.insert(it.key(), out.pos());
+        stream << encode(profile);
+    }
+
+    m_store.close();
+    if (!out.commit()) {
+        qWarning() << "Profile store: compaction failed" << out.errorString();
+        m_store.open(QIODevice::ReadWrite);
+        return;
+    }
+    if (!m_store.open(QIODevice::ReadWrite)) {
+        qWarning() << "Profile store: cannot reopen" << m_path << m_store.errorString();
+        m_diskIndex.clear();
+        return;
+    }
+
+    qDebug() << "Profile store compacted:" << m_deadRecords << "records dropped";
+    m_diskIndex = index;
+    m_deadRecords = 0;
+}
+
+bool ProfileCache::readRecord(qint64 offset, UserProfile *profile)
+{
+    if (!m_store.isOpen() || !m_store.seek(offset)) {
+        return false;
+    }
+    QDataStream in(&m_store);
+    in.setVersion(QDataStream::Qt_6_5);
+    QByteArray payload;
+    in >> payload;
+    return in.status() == QDataStream::Ok && decode(payload, profile);
+}
+
+void ProfileCache::writeRecord(const UserProfile &profile)
+{
+    if (!m_store.isOpen()) {
+        return;
+    }
+
+    const qint64 offset = m_store.size();
+    m_store.seek(offset);
+    QDataStream out(&m_store);
+    out.setVersion(QDataStream::Qt_6_5);
+    out << encode(profile);
+
+    if (m_diskIndex.contains(profile.user.id)) {
+        ++m_deadRecords;
+    }
+    m_diskIndex.insert(profile.user.id, offset);
+    ++m_stats.diskWrites;
+}
+
+double ProfileCache::Stats::hitRate(Field field) const
+{
+    const quint64 lookups = hits[field] + misses[field];
+    return lookups == 0 ? 0.0 : double(hits[field]) / double(lookups);
+}
+
+double ProfileCache::Stats::hitRate() const
+{
+    quint64 totalHits = 0;
+    quint64 lookups = 0;
+    for (int f = 0; f < FieldCount; ++f) {
+        totalHits += hits[f];
+        lookups += hits[f] + misses[f];
+    }
+    return lookups == 0 ? 0.0 : double(totalHits) / double(lookups);
+}
+
+ProfileCache::Stats ProfileCache::stats() const
+{
+    Stats stats = m_stats;
+    stats.memoryEntries = int(m_memory.size());
+    stats.capacity = m_capacity;
+    stats.diskRecords = int(m_diskIndex.size());
+    stats.diskBytes = m_store.isOpen() ? m_store.size() : 0;
+    return stats;
+}
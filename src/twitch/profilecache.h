@@ -0,0 +1,143 @@
+#ifndef PROFILECACHE_H
+#define PROFILECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QFile>
+#include <QTimer>
+#include <list>
+#include "userlookupservice.h"
+
+// Cached account record. Each field group carries the wall-clock time
+// (ms since epoch) it was last confirmed by Helix or IRC; 0 = never.
+struct UserProfile {
+    // Per-channel state, keyed by broadcaster id
+    struct ChannelRole {
+        bool moderator = false;
+        bool vip = false;
+        bool banned = false;
+        qint64 moderatorAtMs = 0;
+        qint64 vipAtMs = 0;
+        qint64 bannedAtMs = 0;
+    };
+
+    TwitchUser user;
+    qint64 loginAtMs = 0;   // login -> id mapping
+    qint64 profileAtMs = 0; // display name, type, description, avatar
+    QHash<QString, ChannelRole> channels;
+
+    bool isValid() const { return user.isValid(); }
+    qint64 lastConfirmedMs() const;
+};
+
+// Two-tier cache of Twitch accounts, keyed by user id and by login.
+//
+// Tier 1 is an in-memory LRU of decoded records. Tier 2 is an append-only
+// file of QDataStream records; only its index (id -> file offset, login ->
+// id) is loaded at startup, and records are read back and promoted on a
+// miss in tier 1. Changes are written behind: dirty records are appended
+// on eviction and every FLUSH_INTERVAL_MS, and the file is compacted at
+// startup once superseded records outnumber live ones.
+//
+// Every field has its own TTL (see ttlMs): created_at never changes, the
+// profile is good for a day, roles for a few minutes. A lookup names the
+// field it needs and is only a hit while that field is fresh, so an
+// account-age check keeps hitting long after the avatar has gone stale.
+class ProfileCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Field {
+        CreatedAt,
+        Profile,
+        Moderator,
+        Vip,
+        Banned,
+        FieldCount
+    };
+
+    explicit ProfileCache(const QString &path, int capacity = 5000, QObject *parent = nullptr);
+    ~ProfileCache() override;
+
+    // Returns the record if `field` is fresh (roles: in broadcasterId),
+    // otherwise an invalid profile. Logins only resolve while the login
+    // mapping is fresh, since accounts can be renamed and logins reused.
+    UserProfile findById(const QString &userId, Field field = Profile,
+                         const QString &broadcasterId = QString());
+    UserProfile findByLogin(const QString &login, Field field = Profile,
+                            const QString &broadcasterId = QString());
+
+    void storeUser(const TwitchUser &user);
+    // Accounts not cached yet get a stub record holding only id and login
+    void storeRole(const QString &userId, const QString &login, const QString &broadcasterId,
+                   Field field, bool value);
+
+    // Appends all dirty records to the store
+    void flush();
+
+    static qint64 ttlMs(Field field); // -1 = never expires
+    static const char *fieldName(Field field);
+
+    struct Stats {
+        quint64 hits[FieldCount] = {};
+        quint64 misses[FieldCount] = {};  // includes expired
+        quint64 expired[FieldCount] = {}; // record found, field stale
+        quint64 memoryHits = 0;
+        quint64 diskHits = 0;             // promoted from the store
+        quint64 evictions = 0;
+        quint64 diskWrites = 0;
+        int memoryEntries = 0;
+        int capacity = 0;
+        int diskRecords = 0;
+        qint64 diskBytes = 0;
+
+        double hitRate(Field field) const;
+        double hitRate() const;
+    };
+    Stats stats() const;
+
+    static constexpr qint64 FLUSH_INTERVAL_MS = 30 * 1000;
+    static constexpr qint64 RETENTION_MS = 30LL * 24 * 60 * 60 * 1000;
+
+private:
+    struct Node {
+        UserProfile profile;
+        std::list<QString>::iterator lru;
+        bool dirty = false;
+    };
+
+    UserProfile find(const QString &userId, const QString &loginKey, Field field,
+                     const QString &broadcasterId);
+    Node *node(const QString &userId, bool *promoted = nullptr);
+    Node &insertNode(const UserProfile &profile, bool dirty);
+    void touch(Node &node);
+    void evict();
+    void indexLogin(const QString &login, const QString &userId);
+    bool isFresh(const UserProfile &profile, Field field, const QString &broadcasterId,
+                 qint64 now) const;
+
+    bool openStore();
+    bool scanStore();
+    void compactStore();
+    bool readRecord(qint64 offset, UserProfile *profile);
+    void writeRecord(const UserProfile &profile);
+    static QByteArray encode(const UserProfile &profile);
+    static bool decode(const QByteArray &bytes, UserProfile *profile);
+
+    int m_capacity;
+    QHash<QString, Node> m_memory;        // user id -> record (tier 1)
+    std::list<QString> m_lru;             // user ids, most recent first
+    QHash<QString, QString> m_loginIndex; // lowercase login -> user id (both tiers)
+
+    QString m_path;
+    QFile m_store;
+    QHash<QString, qint64> m_diskIndex;   // user id -> offset of its newest record (tier 2)
+    int m_deadRecords;                    // superseded records in the file
+    QTimer *m_flushTimer;
+
+    Stats m_stats;
+};
+
+#endif // PROFILECACHE_H
@@ -0,0 +1,299 @@
+#include "requestscheduler.h"
+#include "networkstack.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QRandomGenerator>
+#include <QUrl>
+#include <algorithm>
+
+namespace {
+constexpr int DEFAULT_LIMIT = 800;              // Helix points per minute
+constexpr double BUCKET_WINDOW_MS = 60000.0;    // full refill time
+
+// Share of the bucket each priority must leave untouched
+constexpr double RESERVE[ApiRequest::PriorityCount] = {0.0, 0.05, 0.20};
+
+constexpr qint64 BASE_BACKOFF_MS = 500;
+constexpr qint64 MAX_BACKOFF_MS = 30000;
+
+// Safe to send again when the first response was lost. Helix PATCH bodies
+// set absolute state (chat settings, poll/prediction status), so a repeat
+// changes nothing; a repeated POST would create a second poll, prediction
+// or subscription.
+bool isIdempotent(const QString &method)
+{
+    return method == "GET" || method == "PUT" || method == "PATCH" || method == "DELETE";
+}
+}
+
+RequestScheduler::RequestScheduler(NetworkStack *network, const QString &baseUrl, QObject *parent)
+    : QObject(parent)
+    , m_network(network)
+    , m_baseUrl(baseUrl)
+    , m_limit(DEFAULT_LIMIT)
+    , m_tokens(DEFAULT_LIMIT)
+    , m_lastRefillMs(0)
+    , m_pausedUntilMs(0)
+    , m_wakeTimer(new QTimer(this))
+    , m_nextId(1)
+    , m_sent(0)
+    , m_succeeded(0)
+    , m_failed(0)
+    , m_retries(0)
+    , m_rateLimited(0)
+    , m_waitCount{}
+    , m_waitTotalMs{}
+    , m_waitMaxMs{}
+{
+    m_clock.start();
+    m_wakeTimer->setSingleShot(true);
+    connect(m_wakeTimer, &QTimer::timeout, this, &RequestScheduler::dispatch);
+}
+
+void RequestScheduler::setAuthHeaders(const QString &accessToken, const QString &clientId)
+{
+    m_authorization = ("Bearer " + accessToken).toUtf8();
+    m_clientId = clientId.toUtf8();
+}
+
+qint64 RequestScheduler::now() const
+{
+    return m_clock.elapsed();
+}
+
+quint64 RequestScheduler::reserveId()
+{
+    return m_nextId++;
+}
+
+quint64 RequestScheduler::enqueue(const QString &method, const QString &endpoint,
+                                  const QByteArray &body, ApiRequest::Priority priority,
+                                  const QList<QPair<QByteArray, QByteArray>> &headers)
+{
+    ApiRequest request;
+    request.id = reserveId();
+    request.method = method;
+    request.endpoint = endpoint;
+    request.body = body;
+    request.headers = headers;
+    request.priority = priority;
+    request.enqueuedMs = now();
+
+    m_queues[priority].push_back(request);
+    dispatch();
+    return request.id;
+}
+
+void RequestScheduler::refill()
+{
+    const qint64 t = now();
+    m_tokens = qMin(double(m_limit), m_tokens + double(t - m_lastRefillMs) * m_limit / BUCKET_WINDOW_MS);
+    m_lastRefillMs = t;
+}
+
+bool RequestScheduler::hasBudget(ApiRequest::Priority priority) const
+{
+    return m_tokens >= 1.0 + m_limit * RESERVE[priority];
+}
+
+void RequestScheduler::scheduleWakeUp(qint64 delayMs)
+{
+    delayMs = qMax<qint64>(1, delayMs);
+    if (!m_wakeTimer->isActive() || m_wakeTimer->remainingTime() > delayMs) {
+        m_wakeTimer->start(int(qMin<qint64>(delayMs, MAX_BACKOFF_MS)));
+    }
+}
+
+void RequestScheduler::dispatch()
+{
+    refill();
+    const qint64 t = now();
+
+    // Due retries go back to the front of their queue, oldest first
+    if (!m_delayed.isEmpty()) {
+        QList<ApiRequest> due;
+        for (int i = int(m_delayed.size()) - 1; i >= 0; --i) {
+            if (m_delayed.at(i).notBeforeMs <= t) {
+                due.append(m_delayed.takeAt(i));
+            }
+        }
+        std::sort(due.begin(), due.end(), [](const ApiRequest &a, const ApiRequest &b) {
+            return a.id > b.id;
+        });
+        for (const ApiRequest &request : due) {
+            m_queues[request.priority].push_front(request);
+        }
+    }
+
+    if (t < m_pausedUntilMs) {
+        scheduleWakeUp(m_pausedUntilMs - t);
+        return;
+    }
+
+    while (m_inFlight.size() < MAX_IN_FLIGHT) {
+        int priority = 0;
+        while (priority < ApiRequest::PriorityCount && m_queues[priority].empty()) {
+            ++priority;
+        }
+        if (priority == ApiRequest::PriorityCount) {
+            break;
+        }
+
+        // Higher priorities are empty, so waiting on this one blocks nothing
+        if (!hasBudget(ApiRequest::Priority(priority))) {
+            const double deficit = 1.0 + m_limit * RESERVE[priority] - m_tokens;
+            scheduleWakeUp(qint64(deficit * BUCKET_WINDOW_MS / m_limit) + 1);
+            break;
+        }
+
+        ApiRequest request = m_queues[priority].front();
+        m_queues[priority].pop_front();
+        m_tokens -= 1.0;
+        send(request);
+    }
+
+    if (!m_delayed.isEmpty()) {
+        qint64 next = m_delayed.first().notBeforeMs;
+        for (const ApiRequest &request : m_delayed) {
+            next = qMin(next, request.notBeforeMs);
+        }
+        scheduleWakeUp(next - t);
+    }
+}
+
+void RequestScheduler::send(ApiRequest request)
+{
+    if (request.attempts == 0) {
+        const qint64 waited = now() - request.enqueuedMs;
+        m_waitCount[request.priority]++;
+        m_waitTotalMs[request.priority] += waited;
+        m_waitMaxMs[request.priority] = qMax(m_waitMaxMs[request.priority], waited);
+    }
+    ++request.attempts;
+    ++m_sent;
+
+    QNetworkRequest networkRequest = m_network->request(QUrl(m_baseUrl + request.endpoint));
+    networkRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    networkRequest.setRawHeader("Authorization", m_authorization);
+    networkRequest.setRawHeader("Client-Id", m_clientId);
+    for (const auto &header : std::as_const(request.headers)) {
+        networkRequest.setRawHeader(header.first, header.second);
+    }
+
+    QNetworkReply *reply = nullptr;
+    if (request.method == "GET") {
+        reply = m_network->manager()->get(networkRequest);
+    }
+    else if (request.method == "POST") {
+        reply = m_network->manager()->post(networkRequest, request.body);
+    }
+    else if (request.method == "DELETE") {
+        reply = m_network->manager()->deleteResource(networkRequest);
+    }
+    else {
+        reply = m_network->manager()->sendCustomRequest(networkRequest, request.method.toUtf8(), request.body);
+    }
+
+    m_network->track(reply);
+    m_inFlight.insert(reply, request);
+    connect(reply, &QNetworkReply::finished, this, &RequestScheduler::onReplyFinished);
+}
+
+void RequestScheduler::updateBucket(QNetworkReply *reply)
+{
+    bool ok = false;
+    const int limit = reply->rawHeader("Ratelimit-Limit").toInt(&ok);
+    if (ok && limit > 0) {
+        m_limit = limit;
+    }
+
+    const int remaining = reply->rawHeader("Ratelimit-Remaining").toInt(&ok);
+    if (ok) {
+        // Requests still in flight may already be counted by the server or
+        // not; assume they are not, which errs on the safe side
+        refill();
+        m_tokens = qMax(0, remaining - int(m_inFlight.size()));
+    }
+}
+
+void RequestScheduler::retryLater(ApiRequest request, qint64 delayMs)
+{
+    ++m_retries;
+    request.notBeforeMs = now() + delayMs;
+    m_delayed.append(request);
+}
+
+void RequestScheduler::onReplyFinished()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+    if (!reply) {
+        return;
+    }
+
+    ApiRequest request = m_inFlight.take(reply);
+    const int statusCode = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QByteArray data = reply->readAll();
+    updateBucket(reply);
+
+    if (statusCode == 429 && request.attempts < MAX_ATTEMPTS) {
+        // Bucket is empty: stop everyone until it resets, then go first
+        ++m_rateLimited;
+        ++m_retries;
+        m_tokens = 0;
+        bool ok = false;
+        const qint64 resetEpochMs = reply->rawHeader("Ratelimit-Reset").toLongLong(&ok) * 1000;
+        const qint64 untilReset = ok ? resetEpochMs - QDateTime::currentMSecsSinceEpoch() : 0;
+        m_pausedUntilMs = qMax(m_pausedUntilMs, now() + qBound<qint64>(1000, untilReset, 60000));
+        m_queues[request.priority].push_front(request);
+        qWarning() << "Helix rate limit hit, pausing requests for" << (m_pausedUntilMs - now()) << "ms";
+    }
+    else if (reply->error() == QNetworkReply::NoError) {
+        ++m_succeeded;
+        emit requestSucceeded(request.id, request.endpoint, statusCode, data, reply->rawHeader("ETag"));
+    }
+    else if ((statusCode >= 500 || statusCode == 0)
+             && reply->error() != QNetworkReply::OperationCanceledError
+             && isIdempotent(request.method)
+             && request.attempts < MAX_ATTEMPTS) {
+        // Server or transport trouble: exponential backoff with jitter
+        const qint64 backoff = qMin(MAX_BACKOFF_MS, BASE_BACKOFF_MS << (request.attempts - 1));
+        const qint64 jitter = QRandomGenerator::global()->bounded(int(backoff / 2) + 1);
+        qWarning() << "Retrying" << request.method << request.endpoint << "after"
+                   << (backoff + jitter) << "ms (" << reply->errorString() << ")";
+        retryLater(request, backoff + jitter);
+    }
+    else {
+        // Prefer Twitch's own explanation over Qt's generic error text
+        QString error = QJsonDocument::fromJson(data).object().value("message").toString();
+        if (error.isEmpty()) {
+            error = reply->errorString();
+        }
+        ++m_failed;
+        emit requestFailed(request.id, request.endpoint, statusCode, error);
+    }
+
+    reply->deleteLater();
+    dispatch();
+}
+
+RequestSchedulerStats RequestScheduler::stats() const
+{
+    RequestSchedulerStats stats;
+    for (int p = 0; p < ApiRequest::PriorityCount; ++p) {
+        stats.queued[p] = int(m_queues[p].size());
+        stats.averageWaitMs[p] = m_waitCount[p] ? double(m_waitTotalMs[p]) / double(m_waitCount[p]) : 0.0;
+        stats.maxWaitMs[p] = m_waitMaxMs[p];
+    }
+    stats.delayed = int(m_delayed.size());
+    stats.inFlight = int(m_inFlight.size());
+    stats.bucketLimit = m_limit;
+    stats.bucketRemaining = int(m_tokens);
+    stats.pausedForMs = qMax<qint64>(0, m_pausedUntilMs - now());
+    stats.sent = m_sent;
+    stats.succeeded = m_succeeded;
+    stats.failed = m_failed;
+    stats.retries = m_retries;
+    stats.rateLimited = m_rateLimited;
+    return stats;
+}
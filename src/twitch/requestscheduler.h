@@ -0,0 +1,142 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QPair>
+#include <deque>
+
+class NetworkStack;
+
+// One queued Helix call
+struct ApiRequest {
+    enum Priority {
+        Moderation,  // ban, timeout, unban, delete, raid-time chat settings
+        Interactive, // polls, predictions - a moderator is waiting on them
+        Background,  // chatters, user lookups, listings
+        PriorityCount
+    };
+
+    quint64 id = 0;
+    QString method;
+    QString endpoint;
+    QByteArray body;
+    QList<QPair<QByteArray, QByteArray>> headers; // extra request headers
+    Priority priority = Background;
+    int attempts = 0;
+    qint64 enqueuedMs = 0;  // monotonic, for queue wait
+    qint64 notBeforeMs = 0; // monotonic, retry backoff
+};
+
+struct RequestSchedulerStats {
+    int queued[ApiRequest::PriorityCount] = {};
+    int delayed = 0;   // waiting out a retry backoff
+    int inFlight = 0;
+
+    int bucketLimit = 0;
+    int bucketRemaining = 0; // local estimate, corrected from the headers
+    qint64 pausedForMs = 0;  // > 0 after a 429 until the bucket resets
+
+    quint64 sent = 0;
+    quint64 succeeded = 0;
+    quint64 failed = 0;
+    quint64 retries = 0;
+    quint64 rateLimited = 0; // 429 responses
+
+    double averageWaitMs[ApiRequest::PriorityCount] = {};
+    qint64 maxWaitMs[ApiRequest::PriorityCount] = {};
+};
+
+// Rate-limit aware dispatcher for Helix requests.
+//
+// Helix uses a token bucket per client/user (800 points per minute by
+// default, refilled continuously) and reports it in the Ratelimit-Limit,
+// Ratelimit-Remaining and Ratelimit-Reset headers. The scheduler keeps a
+// local estimate of the bucket, corrected on every response, and only
+// sends while it has tokens. Lower priorities keep a reserve untouched so
+// moderation actions always have budget during a raid.
+//
+// 429 pauses all sending until the bucket resets and requeues the request
+// at the front of its priority, whatever the method, since Twitch did not
+// act on it. 5xx and network errors are retried with exponential backoff
+// and jitter, but only for idempotent methods: a POST whose response was
+// lost may already have run, so it fails straight to the caller. Only the
+// final outcome is reported.
+class RequestScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    RequestScheduler(NetworkStack *network, const QString &baseUrl,
+                     QObject *parent = nullptr);
+
+    void setAuthHeaders(const QString &accessToken, const QString &clientId);
+
+    quint64 enqueue(const QString &method, const QString &endpoint,
+                    const QByteArray &body, ApiRequest::Priority priority,
+                    const QList<QPair<QByteArray, QByteArray>> &headers = {});
+    // Id from the same sequence, for outcomes delivered without a request
+    quint64 reserveId();
+
+    RequestSchedulerStats stats() const;
+
+    static constexpr int MAX_IN_FLIGHT = 6; // QNetworkAccessManager's per-host limit
+    static constexpr int MAX_ATTEMPTS = 5;
+
+signals:
+    // etag is the response's ETag header, empty when absent
+    void requestSucceeded(quint64 id, const QString &endpoint, int statusCode, const QByteArray &data,
+                          const QByteArray &etag);
+    void requestFailed(quint64 id, const QString &endpoint, int statusCode, const QString &error);
+
+private slots:
+    void onReplyFinished();
+
+private:
+    void dispatch();
+    void send(ApiRequest request);
+    void retryLater(ApiRequest request, qint64 delayMs);
+    void updateBucket(QNetworkReply *reply);
+    void refill();
+    bool hasBudget(ApiRequest::Priority priority) const;
+    void scheduleWakeUp(qint64 delayMs);
+    qint64 now() const;
+
+    NetworkStack *m_network;
+    QString m_baseUrl;
+    QByteArray m_authorization;
+    QByteArray m_clientId;
+
+    std::deque<ApiRequest> m_queues[ApiRequest::PriorityCount];
+    QList<ApiRequest> m_delayed;
+    QHash<QNetworkReply*, ApiRequest> m_inFlight;
+
+    // Token bucket estimate
+    int m_limit;
+    double m_tokens;
+    qint64 m_lastRefillMs;
+    qint64 m_pausedUntilMs;
+
+    QElapsedTimer m_clock;
+    QTimer *m_wakeTimer;
+    quint64 m_nextId;
+
+    // Stats
+    quint64 m_sent;
+    quint64 m_succeeded;
+    quint64 m_failed;
+    quint64 m_retries;
+    quint64 m_rateLimited;
+    quint64 m_waitCount[ApiRequest::PriorityCount];
+    qint64 m_waitTotalMs[ApiRequest::PriorityCount];
+    qint64 m_waitMaxMs[ApiRequest::PriorityCount];
+};
+
+#endif // REQUESTSCHEDULER_H
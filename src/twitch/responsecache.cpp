@@ -0,0 +1,195 @@
+#include "responsecache.h"
+#include <QMetaObject>
+
+ResponseCache::ResponseCache(RequestScheduler *scheduler, QObject *parent)
+    : QObject(parent)
+    , m_scheduler(scheduler)
+{
+    m_clock.start();
+    connect(m_scheduler, &RequestScheduler::requestSucceeded, this, &ResponseCache::onSucceeded);
+    connect(m_scheduler, &RequestScheduler::requestFailed, this, &ResponseCache::onFailed);
+}
+
+QString ResponseCache::pathOf(const QString &endpoint)
+{
+    const qsizetype query = endpoint.indexOf('?');
+    return query < 0 ? endpoint : endpoint.left(query);
+}
+
+void ResponseCache::setMaxAge(const QString &path, qint64 maxAgeMs)
+{
+    m_maxAgeMs.insert(path, maxAgeMs);
+}
+
+void ResponseCache::clear()
+{
+    m_entries.clear();
+    for (Flight &flight : m_flights) {
+        flight.invalidated = true;
+    }
+}
+
+quint64 ResponseCache::enqueue(const QString &method, const QString &endpoint,
+                               const QByteArray &body, ApiRequest::Priority priority)
+{
+    if (method == "GET") {
+        return get(endpoint, priority);
+    }
+    invalidate(pathOf(endpoint));
+    return m_scheduler->enqueue(method, endpoint, body, priority);
+}
+
+quint64 ResponseCache::get(const QString &endpoint, ApiRequest::Priority priority)
+{
+    ResponseCacheStats &stats = m_stats[pathOf(endpoint)];
+    const qint64 maxAgeMs = m_maxAgeMs.value(pathOf(endpoint), 0);
+
+    auto entry = m_entries.constFind(endpoint);
+    if (entry != m_entries.constEnd() && m_clock.elapsed() - entry->storedMs < maxAgeMs) {
+        ++stats.hits;
+        const quint64 id = m_scheduler->reserveId();
+        const int statusCode = entry->statusCode;
+        const QByteArray data = entry->data;
+        QMetaObject::invokeMethod(this, [this, id, endpoint, statusCode, data]() {
+            emit requestSucceeded(id, endpoint, statusCode, data);
+        }, Qt::QueuedConnection);
+        return id;
+    }
+
+    auto flight = m_flights.find(endpoint);
+    if (flight != m_flights.end()) {
+        // The shared request keeps the priority it was queued with
+        ++stats.joined;
+        const quint64 id = m_scheduler->reserveId();
+        flight->waiters.append(id);
+        return id;
+    }
+
+    ++stats.misses;
+    QList<QPair<QByteArray, QByteArray>> headers;
+    if (entry != m_entries.constEnd() && !entry->etag.isEmpty()) {
+        headers.append(qMakePair(QByteArray("If-None-Match"), entry->etag));
+    }
+
+    const quint64 id = m_scheduler->enqueue("GET", endpoint, QByteArray(), priority, headers);
+    Flight &newFlight = m_flights[endpoint];
+    newFlight.waiters.append(id);
+    newFlight.priority = priority;
+    m_flightIds.insert(id, endpoint);
+    return id;
+}
+
+void ResponseCache::invalidate(const QString &path)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (pathOf(it.key()) == path) {
+            ++m_stats[path].invalidated;
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_flights.begin(); it != m_flights.end(); ++it) {
+        if (pathOf(it.key()) == path) {
+            it->invalidated = true;
+        }
+    }
+}
+
+void ResponseCache::onSucceeded(quint64 id, const QString &endpoint, int statusCode,
+                                const QByteArray &data, const QByteArray &etag)
+{
+    auto flightId = m_flightIds.find(id);
+    if (flightId == m_flightIds.end()) {
+        emit requestSucceeded(id, endpoint, statusCode, data);
+        return;
+    }
+    auto entry = m_entries.find(endpoint);
+    if (statusCode == 304 && entry == m_entries.end()) {
+        // clear() or a write dropped the body we revalidated; a 304 alone
+        // would reach the parsers as an empty success. Same waiters, new
+        // unconditional request.
+        Flight &flight = m_flights[flightId.value()];
+        flight.invalidated = false;
+        ++m_stats[pathOf(endpoint)].misses;
+        m_flightIds.erase(flightId);
+        const quint64 retryId = m_scheduler->enqueue("GET", endpoint, QByteArray(), flight.priority);
+        m_flightIds.insert(retryId, endpoint);
+        return;
+    }
+
+    const Flight flight = m_flights.take(flightId.value());
+    m_flightIds.erase(flightId);
+
+    int resultCode = statusCode;
+    QByteArray result = data;
+    if (statusCode == 304 && entry != m_entries.end()) {
+        ++m_stats[pathOf(endpoint)].revalidated;
+        resultCode = entry->statusCode;
+        result = entry->data;
+        entry->storedMs = m_clock.elapsed();
+    }
+    else if (!flight.invalidated && statusCode == 200
+             && (m_maxAgeMs.value(pathOf(endpoint), 0) > 0 || !etag.isEmpty())) {
+        Entry fresh;
+        fresh.data = data;
+        fresh.etag = etag;
+        fresh.statusCode = statusCode;
+        fresh.storedMs = m_clock.elapsed();
+        m_entries.insert(endpoint, fresh);
+        trim();
+    }
+    else if (entry != m_entries.end()) {
+        m_entries.erase(entry);
+    }
+
+    for (quint64 waiter : flight.waiters) {
+        emit requestSucceeded(waiter, endpoint, resultCode, result);
+    }
+}
+
+void ResponseCache::onFailed(quint64 id, const QString &endpoint, int statusCode, const QString &error)
+{
+    auto flightId = m_flightIds.find(id);
+    if (flightId == m_flightIds.end()) {
+        emit requestFailed(id, endpoint, statusCode, error);
+        return;
+    }
+    const Flight flight = m_flights.take(flightId.value());
+    m_flightIds.erase(flightId);
+
+    for (quint64 waiter : flight.waiters) {
+        emit requestFailed(waiter, endpoint, statusCode, error);
+    }
+}
+
+void ResponseCache::trim()
+{
+    if (m_entries.size() <= MAX_ENTRIES) {
+        return;
+    }
+
+    // Drop what can neither be served nor revalidated, then the oldest
+    const qint64 now = m_clock.elapsed();
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (it->etag.isEmpty() && now - it->storedMs >= m_maxAgeMs.value(pathOf(it.key()), 0)) {
+            it = m_entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    while (m_entries.size() > MAX_ENTRIES) {
+        auto oldest = m_entries.begin();
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+            if (it->storedMs < oldest->storedMs) {
+                oldest = it;
+            }
+        }
+        m_entries.erase(oldest);
+    }
+}
+
+QHash<QString, ResponseCacheStats> ResponseCache::stats() const
+{
+    return m_stats;
+}
@@ -0,0 +1,92 @@
+#ifndef RESPONSECACHE_H
+#define RESPONSECACHE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QHash>
+#include <QElapsedTimer>
+#include "requestscheduler.h"
+
+// Hit/miss counters for one endpoint path (query string stripped)
+struct ResponseCacheStats {
+    quint64 hits = 0;        // answered from a fresh cached response
+    quint64 misses = 0;      // went to the network
+    quint64 joined = 0;      // attached to an identical request in flight
+    quint64 revalidated = 0; // 304 Not Modified, cached body reused
+    quint64 invalidated = 0; // dropped by a write to the same path
+};
+
+// Cache and single-flight layer in front of the RequestScheduler.
+//
+// GETs to the same endpoint (path and query) share one network request
+// while it is in flight; every caller still gets its own request id. A
+// successful response is kept for the max age configured for its path
+// (0 = not kept, single-flight only). Once stale, a response that came
+// with an ETag is revalidated with If-None-Match, and a 304 reuses the
+// cached body; a 304 whose body has been dropped meanwhile is fetched
+// again unconditionally. Any other method is passed straight through and
+// drops the cached GETs of its path, so a PATCH of the chat settings is
+// never followed by the old settings.
+//
+// Outcomes are reported like the scheduler's; cache hits are delivered
+// from the event loop, after the caller has its request id.
+class ResponseCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ResponseCache(RequestScheduler *scheduler, QObject *parent = nullptr);
+
+    quint64 enqueue(const QString &method, const QString &endpoint,
+                    const QByteArray &body, ApiRequest::Priority priority);
+
+    // path is the endpoint without query, e.g. "/chat/settings"
+    void setMaxAge(const QString &path, qint64 maxAgeMs);
+    void clear();
+
+    QHash<QString, ResponseCacheStats> stats() const;
+
+    // Endpoint without its query string
+    static QString pathOf(const QString &endpoint);
+
+    static constexpr int MAX_ENTRIES = 512;
+
+signals:
+    void requestSucceeded(quint64 id, const QString &endpoint, int statusCode, const QByteArray &data);
+    void requestFailed(quint64 id, const QString &endpoint, int statusCode, const QString &error);
+
+private slots:
+    void onSucceeded(quint64 id, const QString &endpoint, int statusCode, const QByteArray &data,
+                     const QByteArray &etag);
+    void onFailed(quint64 id, const QString &endpoint, int statusCode, const QString &error);
+
+private:
+    struct Entry {
+        QByteArray data;
+        QByteArray etag;
+        int statusCode = 200;
+        qint64 storedMs = 0;
+    };
+
+    struct Flight {
+        QList<quint64> waiters; // request ids handed out, the network id first
+        bool invalidated = false; // a write raced the request, don't store
+        ApiRequest::Priority priority = ApiRequest::Background;
+    };
+
+    quint64 get(const QString &endpoint, ApiRequest::Priority priority);
+    void invalidate(const QString &path);
+    void trim();
+
+    RequestScheduler *m_scheduler;
+    QHash<QString, qint64> m_maxAgeMs;   // by path
+    QHash<QString, Entry> m_entries;     // by endpoint
+    QHash<QString, Flight> m_flights;    // by endpoint
+    QHash<quint64, QString> m_flightIds; // network request id -> endpoint
+    QHash<QString, ResponseCacheStats> m_stats;
+    QElapsedTimer m_clock;
+};
+
+#endif // RESPONSECACHE_H
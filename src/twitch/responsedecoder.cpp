@@ -0,0 +1,51 @@
+#include "responsedecoder.h"
+#include <QElapsedTimer>
+#include <QMutexLocker>
+
+ResponseDecoder::ResponseDecoder(int threads)
+{
+    m_pool.setMaxThreadCount(threads);
+    m_pool.setObjectName("ResponseDecoder");
+}
+
+ResponseDecoder::~ResponseDecoder()
+{
+    m_pool.waitForDone();
+}
+
+void ResponseDecoder::run(const QString &path, qsizetype bytes, std::function<void()> decode)
+{
+    if (bytes < INLINE_LIMIT) {
+        QElapsedTimer timer;
+        timer.start();
+        decode();
+        record(path, bytes, timer.nsecsElapsed() / 1000, false);
+        return;
+    }
+
+    m_pool.start([this, path, bytes, decode]() {
+        QElapsedTimer timer;
+        timer.start();
+        decode();
+        record(path, bytes, timer.nsecsElapsed() / 1000, true);
+    });
+}
+
+void ResponseDecoder::record(const QString &path, qsizetype bytes, qint64 elapsedUs, bool offThread)
+{
+    QMutexLocker locker(&m_mutex);
+    DecodeStats &stats = m_stats[path];
+    ++stats.responses;
+    if (offThread) {
+        ++stats.offThread;
+    }
+    stats.bytes += bytes;
+    stats.totalUs += elapsedUs;
+    stats.maxUs = qMax(stats.maxUs, elapsedUs);
+}
+
+QHash<QString, DecodeStats> ResponseDecoder::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_stats;
+}
@@ -0,0 +1,48 @@
+#ifndef RESPONSEDECODER_H
+#define RESPONSEDECODER_H
+
+#include <QString>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <functional>
+
+// Decode timings for one endpoint path
+struct DecodeStats {
+    quint64 responses = 0;
+    quint64 offThread = 0; // decoded on the pool rather than inline
+    qint64 bytes = 0;
+    qint64 totalUs = 0;
+    qint64 maxUs = 0;
+
+    double averageUs() const { return responses ? double(totalUs) / double(responses) : 0.0; }
+};
+
+// Runs response decoders off the GUI thread.
+//
+// Bodies of INLINE_LIMIT bytes or more (chatter pages, moderator and user
+// listings) are decoded on a small private pool; anything smaller is
+// decoded inline, where it costs less than the thread hop. The decode task
+// completes its own promise, so only the finished result reaches the GUI
+// thread through the caller's then(context, ...) continuation.
+class ResponseDecoder
+{
+public:
+    explicit ResponseDecoder(int threads = 2);
+    ~ResponseDecoder();
+
+    void run(const QString &path, qsizetype bytes, std::function<void()> decode);
+
+    QHash<QString, DecodeStats> stats() const;
+
+    static constexpr qsizetype INLINE_LIMIT = 16 * 1024;
+
+private:
+    void record(const QString &path, qsizetype bytes, qint64 elapsedUs, bool offThread);
+
+    QThreadPool m_pool;
+    mutable QMutex m_mutex;
+    QHash<QString, DecodeStats> m_stats;
+};
+
+#endif // RESPONSEDECODER_H
@@ -3,24 +3,45 @@
 #include <QJsonArray>
 #include <QUrlQuery>
 
-TwitchAPI::TwitchAPI(QObject *parent)
+TwitchAPI::TwitchAPI(NetworkStack *network, QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_scheduler(new RequestScheduler(network, API_BASE_URL, this))
+    , m_responseCache(new ResponseCache(m_scheduler, this))
 {
+    // Listings that several panels poll; everything else is single-flight only
+    m_responseCache->setMaxAge("/chat/settings", 10 * 1000);
+    m_responseCache->setMaxAge("/moderation/moderators", 60 * 1000);
+    m_responseCache->setMaxAge("/polls", 5 * 1000);
+    m_responseCache->setMaxAge("/predictions", 5 * 1000);
+
+    connect(m_responseCache, &ResponseCache::requestSucceeded, this,
+            [this](quint64 requestId, const QString &endpoint, int statusCode, const QByteArray &data) {
+        Q_UNUSED(endpoint)
+        finish(requestId, statusCode, data, QString());
+    });
+    connect(m_responseCache, &ResponseCache::requestFailed, this,
+            [this](quint64 requestId, const QString &endpoint, int statusCode, const QString &error) {
+        emit requestFailed(endpoint, statusCode, error);
+        finish(requestId, statusCode, QByteArray(), error);
+    });
 }
 
 void TwitchAPI::setAccessToken(const QString &token)
 {
     m_accessToken = token;
+    m_scheduler->setAuthHeaders(m_accessToken, m_clientId);
+    // Responses depend on who is asking
+    m_responseCache->clear();
 }
 
 void TwitchAPI::setClientId(const QString &clientId)
 {
     m_clientId = clientId;
+    m_scheduler->setAuthHeaders(m_accessToken, m_clientId);
 }
 
-void TwitchAPI::banUser(const QString &broadcasterId, const QString &moderatorId,
-                       const QString &userId, const QString &reason)
+QFuture<ApiResult<BanResult>> TwitchAPI::banUser(const QString &broadcasterId, const QString &moderatorId,
+                                                 const QString &userId, const QString &reason)
 {
     QJsonObject body;
     body["data"] = QJsonObject{
@@ -30,19 +51,20 @@ void TwitchAPI::banUser(const QString &broadcasterId, const QString &moderatorId
 
     QString endpoint = QString("/moderation/bans?broadcaster_id=%1&moderator_id=%2")
                           .arg(broadcasterId, moderatorId);
-    makeRequest("POST", endpoint, body);
+    return call<BanResult>("POST", endpoint, body, ApiRequest::Moderation, &Helix::parseFirst<BanResult>);
 }
 
-void TwitchAPI::unbanUser(const QString &broadcasterId, const QString &moderatorId,
-                         const QString &userId)
+QFuture<ApiReply> TwitchAPI::unbanUser(const QString &broadcasterId, const QString &moderatorId,
+                                       const QString &userId)
 {
     QString endpoint = QString("/moderation/bans?broadcaster_id=%1&moderator_id=%2&user_id=%3")
                           .arg(broadcasterId, moderatorId, userId);
-    makeRequest("DELETE", endpoint);
+    return callWithoutResult("DELETE", endpoint, ApiRequest::Moderation);
 }
 
-void TwitchAPI::timeoutUser(const QString &broadcasterId, const QString &moderatorId,
-                           const QString &userId, int durationSeconds, const QString &reason)
+QFuture<ApiResult<BanResult>> TwitchAPI::timeoutUser(const QString &broadcasterId, const QString &moderatorId,
+                                                     const QString &userId, int durationSeconds,
+                                                     const QString &reason)
 {
     QJsonObject body;
     body["data"] = QJsonObject{
@@ -53,33 +75,47 @@ void TwitchAPI::timeoutUser(const QString &broadcasterId, const QString &moderat
 
     QString endpoint = QString("/moderation/bans?broadcaster_id=%1&moderator_id=%2")
                           .arg(broadcasterId, moderatorId);
-    makeRequest("POST", endpoint, body);
+    return call<BanResult>("POST", endpoint, body, ApiRequest::Moderation, &Helix::parseFirst<BanResult>);
 }
 
-void TwitchAPI::deleteMessage(const QString &broadcasterId, const QString &moderatorId,
-                             const QString &messageId)
+QFuture<ApiReply> TwitchAPI::deleteMessage(const QString &broadcasterId, const QString &moderatorId,
+                                           const QString &messageId)
 {
     QString endpoint = QString("/moderation/chat?broadcaster_id=%1&moderator_id=%2&message_id=%3")
                           .arg(broadcasterId, moderatorId, messageId);
-    makeRequest("DELETE", endpoint);
+    return callWithoutResult("DELETE", endpoint, ApiRequest::Moderation);
 }
 
-void TwitchAPI::getChatSettings(const QString &broadcasterId)
+QFuture<ApiReply> TwitchAPI::manageHeldAutoModMessage(const QString &moderatorId, const QString &messageId,
+                                                      bool allow)
+{
+    QJsonObject body;
+    body["user_id"] = moderatorId;
+    body["msg_id"] = messageId;
+    body["action"] = allow ? "ALLOW" : "DENY";
+
+    return callWithoutResult("POST", "/moderation/automod/message", ApiRequest::Moderation, body);
+}
+
+QFuture<ApiResult<ChatSettings>> TwitchAPI::getChatSettings(const QString &broadcasterId)
 {
     QString endpoint = QString("/chat/settings?broadcaster_id=%1").arg(broadcasterId);
-    makeRequest("GET", endpoint);
+    return call<ChatSettings>("GET", endpoint, QJsonObject(), ApiRequest::Background,
+                              &Helix::parseFirst<ChatSettings>);
 }
 
-void TwitchAPI::updateChatSettings(const QString &broadcasterId, const QString &moderatorId,
-                                  const QJsonObject &settings)
+QFuture<ApiResult<ChatSettings>> TwitchAPI::updateChatSettings(const QString &broadcasterId,
+                                                               const QString &moderatorId,
+                                                               const QJsonObject &settings)
 {
     QString endpoint = QString("/chat/settings?broadcaster_id=%1&moderator_id=%2")
                           .arg(broadcasterId, moderatorId);
-    makeRequest("PATCH", endpoint, settings);
+    return call<ChatSettings>("PATCH", endpoint, settings, ApiRequest::Moderation,
+                              &Helix::parseFirst<ChatSettings>);
 }
 
-void TwitchAPI::createPrediction(const QString &broadcasterId, const QString &title,
-                                const QStringList &outcomes, int durationSeconds)
+QFuture<ApiResult<Prediction>> TwitchAPI::createPrediction(const QString &broadcasterId, const QString &title,
+                                                           const QStringList &outcomes, int durationSeconds)
 {
     QJsonArray outcomesArray;
     for (const QString &outcome : outcomes) {
@@ -92,11 +128,12 @@ void TwitchAPI::createPrediction(const QString &broadcasterId, const QString &ti
     body["outcomes"] = outcomesArray;
     body["prediction_window"] = durationSeconds;
 
-    makeRequest("POST", "/predictions", body);
+    return call<Prediction>("POST", "/predictions", body, ApiRequest::Interactive,
+                            &Helix::parseFirst<Prediction>);
 }
 
-void TwitchAPI::endPrediction(const QString &broadcasterId, const QString &predictionId,
-                             const QString &status, const QString &winningOutcomeId)
+QFuture<ApiResult<Prediction>> TwitchAPI::endPrediction(const QString &broadcasterId, const QString &predictionId,
+                                                        const QString &status, const QString &winningOutcomeId)
 {
     QJsonObject body;
     body["broadcaster_id"] = broadcasterId;
@@ -107,17 +144,19 @@ void TwitchAPI::endPrediction(const QString &broadcasterId, const QString &predi
         body["winning_outcome_id"] = winningOutcomeId;
     }
 
-    makeRequest("PATCH", "/predictions", body);
+    return call<Prediction>("PATCH", "/predictions", body, ApiRequest::Interactive,
+                            &Helix::parseFirst<Prediction>);
 }
 
-void TwitchAPI::getPredictions(const QString &broadcasterId)
+QFuture<ApiResult<QList<Prediction>>> TwitchAPI::getPredictions(const QString &broadcasterId)
 {
     QString endpoint = QString("/predictions?broadcaster_id=%1").arg(broadcasterId);
-    makeRequest("GET", endpoint);
+    return call<QList<Prediction>>("GET", endpoint, QJsonObject(), ApiRequest::Background,
+                                   &Helix::parseList<Prediction>);
 }
 
-void TwitchAPI::createPoll(const QString &broadcasterId, const QString &title,
-                          const QStringList &choices, int durationSeconds)
+QFuture<ApiResult<Poll>> TwitchAPI::createPoll(const QString &broadcasterId, const QString &title,
+                                               const QStringList &choices, int durationSeconds)
 {
     QJsonArray choicesArray;
     for (const QString &choice : choices) {
@@ -130,98 +169,203 @@ void TwitchAPI::createPoll(const QString &broadcasterId, const QString &title,
     body["choices"] = choicesArray;
     body["duration"] = durationSeconds;
 
-    makeRequest("POST", "/polls", body);
+    return call<Poll>("POST", "/polls", body, ApiRequest::Interactive, &Helix::parseFirst<Poll>);
 }
 
-void TwitchAPI::endPoll(const QString &broadcasterId, const QString &pollId,
-                       const QString &status)
+QFuture<ApiResult<Poll>> TwitchAPI::endPoll(const QString &broadcasterId, const QString &pollId,
+                                            const QString &status)
 {
     QJsonObject body;
     body["broadcaster_id"] = broadcasterId;
     body["id"] = pollId;
     body["status"] = status; // "TERMINATED" or "ARCHIVED"
 
-    makeRequest("PATCH", "/polls", body);
+    return call<Poll>("PATCH", "/polls", body, ApiRequest::Interactive, &Helix::parseFirst<Poll>);
 }
 
-void TwitchAPI::getPolls(const QString &broadcasterId)
+QFuture<ApiResult<QList<Poll>>> TwitchAPI::getPolls(const QString &broadcasterId)
 {
     QString endpoint = QString("/polls?broadcaster_id=%1").arg(broadcasterId);
-    makeRequest("GET", endpoint);
+    return call<QList<Poll>>("GET", endpoint, QJsonObject(), ApiRequest::Background,
+                             &Helix::parseList<Poll>);
 }
 
-void TwitchAPI::getUsers(const QStringList &userIds)
+QFuture<ApiResult<QList<TwitchUser>>> TwitchAPI::getUsers(const QStringList &userIds, const QStringList &logins,
+                                                          ApiRequest::Priority priority)
 {
-    QString endpoint = "/users?";
+    QUrlQuery query;
     for (const QString &userId : userIds) {
-        endpoint += "id=" + userId + "&";
+        query.addQueryItem("id", userId);
+    }
+    for (const QString &login : logins) {
+        query.addQueryItem("login", login);
     }
-    makeRequest("GET", endpoint);
+    return call<QList<TwitchUser>>("GET", "/users?" + query.toString(QUrl::FullyEncoded), QJsonObject(),
+                                   priority, &Helix::parseUsers);
 }
 
-void TwitchAPI::getModerators(const QString &broadcasterId)
+QFuture<ApiResult<QList<TwitchUser>>> TwitchAPI::getUsersByLogin(const QStringList &logins,
+                                                                 ApiRequest::Priority priority)
 {
-    QString endpoint = QString("/moderation/moderators?broadcaster_id=%1").arg(broadcasterId);
-    makeRequest("GET", endpoint);
+    return getUsers(QStringList(), logins, priority);
 }
 
-void TwitchAPI::getChatters(const QString &broadcasterId, const QString &moderatorId)
+QFuture<ApiResult<QList<UserRef>>> TwitchAPI::getModerators(const QString &broadcasterId,
+                                                             const QStringList &userIds,
+                                                             ApiRequest::Priority priority)
 {
-    QString endpoint = QString("/chat/chatters?broadcaster_id=%1&moderator_id=%2")
-                          .arg(broadcasterId, moderatorId);
-    makeRequest("GET", endpoint);
+    QUrlQuery query;
+    query.addQueryItem("broadcaster_id", broadcasterId);
+    for (const QString &userId : userIds) {
+        query.addQueryItem("user_id", userId);
+    }
+    QString endpoint = "/moderation/moderators?" + query.toString(QUrl::FullyEncoded);
+    return call<QList<UserRef>>("GET", endpoint, QJsonObject(), priority, &Helix::parseUserRefs);
 }
 
-void TwitchAPI::makeRequest(const QString &method, const QString &endpoint,
-                           const QJsonObject &body)
+QFuture<ApiResult<QList<UserRef>>> TwitchAPI::getVips(const QString &broadcasterId, const QStringList &userIds,
+                                                       ApiRequest::Priority priority)
 {
-    QUrl url(API_BASE_URL + endpoint);
-    QNetworkRequest request(url);
-
-    // Set headers
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", ("Bearer " + m_accessToken).toUtf8());
-    request.setRawHeader("Client-Id", m_clientId.toUtf8());
+    QUrlQuery query;
+    query.addQueryItem("broadcaster_id", broadcasterId);
+    for (const QString &userId : userIds) {
+        query.addQueryItem("user_id", userId);
+    }
+    QString endpoint = "/channels/vips?" + query.toString(QUrl::FullyEncoded);
+    return call<QList<UserRef>>("GET", endpoint, QJsonObject(), priority, &Helix::parseUserRefs);
+}
 
-    QNetworkReply *reply = nullptr;
+QFuture<ApiResult<ChannelFollower>> TwitchAPI::getChannelFollower(const QString &broadcasterId,
+                                                                  const QString &userId,
+                                                                  ApiRequest::Priority priority)
+{
+    QUrlQuery query;
+    query.addQueryItem("broadcaster_id", broadcasterId);
+    query.addQueryItem("user_id", userId);
+    QString endpoint = "/channels/followers?" + query.toString(QUrl::FullyEncoded);
+    return call<ChannelFollower>("GET", endpoint, QJsonObject(), priority,
+                                 &Helix::parseFirst<ChannelFollower>);
+}
 
-    if (method == "GET") {
-        reply = m_networkManager->get(request);
-    }
-    else if (method == "POST") {
-        QByteArray data = QJsonDocument(body).toJson();
-        reply = m_networkManager->post(request, data);
-    }
-    else if (method == "PATCH") {
-        QByteArray data = QJsonDocument(body).toJson();
-        reply = m_networkManager->sendCustomRequest(request, "PATCH", data);
+QFuture<ApiResult<ChatterPage>> TwitchAPI::getChatters(const QString &broadcasterId, const QString &moderatorId,
+                                                       const QString &after, int first)
+{
+    QUrlQuery query;
+    query.addQueryItem("broadcaster_id", broadcasterId);
+    query.addQueryItem("moderator_id", moderatorId);
+    query.addQueryItem("first", QString::number(qBound(1, first, 1000)));
+    if (!after.isEmpty()) {
+        query.addQueryItem("after", after);
     }
-    else if (method == "DELETE") {
-        reply = m_networkManager->deleteResource(request);
+    QString endpoint = "/chat/chatters?" + query.toString(QUrl::FullyEncoded);
+    return call<ChatterPage>("GET", endpoint, QJsonObject(), ApiRequest::Background,
+                             &Helix::parseChatterPage);
+}
+
+QFuture<ApiResult<BannedUserPage>> TwitchAPI::getBannedUsers(const QString &broadcasterId,
+                                                             const QString &after, int first)
+{
+    QUrlQuery query;
+    query.addQueryItem("broadcaster_id", broadcasterId);
+    query.addQueryItem("first", QString::number(qBound(1, first, 100)));
+    if (!after.isEmpty()) {
+        query.addQueryItem("after", after);
     }
+    QString endpoint = "/moderation/banned?" + query.toString(QUrl::FullyEncoded);
+    return call<BannedUserPage>("GET", endpoint, QJsonObject(), ApiRequest::Background,
+                                &Helix::parseBannedUserPage);
+}
 
-    if (reply) {
-        reply->setProperty("endpoint", endpoint);
-        connect(reply, &QNetworkReply::finished, this, &TwitchAPI::onReplyFinished);
+QFuture<ApiResult<BannedUserPage>> TwitchAPI::getBannedUser(const QString &broadcasterId, const QString &userId,
+                                                            ApiRequest::Priority priority)
+{
+    QUrlQuery query;
+    query.addQueryItem("broadcaster_id", broadcasterId);
+    query.addQueryItem("user_id", userId);
+    QString endpoint = "/moderation/banned?" + query.toString(QUrl::FullyEncoded);
+    return call<BannedUserPage>("GET", endpoint, QJsonObject(), priority, &Helix::parseBannedUserPage);
+}
+
+QFuture<ApiResult<EventSubSubscription>> TwitchAPI::createEventSubSubscription(const QString &type,
+                                                                               const QString &version,
+                                                                               const QJsonObject &condition,
+                                                                               const QString &sessionId)
+{
+    QJsonObject body;
+    body["type"] = type;
+    body["version"] = version;
+    body["condition"] = condition;
+    body["transport"] = QJsonObject{
+        {"method", "websocket"},
+        {"session_id", sessionId}
+    };
+
+    // A new session is closed if it has no subscription within 10 seconds
+    return call<EventSubSubscription>("POST", "/eventsub/subscriptions", body, ApiRequest::Interactive,
+                                      &Helix::parseFirst<EventSubSubscription>);
+}
+
+QFuture<ApiReply> TwitchAPI::deleteEventSubSubscription(const QString &subscriptionId)
+{
+    QString endpoint = QString("/eventsub/subscriptions?id=%1").arg(subscriptionId);
+    return callWithoutResult("DELETE", endpoint, ApiRequest::Background);
+}
+
+quint64 TwitchAPI::makeRequest(const QString &method, const QString &endpoint,
+                              const QJsonObject &body, ApiRequest::Priority priority)
+{
+    QByteArray data;
+    if (method == "POST" || method == "PATCH") {
+        data = QJsonDocument(body).toJson();
     }
+    return m_responseCache->enqueue(method, endpoint, data, priority);
 }
 
-void TwitchAPI::onReplyFinished()
+QFuture<ApiReply> TwitchAPI::callWithoutResult(const QString &method, const QString &endpoint,
+                                              ApiRequest::Priority priority, const QJsonObject &body)
 {
-    QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
-    if (!reply) {
-        return;
+    auto promise = std::make_shared<QPromise<ApiReply>>();
+    promise->start();
+    const quint64 requestId = makeRequest(method, endpoint, body, priority);
+    m_handlers.insert(requestId, [promise](int statusCode, const QByteArray &data, const QString &error) {
+        Q_UNUSED(data)
+        ApiReply reply;
+        reply.statusCode = statusCode;
+        reply.error = error;
+        promise->addResult(reply);
+        promise->finish();
+    });
+    return promise->future();
+}
+
+void TwitchAPI::finish(quint64 requestId, int statusCode, const QByteArray &data, const QString &error)
+{
+    const Handler handler = m_handlers.take(requestId);
+    if (handler) {
+        handler(statusCode, data, error);
     }
+}
 
-    QString endpoint = reply->property("endpoint").toString();
-    QByteArray responseData = reply->readAll();
+RequestSchedulerStats TwitchAPI::schedulerStats() const
+{
+    return m_scheduler->stats();
+}
 
-    if (reply->error() == QNetworkReply::NoError) {
-        QJsonDocument doc = QJsonDocument::fromJson(responseData);
-        emit requestCompleted(endpoint, doc.object());
-    } else {
-        emit requestFailed(endpoint, reply->errorString());
+int TwitchAPI::concurrencyWindow(int maxWindow) const
+{
+    const RequestSchedulerStats stats = m_scheduler->stats();
+    if (stats.pausedForMs > 0) {
+        return 1;
     }
+    return qBound(1, stats.bucketRemaining / 20, maxWindow);
+}
 
-    reply->deleteLater();
+QHash<QString, ResponseCacheStats> TwitchAPI::cacheStats() const
+{
+    return m_responseCache->stats();
+}
+
+QHash<QString, DecodeStats> TwitchAPI::decodeStats() const
+{
+    return m_decoder.stats();
 }
@@ -2,67 +2,172 @@
 #define TWITCHAPI_H
 
 #include <QObject>
-#include <QNetworkAccessManager>
-#include <QNetworkReply>
 #include <QString>
 #include <QJsonObject>
+#include <QFuture>
+#include <QPromise>
+#include <QHash>
+#include <functional>
+#include <memory>
+#include "requestscheduler.h"
+#include "responsecache.h"
+#include "helixtypes.h"
+#include "responsedecoder.h"
+
+class NetworkStack;
 
 class TwitchAPI : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit TwitchAPI(QObject *parent = nullptr);
+    explicit TwitchAPI(NetworkStack *network, QObject *parent = nullptr);
 
     void setAccessToken(const QString &token);
     void setClientId(const QString &clientId);
 
+    // Every call returns a future that finishes once the request has its
+    // final outcome (after the scheduler's retries). The payload is parsed
+    // for that caller only; on failure it is default-constructed and
+    // ApiReply::error says why. Large bodies are decoded on a worker
+    // thread and the future finishes there, so attach continuations with
+    // then(context, ...).
+
     // Moderation API calls
-    void banUser(const QString &broadcasterId, const QString &moderatorId,
-                const QString &userId, const QString &reason = "");
-    void unbanUser(const QString &broadcasterId, const QString &moderatorId,
-                  const QString &userId);
-    void timeoutUser(const QString &broadcasterId, const QString &moderatorId,
-                    const QString &userId, int durationSeconds, const QString &reason = "");
-    void deleteMessage(const QString &broadcasterId, const QString &moderatorId,
-                      const QString &messageId);
+    QFuture<ApiResult<BanResult>> banUser(const QString &broadcasterId, const QString &moderatorId,
+                                          const QString &userId, const QString &reason = "");
+    QFuture<ApiReply> unbanUser(const QString &broadcasterId, const QString &moderatorId,
+                                const QString &userId);
+    QFuture<ApiResult<BanResult>> timeoutUser(const QString &broadcasterId, const QString &moderatorId,
+                                              const QString &userId, int durationSeconds,
+                                              const QString &reason = "");
+    QFuture<ApiReply> deleteMessage(const QString &broadcasterId, const QString &moderatorId,
+                                    const QString &messageId);
+    // One page of up to `first` (max 100) bans and timeouts; pass the
+    // previous page's cursor as `after` to continue
+    QFuture<ApiResult<BannedUserPage>> getBannedUsers(const QString &broadcasterId,
+                                                      const QString &after = QString(), int first = 100);
+    // The user's current ban or timeout, an empty page if there is none
+    QFuture<ApiResult<BannedUserPage>> getBannedUser(const QString &broadcasterId, const QString &userId,
+                                                     ApiRequest::Priority priority = ApiRequest::Interactive);
+    // Releases (allow) or drops a message held by AutoMod
+    QFuture<ApiReply> manageHeldAutoModMessage(const QString &moderatorId, const QString &messageId,
+                                               bool allow);
 
     // Chat settings
-    void getChatSettings(const QString &broadcasterId);
-    void updateChatSettings(const QString &broadcasterId, const QString &moderatorId,
-                           const QJsonObject &settings);
+    QFuture<ApiResult<ChatSettings>> getChatSettings(const QString &broadcasterId);
+    QFuture<ApiResult<ChatSettings>> updateChatSettings(const QString &broadcasterId,
+                                                        const QString &moderatorId,
+                                                        const QJsonObject &settings);
 
     // Predictions
-    void createPrediction(const QString &broadcasterId, const QString &title,
-                         const QStringList &outcomes, int durationSeconds);
-    void endPrediction(const QString &broadcasterId, const QString &predictionId,
-                      const QString &status, const QString &winningOutcomeId = "");
-    void getPredictions(const QString &broadcasterId);
+    QFuture<ApiResult<Prediction>> createPrediction(const QString &broadcasterId, const QString &title,
+                                                    const QStringList &outcomes, int durationSeconds);
+    QFuture<ApiResult<Prediction>> endPrediction(const QString &broadcasterId, const QString &predictionId,
+                                                 const QString &status,
+                                                 const QString &winningOutcomeId = "");
+    QFuture<ApiResult<QList<Prediction>>> getPredictions(const QString &broadcasterId);
 
     // Polls
-    void createPoll(const QString &broadcasterId, const QString &title,
-                   const QStringList &choices, int durationSeconds);
-    void endPoll(const QString &broadcasterId, const QString &pollId,
-                const QString &status);
-    void getPolls(const QString &broadcasterId);
+    QFuture<ApiResult<Poll>> createPoll(const QString &broadcasterId, const QString &title,
+                                        const QStringList &choices, int durationSeconds);
+    QFuture<ApiResult<Poll>> endPoll(const QString &broadcasterId, const QString &pollId,
+                                     const QString &status);
+    QFuture<ApiResult<QList<Poll>>> getPolls(const QString &broadcasterId);
 
     // User info
-    void getUsers(const QStringList &userIds);
-    void getModerators(const QString &broadcasterId);
-    void getChatters(const QString &broadcasterId, const QString &moderatorId);
+    // Up to 100 ids and logins combined; prefer UserLookupService for
+    // single accounts, it batches and de-duplicates
+    QFuture<ApiResult<QList<TwitchUser>>> getUsers(const QStringList &userIds,
+                                                   const QStringList &logins = QStringList(),
+                                                   ApiRequest::Priority priority = ApiRequest::Background);
+    QFuture<ApiResult<QList<TwitchUser>>> getUsersByLogin(const QStringList &logins,
+                                                          ApiRequest::Priority priority = ApiRequest::Background);
+    // Listings of the broadcaster's own channel only; userIds (max 100)
+    // limits them to those accounts
+    QFuture<ApiResult<QList<UserRef>>> getModerators(const QString &broadcasterId,
+                                                     const QStringList &userIds = QStringList(),
+                                                     ApiRequest::Priority priority = ApiRequest::Background);
+    QFuture<ApiResult<QList<UserRef>>> getVips(const QString &broadcasterId,
+                                               const QStringList &userIds = QStringList(),
+                                               ApiRequest::Priority priority = ApiRequest::Background);
+    // Needs moderator access to the channel
+    QFuture<ApiResult<ChannelFollower>> getChannelFollower(const QString &broadcasterId, const QString &userId,
+                                                           ApiRequest::Priority priority = ApiRequest::Interactive);
+    // One page of up to `first` (max 1000) chatters; pass the previous
+    // page's cursor as `after` to continue
+    QFuture<ApiResult<ChatterPage>> getChatters(const QString &broadcasterId, const QString &moderatorId,
+                                                const QString &after = QString(), int first = 1000);
 
-signals:
-    void requestCompleted(const QString &endpoint, const QJsonObject &response);
-    void requestFailed(const QString &endpoint, const QString &error);
+    // EventSub over WebSocket: the subscription is bound to the session
+    QFuture<ApiResult<EventSubSubscription>> createEventSubSubscription(const QString &type,
+                                                                        const QString &version,
+                                                                        const QJsonObject &condition,
+                                                                        const QString &sessionId);
+    QFuture<ApiReply> deleteEventSubSubscription(const QString &subscriptionId);
 
-private slots:
-    void onReplyFinished();
+    // Queue, bucket and retry figures of the request scheduler
+    RequestSchedulerStats schedulerStats() const;
+    // How many calls a batch job should keep in flight: one per 20 tokens
+    // left in the bucket, capped at maxWindow; single file when it runs
+    // low or Twitch has asked us to wait
+    int concurrencyWindow(int maxWindow) const;
+    // Response cache counters by endpoint path
+    QHash<QString, ResponseCacheStats> cacheStats() const;
+    // Body decode timings by endpoint path
+    QHash<QString, DecodeStats> decodeStats() const;
+
+signals:
+    // Final failure of any call, for global error reporting; statusCode is
+    // 0 for transport errors, error is Twitch's message when it sent one
+    void requestFailed(const QString &endpoint, int statusCode, const QString &error);
 
 private:
-    void makeRequest(const QString &method, const QString &endpoint,
-                    const QJsonObject &body = QJsonObject());
+    using Handler = std::function<void(int statusCode, const QByteArray &data, const QString &error)>;
+
+    quint64 makeRequest(const QString &method, const QString &endpoint,
+                        const QJsonObject &body = QJsonObject(),
+                        ApiRequest::Priority priority = ApiRequest::Background);
+
+    // Queues a request whose 2xx body is turned into a T by parse
+    template <typename T, typename Parser>
+    QFuture<ApiResult<T>> call(const QString &method, const QString &endpoint, const QJsonObject &body,
+                               ApiRequest::Priority priority, Parser parse)
+    {
+        auto promise = std::make_shared<QPromise<ApiResult<T>>>();
+        promise->start();
+        const quint64 requestId = makeRequest(method, endpoint, body, priority);
+        const QString path = ResponseCache::pathOf(endpoint);
+        m_handlers.insert(requestId, [this, promise, parse, path](int statusCode, const QByteArray &data,
+                                                                  const QString &error) {
+            ApiResult<T> result;
+            result.statusCode = statusCode;
+            result.error = error;
+            if (!error.isEmpty()) {
+                promise->addResult(result);
+                promise->finish();
+                return;
+            }
+            m_decoder.run(path, data.size(), [promise, parse, data, result]() mutable {
+                result.value = parse(data);
+                promise->addResult(result);
+                promise->finish();
+            });
+        });
+        return promise->future();
+    }
+
+    // Queues a request whose body is not read (204 No Content and the like)
+    QFuture<ApiReply> callWithoutResult(const QString &method, const QString &endpoint,
+                                        ApiRequest::Priority priority,
+                                        const QJsonObject &body = QJsonObject());
+
+    void finish(quint64 requestId, int statusCode, const QByteArray &data, const QString &error);
 
-    QNetworkAccessManager *m_networkManager;
+    RequestScheduler *m_scheduler;
+    ResponseCache *m_responseCache;
+    QHash<quint64, Handler> m_handlers; // request id -> completes its future
+    ResponseDecoder m_decoder;
     QString m_accessToken;
     QString m_clientId;
 
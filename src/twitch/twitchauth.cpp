@@ -1,5 +1,6 @@
 #include "twitchauth.h"
 #include "oauthserver.h"
+#include "networkstack.h"
 #include <QDesktopServices>
 #include <QUrl>
 #include <QUrlQuery>
@@ -10,9 +11,9 @@
 #include <QProcessEnvironment>
 #include <QTimer>
 
-TwitchAuth::TwitchAuth(QObject *parent)
+TwitchAuth::TwitchAuth(NetworkStack *network, QObject *parent)
     : QObject(parent)
-    , m_networkManager(new QNetworkAccessManager(this))
+    , m_network(network)
     , m_oauthServer(new OAuthServer(this))
     , m_authenticated(false)
     , m_pollingInterval(5000)  // Default 5 seconds
@@ -92,6 +93,10 @@ QStringList TwitchAuth::getRequiredScopes()
         // Shoutouts
         "moderator:read:shoutouts",
         "moderator:manage:shoutouts",
+
+        // EventSub ban/unban and chat settings notifications
+        "channel:moderate",
+        "user:read:chat",
     };
 }
 
@@ -107,14 +112,15 @@ void TwitchAuth::startAuthentication()
     }
 
     QUrl url("https://id.twitch.tv/oauth2/device");
-    QNetworkRequest request(url);
+    QNetworkRequest request = m_network->request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     QUrlQuery params;
     params.addQueryItem("client_id", clientId);
     params.addQueryItem("scopes", getRequiredScopes().join(" "));
 
-    QNetworkReply *reply = m_networkManager->post(request, params.toString(QUrl::FullyEncoded).toUtf8());
+    QNetworkReply *reply = m_network->manager()->post(request, params.toString(QUrl::FullyEncoded).toUtf8());
+    m_network->track(reply);
     connect(reply, &QNetworkReply::finished, this, &TwitchAuth::onDeviceCodeReceived);
 }
 
@@ -171,7 +177,7 @@ void TwitchAuth::pollForToken()
     }
 
     QUrl url("https://id.twitch.tv/oauth2/token");
-    QNetworkRequest request(url);
+    QNetworkRequest request = m_network->request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
     QUrlQuery params;
@@ -179,7 +185,8 @@ void TwitchAuth::pollForToken()
     params.addQueryItem("device_code", m_deviceCode);
     params.addQueryItem("grant_type", "urn:ietf:params:oauth:grant-type:device_code");
 
-    QNetworkReply *reply = m_networkManager->post(request, params.toString(QUrl::FullyEncoded).toUtf8());
+    QNetworkReply *reply = m_network->manager()->post(request, params.toString(QUrl::FullyEncoded).toUtf8());
+    m_network->track(reply);
     connect(reply, &QNetworkReply::finished, this, &TwitchAuth::onTokenPollResponse);
 }
 
@@ -248,10 +255,11 @@ void TwitchAuth::onTokenPollResponse()
 void TwitchAuth::validateToken()
 {
     QUrl url("https://id.twitch.tv/oauth2/validate");
-    QNetworkRequest request(url);
+    QNetworkRequest request = m_network->request(url);
     request.setRawHeader("Authorization", ("OAuth " + m_accessToken).toUtf8());
 
-    QNetworkReply *reply = m_networkManager->get(request);
+    QNetworkReply *reply = m_network->manager()->get(request);
+    m_network->track(reply);
     connect(reply, &QNetworkReply::finished, this, &TwitchAuth::onValidateReplyFinished);
 }
 
@@ -4,17 +4,17 @@
 #include <QObject>
 #include <QString>
 #include <QStringList>
-#include <QNetworkAccessManager>
 #include <QSettings>
 
 class OAuthServer;
+class NetworkStack;
 
 class TwitchAuth : public QObject
 {
     Q_OBJECT
 
 public:
-    explicit TwitchAuth(QObject *parent = nullptr);
+    explicit TwitchAuth(NetworkStack *network, QObject *parent = nullptr);
 
     // OAuth flow
     void startAuthentication();
@@ -54,7 +54,7 @@ private:
     void startTokenPolling();
     void pollForToken();
 
-    QNetworkAccessManager *m_networkManager;
+    NetworkStack *m_network;
     OAuthServer *m_oauthServer;  // Not used anymore but keeping for compatibility
 
     QString m_accessToken;
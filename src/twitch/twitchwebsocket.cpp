@@ -2,6 +2,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QDateTime>
 
 TwitchWebSocket::TwitchWebSocket(QObject *parent)
     : QObject(parent)
@@ -133,8 +134,19 @@ void TwitchWebSocket::onDisconnected()
 
 void TwitchWebSocket::onTextMessageReceived(const QString &message)
 {
-    qDebug() << "IRC <<" << message;
-    parseIrcMessage(message);
+    // A single frame can carry several CRLF-terminated IRC lines
+    const QStringList lines = message.split("\r\n", Qt::SkipEmptyParts);
+    for (const QString &line : lines) {
+        // Chat lines skip the full parse here, the pipeline does it off-thread
+        const QString channel = privmsgChannel(line);
+        if (!channel.isEmpty()) {
+            emit chatLineReceived(channel, line);
+            continue;
+        }
+
+        qDebug() << "IRC <<" << line;
+        parseIrcMessage(line);
+    }
 }
 
 void TwitchWebSocket::onError(QAbstractSocket::SocketError error)
@@ -144,33 +156,57 @@ void TwitchWebSocket::onError(QAbstractSocket::SocketError error)
     emit this->error(errorString);
 }
 
-void TwitchWebSocket::parseIrcMessage(const QString &message)
+QHash<QString, QString> TwitchWebSocket::parseTags(const QString &tags)
 {
-    // Handle PING - must respond with PONG to stay connected
-    if (message.startsWith("PING")) {
-        QString pongResponse = message;
-        pongResponse.replace("PING", "PONG");
-        m_webSocket->sendTextMessage(pongResponse);
-        qDebug() << "IRC >>" << pongResponse;
-        return;
-    }
-
-    // Parse IRC message format:
-    // @tags :prefix COMMAND params :trailing
+    // IRCv3 tags: key=value;key2=value2 with \s, \:, \\, \r, \n escapes
+    QHash<QString, QString> result;
+    const QStringList pairs = tags.split(";", Qt::SkipEmptyParts);
+    for (const QString &pair : pairs) {
+        int eq = pair.indexOf("=");
+        QString key = eq == -1 ? pair : pair.left(eq);
+        QString rawValue = eq == -1 ? QString() : pair.mid(eq + 1);
+
+        if (!rawValue.contains('\\')) {
+            result.insert(key, rawValue);
+            continue;
+        }
 
-    QString tags;
-    QString prefix;
-    QString command;
-    QString params;
-    QString trailing;
+        QString value;
+        value.reserve(rawValue.size());
+        for (int i = 0; i < rawValue.size(); ++i) {
+            QChar c = rawValue.at(i);
+            if (c != '\\' || i + 1 >= rawValue.size()) {
+                value.append(c);
+                continue;
+            }
+            QChar next = rawValue.at(++i);
+            if (next == 's') {
+                value.append(' ');
+            } else if (next == ':') {
+                value.append(';');
+            } else if (next == 'r') {
+                value.append('\r');
+            } else if (next == 'n') {
+                value.append('\n');
+            } else {
+                value.append(next);
+            }
+        }
+        result.insert(key, value);
+    }
+    return result;
+}
 
+TwitchWebSocket::IrcLine TwitchWebSocket::splitIrcLine(const QString &message)
+{
+    IrcLine line;
     QString remaining = message;
 
     // Extract tags (optional)
     if (remaining.startsWith("@")) {
         int tagEnd = remaining.indexOf(" ");
         if (tagEnd != -1) {
-            tags = remaining.mid(1, tagEnd - 1);
+            line.tags = remaining.mid(1, tagEnd - 1);
             remaining = remaining.mid(tagEnd + 1);
         }
     }
@@ -179,7 +215,7 @@ void TwitchWebSocket::parseIrcMessage(const QString &message)
     if (remaining.startsWith(":")) {
         int prefixEnd = remaining.indexOf(" ");
         if (prefixEnd != -1) {
-            prefix = remaining.mid(1, prefixEnd - 1);
+            line.prefix = remaining.mid(1, prefixEnd - 1);
             remaining = remaining.mid(prefixEnd + 1).trimmed();
         }
     }
@@ -187,32 +223,112 @@ void TwitchWebSocket::parseIrcMessage(const QString &message)
     // Extract trailing message (after :)
     int trailingStart = remaining.indexOf(" :");
     if (trailingStart != -1) {
-        trailing = remaining.mid(trailingStart + 2);
+        line.trailing = remaining.mid(trailingStart + 2);
         remaining = remaining.left(trailingStart);
     }
 
     // Extract command and params
     QStringList parts = remaining.split(" ", Qt::SkipEmptyParts);
     if (!parts.isEmpty()) {
-        command = parts.first();
+        line.command = parts.first();
         if (parts.size() > 1) {
-            params = parts.mid(1).join(" ");
+            line.params = parts.mid(1).join(" ");
+        }
+    }
+
+    return line;
+}
+
+QString TwitchWebSocket::privmsgChannel(const QString &line)
+{
+    // Cheap routing check on the GUI thread: skip tags and prefix (neither
+    // contains spaces), then expect "PRIVMSG #channel"
+    QStringView view(line);
+    if (view.startsWith(u'@')) {
+        qsizetype space = view.indexOf(u' ');
+        if (space == -1) {
+            return QString();
         }
+        view = view.mid(space + 1);
+    }
+    if (view.startsWith(u':')) {
+        qsizetype space = view.indexOf(u' ');
+        if (space == -1) {
+            return QString();
+        }
+        view = view.mid(space + 1);
+    }
+    if (!view.startsWith(u"PRIVMSG #")) {
+        return QString();
     }
 
+    view = view.mid(9);
+    qsizetype end = view.indexOf(u' ');
+    return (end == -1 ? view : view.left(end)).toString();
+}
+
+ChatMessage TwitchWebSocket::parseChatMessage(const QString &line)
+{
+    const IrcLine ircLine = splitIrcLine(line);
+
+    // Extract username from prefix (user!user@user.tmi.twitch.tv)
+    QString username = ircLine.prefix.split("!").first();
+
+    // Extract channel from params
+    QString channel = ircLine.params.trimmed();
+    if (channel.startsWith("#")) {
+        channel = channel.mid(1);
+    }
+
+    ChatMessage chatMessage;
+    chatMessage.channel = channel;
+    chatMessage.username = username;
+    chatMessage.text = ircLine.trailing;
+    chatMessage.tags = parseTags(ircLine.tags);
+    chatMessage.displayName = chatMessage.tags.value("display-name", username);
+    chatMessage.userId = chatMessage.tags.value("user-id");
+    chatMessage.messageId = chatMessage.tags.value("id");
+    chatMessage.roomId = chatMessage.tags.value("room-id");
+    chatMessage.isFirstMessage = chatMessage.tags.value("first-msg") == "1";
+
+    chatMessage.receivedMs = QDateTime::currentMSecsSinceEpoch();
+    bool hasTimestamp = false;
+    chatMessage.timestamp = chatMessage.tags.value("tmi-sent-ts").toLongLong(&hasTimestamp);
+    if (!hasTimestamp) {
+        chatMessage.timestamp = chatMessage.receivedMs;
+    }
+
+    // Text features for the spam heuristics (SIMD kernels, one pass)
+    chatMessage.features = TextFeatureKernels::compute(chatMessage.text);
+
+    return chatMessage;
+}
+
+void TwitchWebSocket::parseIrcMessage(const QString &message)
+{
+    // Handle PING - must respond with PONG to stay connected
+    if (message.startsWith("PING")) {
+        QString pongResponse = message;
+        pongResponse.replace("PING", "PONG");
+        m_webSocket->sendTextMessage(pongResponse);
+        qDebug() << "IRC >>" << pongResponse;
+        return;
+    }
+
+    const IrcLine ircLine = splitIrcLine(message);
+    const QString &prefix = ircLine.prefix;
+    const QString &command = ircLine.command;
+    const QString &params = ircLine.params;
+    const QString &trailing = ircLine.trailing;
+
     // Handle IRC commands
     if (command == "PRIVMSG") {
-        // Extract username from prefix (user!user@user.tmi.twitch.tv)
-        QString username = prefix.split("!").first();
-
-        // Extract channel from params
+        // Only reached for lines privmsgChannel() did not recognize
         QString channel = params.trimmed();
         if (channel.startsWith("#")) {
             channel = channel.mid(1);
         }
-
-        qDebug() << "Chat message in" << channel << "from" << username << ":" << trailing;
-        emit chatMessageReceived(channel, username, trailing, "");
+        emit chatLineReceived(channel, message);
 
     } else if (command == "JOIN") {
         // User joined channel
@@ -242,12 +358,20 @@ void TwitchWebSocket::parseIrcMessage(const QString &message)
         }
 
         if (!trailing.isEmpty()) {
-            // User banned/timed out
+            // User banned/timed out - timeouts carry a ban-duration tag
+            const QHash<QString, QString> tags = parseTags(ircLine.tags);
+            bool isTimeout = false;
+            int seconds = tags.value("ban-duration").toInt(&isTimeout);
             qDebug() << "User" << trailing << "cleared from" << channel;
-            emit userBanned(channel, trailing);
+            if (isTimeout) {
+                emit userTimedOut(channel, trailing, seconds, tags.value("target-user-id"));
+            } else {
+                emit userBanned(channel, trailing, tags.value("target-user-id"));
+            }
         } else {
             // Entire chat cleared
             qDebug() << "Chat cleared in" << channel;
+            emit chatCleared(channel);
         }
 
     } else if (command == "CLEARMSG") {
@@ -256,8 +380,9 @@ void TwitchWebSocket::parseIrcMessage(const QString &message)
         if (channel.startsWith("#")) {
             channel = channel.mid(1);
         }
+        const QHash<QString, QString> tags = parseTags(ircLine.tags);
         qDebug() << "Message deleted in" << channel;
-        emit messageDeleted(channel, "");
+        emit messageDeleted(channel, tags.value("target-msg-id"), tags.value("login"), trailing);
 
     } else if (command == "001") {
         // Welcome message - successfully authenticated
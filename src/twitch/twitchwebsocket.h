@@ -4,6 +4,8 @@
 #include <QObject>
 #include <QWebSocket>
 #include <QString>
+#include <QHash>
+#include "chatmessage.h"
 
 class TwitchWebSocket : public QObject
 {
@@ -22,25 +24,26 @@ public:
     void partChannel(const QString &channelName);
     void sendMessage(const QString &channelName, const QString &message);
 
+    // Parses a raw PRIVMSG line. Touches no members, safe on any thread.
+    static ChatMessage parseChatMessage(const QString &line);
+
 signals:
     void connected();
     void disconnected();
     void error(const QString &error);
 
-    // Chat events
-    void chatMessageReceived(const QString &channelName, const QString &username,
-                            const QString &message, const QString &userId);
+    // Chat events. PRIVMSG lines are handed out unparsed so parsing can run
+    // on the message pipeline's workers (see parseChatMessage).
+    void chatLineReceived(const QString &channelName, const QString &line);
     void userJoined(const QString &channelName, const QString &username);
     void userParted(const QString &channelName, const QString &username);
-    void userBanned(const QString &channelName, const QString &username);
-    void userTimedOut(const QString &channelName, const QString &username, int seconds);
-    void messageDeleted(const QString &channelName, const QString &messageId);
-
-    // Prediction/Poll events
-    void predictionStarted(const QString &channelName, const QString &title);
-    void predictionEnded(const QString &channelName, const QString &winningOutcome);
-    void pollStarted(const QString &channelName, const QString &title);
-    void pollEnded(const QString &channelName);
+    // userId from the target-user-id tag, empty if Twitch left it out
+    void userBanned(const QString &channelName, const QString &username, const QString &userId);
+    void userTimedOut(const QString &channelName, const QString &username, int seconds,
+                      const QString &userId);
+    void messageDeleted(const QString &channelName, const QString &messageId,
+                        const QString &username, const QString &text);
+    void chatCleared(const QString &channelName);
 
 private slots:
     void onConnected();
@@ -49,7 +52,19 @@ private slots:
     void onError(QAbstractSocket::SocketError error);
 
 private:
+    // @tags :prefix COMMAND params :trailing
+    struct IrcLine {
+        QString tags;
+        QString prefix;
+        QString command;
+        QString params;
+        QString trailing;
+    };
+
     void parseIrcMessage(const QString &message);
+    static IrcLine splitIrcLine(const QString &message);
+    static QString privmsgChannel(const QString &line);
+    static QHash<QString, QString> parseTags(const QString &tags);
 
     QWebSocket *m_webSocket;
     QString m_accessToken;
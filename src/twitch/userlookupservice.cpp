@@ -0,0 +1,168 @@
+#include "userlookupservice.h"
+#include "twitchapi.h"
+#include "profilecache.h"
+
+UserLookupService::UserLookupService(TwitchAPI *api, ProfileCache *cache, QObject *parent)
+    : QObject(parent)
+    , m_api(api)
+    , m_cache(cache)
+    , m_flushTimer(new QTimer(this))
+    , m_queuedPriority(ApiRequest::Background)
+{
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(COLLECT_WINDOW_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &UserLookupService::flush);
+}
+
+ProfileCache *UserLookupService::profileCache() const
+{
+    return m_cache;
+}
+
+QFuture<TwitchUser> UserLookupService::lookupById(const QString &userId, ApiRequest::Priority priority)
+{
+    ++m_stats.lookups;
+    if (m_cache && !userId.isEmpty()) {
+        const UserProfile cached = m_cache->findById(userId);
+        if (cached.isValid()) {
+            ++m_stats.cached;
+            return completed(cached.user);
+        }
+    }
+    return lookup(m_byId, m_queuedIds, userId, priority);
+}
+
+QFuture<TwitchUser> UserLookupService::lookupByLogin(const QString &login, ApiRequest::Priority priority)
+{
+    ++m_stats.lookups;
+    if (m_cache && !login.isEmpty()) {
+        const UserProfile cached = m_cache->findByLogin(login);
+        if (cached.isValid()) {
+            ++m_stats.cached;
+            return completed(cached.user);
+        }
+    }
+    return lookup(m_byLogin, m_queuedLogins, login.toLower(), priority);
+}
+
+QFuture<TwitchUser> UserLookupService::completed(const TwitchUser &user)
+{
+    QPromise<TwitchUser> promise;
+    promise.start();
+    promise.addResult(user);
+    promise.finish();
+    return promise.future();
+}
+
+QFuture<TwitchUser> UserLookupService::lookup(QHash<QString, Pending> &pending, QStringList &queue,
+                                              const QString &key, ApiRequest::Priority priority)
+{
+    auto it = pending.constFind(key);
+    if (it != pending.constEnd()) {
+        ++m_stats.shared;
+        // Already in flight at a lower priority: nothing to do, it will
+        // arrive. Still queued: the new priority applies to the batch.
+        if (!it->sent) {
+            m_queuedPriority = qMin(m_queuedPriority, priority);
+        }
+        if (priority == ApiRequest::Moderation && !it->sent) {
+            flush();
+        }
+        return it->future;
+    }
+
+    if (key.isEmpty()) {
+        return completed(TwitchUser());
+    }
+
+    Pending entry;
+    entry.promise = std::make_shared<QPromise<TwitchUser>>();
+    entry.promise->start();
+    entry.future = entry.promise->future();
+    pending.insert(key, entry);
+
+    queue.append(key);
+    m_queuedPriority = qMin(m_queuedPriority, priority);
+
+    if (priority == ApiRequest::Moderation
+            || m_queuedIds.size() + m_queuedLogins.size() >= BATCH_SIZE) {
+        flush();
+    } else if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+    return entry.future;
+}
+
+void UserLookupService::flush()
+{
+    m_flushTimer->stop();
+
+    // Drop keys answered meanwhile by a request for the same account
+    m_queuedIds.removeIf([this](const QString &id) { return !m_byId.contains(id); });
+    m_queuedLogins.removeIf([this](const QString &login) { return !m_byLogin.contains(login); });
+
+    // Helix takes up to 100 ids and logins combined per call
+    while (!m_queuedIds.isEmpty() || !m_queuedLogins.isEmpty()) {
+        Request request;
+        int room = BATCH_SIZE;
+        request.ids = m_queuedIds.mid(0, room);
+        m_queuedIds.remove(0, request.ids.size());
+        room -= int(request.ids.size());
+        request.logins = m_queuedLogins.mid(0, room);
+        m_queuedLogins.remove(0, request.logins.size());
+
+        for (const QString &id : std::as_const(request.ids)) {
+            m_byId[id].sent = true;
+        }
+        for (const QString &login : std::as_const(request.logins)) {
+            m_byLogin[login].sent = true;
+        }
+
+        m_api->getUsers(request.ids, request.logins, m_queuedPriority)
+            .then(this, [this, request](const ApiResult<QList<TwitchUser>> &result) {
+                onUsersReceived(request, result);
+            });
+        ++m_stats.requests;
+    }
+    m_queuedPriority = ApiRequest::Background;
+}
+
+void UserLookupService::resolve(QHash<QString, Pending> &pending, const QString &key, const TwitchUser &user)
+{
+    auto it = pending.find(key);
+    if (it == pending.end()) {
+        return;
+    }
+    it->promise->addResult(user);
+    it->promise->finish();
+    pending.erase(it);
+}
+
+void UserLookupService::onUsersReceived(const Request &request,
+                                        const ApiResult<QList<TwitchUser>> &result)
+{
+    if (!result.ok()) {
+        qWarning() << "User lookup failed:" << result.statusCode << result.error;
+    }
+
+    for (const TwitchUser &user : result.value) {
+        if (m_cache) {
+            m_cache->storeUser(user);
+        }
+        resolve(m_byId, user.id, user);
+        resolve(m_byLogin, user.login.toLower(), user);
+    }
+
+    // Whatever is left does not exist (or the request failed)
+    for (const QString &id : request.ids) {
+        resolve(m_byId, id, TwitchUser());
+    }
+    for (const QString &login : request.logins) {
+        resolve(m_byLogin, login, TwitchUser());
+    }
+}
+
+UserLookupService::Stats UserLookupService::stats() const
+{
+    return m_stats;
+}
@@ -0,0 +1,89 @@
+#ifndef USERLOOKUPSERVICE_H
+#define USERLOOKUPSERVICE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QDateTime>
+#include <QFuture>
+#include <QPromise>
+#include <QTimer>
+#include <memory>
+#include "requestscheduler.h"
+#include "helixtypes.h"
+
+class TwitchAPI;
+class ProfileCache;
+
+// Coalescing front end for GET /users.
+//
+// Single lookups are collected for a short window and sent as one request
+// of up to 100 ids/logins (Helix's limit). Concurrent lookups of the same
+// account share one pending entry and therefore one future. A future whose
+// account does not exist (or whose request failed) yields an invalid user.
+// With a ProfileCache, accounts whose profile is still fresh are answered
+// from it and every fetched account is stored back into it.
+class UserLookupService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit UserLookupService(TwitchAPI *api, ProfileCache *cache = nullptr,
+                               QObject *parent = nullptr);
+
+    ProfileCache *profileCache() const;
+
+    // Moderation priority skips the collection window
+    QFuture<TwitchUser> lookupById(const QString &userId,
+                                   ApiRequest::Priority priority = ApiRequest::Background);
+    QFuture<TwitchUser> lookupByLogin(const QString &login,
+                                      ApiRequest::Priority priority = ApiRequest::Background);
+
+    struct Stats {
+        quint64 lookups = 0;  // calls to lookupBy*
+        quint64 cached = 0;   // answered by the profile cache
+        quint64 shared = 0;   // answered by an already pending entry
+        quint64 requests = 0; // GET /users calls made
+    };
+    Stats stats() const;
+
+    static constexpr int BATCH_SIZE = 100;
+    static constexpr int COLLECT_WINDOW_MS = 50;
+
+private slots:
+    void flush();
+
+private:
+    struct Pending {
+        std::shared_ptr<QPromise<TwitchUser>> promise;
+        QFuture<TwitchUser> future;
+        bool sent = false;
+    };
+
+    struct Request {
+        QStringList ids;
+        QStringList logins;
+    };
+
+    QFuture<TwitchUser> lookup(QHash<QString, Pending> &pending, QStringList &queue,
+                               const QString &key, ApiRequest::Priority priority);
+    void resolve(QHash<QString, Pending> &pending, const QString &key, const TwitchUser &user);
+    void onUsersReceived(const Request &request, const ApiResult<QList<TwitchUser>> &result);
+    static QFuture<TwitchUser> completed(const TwitchUser &user);
+
+    TwitchAPI *m_api;
+    ProfileCache *m_cache;
+    QTimer *m_flushTimer;
+
+    // Queued or in flight, by id and by lowercase login
+    QHash<QString, Pending> m_byId;
+    QHash<QString, Pending> m_byLogin;
+    QStringList m_queuedIds;
+    QStringList m_queuedLogins;
+    ApiRequest::Priority m_queuedPriority;
+
+    Stats m_stats;
+};
+
+#endif // USERLOOKUPSERVICE_H
@@ -0,0 +1,102 @@
+#include "usernameindex.h"
+#include <QSet>
+#include <algorithm>
+#include <iterator>
+
+std::vector<QString> UsernameIndex::normalized(const QStringList &logins)
+{
+    std::vector<QString> sorted;
+    sorted.reserve(logins.size());
+    for (const QString &login : logins) {
+        if (!login.isEmpty()) {
+            sorted.push_back(login.toLower());
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    return sorted;
+}
+
+void UsernameIndex::setMembers(const QStringList &logins)
+{
+    m_members = normalized(logins);
+}
+
+void UsernameIndex::addMembers(const QStringList &logins)
+{
+    std::vector<QString> added = normalized(logins);
+    if (added.empty()) {
+        return;
+    }
+    const auto middle = m_members.size();
+    m_members.insert(m_members.end(), std::make_move_iterator(added.begin()), std::make_move_iterator(added.end()));
+    std::inplace_merge(m_members.begin(), m_members.begin() + middle, m_members.end());
+    m_members.erase(std::unique(m_members.begin(), m_members.end()), m_members.end());
+}
+
+void UsernameIndex::removeMembers(const QStringList &logins)
+{
+    if (logins.isEmpty()) {
+        return;
+    }
+    QSet<QString> removed;
+    for (const QString &login : logins) {
+        removed.insert(login.toLower());
+    }
+    m_members.erase(std::remove_if(m_members.begin(), m_members.end(),
+                                   [&removed](const QString &login) { return removed.contains(login); }),
+                    m_members.end());
+}
+
+void UsernameIndex::addChatter(const QString &login)
+{
+    if (login.isEmpty()) {
+        return;
+    }
+    const QString lower = login.toLower();
+    if (!m_recent.empty() && m_recent.front() == lower) {
+        return;
+    }
+    auto it = std::find(m_recent.begin(), m_recent.end(), lower);
+    if (it != m_recent.end()) {
+        m_recent.erase(it);
+    }
+    m_recent.push_front(lower);
+    if (int(m_recent.size()) > MAX_RECENT) {
+        m_recent.pop_back();
+    }
+}
+
+void UsernameIndex::clear()
+{
+    m_members.clear();
+    m_recent.clear();
+}
+
+QStringList UsernameIndex::complete(const QString &prefix, int limit) const
+{
+    QString lower = prefix.toLower();
+    if (lower.startsWith('@')) {
+        lower.remove(0, 1);
+    }
+
+    QStringList matches;
+    for (const QString &login : m_recent) {
+        if (matches.size() >= limit) {
+            return matches;
+        }
+        if (login.startsWith(lower)) {
+            matches.append(login);
+        }
+    }
+
+    const qsizetype recentMatches = matches.size();
+    for (auto it = std::lower_bound(m_members.begin(), m_members.end(), lower);
+         it != m_members.end() && it->startsWith(lower) && matches.size() < limit; ++it) {
+        // Recent chatters are usually members too; they are already listed
+        if (std::find(matches.cbegin(), matches.cbegin() + recentMatches, *it) == matches.cbegin() + recentMatches) {
+            matches.append(*it);
+        }
+    }
+    return matches;
+}
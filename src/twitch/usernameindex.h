@@ -0,0 +1,44 @@
+#ifndef USERNAMEINDEX_H
+#define USERNAMEINDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <deque>
+#include <vector>
+
+// Login completion for one channel.
+//
+// Members (the chatter list, up to 100k+ in big channels) are kept in a
+// sorted array, so the accounts starting with a prefix are one binary
+// search away and form a contiguous run; a completion costs O(log n +
+// limit) whatever the channel size. Joins and parts arrive in batches
+// from the chatters sync and are merged in one pass per batch.
+//
+// People who just talked are what a moderator usually types, so recent
+// chatters are kept apart, most recent first, and are offered before
+// the alphabetical members.
+class UsernameIndex
+{
+public:
+    void setMembers(const QStringList &logins);
+    void addMembers(const QStringList &logins);
+    void removeMembers(const QStringList &logins);
+    void addChatter(const QString &login);
+    void clear();
+
+    // Lowercase logins starting with prefix (case-insensitive, '@' ignored)
+    QStringList complete(const QString &prefix, int limit = MAX_COMPLETIONS) const;
+
+    int memberCount() const { return int(m_members.size()); }
+
+    static constexpr int MAX_RECENT = 200;
+    static constexpr int MAX_COMPLETIONS = 50;
+
+private:
+    static std::vector<QString> normalized(const QStringList &logins);
+
+    std::vector<QString> m_members; // lowercase, sorted, unique
+    std::deque<QString> m_recent;   // lowercase, most recent first
+};
+
+#endif // USERNAMEINDEX_H
@@ -0,0 +1,165 @@
+#include "usercarddialog.h"
+#include "moderation/usercardloader.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QPushButton>
+
+namespace {
+QString age(const QDateTime &since)
+{
+    const qint64 days = since.daysTo(QDateTime::currentDateTimeUtc());
+    if (days >= 365) {
+        return QString("%1 years %2 days").arg(days / 365).arg(days % 365);
+    }
+    return QString("%1 days").arg(days);
+}
+
+// Text for a piece that has no answer yet
+QString placeholder(const UserCard &card, UserCard::Piece piece)
+{
+    return card.hasFailed(piece) ? "unavailable: " + card.errors[piece] : QString("loading...");
+}
+}
+
+UserCardDialog::UserCardDialog(const QString &login, const QString &channel, QWidget *parent)
+    : QDialog(parent)
+    , m_login(login)
+{
+    setWindowTitle(QString("%1 in #%2").arg(login, channel));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(480, 560);
+
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    m_titleLabel = new QLabel(login, this);
+    m_titleLabel->setStyleSheet("font-weight: bold; color: #9147ff; font-size: 15px;");
+    mainLayout->addWidget(m_titleLabel);
+
+    QFormLayout *form = new QFormLayout();
+    m_accountLabel = new QLabel("loading...", this);
+    m_followLabel = new QLabel("loading...", this);
+    m_rolesLabel = new QLabel("loading...", this);
+    m_banLabel = new QLabel("loading...", this);
+    for (QLabel *label : {m_accountLabel, m_followLabel, m_rolesLabel, m_banLabel}) {
+        label->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        label->setWordWrap(true);
+    }
+    form->addRow("Account:", m_accountLabel);
+    form->addRow("Follows:", m_followLabel);
+    form->addRow("Roles:", m_rolesLabel);
+    form->addRow("Status:", m_banLabel);
+    mainLayout->addLayout(form);
+
+    mainLayout->addWidget(new QLabel("Previous bans/timeouts (all channels):", this));
+    m_historyTree = new QTreeWidget(this);
+    m_historyTree->setRootIsDecorated(false);
+    m_historyTree->setUniformRowHeights(true);
+    m_historyTree->setHeaderLabels(QStringList() << "Time" << "Channel" << "Action" << "Moderator" << "Details");
+    m_historyTree->header()->setStretchLastSection(true);
+    mainLayout->addWidget(m_historyTree, 1);
+
+    mainLayout->addWidget(new QLabel("Recent messages:", this));
+    m_messagesList = new QListWidget(this);
+    m_messagesList->setUniformItemSizes(true);
+    mainLayout->addWidget(m_messagesList, 1);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout();
+    QPushButton *timeoutButton = new QPushButton("Timeout 10m", this);
+    QPushButton *banButton = new QPushButton("Ban", this);
+    QPushButton *closeButton = new QPushButton("Close", this);
+    buttonLayout->addWidget(timeoutButton);
+    buttonLayout->addWidget(banButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(closeButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(timeoutButton, &QPushButton::clicked, [this]() { emit timeoutRequested(m_login, 600); });
+    connect(banButton, &QPushButton::clicked, [this]() { emit banRequested(m_login); });
+    connect(closeButton, &QPushButton::clicked, this, &QDialog::close);
+}
+
+void UserCardDialog::setCard(const UserCard &card)
+{
+    if (card.has(UserCard::Account)) {
+        const TwitchUser &user = card.user;
+        m_titleLabel->setText(user.displayName.isEmpty() ? card.login : user.displayName);
+        QString text = QString("created %1 (%2 ago)").arg(user.createdAt.toLocalTime().toString("yyyy-MM-dd"),
+                                                          age(user.createdAt));
+        if (!user.broadcasterType.isEmpty()) {
+            text += ", " + user.broadcasterType;
+        }
+        if (!user.type.isEmpty()) {
+            text += ", " + user.type;
+        }
+        m_accountLabel->setText(text);
+    } else if (card.user.createdAt.isValid()) {
+        m_accountLabel->setText(QString("created %1 (%2 ago)")
+                                .arg(card.user.createdAt.toLocalTime().toString("yyyy-MM-dd"),
+                                     age(card.user.createdAt)));
+    } else {
+        m_accountLabel->setText(placeholder(card, UserCard::Account));
+    }
+
+    if (card.has(UserCard::Follow)) {
+        m_followLabel->setText(card.following ? QString("since %1 (%2)")
+                                                .arg(card.followedAt.toLocalTime().toString("yyyy-MM-dd"),
+                                                     age(card.followedAt))
+                                              : QString("not following"));
+    } else {
+        m_followLabel->setText(placeholder(card, UserCard::Follow));
+    }
+
+    if (card.has(UserCard::Roles)) {
+        QStringList roles;
+        if (card.moderator) {
+            roles.append("moderator");
+        }
+        if (card.vip) {
+            roles.append("VIP");
+        }
+        m_rolesLabel->setText(!card.rolesKnown ? QString("unknown until they chat")
+                                               : roles.isEmpty() ? QString("none") : roles.join(", "));
+    } else {
+        m_rolesLabel->setText(placeholder(card, UserCard::Roles));
+    }
+
+    if (card.has(UserCard::Bans) || card.banned) {
+        QString text = "not banned";
+        if (card.banned && card.ban.expiresAt.isValid()) {
+            text = QString("timed out until %1").arg(card.ban.expiresAt.toLocalTime().toString("HH:mm:ss"));
+        } else if (card.banned) {
+            text = "banned";
+        }
+        if (card.banned && !card.ban.moderatorLogin.isEmpty()) {
+            text += " by " + card.ban.moderatorLogin;
+        }
+        if (card.banned && !card.ban.reason.isEmpty()) {
+            text += ": " + card.ban.reason;
+        }
+        m_banLabel->setText(text);
+        m_banLabel->setStyleSheet(card.banned ? "color: #ff6b6b;" : QString());
+    } else {
+        m_banLabel->setText(placeholder(card, UserCard::Bans));
+    }
+
+    // Local pieces, complete from the first call
+    if (m_historyTree->topLevelItemCount() != card.history.size()) {
+        m_historyTree->clear();
+        for (const ModAction &action : card.history) {
+            QTreeWidgetItem *item = new QTreeWidgetItem(m_historyTree);
+            item->setText(0, QDateTime::fromMSecsSinceEpoch(action.timeMs).toString("yyyy-MM-dd HH:mm"));
+            item->setText(1, "#" + action.channel);
+            item->setText(2, action.kind == ModAction::Timeout
+                                 ? QString("Timeout %1s").arg(action.durationSeconds)
+                                 : ModAction::kindName(action.kind));
+            item->setText(3, action.moderatorLogin);
+            item->setText(4, action.reason.isEmpty() ? action.messageText : action.reason);
+        }
+    }
+    if (m_messagesList->count() != card.recentMessages.size()) {
+        m_messagesList->clear();
+        m_messagesList->addItems(card.recentMessages);
+    }
+}
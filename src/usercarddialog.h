@@ -0,0 +1,38 @@
+#ifndef USERCARDDIALOG_H
+#define USERCARDDIALOG_H
+
+#include <QDialog>
+#include <QLabel>
+#include <QTreeWidget>
+#include <QListWidget>
+
+struct UserCard;
+
+// User info card: account, follow, roles, ban state and history, recent
+// lines. Filled by UserCardLoader; pieces still on their way read
+// "loading..." and are redrawn as they arrive.
+class UserCardDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    UserCardDialog(const QString &login, const QString &channel, QWidget *parent = nullptr);
+
+    void setCard(const UserCard &card);
+
+signals:
+    void banRequested(const QString &login);
+    void timeoutRequested(const QString &login, int seconds);
+
+private:
+    QString m_login;
+    QLabel *m_titleLabel;
+    QLabel *m_accountLabel;
+    QLabel *m_followLabel;
+    QLabel *m_rolesLabel;
+    QLabel *m_banLabel;
+    QTreeWidget *m_historyTree;
+    QListWidget *m_messagesList;
+};
+
+#endif // USERCARDDIALOG_H
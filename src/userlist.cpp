@@ -1,7 +1,6 @@
 #include "userlist.h"
 #include <QApplication>
 #include <QClipboard>
-#include <QMessageBox>
 
 UserList::UserList(QWidget *parent)
     : QWidget(parent)
@@ -18,6 +17,7 @@ UserList::UserList(QWidget *parent)
     m_listWidget = new QListWidget(this);
     m_listWidget->setContextMenuPolicy(Qt::CustomContextMenu);
     m_listWidget->setSortingEnabled(true);
+    m_listWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
 
     layout->addWidget(m_headerLabel);
     layout->addWidget(m_listWidget);
@@ -29,8 +29,6 @@ UserList::UserList(QWidget *parent)
     addUser("viewer2", false, false);
     addUser("viewer3", false, false);
 
-    setUserCount(5);
-
     // Context menu connection
     connect(m_listWidget, &QListWidget::customContextMenuRequested,
             this, &UserList::onUserContextMenu);
@@ -38,6 +36,32 @@ UserList::UserList(QWidget *parent)
 
 void UserList::addUser(const QString &username, bool isModerator, bool isVip)
 {
+    insertUser(username, isModerator, isVip);
+    setUserCount(int(m_items.size()));
+}
+
+void UserList::addUsers(const QStringList &usernames)
+{
+    // Re-sorting after every insert is quadratic on a 10k-user page
+    m_listWidget->setSortingEnabled(false);
+    for (const QString &username : usernames) {
+        insertUser(username, false, false);
+    }
+    m_listWidget->setSortingEnabled(true);
+    setUserCount(int(m_items.size()));
+}
+
+bool UserList::hasUser(const QString &username) const
+{
+    return m_items.contains(username);
+}
+
+void UserList::insertUser(const QString &username, bool isModerator, bool isVip)
+{
+    if (m_items.contains(username)) {
+        return;
+    }
+
     QString displayName = username;
 
     // Add badges (mIRC-style)
@@ -58,22 +82,29 @@ void UserList::addUser(const QString &username, bool isModerator, bool isVip)
     }
 
     m_listWidget->addItem(item);
+    m_items.insert(username, item);
 }
 
 void UserList::removeUser(const QString &username)
 {
-    for (int i = 0; i < m_listWidget->count(); ++i) {
-        QListWidgetItem *item = m_listWidget->item(i);
-        if (item->data(Qt::UserRole).toString() == username) {
-            delete m_listWidget->takeItem(i);
-            break;
-        }
+    // Deleting an item removes it from its list widget
+    delete m_items.take(username);
+    setUserCount(int(m_items.size()));
+}
+
+void UserList::removeUsers(const QStringList &usernames)
+{
+    for (const QString &username : usernames) {
+        delete m_items.take(username);
     }
+    setUserCount(int(m_items.size()));
 }
 
 void UserList::clearUsers()
 {
     m_listWidget->clear();
+    m_items.clear();
+    setUserCount(0);
 }
 
 void UserList::setUserCount(int count)
@@ -81,6 +112,24 @@ void UserList::setUserCount(int count)
     m_headerLabel->setText(QString("Users (%1)").arg(count));
 }
 
+void UserList::setAccountCreated(const QString &username, const QDateTime &createdAt)
+{
+    QListWidgetItem *item = m_items.value(username);
+    if (!item) {
+        return;
+    }
+
+    qint64 days = createdAt.daysTo(QDateTime::currentDateTimeUtc());
+    item->setToolTip(QString("Account created %1 (%2 days ago)")
+                     .arg(createdAt.toLocalTime().toString("yyyy-MM-dd"))
+                     .arg(days));
+
+    // Keep mod/VIP colours, flag fresh accounts otherwise
+    if (days < 7 && item->foreground() == QBrush()) {
+        item->setForeground(QBrush(QColor(255, 165, 0))); // Orange for new accounts
+    }
+}
+
 QString UserList::getSelectedUsername() const
 {
     QListWidgetItem *item = m_listWidget->currentItem();
@@ -90,8 +139,62 @@ QString UserList::getSelectedUsername() const
     return QString();
 }
 
+QStringList UserList::getSelectedUsernames() const
+{
+    QStringList usernames;
+    const QList<QListWidgetItem*> items = m_listWidget->selectedItems();
+    for (QListWidgetItem *item : items) {
+        usernames.append(item->data(Qt::UserRole).toString());
+    }
+    return usernames;
+}
+
+void UserList::showMultiUserMenu(const QStringList &usernames, const QPoint &globalPos)
+{
+    // Only actions that make sense for a group
+    QMenu menu(this);
+
+    QAction *header = menu.addAction(QString("%1 users selected").arg(usernames.size()));
+    header->setEnabled(false);
+    menu.addSeparator();
+
+    QMenu *timeoutMenu = menu.addMenu("Timeout All");
+    QAction *timeout1m = timeoutMenu->addAction("1 minute");
+    QAction *timeout10m = timeoutMenu->addAction("10 minutes");
+    QAction *timeout1h = timeoutMenu->addAction("1 hour");
+
+    QAction *banAction = menu.addAction("Ban All");
+    menu.addSeparator();
+
+    QAction *copyUsernamesAction = menu.addAction("Copy Usernames");
+
+    QAction *selectedAction = menu.exec(globalPos);
+
+    if (selectedAction == timeout1m) {
+        emit usersTimeoutRequested(usernames, 60);
+    }
+    else if (selectedAction == timeout10m) {
+        emit usersTimeoutRequested(usernames, 600);
+    }
+    else if (selectedAction == timeout1h) {
+        emit usersTimeoutRequested(usernames, 3600);
+    }
+    else if (selectedAction == banAction) {
+        emit usersBanRequested(usernames);
+    }
+    else if (selectedAction == copyUsernamesAction) {
+        QApplication::clipboard()->setText(usernames.join("\n"));
+    }
+}
+
 void UserList::onUserContextMenu(const QPoint &pos)
 {
+    QStringList selected = getSelectedUsernames();
+    if (selected.size() > 1) {
+        showMultiUserMenu(selected, m_listWidget->mapToGlobal(pos));
+        return;
+    }
+
     QString username = getSelectedUsername();
     if (username.isEmpty()) {
         return;
@@ -123,13 +226,6 @@ void UserList::onUserContextMenu(const QPoint &pos)
     // Handle actions
     if (selectedAction == viewInfoAction) {
         emit userInfoRequested(username);
-        QMessageBox::information(this, "User Info",
-                                QString("User: %1\n\n"
-                                       "This will show:\n"
-                                       "- Account creation date\n"
-                                       "- Follow status\n"
-                                       "- Previous bans/timeouts\n"
-                                       "- Message history").arg(username));
     }
     else if (selectedAction == timeout1m) {
         emit userTimeoutRequested(username, 60);
@@ -147,8 +243,7 @@ void UserList::onUserContextMenu(const QPoint &pos)
         emit userBanRequested(username);
     }
     else if (selectedAction == deleteMessagesAction) {
-        QMessageBox::information(this, "Delete Messages",
-                                QString("Deleting recent messages from %1").arg(username));
+        emit userMessagesDeleteRequested(username);
     }
     else if (selectedAction == copyUsernameAction) {
         QApplication::clipboard()->setText(username);
@@ -6,6 +6,8 @@
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QMenu>
+#include <QDateTime>
+#include <QHash>
 
 class UserList : public QWidget
 {
@@ -14,15 +16,28 @@ class UserList : public QWidget
 public:
     explicit UserList(QWidget *parent = nullptr);
 
+    // Adding a user already listed is a no-op
     void addUser(const QString &username, bool isModerator = false, bool isVip = false);
     void removeUser(const QString &username);
+    // Bulk variants for chatter list syncs, sorted once per call
+    void addUsers(const QStringList &usernames);
+    void removeUsers(const QStringList &usernames);
+    bool hasUser(const QString &username) const;
     void clearUsers();
     void setUserCount(int count);
 
+    // Account age from a user lookup; accounts younger than a week are highlighted
+    void setAccountCreated(const QString &username, const QDateTime &createdAt);
+
 signals:
     void userBanRequested(const QString &username);
     void userTimeoutRequested(const QString &username, int seconds);
     void userInfoRequested(const QString &username);
+    void userMessagesDeleteRequested(const QString &username);
+
+    // Multi-selection (Ctrl/Shift-click) actions, run as one batch
+    void usersBanRequested(const QStringList &usernames);
+    void usersTimeoutRequested(const QStringList &usernames, int seconds);
 
 private slots:
     void onUserContextMenu(const QPoint &pos);
@@ -30,8 +45,12 @@ private slots:
 private:
     QLabel *m_headerLabel;
     QListWidget *m_listWidget;
+    QHash<QString, QListWidgetItem*> m_items; // by username
 
     QString getSelectedUsername() const;
+    QStringList getSelectedUsernames() const;
+    void showMultiUserMenu(const QStringList &usernames, const QPoint &globalPos);
+    void insertUser(const QString &username, bool isModerator, bool isVip);
 };
 
 #endif // USERLIST_H
@@ -0,0 +1,93 @@
+#include "moderation/textfeatures.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <cstdio>
+
+// ns/char of each text feature kernel on chat-sized messages and on one
+// long buffer. Run a Release build:
+//
+//   bench_textfeatures [iterations]
+
+using TextFeatureKernels::Kernel;
+
+namespace {
+QStringList makeMessages(int count)
+{
+    static const QStringList words = {
+        "lol", "KEKW", "PogChamp", "gg", "www.example.com", "https://clips.twitch.tv/x",
+        "!!!!!", "wwwwwww", "1234", "HYPE", "nice", "that", "was", "close",
+        QString::fromUtf16(u"\U0001F602\U0001F602"),
+        QString::fromUtf16(u"Z\u0336\u0337a\u0301l\u1DC0g\u20D0o"),
+        QString::fromUtf16(u"\u00E9t\u00E9"),
+    };
+    QRandomGenerator random(7);
+    QStringList messages;
+    messages.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QString message;
+        const int wordCount = 1 + random.bounded(24);
+        for (int w = 0; w < wordCount; ++w) {
+            if (w > 0) {
+                message += ' ';
+            }
+            message += words.at(random.bounded(int(words.size())));
+        }
+        messages.append(message);
+    }
+    return messages;
+}
+
+// Sum of a counter so the compiler cannot drop the work
+int run(Kernel kernel, const QStringList &messages)
+{
+    int sink = 0;
+    for (const QString &message : messages) {
+        sink += TextFeatureKernels::computeWith(kernel, message.constData(), message.size()).urlHits;
+    }
+    return sink;
+}
+
+void report(const char *corpus, const QStringList &messages, int iterations)
+{
+    qint64 units = 0;
+    for (const QString &message : messages) {
+        units += message.size();
+    }
+
+    double scalarNs = 0;
+    for (Kernel kernel : {Kernel::Scalar, Kernel::SSE2, Kernel::AVX2}) {
+        if (!TextFeatureKernels::isSupported(kernel)) {
+            std::printf("%-10s %-7s unsupported\n", corpus, TextFeatureKernels::kernelName(kernel));
+            continue;
+        }
+        int sink = run(kernel, messages); // warm-up
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i) {
+            sink += run(kernel, messages);
+        }
+        const double nsPerChar = double(timer.nsecsElapsed()) / (double(units) * iterations);
+        if (kernel == Kernel::Scalar) {
+            scalarNs = nsPerChar;
+        }
+        std::printf("%-10s %-7s %8.3f ns/char  %5.2fx  (%d)\n", corpus, TextFeatureKernels::kernelName(kernel),
+                    nsPerChar, scalarNs / nsPerChar, sink);
+    }
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const int iterations = argc > 1 ? qMax(1, QString(argv[1]).toInt()) : 200;
+
+    std::printf("active kernel: %s, %d iterations\n",
+                TextFeatureKernels::kernelName(TextFeatureKernels::activeKernel()), iterations);
+
+    const QStringList messages = makeMessages(10000);
+    report("messages", messages, iterations);
+    report("long", QStringList{messages.join(' ')}, iterations);
+    return 0;
+}
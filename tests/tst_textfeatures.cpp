@@ -0,0 +1,205 @@
+#include "moderation/textfeatures.h"
+#include <QRandomGenerator>
+#include <QtTest>
+
+using TextFeatureKernels::Kernel;
+
+namespace {
+const Kernel SIMD_KERNELS[] = {Kernel::SSE2, Kernel::AVX2};
+
+// Lengths around one SSE2 (8) and AVX2 (16) block, plus the three units of
+// look-ahead the URL compare needs past the end of a block
+const int EDGE_LENGTHS[] = {0, 1, 2, 3, 7, 8, 9, 10, 11, 12, 15, 16, 17, 18, 19, 20,
+                            23, 24, 31, 32, 33, 34, 35, 36, 63, 64, 65, 67};
+
+QString describe(const TextFeatures &f)
+{
+    return QString("len=%1 upper=%2 lower=%3 digits=%4 spaces=%5 symbols=%6 nonAscii=%7 "
+                   "combining=%8 repeated=%9 longestRun=%10 urlHits=%11")
+        .arg(f.length).arg(f.uppercase).arg(f.lowercase).arg(f.digits).arg(f.spaces)
+        .arg(f.symbols).arg(f.nonAscii).arg(f.combining).arg(f.repeated)
+        .arg(f.longestRun).arg(f.urlHits);
+}
+
+// seed repeated and cut to exactly length code units; a cut may split a
+// surrogate pair, which the kernels must handle like any other unit
+QString fill(const QString &seed, int length)
+{
+    QString text;
+    text.reserve(length);
+    while (text.size() < length) {
+        text += seed;
+    }
+    text.truncate(length);
+    return text;
+}
+
+QChar randomUnit(QRandomGenerator &random, QChar previous)
+{
+    static const char16_t COMBINING_BASES[] = {0x0300, 0x1AB0, 0x1DC0, 0x20D0, 0xFE20};
+    const int pick = random.bounded(100);
+    if (pick < 55) {
+        return QChar(char16_t(0x20 + random.bounded(0x5F)));
+    }
+    if (pick < 65) {
+        return QChar(char16_t(COMBINING_BASES[random.bounded(5)] + random.bounded(0x30)));
+    }
+    if (pick < 75) {
+        return QChar(char16_t(0xD800 + random.bounded(0x800)));
+    }
+    if (pick < 90) {
+        return previous;
+    }
+    return QChar(char16_t(0x80 + random.bounded(0xFF80)));
+}
+}
+
+class TestTextFeatures : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void scalarReference();
+    void kernelsAgree_data();
+    void kernelsAgree();
+    void urlMarkerAtEveryOffset();
+    void runAcrossBlocks();
+    void randomText();
+
+private:
+    void compareKernels(const QString &text);
+};
+
+void TestTextFeatures::initTestCase()
+{
+    for (Kernel kernel : SIMD_KERNELS) {
+        if (!TextFeatureKernels::isSupported(kernel)) {
+            qInfo("%s is not supported on this CPU; only the scalar path is checked for it",
+                  TextFeatureKernels::kernelName(kernel));
+        }
+    }
+    qInfo("active kernel: %s", TextFeatureKernels::kernelName(TextFeatureKernels::activeKernel()));
+}
+
+void TestTextFeatures::compareKernels(const QString &text)
+{
+    const TextFeatures expected = TextFeatureKernels::computeWith(Kernel::Scalar, text.constData(), text.size());
+    for (Kernel kernel : SIMD_KERNELS) {
+        if (!TextFeatureKernels::isSupported(kernel)) {
+            continue;
+        }
+        const TextFeatures actual = TextFeatureKernels::computeWith(kernel, text.constData(), text.size());
+        QVERIFY2(actual == expected,
+                 qPrintable(QString("%1 differs from scalar on %2 units\n  scalar: %3\n  %1: %4")
+                                .arg(TextFeatureKernels::kernelName(kernel))
+                                .arg(text.size())
+                                .arg(describe(expected), describe(actual))));
+    }
+}
+
+// Pins down what the counters mean, so agreement is with the right thing
+void TestTextFeatures::scalarReference()
+{
+    const QString text = QString::fromUtf16(u"AAb1 !\u00E9\u0301 https://x www.y");
+    const TextFeatures f = TextFeatureKernels::computeWith(Kernel::Scalar, text.constData(), text.size());
+    QCOMPARE(f.length, int(text.size()));
+    QCOMPARE(f.uppercase, 2);
+    QCOMPARE(f.lowercase, 1 + 5 + 1 + 3 + 1);
+    QCOMPARE(f.digits, 1);
+    QCOMPARE(f.spaces, 3);
+    QCOMPARE(f.symbols, 1 + 1 + 2 + 1);
+    QCOMPARE(f.nonAscii, 2);
+    QCOMPARE(f.combining, 1);
+    QCOMPARE(f.urlHits, 2);
+    QCOMPARE(f.longestRun, 3);
+}
+
+void TestTextFeatures::kernelsAgree_data()
+{
+    QTest::addColumn<QString>("text");
+
+    const QList<QPair<const char *, QString>> seeds = {
+        {"ascii", QStringLiteral("Hello, World! 123 abc XYZ ~~~ ")},
+        {"surrogates", QString::fromUtf16(u"a\U0001F600b\U0001F600\U0001F602 x\U0001F47E")},
+        {"combining", QString::fromUtf16(u"Z\u0336\u0337a\u0301\u1AB0l\u1DC0g\u20D0o\uFE20 \u0300\u036F")},
+        {"url", QStringLiteral("see https://www.example.com or WWW.x :// ww.w wWw.")},
+        {"runs", QStringLiteral("aaaaAAAA!!!!    1111")},
+        {"mixed", QString::fromUtf16(u"GG\u00E9\u0301 \U0001F600 www.a ://b zzz")},
+    };
+    for (const auto &seed : seeds) {
+        for (int length : EDGE_LENGTHS) {
+            QTest::addRow("%s/%d", seed.first, length) << fill(seed.second, length);
+        }
+    }
+}
+
+void TestTextFeatures::kernelsAgree()
+{
+    QFETCH(QString, text);
+    compareKernels(text);
+}
+
+// A marker may start in one block and end in the next, or in the tail
+void TestTextFeatures::urlMarkerAtEveryOffset()
+{
+    for (const QString &marker : {QStringLiteral("://"), QStringLiteral("www."), QStringLiteral("WwW.")}) {
+        for (int length : {24, 40}) {
+            for (int offset = 0; offset + marker.size() <= length; ++offset) {
+                QString text(length, QChar('x'));
+                text.replace(offset, marker.size(), marker);
+                const TextFeatures f = TextFeatureKernels::computeWith(Kernel::Scalar, text.constData(), text.size());
+                QCOMPARE(f.urlHits, 1);
+                compareKernels(text);
+                if (QTest::currentTestFailed()) {
+                    return;
+                }
+                // One unit short of a marker must not count
+                text.truncate(offset + marker.size() - 1);
+                compareKernels(text);
+            }
+        }
+    }
+}
+
+// The longest run may start in one block and span several
+void TestTextFeatures::runAcrossBlocks()
+{
+    for (int start = 0; start < 20; ++start) {
+        for (int run : {1, 2, 7, 8, 9, 16, 17, 33}) {
+            QString text = fill(QStringLiteral("ab"), start + run + 5);
+            text.replace(start, run, QString(run, QChar('z')));
+            compareKernels(text);
+            if (QTest::currentTestFailed()) {
+                return;
+            }
+        }
+    }
+}
+
+void TestTextFeatures::randomText()
+{
+    QRandomGenerator random(20261019);
+    for (int round = 0; round < 2000; ++round) {
+        const int length = round < 200 ? round : random.bounded(1, 600);
+        QString text;
+        text.reserve(length);
+        QChar previous(u'a');
+        for (int i = 0; i < length; ++i) {
+            previous = randomUnit(random, previous);
+            text += previous;
+        }
+        if (length > 4 && random.bounded(4) == 0) {
+            text.replace(random.bounded(length - 4), 4, random.bounded(2) ? QStringLiteral("www.")
+                                                                          : QStringLiteral("://x"));
+        }
+        compareKernels(text);
+        if (QTest::currentTestFailed()) {
+            qWarning("random round %d, length %d", round, length);
+            return;
+        }
+    }
+}
+
+QTEST_MAIN(TestTextFeatures)
+#include "tst_textfeatures.moc"